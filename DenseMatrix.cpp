@@ -1,9 +1,17 @@
 #include "DenseMatrix.h"
 #include "SparseMatrix.h"
 #include "MatCalcUtil.h"
+#include "NonZeroVisitor.h"
+#include "MatrixCostModel.h"
+#include "MatCalcKernels.h"
 #include <algorithm>
 #include <iomanip>
 #include <set>
+#include <limits> // Required by g++ (std::numeric_limits<double>)
+
+const size_t DenseMatrix::MultiplyBlockNumRows;
+const size_t DenseMatrix::MultiplyPanelNumRows;
+const size_t DenseMatrix::TransposeBlockSize;
 
 // Public members
 
@@ -12,6 +20,8 @@ DenseMatrix::DenseMatrix()
 	// Invalid state.
 	numRows = 0;
 	numColumns = 0;
+	numNonZeros = 0;
+	isNonZeroCountDirty = false;
 }
 
 DenseMatrix::DenseMatrix(size_t numRows, size_t numColumns, double initialValues)
@@ -19,17 +29,56 @@ DenseMatrix::DenseMatrix(size_t numRows, size_t numColumns, double initialValues
 	this->numRows = numRows;
 	this->numColumns = numColumns;
 
-	denseMatrix.resize(numRows);
+	denseMatrix.assign(numRows * numColumns, initialValues);
 
-	for (size_t r = 0; r < numRows; r++)
-	{
-		denseMatrix[r].resize(numColumns);
+	numNonZeros = mcu::doubleAlmostEqual(initialValues, 0.0) ? 0 : denseMatrix.size();
+	isNonZeroCountDirty = false;
+}
 
-		for (size_t c = 0; c < numColumns; c++)
-		{
-			denseMatrix[r][c] = initialValues;
-		}
+DenseMatrix::DenseMatrix(size_t numRows, size_t numColumns, double initialValues, MatrixAllocator* allocator)
+	: denseMatrix(numRows * numColumns, initialValues, CellStorage::allocator_type(allocator))
+{
+	this->numRows = numRows;
+	this->numColumns = numColumns;
+
+	numNonZeros = mcu::doubleAlmostEqual(initialValues, 0.0) ? 0 : denseMatrix.size();
+	isNonZeroCountDirty = false;
+}
+
+DenseMatrix* DenseMatrix::createUninitialized(size_t numRows, size_t numColumns)
+{
+	DenseMatrix* matrix = new DenseMatrix();
+	matrix->numRows = numRows;
+	matrix->numColumns = numColumns;
+	matrix->denseMatrix.resize(numRows * numColumns); // Default-initialized (see MatrixStorageAllocator::construct).
+	matrix->isNonZeroCountDirty = true;
+
+	return matrix;
+}
+
+DenseMatrix* DenseMatrix::createCopy(const MatrixBase& source, MatrixAllocator* allocator)
+{
+	DenseMatrix* copy = new DenseMatrix(0, 0, 0.0, allocator);
+	copy->numRows = source.getNumRows();
+	copy->numColumns = source.getNumColumns();
+	copy->isNonZeroCountDirty = true;
+
+	const DenseMatrix* denseSource = dynamic_cast<const DenseMatrix*>(&source);
+
+	if (denseSource != nullptr)
+	{
+		copy->denseMatrix.assign(denseSource->denseMatrix.begin(), denseSource->denseMatrix.end());
+		return copy;
 	}
+
+	copy->denseMatrix.assign(copy->numRows * copy->numColumns, 0.0);
+
+	mcu::visitNonZeros(source, [&](size_t row, size_t column, double value)
+	{
+		copy->denseMatrix[row * copy->numColumns + column] = value;
+	});
+
+	return copy;
 }
 
 // Inherited via MatrixBase
@@ -45,12 +94,29 @@ size_t DenseMatrix::getNumColumns() const
 
 double DenseMatrix::getCell(size_t row, size_t column) const
 {
-	return denseMatrix[row][column];
+	return denseMatrix[row * numColumns + column];
 }
 
 void DenseMatrix::setCell(size_t row, size_t column, double value)
 {
-	denseMatrix[row][column] = value;
+	double& cell = denseMatrix[row * numColumns + column];
+
+	if (isNonZeroCountDirty == false)
+	{
+		bool wasZero = mcu::doubleAlmostEqual(cell, 0.0);
+		bool isZero = mcu::doubleAlmostEqual(value, 0.0);
+
+		if (wasZero && !isZero)
+		{
+			numNonZeros++;
+		}
+		else if (!wasZero && isZero)
+		{
+			numNonZeros--;
+		}
+	}
+
+	cell = value;
 }
 
 void DenseMatrix::resizeNumRows(size_t newNumRows)
@@ -60,23 +126,21 @@ void DenseMatrix::resizeNumRows(size_t newNumRows)
 		return;
 	}
 
-	size_t oldNumRows = numRows;
-
-	numRows = newNumRows;
-	denseMatrix.resize(numRows);
-
-	if (oldNumRows < numRows)
+	// Only the removed rows need to be counted. The added rows are zero.
+	if (isNonZeroCountDirty == false)
 	{
-		for (size_t r = oldNumRows; r < numRows; r++)
+		for (size_t i = newNumRows * numColumns; i < denseMatrix.size(); i++)
 		{
-			denseMatrix[r].resize(numColumns);
-
-			for (size_t c = 0; c < numColumns; c++)
+			if (mcu::doubleAlmostEqual(denseMatrix[i], 0.0) == false)
 			{
-				denseMatrix[r][c] = 0.0;
+				numNonZeros--;
 			}
 		}
 	}
+
+	// The rows are stored one after another, so rows can be added (or removed) at the end without moving the others.
+	numRows = newNumRows;
+	denseMatrix.resize(numRows * numColumns, 0.0);
 }
 
 void DenseMatrix::resizeNumColumns(size_t newNumColumns)
@@ -86,22 +150,21 @@ void DenseMatrix::resizeNumColumns(size_t newNumColumns)
 		return;
 	}
 
-	size_t oldNumColumns = numColumns;
-
-	numColumns = newNumColumns;
+	// Every row moves, so copy the rows into a new container (with the same allocator, so that the containers can be swapped).
+	CellStorage resizedMatrix(numRows * newNumColumns, 0.0, denseMatrix.get_allocator());
+	size_t numColumnsToCopy = std::min(numColumns, newNumColumns);
 
 	for (size_t r = 0; r < numRows; r++)
 	{
-		denseMatrix[r].resize(numColumns);
-
-		if (oldNumColumns < numColumns)
-		{
-			for (size_t c = oldNumColumns; c < numColumns; c++)
-			{
-				denseMatrix[r][c] = 0.0;
-			}
-		}
+		const double* oldRow = getRowData(r);
+		std::copy(oldRow, oldRow + numColumnsToCopy, resizedMatrix.begin() + (r * newNumColumns));
 	}
+
+	numColumns = newNumColumns;
+	denseMatrix.swap(resizedMatrix);
+
+	// Columns may have been removed.
+	isNonZeroCountDirty = true;
 }
 
 void DenseMatrix::resize(size_t newNumRows, size_t newNumColumns)
@@ -112,51 +175,21 @@ void DenseMatrix::resize(size_t newNumRows, size_t newNumColumns)
 
 void DenseMatrix::transpose()
 {
-	// Prepare transposed denseMatrix container.
-	std::vector<std::vector<double>> transposedMatrix;
-
-	transposedMatrix.resize(numColumns); // newNumRows == oldNumColumns
-
-	for (size_t r = 0; r < numColumns; r++)
+	if (numRows == numColumns)
 	{
-		transposedMatrix[r].resize(numRows); // newNumColumns == oldNumRows
-
-		for (size_t c = 0; c < numRows; c++)
-		{
-			transposedMatrix[r][c] = 0.0;
-		}
+		transposeDiagonalBlock(0, numRows);
 	}
-
-	// Copy from old to transposed.
-	for (size_t r = 0; r < numRows; r++)
+	else
 	{
-		for (size_t c = 0; c < numColumns; c++)
-		{
-			transposedMatrix[c][r] = denseMatrix[r][c];
-		}
+		transposeRectangular();
+		std::swap(numRows, numColumns);
 	}
-
-	std::swap(numRows, numColumns);
-
-	denseMatrix = transposedMatrix;
 }
 
 double DenseMatrix::getSparsity() const
 {
 	size_t numElements = numRows * numColumns;
-	size_t numZeroElements = 0;
-
-	for (size_t r = 0; r < numRows; r++)
-	{
-		for (size_t c = 0; c < numColumns; c++)
-		{
-			double valueAtCell = denseMatrix[r][c];
-			if (mcu::doubleAlmostEqual(valueAtCell, 0.0))
-			{
-				numZeroElements++;
-			}
-		}
-	}
+	size_t numZeroElements = numElements - getNumNonZeros();
 
 	double nominator = numZeroElements;
 	double denominator = numElements;
@@ -165,6 +198,16 @@ double DenseMatrix::getSparsity() const
 	return sparsity;
 }
 
+size_t DenseMatrix::getNumNonZeros() const
+{
+	if (isNonZeroCountDirty)
+	{
+		recountNonZeros();
+	}
+
+	return numNonZeros;
+}
+
 double DenseMatrix::getDensity() const
 {
 	return 1.0 - getSparsity();
@@ -183,7 +226,8 @@ bool DenseMatrix::isDense() const
 
 bool DenseMatrix::requiresConversion() const
 {
-	return !isDense(); // This is DenseMatrix. If it's not Dense, then it requires conversion to Sparse.
+	// This is DenseMatrix. It requires conversion to Sparse only if SparseMatrix is clearly cheaper (below the hysteresis band of the cost model).
+	return MatrixCostModel::getInstance().shouldConvertToSparse(numRows, numColumns, getNumNonZeros());
 }
 
 MatrixBase* DenseMatrix::getConvertedCopy() const
@@ -193,17 +237,7 @@ MatrixBase* DenseMatrix::getConvertedCopy() const
 
 MatrixBase* DenseMatrix::clone() const
 {
-	DenseMatrix* clone = new DenseMatrix(numRows, numColumns, 0.0);
-
-	for (size_t r = 0; r < numRows; r++)
-	{
-		for (size_t c = 0; c < numColumns; c++)
-		{
-			clone->denseMatrix[r][c] = this->denseMatrix[r][c];
-		}
-	}
-
-	return clone;
+	return new DenseMatrix(*this);
 }
 
 DenseMatrix* DenseMatrix::cloneAsDenseMatrix() const
@@ -219,7 +253,7 @@ SparseMatrix* DenseMatrix::cloneAsSparseMatrix() const
 	{
 		for (size_t c = 0; c < numColumns; c++)
 		{
-			double valueAtCell = this->denseMatrix[r][c];
+			double valueAtCell = this->getCell(r, c);
 			sparseClone->setCell(r, c, valueAtCell);
 		}
 	}
@@ -227,29 +261,143 @@ SparseMatrix* DenseMatrix::cloneAsSparseMatrix() const
 	return sparseClone;
 }
 
-std::vector<std::tuple<size_t, size_t, double>> DenseMatrix::getCellDataList() const
+void DenseMatrix::forEachNonZero(const std::function<void(size_t row, size_t column, double value)>& visitor) const
+{
+	visitNonZeros([&](size_t row, size_t column, double value)
+	{
+		visitor(row, column, value);
+	});
+}
+
+const double* DenseMatrix::getRowData(size_t row) const
 {
-	std::vector<std::tuple<size_t, size_t, double>> cellList;
+	return denseMatrix.data() + (row * numColumns);
+}
 
-	for (size_t r = 0; r < numRows; r++)
+double* DenseMatrix::getRowData(size_t row)
+{
+	// The caller may write anything into the row.
+	isNonZeroCountDirty = true;
+
+	return denseMatrix.data() + (row * numColumns);
+}
+
+DenseMatrixView DenseMatrix::getView() const
+{
+	return DenseMatrixView(denseMatrix.data(), numRows, numColumns, numColumns, 1);
+}
+
+DenseMatrixView DenseMatrix::getSubView(size_t subRowBeginIndex, size_t subNumRows, size_t subColumnBeginIndex, size_t subNumColumns) const
+{
+	return getView().getSubView(subRowBeginIndex, subNumRows, subColumnBeginIndex, subNumColumns);
+}
+
+void DenseMatrix::scale(double scalar)
+{
+	// Count the non-zero elements in the same pass, because scaling may turn elements into (almost) zero.
+	numNonZeros = 0;
+
+	for (size_t i = 0; i < denseMatrix.size(); i++)
 	{
-		for (size_t c = 0; c < numColumns; c++)
+		denseMatrix[i] *= scalar;
+
+		if (mcu::doubleAlmostEqual(denseMatrix[i], 0.0) == false)
 		{
-			auto cellData = std::make_tuple(r, c, denseMatrix[r][c]);
-			cellList.push_back(cellData);
+			numNonZeros++;
 		}
 	}
 
-	return cellList;
+	isNonZeroCountDirty = false;
 }
 
-void DenseMatrix::scale(double scalar)
+void DenseMatrix::addInPlace(const MatrixBase& right, double alpha)
+{
+	right.addScaledTo(*this, alpha);
+}
+
+void DenseMatrix::addScaledTo(DenseMatrix& target, double alpha) const
+{
+	// Same dimensions, so the cells line up in memory. The non-zero elements of the target are counted in the same pass.
+	target.numNonZeros = 0;
+
+	for (size_t i = 0; i < denseMatrix.size(); i++)
+	{
+		target.denseMatrix[i] += alpha * denseMatrix[i];
+
+		if (mcu::doubleAlmostEqual(target.denseMatrix[i], 0.0) == false)
+		{
+			target.numNonZeros++;
+		}
+	}
+
+	target.isNonZeroCountDirty = false;
+}
+
+void DenseMatrix::addScaledTo(SparseMatrix& target, double alpha) const
 {
 	for (size_t r = 0; r < numRows; r++)
 	{
 		for (size_t c = 0; c < numColumns; c++)
 		{
-			denseMatrix[r][c] *= scalar;
+			double value = getCell(r, c);
+
+			if (value == 0.0)
+			{
+				continue; // Nothing to add.
+			}
+
+			double existingValue = target.getCell(r, c);
+			target.setCell(r, c, existingValue + alpha * value);
+		}
+	}
+}
+
+void DenseMatrix::multiplyAccumulate(double alpha, const MatrixBase& left, const MatrixBase& right, double beta)
+{
+	// Scale the existing values first. When beta is zero, the existing values are ignored (even if they are NaN), like BLAS does.
+	if (beta == 0.0)
+	{
+		std::fill(denseMatrix.begin(), denseMatrix.end(), 0.0);
+	}
+	else if (beta != 1.0)
+	{
+		scale(beta);
+	}
+
+	size_t innerDimension = left.getNumColumns();
+	const DenseMatrix* leftDense = dynamic_cast<const DenseMatrix*>(&left);
+	const DenseMatrix* rightDense = dynamic_cast<const DenseMatrix*>(&right);
+
+	// Same traversal as the multiply methods: a CELL of the LEFTmatrix scales a ROW of the RIGHTmatrix, which is ADDED to a ROW of this matrix.
+	for (size_t r = 0; r < numRows; r++)
+	{
+		double* resultRow = getRowData(r);
+
+		for (size_t k = 0; k < innerDimension; k++)
+		{
+			double leftValue = alpha * ((leftDense != nullptr) ? leftDense->getCell(r, k) : left.getCell(r, k));
+
+			if (leftValue == 0.0)
+			{
+				continue; // The row of the right matrix would contribute nothing.
+			}
+
+			if (rightDense != nullptr)
+			{
+				const double* rightRow = rightDense->getRowData(k);
+
+				for (size_t c = 0; c < numColumns; c++)
+				{
+					resultRow[c] += leftValue * rightRow[c];
+				}
+			}
+			else
+			{
+				for (size_t c = 0; c < numColumns; c++)
+				{
+					resultRow[c] += leftValue * right.getCell(k, c);
+				}
+			}
 		}
 	}
 }
@@ -269,12 +417,12 @@ bool DenseMatrix::equal(const DenseMatrix& left) const
 	// Dimensions match. Check every element.
 	for (size_t r = 0; r < numRows; r++)
 	{
+		const double* leftRow = left.getRowData(r);
+		const double* rightRow = this->getRowData(r);
+
 		for (size_t c = 0; c < numColumns; c++)
 		{
-			double leftValue = left.getCell(r, c);
-			double rightValue = this->getCell(r, c);
-
-			if (mcu::doubleAlmostEqual(leftValue, rightValue) == false)
+			if (mcu::doubleAlmostEqual(leftRow[c], rightRow[c]) == false)
 			{
 				return false;
 			}
@@ -292,14 +440,25 @@ bool DenseMatrix::equal(const SparseMatrix& left) const
 	}
 
 	// Dimensions match. Check every element.
+	// The non-zero elements of the left matrix are ordered by row, then by column. So they can be walked alongside the cells, without any lookups.
+	auto leftIter = left.nonZeroBegin();
+	auto leftEnd = left.nonZeroEnd();
+
 	for (size_t r = 0; r < numRows; r++)
 	{
+		const double* rightRow = this->getRowData(r);
+
 		for (size_t c = 0; c < numColumns; c++)
 		{
-			double leftValue = left.getCell(r, c);
-			double rightValue = this->getCell(r, c);
+			double leftValue = 0.0;
 
-			if (mcu::doubleAlmostEqual(leftValue, rightValue) == false)
+			if (leftIter != leftEnd && (*leftIter).first.first == r && (*leftIter).first.second == c)
+			{
+				leftValue = (*leftIter).second;
+				++leftIter;
+			}
+
+			if (mcu::doubleAlmostEqual(leftValue, rightRow[c]) == false)
 			{
 				return false;
 			}
@@ -316,24 +475,17 @@ MatrixBase* DenseMatrix::add(const MatrixBase& right) const
 
 MatrixBase* DenseMatrix::add(const DenseMatrix& left) const
 {
-	DenseMatrix* addedDense = new DenseMatrix(numRows, numColumns, 0.0);
-
-	// Set left.
-	for (size_t r = 0; r < left.numRows; r++)
-	{
-		for (size_t c = 0; c < left.numColumns; c++)
-		{
-			double valueAtCell = left.getCell(r, c);
-			addedDense->setCell(r, c, valueAtCell);
-		}
-	}
+	DenseMatrix* addedDense = new DenseMatrix(left);
 
 	// Add right.
 	for (size_t r = 0; r < this->numRows; r++)
 	{
+		const double* rightRow = this->getRowData(r);
+		double* resultRow = addedDense->getRowData(r);
+
 		for (size_t c = 0; c < this->numColumns; c++)
 		{
-			addedDense->denseMatrix[r][c] += this->denseMatrix[r][c];
+			resultRow[c] += rightRow[c];
 		}
 	}
 
@@ -342,34 +494,16 @@ MatrixBase* DenseMatrix::add(const DenseMatrix& left) const
 
 MatrixBase* DenseMatrix::add(const SparseMatrix& left) const
 {
-	DenseMatrix* addedDense = new DenseMatrix(numRows, numColumns, 0.0);
-
-	// Set left.
-	auto leftCellDataList = left.getCellDataList();
-	auto leftCellDataListBegin = leftCellDataList.begin();
-	auto leftCellDataListEnd = leftCellDataList.end();
+	// Set right.
+	DenseMatrix* addedDense = new DenseMatrix(*this);
 
-	for (auto iter = leftCellDataListBegin; iter != leftCellDataListEnd; ++iter)
+	// Add the non-zero elements of left.
+	for (auto iter = left.nonZeroBegin(); iter != left.nonZeroEnd(); ++iter)
 	{
-		auto cellData = (*iter);
-		size_t row = std::get<0>(cellData);
-		size_t column = std::get<1>(cellData);
-		double value = std::get<2>(cellData);
+		size_t row = (*iter).first.first;
+		size_t column = (*iter).first.second;
 
-		addedDense->setCell(row, column, value);
-	}
-
-	// Add right.
-	for (size_t r = 0; r < this->numRows; r++)
-	{
-		for (size_t c = 0; c < this->numColumns; c++)
-		{
-			double rightValue = this->getCell(r, c);
-			double existingValue = addedDense->getCell(r, c);
-			double newValue = existingValue + rightValue;
-
-			addedDense->setCell(r, c, newValue);
-		}
+		addedDense->getRowData(row)[column] += (*iter).second;
 	}
 
 	return addedDense;
@@ -382,28 +516,17 @@ MatrixBase* DenseMatrix::subtract(const MatrixBase& right) const
 
 MatrixBase* DenseMatrix::subtract(const DenseMatrix& left) const
 {
-	DenseMatrix* subtractedDense = new DenseMatrix(numRows, numColumns, 0.0);
-
-	// Set left.
-	for (size_t r = 0; r < left.numRows; r++)
-	{
-		for (size_t c = 0; c < left.numColumns; c++)
-		{
-			double valueAtCell = left.getCell(r, c);
-			subtractedDense->setCell(r, c, valueAtCell);
-		}
-	}
+	DenseMatrix* subtractedDense = new DenseMatrix(left);
 
 	// Add negated right.
 	for (size_t r = 0; r < this->numRows; r++)
 	{
+		const double* rightRow = this->getRowData(r);
+		double* resultRow = subtractedDense->getRowData(r);
+
 		for (size_t c = 0; c < this->numColumns; c++)
 		{
-			double rightValue = this->getCell(r, c);
-			double existingValue = subtractedDense->getCell(r, c);
-			double newValue = existingValue - rightValue; // SUBTRACTION
-
-			subtractedDense->setCell(r, c, newValue);
+			resultRow[c] -= rightRow[c]; // SUBTRACTION
 		}
 	}
 
@@ -412,34 +535,27 @@ MatrixBase* DenseMatrix::subtract(const DenseMatrix& left) const
 
 MatrixBase* DenseMatrix::subtract(const SparseMatrix& left) const
 {
+	// Set negated right. Subtracting from zero (instead of negating) keeps the zero cells positive.
 	DenseMatrix* subtractedDense = new DenseMatrix(numRows, numColumns, 0.0);
 
-	// Set left.
-	auto leftCellDataList = left.getCellDataList();
-	auto leftCellDataListBegin = leftCellDataList.begin();
-	auto leftCellDataListEnd = leftCellDataList.end();
-
-	for (auto iter = leftCellDataListBegin; iter != leftCellDataListEnd; ++iter)
+	for (size_t r = 0; r < this->numRows; r++)
 	{
-		auto cellData = (*iter);
-		size_t row = std::get<0>(cellData);
-		size_t column = std::get<1>(cellData);
-		double value = std::get<2>(cellData);
+		const double* rightRow = this->getRowData(r);
+		double* resultRow = subtractedDense->getRowData(r);
 
-		subtractedDense->setCell(row, column, value);
+		for (size_t c = 0; c < this->numColumns; c++)
+		{
+			resultRow[c] = 0.0 - rightRow[c]; // SUBTRACTION
+		}
 	}
 
-	// Add negated right.
-	for (size_t r = 0; r < this->numRows; r++)
+	// Add the non-zero elements of left.
+	for (auto iter = left.nonZeroBegin(); iter != left.nonZeroEnd(); ++iter)
 	{
-		for (size_t c = 0; c < this->numColumns; c++)
-		{
-			double rightValue = this->getCell(r, c);
-			double existingValue = subtractedDense->getCell(r, c);
-			double newValue = existingValue - rightValue; // SUBTRACTION
+		size_t row = (*iter).first.first;
+		size_t column = (*iter).first.second;
 
-			subtractedDense->setCell(r, c, newValue);
-		}
+		subtractedDense->getRowData(row)[column] += (*iter).second;
 	}
 
 	return subtractedDense;
@@ -462,18 +578,17 @@ MatrixBase* DenseMatrix::multiply(const DenseMatrix& left) const
 
 	for (size_t leftRow = 0; leftRow < left.getNumRows(); leftRow++)
 	{
+		const double* leftRowData = left.getRowData(leftRow);
+		double* productRowData = denseProduct->getRowData(leftRow);
+
 		for (size_t leftCol = 0; leftCol < left.getNumColumns(); leftCol++)
 		{
+			double leftValue = leftRowData[leftCol];
+			const double* rightRowData = this->getRowData(leftCol);
+
 			for (size_t rightCol = 0; rightCol < this->numColumns; rightCol++)
 			{
-				double leftValue = left.getCell(leftRow, leftCol);
-				double rightValue = this->getCell(leftCol, rightCol);
-				double product = leftValue * rightValue;
-
-				double existingValue = denseProduct->getCell(leftRow, rightCol);
-				double newValue = existingValue + product;
-
-				denseProduct->setCell(leftRow, rightCol, newValue);
+				productRowData[rightCol] += leftValue * rightRowData[rightCol];
 			}
 		}
 	}
@@ -483,24 +598,93 @@ MatrixBase* DenseMatrix::multiply(const DenseMatrix& left) const
 
 MatrixBase* DenseMatrix::multiply(const SparseMatrix& left) const
 {
-	// I'm using DenseMatrix * DenseMatrix algorithm again, because I don't know the best approach for now.
+	// Same as DenseMatrix * DenseMatrix, except that only the non-zero CELLs of the LEFTmatrix are used to scale the ROWs of the RIGHTmatrix.
 
 	DenseMatrix* denseProduct = new DenseMatrix(left.getNumRows(), this->numColumns, 0.0);
 
-	for (size_t leftRow = 0; leftRow < left.getNumRows(); leftRow++)
+	for (auto iter = left.nonZeroBegin(); iter != left.nonZeroEnd(); ++iter)
 	{
-		for (size_t leftCol = 0; leftCol < left.getNumColumns(); leftCol++)
+		size_t leftRow = (*iter).first.first;
+		size_t leftCol = (*iter).first.second;
+		double leftValue = (*iter).second;
+
+		const double* rightRowData = this->getRowData(leftCol);
+		double* productRowData = denseProduct->getRowData(leftRow);
+
+		for (size_t rightCol = 0; rightCol < this->numColumns; rightCol++)
 		{
-			for (size_t rightCol = 0; rightCol < this->numColumns; rightCol++)
+			productRowData[rightCol] += leftValue * rightRowData[rightCol];
+		}
+	}
+
+	return denseProduct;
+}
+
+DenseMatrix* DenseMatrix::multiplyViews(const DenseMatrixView& left, const DenseMatrixView& right)
+{
+	size_t productNumRows = left.getNumRows();
+	size_t productNumColumns = right.getNumColumns();
+	size_t innerDimension = left.getNumColumns();
+
+	DenseMatrix* denseProduct = new DenseMatrix(productNumRows, productNumColumns, 0.0);
+
+	for (size_t panelBegin = 0; panelBegin < innerDimension; panelBegin += MultiplyPanelNumRows)
+	{
+		size_t panelNumRows = std::min(MultiplyPanelNumRows, innerDimension - panelBegin);
+		DenseMatrixView rightPanel = right.getSubView(panelBegin, panelNumRows, 0, productNumColumns);
+
+		MatrixScratchScope scratchScope;
+		CellStorage packedRightPanel(scratchScope.getAllocator());
+		const double* rightPanelData = rightPanel.getData();
+		size_t rightPanelRowStride = rightPanel.getRowStride();
+
+		if (rightPanel.hasContiguousRows() == false)
+		{
+			packedRightPanel.resize(panelNumRows * productNumColumns);
+			rightPanel.copyTo(packedRightPanel.data(), productNumColumns);
+			rightPanelData = packedRightPanel.data();
+			rightPanelRowStride = productNumColumns;
+		}
+
+		CellStorage packedLeftBlock(scratchScope.getAllocator());
+
+		for (size_t blockBegin = 0; blockBegin < productNumRows; blockBegin += MultiplyBlockNumRows)
+		{
+			size_t blockNumRows = std::min(MultiplyBlockNumRows, productNumRows - blockBegin);
+			DenseMatrixView leftBlock = left.getSubView(blockBegin, blockNumRows, panelBegin, panelNumRows);
+			const double* leftBlockData = leftBlock.getData();
+			size_t leftBlockRowStride = leftBlock.getRowStride();
+
+			if (leftBlock.hasContiguousRows() == false)
+			{
+				packedLeftBlock.resize(blockNumRows * panelNumRows);
+				leftBlock.copyTo(packedLeftBlock.data(), panelNumRows);
+				leftBlockData = packedLeftBlock.data();
+				leftBlockRowStride = panelNumRows;
+			}
+
+			// Same traversal as multiply: a CELL of the LEFTmatrix scales a ROW of the RIGHTmatrix, which is ADDED to a ROW of the product.
+			for (size_t r = 0; r < blockNumRows; r++)
 			{
-				double leftValue = left.getCell(leftRow, leftCol);
-				double rightValue = this->getCell(leftCol, rightCol);
-				double product = leftValue * rightValue;
+				const double* leftRowData = leftBlockData + r * leftBlockRowStride;
+				double* productRowData = denseProduct->getRowData(blockBegin + r);
+
+				for (size_t k = 0; k < panelNumRows; k++)
+				{
+					double leftValue = leftRowData[k];
+
+					if (leftValue == 0.0)
+					{
+						continue;
+					}
 
-				double existingValue = denseProduct->getCell(leftRow, rightCol);
-				double newValue = existingValue + product;
+					const double* rightRowData = rightPanelData + k * rightPanelRowStride;
 
-				denseProduct->setCell(leftRow, rightCol, newValue);
+					for (size_t c = 0; c < productNumColumns; c++)
+					{
+						productRowData[c] += leftValue * rightRowData[c];
+					}
+				}
 			}
 		}
 	}
@@ -508,6 +692,72 @@ MatrixBase* DenseMatrix::multiply(const SparseMatrix& left) const
 	return denseProduct;
 }
 
+DenseMatrix* DenseMatrix::multiplyTransposed(const MatrixBase& left, bool transposeLeft, const DenseMatrix& right, bool transposeRight)
+{
+	size_t leftNumRows = transposeLeft ? left.getNumColumns() : left.getNumRows();
+	size_t innerDimension = transposeLeft ? left.getNumRows() : left.getNumColumns();
+	DenseMatrixView rightView = transposeRight ? right.getView().getTransposedView() : right.getView();
+
+	if (innerDimension != rightView.getNumRows())
+	{
+		return nullptr;
+	}
+
+	const DenseMatrix* leftDense = dynamic_cast<const DenseMatrix*>(&left);
+
+	if (leftDense != nullptr)
+	{
+		return multiplyViews(transposeLeft ? leftDense->getView().getTransposedView() : leftDense->getView(), rightView);
+	}
+
+	// The left operand is visited through its non-zero elements. An element at (row, column) of the left matrix is at (column, row) of its transpose.
+	size_t productNumColumns = rightView.getNumColumns();
+	DenseMatrix* denseProduct = new DenseMatrix(leftNumRows, productNumColumns, 0.0);
+
+	// Without packing, the whole right operand is a single panel. Packing only happens panel by panel, so each pass over the left operand skips the elements which belong to the other panels.
+	size_t panelNumRows = rightView.hasContiguousRows() ? innerDimension : MultiplyPanelNumRows;
+
+	for (size_t panelBegin = 0; panelBegin < innerDimension; panelBegin += panelNumRows)
+	{
+		size_t currentPanelNumRows = std::min(panelNumRows, innerDimension - panelBegin);
+		DenseMatrixView rightPanel = rightView.getSubView(panelBegin, currentPanelNumRows, 0, productNumColumns);
+
+		MatrixScratchScope scratchScope;
+		CellStorage packedRightPanel(scratchScope.getAllocator());
+		const double* rightPanelData = rightPanel.getData();
+		size_t rightPanelRowStride = rightPanel.getRowStride();
+
+		if (rightPanel.hasContiguousRows() == false)
+		{
+			packedRightPanel.resize(currentPanelNumRows * productNumColumns);
+			rightPanel.copyTo(packedRightPanel.data(), productNumColumns);
+			rightPanelData = packedRightPanel.data();
+			rightPanelRowStride = productNumColumns;
+		}
+
+		mcu::visitNonZeros(left, [&](size_t row, size_t column, double value)
+		{
+			size_t productRow = transposeLeft ? column : row;
+			size_t k = transposeLeft ? row : column;
+
+			if (k < panelBegin || k >= panelBegin + currentPanelNumRows)
+			{
+				return; // Belongs to another panel.
+			}
+
+			const double* rightRowData = rightPanelData + (k - panelBegin) * rightPanelRowStride;
+			double* productRowData = denseProduct->getRowData(productRow);
+
+			for (size_t c = 0; c < productNumColumns; c++)
+			{
+				productRowData[c] += value * rightRowData[c];
+			}
+		});
+	}
+
+	return denseProduct;
+}
+
 MatrixBase* DenseMatrix::mergeByColumns(const MatrixBase& right) const
 {
 	return right.mergeByColumns(*this);
@@ -517,28 +767,16 @@ MatrixBase* DenseMatrix::mergeByColumns(const DenseMatrix& left) const
 {
 	DenseMatrix* mergedDense = new DenseMatrix(numRows, left.getNumColumns() + numColumns, 0.0);
 
-	// Copy left.
-	for (size_t r = 0; r < numRows; r++)
-	{
-		for (size_t c = 0; c < left.getNumColumns(); c++)
-		{
-			double leftValue = left.getCell(r, c);
-			mergedDense->setCell(r, c, leftValue);
-		}
-	}
-
-	// Copy right.
 	for (size_t r = 0; r < numRows; r++)
 	{
-		for (size_t c = 0; c < this->getNumColumns(); c++)
-		{
-			double rightValue = this->getCell(r, c);
-
-			size_t columnOffset = left.getNumColumns();
-			size_t newColumnIndex = c + columnOffset;
+		// Copy left.
+		const double* leftRow = left.getRowData(r);
+		double* mergedRow = mergedDense->getRowData(r);
+		std::copy(leftRow, leftRow + left.getNumColumns(), mergedRow);
 
-			mergedDense->setCell(r, newColumnIndex, rightValue);
-		}
+		// Copy right.
+		const double* rightRow = this->getRowData(r);
+		std::copy(rightRow, rightRow + numColumns, mergedRow + left.getNumColumns());
 	}
 
 	return mergedDense;
@@ -549,32 +787,19 @@ MatrixBase* DenseMatrix::mergeByColumns(const SparseMatrix& left) const
 	DenseMatrix* mergedDense = new DenseMatrix(numRows, left.getNumColumns() + numColumns, 0.0);
 
 	// Copy left.
-	auto leftCellDataList = left.getCellDataList();
-	auto leftCellDataListBegin = leftCellDataList.begin();
-	auto leftCellDataListEnd = leftCellDataList.end();
-
-	for (auto iter = leftCellDataListBegin; iter != leftCellDataListEnd; ++iter)
+	for (auto iter = left.nonZeroBegin(); iter != left.nonZeroEnd(); ++iter)
 	{
-		auto cellData = (*iter);
-		size_t row = std::get<0>(cellData);
-		size_t column = std::get<1>(cellData);
-		double value = std::get<2>(cellData);
+		size_t row = (*iter).first.first;
+		size_t column = (*iter).first.second;
 
-		mergedDense->setCell(row, column, value);
+		mergedDense->getRowData(row)[column] = (*iter).second;
 	}
 
 	// Copy right.
 	for (size_t r = 0; r < numRows; r++)
 	{
-		for (size_t c = 0; c < this->getNumColumns(); c++)
-		{
-			double rightValue = this->getCell(r, c);
-
-			size_t columnOffset = left.getNumColumns();
-			size_t newColumnIndex = c + columnOffset;
-
-			mergedDense->setCell(r, newColumnIndex, rightValue);
-		}
+		const double* rightRow = this->getRowData(r);
+		std::copy(rightRow, rightRow + numColumns, mergedDense->getRowData(r) + left.getNumColumns());
 	}
 
 	return mergedDense;
@@ -592,25 +817,17 @@ MatrixBase* DenseMatrix::mergeByRows(const DenseMatrix& left) const
 	// Copy left.
 	for (size_t r = 0; r < left.getNumRows(); r++)
 	{
-		for (size_t c = 0; c < numColumns; c++)
-		{
-			double leftValue = left.getCell(r, c);
-			mergedDense->setCell(r, c, leftValue);
-		}
+		const double* leftRow = left.getRowData(r);
+		std::copy(leftRow, leftRow + numColumns, mergedDense->getRowData(r));
 	}
 
 	// Copy right.
+	size_t rowOffset = left.getNumRows();
+
 	for (size_t r = 0; r < this->getNumRows(); r++)
 	{
-		for (size_t c = 0; c < numColumns; c++)
-		{
-			double rightValue = this->getCell(r, c);
-
-			size_t rowOffset = left.getNumRows();
-			size_t newRowIndex = r + rowOffset;
-
-			mergedDense->setCell(newRowIndex, c, rightValue);
-		}
+		const double* rightRow = this->getRowData(r);
+		std::copy(rightRow, rightRow + numColumns, mergedDense->getRowData(r + rowOffset));
 	}
 
 	return mergedDense;
@@ -621,32 +838,21 @@ MatrixBase* DenseMatrix::mergeByRows(const SparseMatrix& left) const
 	DenseMatrix* mergedDense = new DenseMatrix(left.getNumRows() + numRows, numColumns, 0.0);
 
 	// Copy left.
-	auto leftCellDataList = left.getCellDataList();
-	auto leftCellDataListBegin = leftCellDataList.begin();
-	auto leftCellDataListEnd = leftCellDataList.end();
-
-	for (auto iter = leftCellDataListBegin; iter != leftCellDataListEnd; ++iter)
+	for (auto iter = left.nonZeroBegin(); iter != left.nonZeroEnd(); ++iter)
 	{
-		auto cellData = (*iter);
-		size_t row = std::get<0>(cellData);
-		size_t column = std::get<1>(cellData);
-		double leftValue = std::get<2>(cellData);
+		size_t row = (*iter).first.first;
+		size_t column = (*iter).first.second;
 
-		mergedDense->setCell(row, column, leftValue);
+		mergedDense->getRowData(row)[column] = (*iter).second;
 	}
 
 	// Copy right.
+	size_t rowOffset = left.getNumRows();
+
 	for (size_t r = 0; r < this->getNumRows(); r++)
 	{
-		for (size_t c = 0; c < numColumns; c++)
-		{
-			double rightValue = this->getCell(r, c);
-
-			size_t rowOffset = left.getNumRows();
-			size_t newRowIndex = r + rowOffset;
-
-			mergedDense->setCell(newRowIndex, c, rightValue);
-		}
+		const double* rightRow = this->getRowData(r);
+		std::copy(rightRow, rightRow + numColumns, mergedDense->getRowData(r + rowOffset));
 	}
 
 	return mergedDense;
@@ -660,20 +866,7 @@ MatrixBase* DenseMatrix::splitByColumn(size_t leftNewNumColumns, bool returnLeft
 	size_t splitMatrixNumColumns = returnLeftMatrix ? leftNewNumColumns : rightNewNumColumns;
 	size_t columnOffset = returnLeftMatrix ? 0 : leftNewNumColumns;
 
-	DenseMatrix* split = new DenseMatrix(this->numRows, splitMatrixNumColumns, 0.0);
-
-	for (size_t r = 0; r < split->getNumRows(); r++)
-	{
-		for (size_t c = 0; c < split->getNumColumns(); c++)
-		{
-			size_t bigMatrixOffsetColumnIndex = c + columnOffset;
-
-			double value = this->getCell(r, bigMatrixOffsetColumnIndex);
-			split->setCell(r, c, value);
-		}
-	}
-
-	return split;
+	return getSubView(0, this->numRows, columnOffset, splitMatrixNumColumns).materialize();
 }
 
 MatrixBase* DenseMatrix::splitByRow(size_t topNewNumRows, bool returnTopMatrix) const
@@ -684,20 +877,7 @@ MatrixBase* DenseMatrix::splitByRow(size_t topNewNumRows, bool returnTopMatrix)
 	size_t splitMatrixNumRows = returnTopMatrix ? topNewNumRows : bottomNewNumRows;
 	size_t rowOffset = returnTopMatrix ? 0 : topNewNumRows;
 
-	DenseMatrix* split = new DenseMatrix(splitMatrixNumRows, this->numColumns, 0.0);
-
-	for (size_t r = 0; r < split->getNumRows(); r++)
-	{
-		for (size_t c = 0; c < split->getNumColumns(); c++)
-		{
-			size_t bigMatrixOffsetRowIndex = r + rowOffset;
-
-			double value = this->getCell(bigMatrixOffsetRowIndex, c);
-			split->setCell(r, c, value);
-		}
-	}
-
-	return split;
+	return getSubView(rowOffset, splitMatrixNumRows, 0, this->numColumns).materialize();
 }
 
 MatrixBase* DenseMatrix::getSubMatrix(size_t subRowBeginIndex, size_t subNumRows, size_t subColumnBeginIndex, size_t subNumColumns) const
@@ -708,84 +888,37 @@ MatrixBase* DenseMatrix::getSubMatrix(size_t subRowBeginIndex, size_t subNumRows
 		return nullptr;
 	}
 
-	DenseMatrix* subDense = new DenseMatrix(subNumRows, subNumColumns, 0);
-
 	// Copy values from the big matrix into the sub matrix.
-	for (size_t r = 0; r < subDense->getNumRows(); r++)
-	{
-		for (size_t c = 0; c < subDense->getNumColumns(); c++)
-		{
-			size_t bigMatRow = r + subRowBeginIndex;
-			size_t bigMatCol = c + subColumnBeginIndex;
-			double bigMatValue = this->getCell(bigMatRow, bigMatCol);
-			subDense->setCell(r, c, bigMatValue);
-		}
-	}
-
-	return subDense;
+	return getSubView(subRowBeginIndex, subNumRows, subColumnBeginIndex, subNumColumns).materialize();
 }
 
 MatrixBase* DenseMatrix::getSubMatrix(size_t ignoredRowIndex, size_t ignoredColumnIndex) const
 {
-	MatrixBase* topLeft = this->getSubMatrixTopLeft(ignoredRowIndex, ignoredColumnIndex);
-	MatrixBase* topRight = this->getSubMatrixTopRight(ignoredRowIndex, ignoredColumnIndex);
-	MatrixBase* bottomLeft = this->getSubMatrixBottomLeft(ignoredRowIndex, ignoredColumnIndex);
-	MatrixBase* bottomRight = this->getSubMatrixBottomRight(ignoredRowIndex, ignoredColumnIndex);
+	size_t subNumRows = numRows - 1;
+	size_t subNumColumns = numColumns - 1;
 
-	// Merge 'topLeft' and 'topRight', and get 'top'.
-	MatrixBase* top = nullptr;
-	if (topLeft != nullptr && topRight != nullptr)
-	{
-		top = topLeft->mergeByColumns(*topRight);
-	}
-	else if (topLeft != nullptr)
-	{
-		top = topLeft->clone();;
-	}
-	else if (topRight != nullptr)
+	if (subNumRows == 0 || subNumColumns == 0)
 	{
-		top = topRight->clone();
+		return nullptr;
 	}
 
-	// Merge 'botomLeft' and 'bottomRight', and get 'bottom'.
-	MatrixBase* bottom = nullptr;
-	if (bottomLeft != nullptr && bottomRight != nullptr)
-	{
-		bottom = bottomLeft->mergeByColumns(*bottomRight);
-	}
-	else if (bottomLeft != nullptr)
-	{
-		bottom = bottomLeft->clone();
-	}
-	else if (bottomRight != nullptr)
-	{
-		bottom = bottomRight->clone();
-	}
+	// Copy the four corners around the ignored row and column straight into the sub matrix (one copy, no intermediate matrices).
+	// Corners which are empty are empty views, so copying them does nothing.
+	DenseMatrix* subDense = DenseMatrix::createUninitialized(subNumRows, subNumColumns);
+	double* subData = subDense->getRowData(0);
 
-	// Merge 'top' and 'bottom', and get 'subMatrix'.
-	MatrixBase* subMatrix = nullptr;
-	if (top != nullptr && bottom != nullptr)
-	{
-		subMatrix = top->mergeByRows(*bottom);
-	}
-	else if (top != nullptr)
-	{
-		subMatrix = top->clone();
-	}
-	else if (bottom != nullptr)
-	{
-		// If-check to make the compiler happy. 'bottom' cannot be equal to nullptr at this point!
-		subMatrix = bottom->clone();
-	}
+	size_t topNumRows = ignoredRowIndex;
+	size_t bottomNumRows = subNumRows - ignoredRowIndex;
+	size_t leftNumColumns = ignoredColumnIndex;
+	size_t rightNumColumns = subNumColumns - ignoredColumnIndex;
+	double* bottomSubData = subData + (topNumRows * subNumColumns);
 
-	delete topLeft;
-	delete topRight;
-	delete bottomLeft;
-	delete bottomRight;
-	delete top;
-	delete bottom;
+	getSubView(0, topNumRows, 0, leftNumColumns).copyTo(subData, subNumColumns);
+	getSubView(0, topNumRows, ignoredColumnIndex + 1, rightNumColumns).copyTo(subData + leftNumColumns, subNumColumns);
+	getSubView(ignoredRowIndex + 1, bottomNumRows, 0, leftNumColumns).copyTo(bottomSubData, subNumColumns);
+	getSubView(ignoredRowIndex + 1, bottomNumRows, ignoredColumnIndex + 1, rightNumColumns).copyTo(bottomSubData + leftNumColumns, subNumColumns);
 
-	return subMatrix;
+	return subDense;
 }
 
 MatrixBase* DenseMatrix::getSubMatrixTopLeft(size_t ignoredRowIndex, size_t ignoredColumnIndex) const
@@ -795,12 +928,7 @@ MatrixBase* DenseMatrix::getSubMatrixTopLeft(size_t ignoredRowIndex, size_t igno
 		return nullptr;
 	}
 
-	MatrixBase* left = splitByColumn(ignoredColumnIndex, true);
-	MatrixBase* topLeft = left->splitByRow(ignoredRowIndex, true);
-
-	delete left;
-
-	return topLeft;
+	return getSubView(0, ignoredRowIndex, 0, ignoredColumnIndex).materialize();
 }
 
 MatrixBase* DenseMatrix::getSubMatrixTopRight(size_t ignoredRowIndex, size_t ignoredColumnIndex) const
@@ -810,12 +938,9 @@ MatrixBase* DenseMatrix::getSubMatrixTopRight(size_t ignoredRowIndex, size_t ign
 		return nullptr;
 	}
 
-	MatrixBase* right = splitByColumn(ignoredColumnIndex + 1, false);
-	MatrixBase* topRight = right->splitByRow(ignoredRowIndex, true);
+	size_t subNumColumns = (numColumns - 1) - ignoredColumnIndex;
 
-	delete right;
-
-	return topRight;
+	return getSubView(0, ignoredRowIndex, ignoredColumnIndex + 1, subNumColumns).materialize();
 }
 
 MatrixBase* DenseMatrix::getSubMatrixBottomLeft(size_t ignoredRowIndex, size_t ignoredColumnIndex) const
@@ -825,12 +950,9 @@ MatrixBase* DenseMatrix::getSubMatrixBottomLeft(size_t ignoredRowIndex, size_t i
 		return nullptr;
 	}
 
-	MatrixBase* left = splitByColumn(ignoredColumnIndex, true);
-	MatrixBase* bottomLeft = left->splitByRow(ignoredRowIndex + 1, false);
-
-	delete left;
+	size_t subNumRows = (numRows - 1) - ignoredRowIndex;
 
-	return bottomLeft;
+	return getSubView(ignoredRowIndex + 1, subNumRows, 0, ignoredColumnIndex).materialize();
 }
 
 MatrixBase* DenseMatrix::getSubMatrixBottomRight(size_t ignoredRowIndex, size_t ignoredColumnIndex) const
@@ -840,18 +962,14 @@ MatrixBase* DenseMatrix::getSubMatrixBottomRight(size_t ignoredRowIndex, size_t
 		return nullptr;
 	}
 
-	MatrixBase* right = splitByColumn(ignoredColumnIndex + 1, false);
-	MatrixBase* bottomRight = right->splitByRow(ignoredRowIndex + 1, false);
+	size_t subNumRows = (numRows - 1) - ignoredRowIndex;
+	size_t subNumColumns = (numColumns - 1) - ignoredColumnIndex;
 
-	delete right;
-
-	return bottomRight;
+	return getSubView(ignoredRowIndex + 1, subNumRows, ignoredColumnIndex + 1, subNumColumns).materialize();
 }
 
 double DenseMatrix::getDeterminant() const
 {
-	// Determinant calculation algorithm is based on Laplace Expansion.
-
 	// The matrix is assumed to be square (numRows == numColumns).
 
 	if (numRows == 1)
@@ -867,67 +985,13 @@ double DenseMatrix::getDeterminant() const
 
 	double determinant = 0;
 
-	for (size_t c = 0; c < numColumns; c++)
+	// A symmetric positive definite matrix is detected quickly, and its Cholesky factorization is twice as cheap as LU.
+	if (mck::getCholeskyDeterminant(*this, &determinant))
 	{
-		double cellAtFirstRow = this->getCell(0, c);
-
-		// If the value at this cell is zero, then there's no point in calculating the determinant of the sub-matrix.
-		if (mcu::doubleAlmostEqual(cellAtFirstRow, 0))
-		{
-			continue;
-		}
-
-		// Determine the sign based on checkerboard pattern (+-+-+-...).
-		// If 'c' is even (default assumption), then positive. If 'c' is odd, then negative.
-		if (c % 2 == 1)
-		{
-			cellAtFirstRow = -cellAtFirstRow;
-		}
-
-		// Create sub-matrix, by ignoring the current cell's entire row and column.
-		// Create left side.
-		size_t leftRowBegin = 1;
-		size_t leftNumRows = this->numRows - 1;
-		size_t leftColBegin = 0;
-		size_t leftNumCols = c;
-		MatrixBase* leftSubMatrix = this->getSubMatrix(leftRowBegin, leftNumRows, leftColBegin, leftNumCols);
-
-		// Create right side.
-		size_t rightRowBegin = leftRowBegin; // Always the same.
-		size_t rightNumRows = leftNumRows; // Always the same.
-		size_t rightColBegin = c + 1;
-		size_t rightNumCols = (this->numColumns - 1) - c;
-		MatrixBase* rightSubMatrix = this->getSubMatrix(rightRowBegin, rightNumRows, rightColBegin, rightNumCols);
-
-		// Create merged sub-matrix from left and right sides.
-		MatrixBase* mergedSub = nullptr;
-
-		if (leftSubMatrix == nullptr)
-		{
-			mergedSub = rightSubMatrix->clone();
-		}
-		else if (rightSubMatrix == nullptr)
-		{
-			mergedSub = leftSubMatrix->clone();
-		}
-		else
-		{
-			mergedSub = leftSubMatrix->mergeByColumns((*rightSubMatrix));
-		}
-
-		// Get the determinant of the merged sub-matrix.
-		double subMatDet = mergedSub->getDeterminant();
-
-		// Finally, the big meat.
-		determinant += (cellAtFirstRow * subMatDet);
-
-		// Delete the matrices. (left, right and mergedSub).
-		delete leftSubMatrix;
-		delete rightSubMatrix;
-		delete mergedSub;
+		return determinant;
 	}
 
-	return determinant;
+	return mck::getLUDeterminant(*this);
 }
 
 MatrixBase* DenseMatrix::getMinorMatrix() const
@@ -938,13 +1002,26 @@ MatrixBase* DenseMatrix::getMinorMatrix() const
 	{
 		for (size_t c = 0; c < numColumns; c++)
 		{
-			MatrixBase* subDenseMatrix = this->getSubMatrix(r, c);
+			double subDeterminant = 0;
+
+			{
+				// The sub-matrix (without row r and column c) is a temporary, so its cells come from the scratch arena.
+				MatrixScratchScope scratchScope;
+				DenseMatrix subDenseMatrix(numRows - 1, numColumns - 1, 0.0, scratchScope.getAllocator());
 
-			double subDeterminant = subDenseMatrix->getDeterminant();
+				for (size_t subRow = 0; subRow < numRows - 1; subRow++)
+				{
+					const double* rowData = getRowData((subRow < r) ? subRow : subRow + 1);
+					double* subRowData = subDenseMatrix.getRowData(subRow);
 
-			denseMinorMatrix->setCell(r, c, subDeterminant);
+					std::copy(rowData, rowData + c, subRowData);
+					std::copy(rowData + c + 1, rowData + numColumns, subRowData + c);
+				}
 
-			delete subDenseMatrix;
+				subDeterminant = subDenseMatrix.getDeterminant();
+			}
+
+			denseMinorMatrix->setCell(r, c, subDeterminant);
 		}
 	}
 
@@ -991,6 +1068,27 @@ MatrixBase* DenseMatrix::getInverse(double determinant) const
 		return inverse;
 	}
 
+	// A symmetric positive definite matrix is inverted by solving (A * X == I) with the Cholesky factorization.
+	DenseMatrix identity(numRows, numColumns, 0.0);
+
+	for (size_t d = 0; d < numRows; d++)
+	{
+		identity.getRowData(d)[d] = 1.0;
+	}
+
+	inverse = mck::solveCholesky(*this, identity);
+
+	if (inverse == nullptr)
+	{
+		// Any other (numerically) non-singular matrix is inverted with the LU factorization.
+		inverse = mck::solveLU(*this, identity);
+	}
+
+	if (inverse != nullptr)
+	{
+		return inverse;
+	}
+
 	// Get matrix of minors.
 	inverse = this->getMinorMatrix();
 
@@ -1061,6 +1159,25 @@ std::string DenseMatrix::getPrintStr(size_t precision) const
 
 std::string DenseMatrix::solveFor(const MatrixBase& augmentedColumn, bool verbose, size_t doublePrecision) const
 {
+	// The steps of a verbose solution are those of the Gaussian Elimination. Otherwise, a system which has a unique solution is solved with the Cholesky factorization (if the matrix is symmetric positive definite) or with the LU factorization.
+	if (!verbose)
+	{
+		DenseMatrix* uniqueSolution = mck::solveCholesky(*this, augmentedColumn);
+
+		if (uniqueSolution == nullptr)
+		{
+			uniqueSolution = mck::solveLU(*this, augmentedColumn);
+		}
+
+		if (uniqueSolution != nullptr)
+		{
+			std::string uniqueSolutionStr = getUniqueSolutionStr(*uniqueSolution);
+			delete uniqueSolution;
+
+			return uniqueSolutionStr;
+		}
+	}
+
 	DenseMatrix* denseClone = this->cloneAsDenseMatrix();
 	DenseMatrix* augmentedMatrix = dynamic_cast<DenseMatrix*>(this->mergeByColumns(augmentedColumn));
 
@@ -1085,8 +1202,8 @@ std::string DenseMatrix::solveFor(const MatrixBase& augmentedColumn, bool verbos
 
 				if (r != leadingEntryRow)
 				{
-					// Sorry for the hack.
-					std::swap(augmentedMatrix->denseMatrix[r], augmentedMatrix->denseMatrix[leadingEntryRow]);
+					double* rowData = augmentedMatrix->getRowData(r);
+					std::swap_ranges(rowData, rowData + augNumCols, augmentedMatrix->getRowData(leadingEntryRow));
 				}
 
 				break;
@@ -1362,107 +1479,48 @@ std::string DenseMatrix::solveFor(const MatrixBase& augmentedColumn, bool verbos
 
 size_t DenseMatrix::getRank() const
 {
-	DenseMatrix* clone = this->cloneAsDenseMatrix();
-
-	// Step 1): Reduce the matrix into Row Echelon Form (REF).
-	size_t cloneNumRows = clone->getNumRows();
-	size_t cloneNumCols = clone->getNumColumns();
-	size_t leadingEntryRow = 0;
-
-	std::stringstream sst;
-	for (size_t c = 0; c < cloneNumCols; c++)
-	{
-		bool isZeroColumn = true;
-		// Search whether even a single non-zero element exists in this column's rows.
-		for (size_t r = leadingEntryRow; r < cloneNumRows; r++)
-		{
-			// If a single non-zero row found, then carry it at the top row. 
-			// (top row according to current pivot row).
-			if (mcu::doubleAlmostEqual(clone->getCell(r, c), 0) == false)
-			{
-				isZeroColumn = false;
-
-				if (r != leadingEntryRow)
-				{
-					// Sorry for the hack.
-					std::swap(clone->denseMatrix[r], clone->denseMatrix[leadingEntryRow]);
-				}
+	// Rank-revealing QR is both faster and more reliable than counting the zero rows of an echelon form.
+	return mck::getRank(*this, mcu::EPSILON, nullptr);
+}
 
-				break;
-			}
-		}
+// Private members
 
-		// There isn't a single non-zero element. Skip this column.
-		if (isZeroColumn)
-		{
-			continue;
-		}
+void DenseMatrix::recountNonZeros() const
+{
+	numNonZeros = 0;
 
-		// Second loop to eliminate every other non-zero entry.
-		double leadingEntryValue = clone->getCell(leadingEntryRow, c);
-		for (size_t r = (leadingEntryRow + 1); r < cloneNumRows; r++)
+	for (size_t i = 0; i < denseMatrix.size(); i++)
+	{
+		if (mcu::doubleAlmostEqual(denseMatrix[i], 0.0) == false)
 		{
-			double valueAtColumn = clone->getCell(r, c);
-
-			// Skip if zero element.
-			if (mcu::doubleAlmostEqual(valueAtColumn, 0) == true)
-			{
-				continue;
-			}
-
-			// Eliminate if non-zero.
-			double coefficient = valueAtColumn / leadingEntryValue;
-
-			// Do row operation (including augmented column): victim - (coefficient * leadingEntryValue)
-			for (size_t col = 0; col < cloneNumCols; col++)
-			{
-				double subtrahend = (coefficient * clone->getCell(leadingEntryRow, col));
-				double minuend = clone->getCell(r, col);
-
-				double difference = minuend - subtrahend;
-
-				clone->setCell(r, col, difference);
-			}
+			numNonZeros++;
 		}
-
-		// If the code was able to get to this point, then there was at least 1 non-zero value.
-		// This means, the row index can be incremented in order to find the next leading entry.
-		leadingEntryRow++;
 	}
 
-	// Step 2): Count the number of 'zero rows'.
+	isNonZeroCountDirty = false;
+}
+
+std::string DenseMatrix::getUniqueSolutionStr(const DenseMatrix& solution)
+{
+	// The same format as the solution set of solveFor: "x1 = + 2.5", one line per variable.
+	std::stringstream sst;
+	sst << std::endl << "Solution:" << std::endl << std::endl;
 
-	size_t numZeroRows = 0;
-	for (size_t r = 0; r < clone->getNumRows(); r++)
+	for (size_t r = 0; r < solution.getNumRows(); r++)
 	{
-		bool isZeroRow = true;
+		double value = solution.getCell(r, 0);
 
-		for (size_t c = 0; c < clone->getNumColumns(); c++)
+		if (mcu::doubleAlmostEqual(value, 0))
 		{
-			double valueAtCell = clone->getCell(r, c);
-
-			if (mcu::doubleAlmostEqual(valueAtCell, 0) == false)
-			{
-				isZeroRow = false;
-				break;
-			}
+			value = 0; // To prevent minus zero, and round-off residue.
 		}
 
-		if (isZeroRow)
-		{
-			numZeroRows++;
-		}
+		sst << "x" << (r + 1) << " = " << ((value < 0.0) ? "-" : "+") << " " << std::abs(value) << std::endl; // When printing out, indices start from '1'.
 	}
 
-	size_t numNonZeroRows = clone->getNumRows() - numZeroRows;
-
-	delete clone;
-
-	return numNonZeroRows;
+	return sst.str();
 }
 
-// Private members
-
 std::map<size_t, size_t> DenseMatrix::getColumnAlignmentMapForPrinting() const
 {
 	// I think putting this logic in a function is a bad idea, because the logic is not used anywhere else.
@@ -1499,3 +1557,93 @@ std::map<size_t, size_t> DenseMatrix::getColumnAlignmentMapForPrinting() const
 
 	return map_colIndex_maxDigits;
 }
+
+void DenseMatrix::transposeDiagonalBlock(size_t beginIndex, size_t blockSize)
+{
+	if (blockSize <= TransposeBlockSize)
+	{
+		for (size_t r = beginIndex + 1; r < beginIndex + blockSize; r++)
+		{
+			for (size_t c = beginIndex; c < r; c++)
+			{
+				std::swap(denseMatrix[r * numColumns + c], denseMatrix[c * numColumns + r]);
+			}
+		}
+
+		return;
+	}
+
+	size_t topBlockSize = blockSize / 2;
+	size_t bottomBlockSize = blockSize - topBlockSize;
+
+	transposeDiagonalBlock(beginIndex, topBlockSize);
+	transposeDiagonalBlock(beginIndex + topBlockSize, bottomBlockSize);
+	swapTransposedBlocks(beginIndex + topBlockSize, beginIndex, bottomBlockSize, topBlockSize);
+}
+
+void DenseMatrix::swapTransposedBlocks(size_t rowBeginIndex, size_t columnBeginIndex, size_t blockNumRows, size_t blockNumColumns)
+{
+	if (blockNumRows <= TransposeBlockSize && blockNumColumns <= TransposeBlockSize)
+	{
+		for (size_t r = rowBeginIndex; r < rowBeginIndex + blockNumRows; r++)
+		{
+			double* rowData = &denseMatrix[r * numColumns];
+
+			for (size_t c = columnBeginIndex; c < columnBeginIndex + blockNumColumns; c++)
+			{
+				std::swap(rowData[c], denseMatrix[c * numColumns + r]);
+			}
+		}
+
+		return;
+	}
+
+	if (blockNumRows >= blockNumColumns)
+	{
+		size_t topNumRows = blockNumRows / 2;
+
+		swapTransposedBlocks(rowBeginIndex, columnBeginIndex, topNumRows, blockNumColumns);
+		swapTransposedBlocks(rowBeginIndex + topNumRows, columnBeginIndex, blockNumRows - topNumRows, blockNumColumns);
+	}
+	else
+	{
+		size_t leftNumColumns = blockNumColumns / 2;
+
+		swapTransposedBlocks(rowBeginIndex, columnBeginIndex, blockNumRows, leftNumColumns);
+		swapTransposedBlocks(rowBeginIndex, columnBeginIndex + leftNumColumns, blockNumRows, blockNumColumns - leftNumColumns);
+	}
+}
+
+void DenseMatrix::transposeRectangular()
+{
+	if (numRows == 1 || numColumns == 1)
+	{
+		return; // The order of the elements doesn't change.
+	}
+
+	size_t numElements = numRows * numColumns;
+
+	// The first and the last elements never move.
+	size_t lastIndex = numElements - 1;
+	std::vector<bool> isMoved(numElements, false);
+
+	for (size_t cycleBegin = 1; cycleBegin < lastIndex; cycleBegin++)
+	{
+		if (isMoved[cycleBegin])
+		{
+			continue;
+		}
+
+		// Each element of the cycle takes the place of the next one. The element at (row, column) moves to (column, row) of the transpose.
+		double carriedValue = denseMatrix[cycleBegin];
+		size_t index = cycleBegin;
+
+		do
+		{
+			size_t nextIndex = (index * numRows) % lastIndex;
+			std::swap(carriedValue, denseMatrix[nextIndex]);
+			isMoved[nextIndex] = true;
+			index = nextIndex;
+		} while (index != cycleBegin);
+	}
+}
@@ -2,6 +2,7 @@
 #define DENSE_MATRIX_H
 
 #include "MatrixBase.h"
+#include "DenseMatrixView.h"
 #include <vector>
 #include <functional>
 #include <map>
@@ -9,11 +10,16 @@
 class SparseMatrix;
 
 /**
-* The implementation of a matrix when it is Dense. When a matrix is Dense, it has more non-zero elements than zero elements. The underlying implementation uses std's vector of vectors of doubles, so a two dimensional vector which stores doubles.
+* The implementation of a matrix when it is Dense. When a matrix is Dense, it has more non-zero elements than zero elements. The underlying implementation uses a single contiguous std::vector of doubles, which stores the rows one after another.
 */
 class DenseMatrix : public MatrixBase
 {
 public:
+	/**
+	* The type of the underlying storage. Its memory is served by MatrixMemory.
+	*/
+	typedef std::vector<double, MatrixStorageAllocator<double>> CellStorage;
+
 	/**
 	* Creates an invalid DenseMatrix with zero rows and zero dimensions. Don't use it. Use the custom consturctor instead.
 	*/
@@ -50,6 +56,29 @@ public:
 	*/
 	DenseMatrix(size_t numRows, size_t numColumns, double initialValues);
 	/**
+	* Custom Constructor for a DenseMatrix whose cells are served by the given allocator, e.g. a temporary in the arena of a MatrixScratchScope. Copies of the matrix are served by the default allocator.
+	* @param numRows The number of rows for the DenseMatrix.
+	* @param numColumns The number of columns for the DenseMatrix.
+	* @param initialValues Every cell of the DenseMatrix will be set to this value.
+	* @param allocator The allocator of the cells. It must outlive the matrix.
+	*/
+	DenseMatrix(size_t numRows, size_t numColumns, double initialValues, MatrixAllocator* allocator);
+	/**
+	* Creates a DenseMatrix whose cells are not initialized, which saves a pass over the memory when every cell is about to be written anyway.
+	* Every cell must be written through getRowData before it is read.
+	* @param numRows The number of rows for the DenseMatrix.
+	* @param numColumns The number of columns for the DenseMatrix.
+	* @return A raw pointer to the new DenseMatrix.
+	*/
+	static DenseMatrix* createUninitialized(size_t numRows, size_t numColumns);
+	/**
+	* Creates a DenseMatrix copy of any matrix, whose cells are served by the given allocator. Like cloneAsDenseMatrix, but meant for the temporary copies which an algorithm works on in place (e.g. the factors of a decomposition), in the arena of a MatrixScratchScope.
+	* @param source The matrix to copy.
+	* @param allocator The allocator of the cells. It must outlive the copy.
+	* @return A raw pointer to the new DenseMatrix.
+	*/
+	static DenseMatrix* createCopy(const MatrixBase& source, MatrixAllocator* allocator);
+	/**
 	* Returns the number of rows of this matrix.
 	*/
 	virtual size_t getNumRows() const override;
@@ -88,7 +117,8 @@ public:
 	*/
 	virtual void resize(size_t newNumRows, size_t newNumColumns) override;
 	/**
-	* Transposes the matrix. Pretty safe function. Shouldn't throw any exceptions unless the matrix was invalid in the first place.
+	* Transposes the matrix in place, without allocating a second matrix. Pretty safe function. Shouldn't throw any exceptions unless the matrix was invalid in the first place.
+	* A square matrix is transposed block by block (see transposeDiagonalBlock); a rectangular matrix by following the cycles of the permutation of its elements (see transposeRectangular).
 	*/
 	virtual void transpose() override;
 	/**
@@ -98,6 +128,11 @@ public:
 	*/
 	virtual double getSparsity() const override;
 	/**
+	* Returns the number of non-zero elements of this matrix. The count is kept up to date by setCell, so this is O(1).
+	* After bulk writes through the non-const getRowData, the matrix is marked "dirty" and the elements are counted again (once) by the next call.
+	*/
+	virtual size_t getNumNonZeros() const override;
+	/**
 	* Gets the Density value of the matrix. Density is the ratio of numNonZeroElements/numTotalElements.
 	* @see MatrixBase::DensityThreshold
 	* @return Density floating point value between 0 and 1. The DensityThreshold value itself IS considered Density.
@@ -118,10 +153,9 @@ public:
 	*/
 	virtual bool isDense() const override;
 	/**
-	* This class is DenseMatrix. It is meant for containing dense matrices. If its Density is less than DensityThreshold, then it requires conversion to SparseMatrix. This method answers that question.
-	* @see MatrixBase::DensityThreshold
+	* This class is DenseMatrix. It is meant for containing dense matrices. If SparseMatrix would be clearly cheaper according to the cost model (below its hysteresis band), then it requires conversion to SparseMatrix. This method answers that question.
+	* @see MatrixCostModel::shouldConvertToSparse()
 	* @see getDensity()
-	* @see isDense()
 	* @return True if it requires conversion, false if not.
 	*/
 	virtual bool requiresConversion() const override;
@@ -149,16 +183,89 @@ public:
 	*/
 	virtual SparseMatrix* cloneAsSparseMatrix() const override;
 	/**
-	* Creates a vector of 3-tuples. The first two size_t are the row & column data; the double is the value at the row & column coordinate. Not recommended when using DenseMatrix. It makes it easier to use SparseMatrix. Acts as a short hack instead of writing a custom iterator.
-	* @return A vector of 3-tuples, which contains row & column coordinates; and their corresponding double value.
+	* Calls the visitor for every non-zero cell of this matrix, in row-major order. Prefer getRowData when the type is known to be DenseMatrix.
+	* @param visitor A function which takes the row index, the column index and the value of the cell.
+	*/
+	virtual void forEachNonZero(const std::function<void(size_t row, size_t column, double value)>& visitor) const override;
+	/**
+	* Calls the visitor for every non-zero cell of this matrix, in row-major order, like forEachNonZero. Not virtual, and the visitor is called directly, so the compiler can inline it into the loop over the rows.
+	* @see mcu::visitNonZeros for the matrices whose type isn't known.
+	* @param visitor A callable which takes the row index, the column index and the value of the cell.
+	*/
+	template <typename Visitor>
+	void visitNonZeros(Visitor visitor) const
+	{
+		for (size_t r = 0; r < numRows; r++)
+		{
+			const double* rowData = getRowData(r);
+
+			for (size_t c = 0; c < numColumns; c++)
+			{
+				if (rowData[c] != 0.0)
+				{
+					visitor(r, c, rowData[c]);
+				}
+			}
+		}
+	}
+	/**
+	* Returns a pointer to the contiguous elements of a row. The row has getNumColumns() elements. Not virtual, so that the kernels can access the rows directly.
+	* The pointer is invalidated when the matrix is resized or transposed.
+	* @param row Row index of the matrix.
+	*/
+	const double* getRowData(size_t row) const;
+	/**
+	* Returns a pointer to the contiguous elements of a row, which can be modified. The row has getNumColumns() elements.
+	* The pointer is invalidated when the matrix is resized or transposed. Marks the non-zero count as dirty, so that it is counted again when it is needed (lazy recount after bulk writes).
+	* @param row Row index of the matrix.
+	*/
+	double* getRowData(size_t row);
+	/**
+	* Returns a read-only view over the whole storage of this matrix. Nothing is copied.
+	* The view is invalidated when this matrix is resized, transposed or destroyed.
 	*/
-	virtual std::vector<std::tuple<size_t, size_t, double>> getCellDataList() const override;
+	DenseMatrixView getView() const;
+	/**
+	* Returns a read-only view over a rectangular part of this matrix. Nothing is copied. The boundaries are assumed to be valid.
+	* The view is invalidated when this matrix is resized, transposed or destroyed.
+	* @param subRowBeginIndex Row index of this matrix where the view begins.
+	* @param subNumRows The number of rows of the view.
+	* @param subColumnBeginIndex Column index of this matrix where the view begins.
+	* @param subNumColumns The number of columns of the view.
+	*/
+	DenseMatrixView getSubView(size_t subRowBeginIndex, size_t subNumRows, size_t subColumnBeginIndex, size_t subNumColumns) const;
 	/**
 	* Scales every cell of this matrix by the given scalar value.
 	* @param scalar Scalar value to scale each cell.
 	*/
 	virtual void scale(double scalar) override;
 	/**
+	* Adds the argument matrix, scaled by alpha, to this matrix in place (this = this + alpha * right). Method implements Double Dispatch. This particular method just calls the addScaledTo method on the argument to activate polymorphism.
+	* @param right The other MatrixBase.
+	* @param alpha Scalar value by which the argument is scaled before it is added.
+	*/
+	virtual void addInPlace(const MatrixBase& right, double alpha) override;
+	/**
+	* Adds this matrix, scaled by alpha, to the target DenseMatrix in place. Method implements Double Dispatch.
+	* @param target The DenseMatrix which is modified.
+	* @param alpha Scalar value by which this matrix is scaled before it is added.
+	*/
+	virtual void addScaledTo(DenseMatrix& target, double alpha) const override;
+	/**
+	* Adds this matrix, scaled by alpha, to the target SparseMatrix in place. Method implements Double Dispatch.
+	* @param target The SparseMatrix which is modified.
+	* @param alpha Scalar value by which this matrix is scaled before it is added.
+	*/
+	virtual void addScaledTo(SparseMatrix& target, double alpha) const override;
+	/**
+	* Performs this = alpha * left * right + beta * this in place. If both operands are DenseMatrix, the product is accumulated directly into the rows of this matrix without allocating anything.
+	* @param alpha Scalar value by which the product is scaled.
+	* @param left The left operand of the product.
+	* @param right The right operand of the product.
+	* @param beta Scalar value by which this matrix is scaled before the product is accumulated.
+	*/
+	virtual void multiplyAccumulate(double alpha, const MatrixBase& left, const MatrixBase& right, double beta) override;
+	/**
 	* Checks if this matrix is equal to the argument matrix. Method implements Double Dispatch. This particular method just calls the equal method on the argument to activate polymorphism.
 	* @param right The other MatrixBase.
 	* @return True if equal, false if not equal.
@@ -231,6 +338,23 @@ public:
 	*/
 	virtual MatrixBase* multiply(const SparseMatrix& left) const override;
 	/**
+	* Multiplies two views (left * right) and returns the result. A transposed operand is passed as a transposed view (see DenseMatrixView::getTransposedView), so no transpose is ever materialized.
+	* The operands are multiplied panel by panel. A panel of an operand whose rows are not contiguous (e.g. a transposed view) is packed into contiguous scratch memory first; the other panels are read in place.
+	* @param left The left operand. Its number of columns must match the number of rows of right.
+	* @param right The right operand.
+	* @return A raw pointer to a new DenseMatrix instance.
+	*/
+	static DenseMatrix* multiplyViews(const DenseMatrixView& left, const DenseMatrixView& right);
+	/**
+	* Calculates (op(left) * op(right)) and returns the result, where op transposes its operand if its flag is set. No transpose is materialized: a DenseMatrix left operand is multiplied through its views (see multiplyViews), and the non-zero elements of any other left operand (e.g. SparseMatrix) are visited with their indices swapped.
+	* @param left The left operand.
+	* @param transposeLeft True to multiply by the transpose of left.
+	* @param right The right operand.
+	* @param transposeRight True to multiply by the transpose of right.
+	* @return A raw pointer to a new DenseMatrix instance. nullptr if the dimensions don't match.
+	*/
+	static DenseMatrix* multiplyTransposed(const MatrixBase& left, bool transposeLeft, const DenseMatrix& right, bool transposeRight);
+	/**
 	* Merges this and the argument matrix by columns and returns the result. Method implements Double Disptch. This particular method just calls the mergeByColumns method on the argument to activate polymorphism. std::vector may throw an exception if the dimensions don't match.
 	* @param right The other MatrixBase.
 	* @return A raw pointer to MatrixBase instance. This is DenseMatrix, so the result will also be DenseMatrix.
@@ -325,7 +449,8 @@ public:
 	*/
 	virtual MatrixBase* getSubMatrixBottomRight(size_t ignoredRowIndex, size_t ignoredColumnIndex) const override;
 	/**
-	* Calculates the determinant of the matrix using Laplace Expansion. The matrix is assumed to be square. std::vector may throw an exception if the matrix is not square.
+	* Calculates the determinant of the matrix with the Cholesky factorization if it is symmetric positive definite, and with the blocked LU factorization otherwise. The matrix is assumed to be square.
+	* @see mck::getCholeskyDeterminant(), mck::getLUDeterminant()
 	* @return A double floating point value containing the determinant of this matrix.
 	*/
 	virtual double getDeterminant() const override;
@@ -340,6 +465,7 @@ public:
 	virtual void applyCheckerboardPattern() override;
 	/**
 	* Returns the inverse of this matrix. If the inverse doesn't exist, it will return nullptr. The matrix is assumed to be square. std::vector may throw an exception if the matrix is not square.
+	* The inverse is solved with the Cholesky or the LU factorization; the adjugate is only used if the factorization considers the matrix numerically singular.
 	* @param determinant The determinant of this matrix. getInverse method will return nullptr if the argument determinant is equal to zero.
 	* @see getDeterminant()
 	* @return A raw pointer to MatrixBase instance, containing the inverse of this matrix. This is DenseMatrix, so the result will also be DenseMatrix.
@@ -353,6 +479,7 @@ public:
 	virtual std::string getPrintStr(size_t precision) const;
 	/**
 	* Treats this and the argument matrices as a Systems of Linear Equations, and performs Gaussian Eliminations to find the solution set, and return it as a string. The augmentedColumn matrix must have 1 column.
+	* Unless verbose is true, a system with a unique solution is solved with the Cholesky or the LU factorization instead; the output has the same format.
 	* @param augmentedColumn A column matrix with 1 column. It contains the numbers which the equations are equal to.
 	* @param verbose True if the output string should contain the steps of Gaussian Elimination, false if not.
 	* @param doublePrecision The number of digits after the floating point when outputting the cells of the matrix.
@@ -361,15 +488,16 @@ public:
 	*/
 	virtual std::string solveFor(const MatrixBase& augmentedColumn, bool verbose, size_t doublePrecision) const override;
 	/**
-	* Performs Gaussian Elimination and finds the rank from the Reduced Echelon Form of this matrix.
+	* Calculates the numerical rank of this matrix with rank-revealing QR (QR with column pivoting), using mcu::EPSILON as the tolerance.
+	* @see mck::getRank()
 	* @return The rank of this matrix.
 	*/
 	virtual size_t getRank() const;
 private:
 	/**
-	* The underlying implementation of DenseMatrix. A two dimensional std::vector which holds doubles.
+	* The underlying implementation of DenseMatrix. A single contiguous std::vector which holds the rows one after another (row-major order). The cell at (row, column) is at index (row * numColumns + column).
 	*/
-	std::vector<std::vector<double>> denseMatrix;
+	CellStorage denseMatrix;
 	/**
 	* The number of rows of this matrix.
 	*/
@@ -378,7 +506,55 @@ private:
 	* The number of columns of this matrix.
 	*/
 	size_t numColumns;
+	/**
+	* The number of non-zero elements. Only valid if isNonZeroCountDirty is false.
+	*/
+	mutable size_t numNonZeros;
+	/**
+	* True if the elements were written in bulk, in which case numNonZeros is counted again when it is needed.
+	*/
+	mutable bool isNonZeroCountDirty;
+	/**
+	* The number of rows of the left operand which are multiplied at once by multiplyViews.
+	*/
+	static const size_t MultiplyBlockNumRows = 64;
+	/**
+	* The number of rows of the right operand (the inner dimension) which are multiplied at once by the transposed multiplication kernels. A packed panel of the right operand holds this many rows.
+	*/
+	static const size_t MultiplyPanelNumRows = 256;
+	/**
+	* The number of rows (and columns) of the largest block which transposeDiagonalBlock and swapTransposedBlocks process without splitting it further.
+	*/
+	static const size_t TransposeBlockSize = 16;
 
+	/**
+	* Counts the non-zero elements again and clears the dirty flag.
+	*/
+	void recountNonZeros() const;
+	/**
+	* Formats the unique solution of a System of Linear Equations the same way solveFor formats a solution set which has no free variables.
+	* @param solution A column matrix which holds the value of each variable.
+	* @return The solution string, starting with the "Solution:" header.
+	*/
+	static std::string getUniqueSolutionStr(const DenseMatrix& solution);
+	/**
+	* Transposes a square block on the main diagonal in place, by splitting it recursively into two smaller diagonal blocks and the pair of blocks which mirror each other. The blocks eventually fit in the cache, whatever its size is.
+	* @param beginIndex The index of the first row (and column) of the block.
+	* @param blockSize The number of rows (and columns) of the block.
+	*/
+	void transposeDiagonalBlock(size_t beginIndex, size_t blockSize);
+	/**
+	* Swaps a block below the main diagonal with the transpose of its mirror above the main diagonal, by splitting it recursively along its longer side.
+	* @param rowBeginIndex The index of the first row of the block below the diagonal.
+	* @param columnBeginIndex The index of the first column of the block below the diagonal.
+	* @param blockNumRows The number of rows of the block below the diagonal.
+	* @param blockNumColumns The number of columns of the block below the diagonal.
+	*/
+	void swapTransposedBlocks(size_t rowBeginIndex, size_t columnBeginIndex, size_t blockNumRows, size_t blockNumColumns);
+	/**
+	* Transposes a rectangular matrix in place. The element at index i moves to index (i * numRows) mod (numElements - 1), so the elements are moved along the cycles of this permutation. A bit per element records the elements which were already moved.
+	*/
+	void transposeRectangular();
 	/**
 	* Returns a map of alignment for each column in order to achieve a neatly aligned output stirng. The method calculates the maximum digit size after the floating point each column has.
 	* @return An "alignment map". The first size_t is the index of the column; the second size_t is the maximum digit size for each column. The negative sign adds 1 to the "digit count" as well.
@@ -0,0 +1,127 @@
+#include "DenseMatrixView.h"
+#include "DenseMatrix.h"
+#include "MatCalcUtil.h"
+#include <algorithm>
+
+// Public members
+
+DenseMatrixView::DenseMatrixView()
+{
+	// Empty view.
+	data = nullptr;
+	numRows = 0;
+	numColumns = 0;
+	rowStride = 0;
+	columnStride = 1;
+}
+
+DenseMatrixView::DenseMatrixView(const double* data, size_t numRows, size_t numColumns, size_t rowStride, size_t columnStride)
+{
+	this->data = data;
+	this->numRows = numRows;
+	this->numColumns = numColumns;
+	this->rowStride = rowStride;
+	this->columnStride = columnStride;
+}
+
+size_t DenseMatrixView::getNumRows() const
+{
+	return numRows;
+}
+
+size_t DenseMatrixView::getNumColumns() const
+{
+	return numColumns;
+}
+
+size_t DenseMatrixView::getRowStride() const
+{
+	return rowStride;
+}
+
+size_t DenseMatrixView::getColumnStride() const
+{
+	return columnStride;
+}
+
+const double* DenseMatrixView::getData() const
+{
+	return data;
+}
+
+double DenseMatrixView::getCell(size_t row, size_t column) const
+{
+	return data[row * rowStride + column * columnStride];
+}
+
+bool DenseMatrixView::hasContiguousRows() const
+{
+	return columnStride == 1;
+}
+
+size_t DenseMatrixView::getNumNonZeros() const
+{
+	size_t numNonZeros = 0;
+
+	for (size_t r = 0; r < numRows; r++)
+	{
+		for (size_t c = 0; c < numColumns; c++)
+		{
+			if (mcu::doubleAlmostEqual(getCell(r, c), 0.0) == false)
+			{
+				numNonZeros++;
+			}
+		}
+	}
+
+	return numNonZeros;
+}
+
+DenseMatrixView DenseMatrixView::getSubView(size_t rowBeginIndex, size_t subNumRows, size_t columnBeginIndex, size_t subNumColumns) const
+{
+	if (subNumRows == 0 || subNumColumns == 0)
+	{
+		return DenseMatrixView(); // Empty view.
+	}
+
+	const double* subData = data + (rowBeginIndex * rowStride) + (columnBeginIndex * columnStride);
+
+	return DenseMatrixView(subData, subNumRows, subNumColumns, rowStride, columnStride);
+}
+
+DenseMatrixView DenseMatrixView::getTransposedView() const
+{
+	return DenseMatrixView(data, numColumns, numRows, columnStride, rowStride);
+}
+
+void DenseMatrixView::copyTo(double* destination, size_t destinationRowStride) const
+{
+	for (size_t r = 0; r < numRows; r++)
+	{
+		const double* sourceRow = data + (r * rowStride);
+		double* destinationRow = destination + (r * destinationRowStride);
+
+		if (columnStride == 1)
+		{
+			std::copy(sourceRow, sourceRow + numColumns, destinationRow);
+			continue;
+		}
+
+		for (size_t c = 0; c < numColumns; c++)
+		{
+			destinationRow[c] = sourceRow[c * columnStride];
+		}
+	}
+}
+
+DenseMatrix* DenseMatrixView::materialize() const
+{
+	DenseMatrix* materialized = DenseMatrix::createUninitialized(numRows, numColumns); // Every cell is copied below.
+
+	if (numRows != 0 && numColumns != 0)
+	{
+		copyTo(materialized->getRowData(0), numColumns);
+	}
+
+	return materialized;
+}
@@ -0,0 +1,110 @@
+#ifndef DENSE_MATRIX_VIEW_H
+#define DENSE_MATRIX_VIEW_H
+
+#include <cstddef> // Required by g++ (size_t)
+
+class DenseMatrix;
+
+/**
+* A non-owning, read-only view over the storage of a DenseMatrix (or any row-major array of doubles). A view is described by a pointer to its first element, its dimensions and two strides.
+* The cell at (row, column) is found at data[row * rowStride + column * columnStride]. Sub-matrices and transposes are just different offsets and strides, so creating a view never copies anything.
+* The view is invalidated when the viewed DenseMatrix is resized, transposed or destroyed. A view is materialized into a new DenseMatrix only when it is explicitly copied.
+*/
+class DenseMatrixView
+{
+public:
+	/**
+	* Creates an empty view with zero rows and zero columns.
+	*/
+	DenseMatrixView();
+	/**
+	* Creates a view over existing storage.
+	* @param data Pointer to the cell at (0, 0) of the view.
+	* @param numRows The number of rows of the view.
+	* @param numColumns The number of columns of the view.
+	* @param rowStride The distance (in doubles) between two vertically adjacent cells.
+	* @param columnStride The distance (in doubles) between two horizontally adjacent cells.
+	*/
+	DenseMatrixView(const double* data, size_t numRows, size_t numColumns, size_t rowStride, size_t columnStride);
+	/**
+	* Returns the number of rows of this view.
+	*/
+	size_t getNumRows() const;
+	/**
+	* Returns the number of columns of this view.
+	*/
+	size_t getNumColumns() const;
+	/**
+	* Returns the distance (in doubles) between two vertically adjacent cells.
+	*/
+	size_t getRowStride() const;
+	/**
+	* Returns the distance (in doubles) between two horizontally adjacent cells.
+	*/
+	size_t getColumnStride() const;
+	/**
+	* Returns a pointer to the cell at (0, 0) of this view.
+	*/
+	const double* getData() const;
+	/**
+	* Returns the double value at a given cell of this view. Indices start from zero.
+	* @param row Row index of the view.
+	* @param column Column index of the view.
+	*/
+	double getCell(size_t row, size_t column) const;
+	/**
+	* Checks whether or not the cells of each row of this view are adjacent in memory (i.e. the column stride is 1).
+	*/
+	bool hasContiguousRows() const;
+	/**
+	* Returns the number of non-zero cells of this view. The cells are counted on every call.
+	*/
+	size_t getNumNonZeros() const;
+	/**
+	* Returns a view over a rectangular part of this view. Nothing is copied. The boundaries are assumed to be valid.
+	* @param rowBeginIndex Row index of this view where the sub view begins.
+	* @param subNumRows The number of rows of the sub view.
+	* @param columnBeginIndex Column index of this view where the sub view begins.
+	* @param subNumColumns The number of columns of the sub view.
+	*/
+	DenseMatrixView getSubView(size_t rowBeginIndex, size_t subNumRows, size_t columnBeginIndex, size_t subNumColumns) const;
+	/**
+	* Returns the transpose of this view, by swapping the dimensions and the strides. Nothing is copied.
+	*/
+	DenseMatrixView getTransposedView() const;
+	/**
+	* Copies the cells of this view into row-major storage.
+	* @param destination Pointer to the cell at (0, 0) of the destination.
+	* @param destinationRowStride The distance (in doubles) between two vertically adjacent cells of the destination.
+	*/
+	void copyTo(double* destination, size_t destinationRowStride) const;
+	/**
+	* Copies this view into a new DenseMatrix. This is the only operation of the view which allocates memory.
+	* @return A raw pointer to a new DenseMatrix instance, which has the same dimensions as this view.
+	*/
+	DenseMatrix* materialize() const;
+
+private:
+	/**
+	* Pointer to the cell at (0, 0) of the view. It is not owned by the view.
+	*/
+	const double* data;
+	/**
+	* The number of rows of the view.
+	*/
+	size_t numRows;
+	/**
+	* The number of columns of the view.
+	*/
+	size_t numColumns;
+	/**
+	* The distance (in doubles) between two vertically adjacent cells.
+	*/
+	size_t rowStride;
+	/**
+	* The distance (in doubles) between two horizontally adjacent cells.
+	*/
+	size_t columnStride;
+};
+
+#endif // DENSE_MATRIX_VIEW_H
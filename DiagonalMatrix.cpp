@@ -0,0 +1,212 @@
+#include "DiagonalMatrix.h"
+#include "DenseMatrix.h"
+#include "SparseMatrix.h"
+#include "MatCalcUtil.h"
+#include "NonZeroVisitor.h"
+
+// Public members
+
+DiagonalMatrix::DiagonalMatrix(size_t numDimensions)
+{
+	diagonal.assign(numDimensions, 0.0);
+}
+
+DiagonalMatrix::DiagonalMatrix(const std::vector<double>& diagonal)
+{
+	this->diagonal.assign(diagonal.begin(), diagonal.end());
+}
+
+size_t DiagonalMatrix::getNumRows() const
+{
+	return diagonal.size();
+}
+
+size_t DiagonalMatrix::getNumColumns() const
+{
+	return diagonal.size();
+}
+
+double DiagonalMatrix::getCell(size_t row, size_t column) const
+{
+	return (row == column) ? diagonal[row] : 0.0;
+}
+
+void DiagonalMatrix::setCell(size_t row, size_t column, double value)
+{
+	if (row == column)
+	{
+		diagonal[row] = value;
+	}
+	// else see canSetCell.
+}
+
+bool DiagonalMatrix::canSetCell(size_t row, size_t column, double value) const
+{
+	return row == column || mcu::doubleAlmostEqual(value, 0.0);
+}
+
+void DiagonalMatrix::transpose()
+{
+	// A diagonal matrix is symmetric.
+}
+
+size_t DiagonalMatrix::getNumNonZeros() const
+{
+	size_t numNonZeros = 0;
+
+	for (size_t d = 0; d < diagonal.size(); d++)
+	{
+		if (mcu::doubleAlmostEqual(diagonal[d], 0.0) == false)
+		{
+			numNonZeros++;
+		}
+	}
+
+	return numNonZeros;
+}
+
+MatrixBase* DiagonalMatrix::clone() const
+{
+	return new DiagonalMatrix(*this);
+}
+
+void DiagonalMatrix::forEachNonZero(const std::function<void(size_t row, size_t column, double value)>& visitor) const
+{
+	for (size_t d = 0; d < diagonal.size(); d++)
+	{
+		if (mcu::doubleAlmostEqual(diagonal[d], 0.0) == false)
+		{
+			visitor(d, d, diagonal[d]);
+		}
+	}
+}
+
+void DiagonalMatrix::scale(double scalar)
+{
+	for (size_t d = 0; d < diagonal.size(); d++)
+	{
+		diagonal[d] *= scalar;
+	}
+}
+
+MatrixBase* DiagonalMatrix::multiplyByRight(const MatrixBase& right) const
+{
+	const DiagonalMatrix* diagonalRight = dynamic_cast<const DiagonalMatrix*>(&right);
+
+	if (diagonalRight != nullptr)
+	{
+		DiagonalMatrix* product = new DiagonalMatrix(*this);
+
+		for (size_t d = 0; d < diagonal.size(); d++)
+		{
+			product->diagonal[d] *= diagonalRight->diagonal[d];
+		}
+
+		return product;
+	}
+
+	const DenseMatrix* denseRight = dynamic_cast<const DenseMatrix*>(&right);
+	size_t rightNumColumns = right.getNumColumns();
+
+	if (denseRight != nullptr)
+	{
+		// Scale the rows of the right operand.
+		DenseMatrix* product = new DenseMatrix(*denseRight);
+
+		for (size_t r = 0; r < diagonal.size(); r++)
+		{
+			double* productRow = product->getRowData(r);
+			double factor = diagonal[r];
+
+			for (size_t c = 0; c < rightNumColumns; c++)
+			{
+				productRow[c] *= factor;
+			}
+		}
+
+		return product;
+	}
+
+	SparseMatrix* product = new SparseMatrix(diagonal.size(), rightNumColumns);
+
+	mcu::visitNonZeros(right, [&](size_t row, size_t column, double value)
+	{
+		product->setCell(row, column, diagonal[row] * value);
+	});
+
+	return product;
+}
+
+MatrixBase* DiagonalMatrix::multiplyByLeft(const MatrixBase& left) const
+{
+	const DiagonalMatrix* diagonalLeft = dynamic_cast<const DiagonalMatrix*>(&left);
+
+	if (diagonalLeft != nullptr)
+	{
+		return diagonalLeft->multiplyByRight(*this); // Diagonal matrices commute.
+	}
+
+	const DenseMatrix* denseLeft = dynamic_cast<const DenseMatrix*>(&left);
+	size_t leftNumRows = left.getNumRows();
+
+	if (denseLeft != nullptr)
+	{
+		// Scale the columns of the left operand.
+		DenseMatrix* product = new DenseMatrix(*denseLeft);
+
+		for (size_t r = 0; r < leftNumRows; r++)
+		{
+			double* productRow = product->getRowData(r);
+
+			for (size_t c = 0; c < diagonal.size(); c++)
+			{
+				productRow[c] *= diagonal[c];
+			}
+		}
+
+		return product;
+	}
+
+	SparseMatrix* product = new SparseMatrix(leftNumRows, diagonal.size());
+
+	mcu::visitNonZeros(left, [&](size_t row, size_t column, double value)
+	{
+		product->setCell(row, column, value * diagonal[column]);
+	});
+
+	return product;
+}
+
+double DiagonalMatrix::getDeterminant() const
+{
+	double determinant = 1.0;
+
+	for (size_t d = 0; d < diagonal.size(); d++)
+	{
+		determinant *= diagonal[d];
+	}
+
+	return determinant;
+}
+
+MatrixBase* DiagonalMatrix::getInverse(double determinant) const
+{
+	if (mcu::doubleAlmostEqual(determinant, 0.0) || determinant != determinant) // NaN is the determinant of an invalid matrix.
+	{
+		return nullptr;
+	}
+
+	DiagonalMatrix* inverse = new DiagonalMatrix(diagonal.size());
+
+	for (size_t d = 0; d < diagonal.size(); d++)
+	{
+		inverse->diagonal[d] = 1.0 / diagonal[d];
+	}
+
+	return inverse;
+}
+
+size_t DiagonalMatrix::getRank() const
+{
+	return getNumNonZeros();
+}
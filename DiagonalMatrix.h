@@ -0,0 +1,104 @@
+#ifndef DIAGONAL_MATRIX_H
+#define DIAGONAL_MATRIX_H
+
+#include "StructuredMatrix.h"
+#include <vector>
+
+/**
+* A square matrix whose non-zero elements can only be on its main diagonal. Only the diagonal is stored (O(n) memory).
+* Multiplying by a diagonal matrix scales the rows (from the left) or the columns (from the right) of the other operand, instead of performing a matrix multiplication.
+*/
+class DiagonalMatrix : public StructuredMatrix
+{
+public:
+	/**
+	* The type of the underlying storage. Its memory is served by MatrixMemory.
+	*/
+	typedef std::vector<double, MatrixStorageAllocator<double>> CellStorage;
+
+	/**
+	* Creates a zero diagonal matrix.
+	* @param numDimensions The number of rows (and columns) of the matrix.
+	*/
+	DiagonalMatrix(size_t numDimensions);
+	/**
+	* Creates a diagonal matrix out of the elements of its diagonal.
+	* @param diagonal The elements of the main diagonal, from the top left to the bottom right.
+	*/
+	DiagonalMatrix(const std::vector<double>& diagonal);
+	/**
+	* Returns the number of rows of this matrix.
+	*/
+	virtual size_t getNumRows() const override;
+	/**
+	* Returns the number of columns of this matrix.
+	*/
+	virtual size_t getNumColumns() const override;
+	/**
+	* Returns the double value at a given cell. Indices start from zero.
+	* @param row Row index of the matrix.
+	* @param column Column index of the matrix.
+	*/
+	virtual double getCell(size_t row, size_t column) const override;
+	/**
+	* Sets a cell of the diagonal to the given value. Cells outside of the diagonal are ignored (see canSetCell).
+	* @param row Row index of the matrix.
+	* @param column Column index of the matrix.
+	* @param value The value to be set in the cell.
+	*/
+	virtual void setCell(size_t row, size_t column, double value) override;
+	/**
+	* Checks whether or not a cell can be set to a value. True for the cells of the diagonal, and for zeros anywhere.
+	*/
+	virtual bool canSetCell(size_t row, size_t column, double value) const override;
+	/**
+	* Does nothing. A diagonal matrix is its own transpose.
+	*/
+	virtual void transpose() override;
+	/**
+	* Returns the number of non-zero elements of the diagonal.
+	*/
+	virtual size_t getNumNonZeros() const override;
+	/**
+	* Creates a deep copy of this matrix.
+	* @return A raw pointer to MatrixBase instance.
+	*/
+	virtual MatrixBase* clone() const override;
+	/**
+	* Calls the visitor for every non-zero element of the diagonal, from the top left to the bottom right.
+	*/
+	virtual void forEachNonZero(const std::function<void(size_t row, size_t column, double value)>& visitor) const override;
+	/**
+	* Scales every element of the diagonal.
+	*/
+	virtual void scale(double scalar) override;
+	/**
+	* Calculates (this * right) by scaling the rows of right by the diagonal. The result has the same storage as right (the product of two diagonal matrices is a DiagonalMatrix).
+	*/
+	virtual MatrixBase* multiplyByRight(const MatrixBase& right) const override;
+	/**
+	* Calculates (left * this) by scaling the columns of left by the diagonal. The result has the same storage as left (the product of two diagonal matrices is a DiagonalMatrix).
+	*/
+	virtual MatrixBase* multiplyByLeft(const MatrixBase& left) const override;
+	/**
+	* Returns the product of the diagonal.
+	*/
+	virtual double getDeterminant() const override;
+	/**
+	* Returns the diagonal matrix of the reciprocals of the diagonal. Returns nullptr if the determinant is zero.
+	* @param determinant The determinant of this matrix.
+	*/
+	virtual MatrixBase* getInverse(double determinant) const override;
+	/**
+	* Returns the number of non-zero elements of the diagonal.
+	*/
+	virtual size_t getRank() const override;
+
+private:
+	/**
+	* The elements of the main diagonal.
+	*/
+	CellStorage diagonal;
+};
+
+#endif // DIAGONAL_MATRIX_H
@@ -0,0 +1,390 @@
+#ifndef FIXED_MATRIX_H
+#define FIXED_MATRIX_H
+
+#include "Matrix.h"
+#include "MatCalcUtil.h"
+#include <cstddef> // Required by g++ (size_t)
+#include <utility>
+
+/**
+* A small dense matrix whose dimensions are known at compile time (e.g. 2x2 to 8x8 transforms). The cells are stored inline (no heap allocation), there are no virtual calls, and every loop has compile-time bounds.
+* Operations whose dimensions don't match (e.g. multiplying a 2x3 matrix by a 2x3 matrix) don't compile. Most of the operations are constexpr.
+* Use Matrix for matrices whose dimensions are only known at run time; convert with toMatrix and fromMatrix.
+* @tparam NumRows The number of rows.
+* @tparam NumColumns The number of columns.
+*/
+template <size_t NumRows, size_t NumColumns>
+class FixedMatrix
+{
+	static_assert(NumRows > 0 && NumColumns > 0, "FixedMatrix must have at least one row and one column.");
+
+public:
+	/**
+	* Creates a zero matrix.
+	*/
+	constexpr FixedMatrix() : cells{}
+	{
+	}
+	/**
+	* Creates an identity matrix. Only square matrices have it.
+	*/
+	static constexpr FixedMatrix createIdentity()
+	{
+		static_assert(NumRows == NumColumns, "Identity matrices are square.");
+
+		FixedMatrix identity;
+
+		for (size_t i = 0; i < NumRows; i++)
+		{
+			identity.setCell(i, i, 1.0);
+		}
+
+		return identity;
+	}
+	/**
+	* Returns the number of rows of this matrix.
+	*/
+	static constexpr size_t getNumRows()
+	{
+		return NumRows;
+	}
+	/**
+	* Returns the number of columns of this matrix.
+	*/
+	static constexpr size_t getNumColumns()
+	{
+		return NumColumns;
+	}
+	/**
+	* Returns the double value at a given cell of the matrix. Indices start from zero.
+	* @param row Row index of the matrix.
+	* @param column Column index of the matrix.
+	*/
+	constexpr double getCell(size_t row, size_t column) const
+	{
+		return cells[row * NumColumns + column];
+	}
+	/**
+	* Sets the double value at a given cell of the matrix. Indices start from zero.
+	* @param row Row index of the matrix.
+	* @param column Column index of the matrix.
+	* @param value The value to set.
+	*/
+	constexpr void setCell(size_t row, size_t column, double value)
+	{
+		cells[row * NumColumns + column] = value;
+	}
+	/**
+	* Checks whether or not every cell of both matrices is (approximately) equal.
+	* @see mcu::doubleAlmostEqual
+	* @param right The other matrix.
+	*/
+	bool operator==(const FixedMatrix& right) const
+	{
+		for (size_t i = 0; i < NumRows * NumColumns; i++)
+		{
+			if (mcu::doubleAlmostEqual(cells[i], right.cells[i]) == false)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+	/**
+	* Checks whether or not any cell of both matrices is different.
+	* @param right The other matrix.
+	*/
+	bool operator!=(const FixedMatrix& right) const
+	{
+		return !(*this == right);
+	}
+	/**
+	* Performs matrix addition and returns the result.
+	* @param right The other matrix.
+	*/
+	constexpr FixedMatrix operator+(const FixedMatrix& right) const
+	{
+		FixedMatrix sum;
+
+		for (size_t i = 0; i < NumRows * NumColumns; i++)
+		{
+			sum.cells[i] = cells[i] + right.cells[i];
+		}
+
+		return sum;
+	}
+	/**
+	* Performs matrix subtraction and returns the result.
+	* @param right The other matrix.
+	*/
+	constexpr FixedMatrix operator-(const FixedMatrix& right) const
+	{
+		FixedMatrix difference;
+
+		for (size_t i = 0; i < NumRows * NumColumns; i++)
+		{
+			difference.cells[i] = cells[i] - right.cells[i];
+		}
+
+		return difference;
+	}
+	/**
+	* Scales every cell of this matrix and returns the result.
+	* @param scalar Scalar value to scale each cell.
+	*/
+	constexpr FixedMatrix operator*(double scalar) const
+	{
+		FixedMatrix scaled;
+
+		for (size_t i = 0; i < NumRows * NumColumns; i++)
+		{
+			scaled.cells[i] = cells[i] * scalar;
+		}
+
+		return scaled;
+	}
+	/**
+	* Performs matrix multiplication and returns the result. The number of rows of the right matrix must be equal to the number of columns of this matrix; otherwise, it doesn't compile.
+	* Every cell of the product is a single expression (the sum is unrolled at compile time), summed in the same order as DenseMatrix::multiply.
+	* @param right The right matrix.
+	*/
+	template <size_t RightNumColumns>
+	constexpr FixedMatrix<NumRows, RightNumColumns> operator*(const FixedMatrix<NumColumns, RightNumColumns>& right) const
+	{
+		return multiplyCells(right, std::make_index_sequence<NumRows * RightNumColumns>());
+	}
+	/**
+	* Returns the transpose of this matrix.
+	*/
+	constexpr FixedMatrix<NumColumns, NumRows> getTransposed() const
+	{
+		FixedMatrix<NumColumns, NumRows> transposed;
+
+		for (size_t r = 0; r < NumRows; r++)
+		{
+			for (size_t c = 0; c < NumColumns; c++)
+			{
+				transposed.setCell(c, r, getCell(r, c));
+			}
+		}
+
+		return transposed;
+	}
+	/**
+	* Calculates the determinant with a closed-form expression. Only available for square matrices up to 4x4.
+	*/
+	constexpr double getDeterminant() const
+	{
+		static_assert(NumRows == NumColumns, "Only square matrices have a determinant.");
+		static_assert(NumRows <= 4, "Closed-form determinants are only available up to 4x4. Use Matrix for larger matrices.");
+
+		if constexpr (NumRows == 1)
+		{
+			return cells[0];
+		}
+		else if constexpr (NumRows == 2)
+		{
+			return cells[0] * cells[3] - cells[1] * cells[2];
+		}
+		else if constexpr (NumRows == 3)
+		{
+			// Expansion along the first row.
+			return cells[0] * (cells[4] * cells[8] - cells[5] * cells[7])
+				- cells[1] * (cells[3] * cells[8] - cells[5] * cells[6])
+				+ cells[2] * (cells[3] * cells[7] - cells[4] * cells[6]);
+		}
+		else
+		{
+			// Laplace expansion along the top two rows: the sum of the products of their 2x2 minors with the complementary 2x2 minors of the bottom two rows.
+			TwoByTwoMinors minors = getTwoByTwoMinors();
+
+			return minors.top[0] * minors.bottom[5] - minors.top[1] * minors.bottom[4] + minors.top[2] * minors.bottom[3]
+				+ minors.top[3] * minors.bottom[2] - minors.top[4] * minors.bottom[1] + minors.top[5] * minors.bottom[0];
+		}
+	}
+	/**
+	* Calculates the inverse with a closed-form expression (the adjugate divided by the determinant). Only available for square matrices up to 4x4.
+	* @param determinant The determinant of this matrix (see getDeterminant). It must not be zero; check it before calling this method.
+	*/
+	constexpr FixedMatrix getInverse(double determinant) const
+	{
+		static_assert(NumRows == NumColumns, "Only square matrices have an inverse.");
+		static_assert(NumRows <= 4, "Closed-form inverses are only available up to 4x4. Use Matrix for larger matrices.");
+
+		FixedMatrix inverse;
+		const double* a = cells;
+		double* b = inverse.cells;
+
+		if constexpr (NumRows == 1)
+		{
+			b[0] = 1.0;
+		}
+		else if constexpr (NumRows == 2)
+		{
+			b[0] = a[3];
+			b[1] = -a[1];
+			b[2] = -a[2];
+			b[3] = a[0];
+		}
+		else if constexpr (NumRows == 3)
+		{
+			b[0] = a[4] * a[8] - a[5] * a[7];
+			b[1] = a[2] * a[7] - a[1] * a[8];
+			b[2] = a[1] * a[5] - a[2] * a[4];
+			b[3] = a[5] * a[6] - a[3] * a[8];
+			b[4] = a[0] * a[8] - a[2] * a[6];
+			b[5] = a[2] * a[3] - a[0] * a[5];
+			b[6] = a[3] * a[7] - a[4] * a[6];
+			b[7] = a[1] * a[6] - a[0] * a[7];
+			b[8] = a[0] * a[4] - a[1] * a[3];
+		}
+		else
+		{
+			// Every cofactor is expanded along the 2x2 minors of the top two rows (s) or the bottom two rows (c).
+			TwoByTwoMinors minors = getTwoByTwoMinors();
+			const double* s = minors.top;
+			const double* c = minors.bottom;
+
+			b[0] = a[5] * c[5] - a[6] * c[4] + a[7] * c[3];
+			b[1] = -a[1] * c[5] + a[2] * c[4] - a[3] * c[3];
+			b[2] = a[13] * s[5] - a[14] * s[4] + a[15] * s[3];
+			b[3] = -a[9] * s[5] + a[10] * s[4] - a[11] * s[3];
+			b[4] = -a[4] * c[5] + a[6] * c[2] - a[7] * c[1];
+			b[5] = a[0] * c[5] - a[2] * c[2] + a[3] * c[1];
+			b[6] = -a[12] * s[5] + a[14] * s[2] - a[15] * s[1];
+			b[7] = a[8] * s[5] - a[10] * s[2] + a[11] * s[1];
+			b[8] = a[4] * c[4] - a[5] * c[2] + a[7] * c[0];
+			b[9] = -a[0] * c[4] + a[1] * c[2] - a[3] * c[0];
+			b[10] = a[12] * s[4] - a[13] * s[2] + a[15] * s[0];
+			b[11] = -a[8] * s[4] + a[9] * s[2] - a[11] * s[0];
+			b[12] = -a[4] * c[3] + a[5] * c[1] - a[6] * c[0];
+			b[13] = a[0] * c[3] - a[1] * c[1] + a[2] * c[0];
+			b[14] = -a[12] * s[3] + a[13] * s[1] - a[14] * s[0];
+			b[15] = a[8] * s[3] - a[9] * s[1] + a[10] * s[0];
+		}
+
+		return inverse * (1.0 / determinant);
+	}
+	/**
+	* Converts this matrix into a DenseMatrix instance of Matrix.
+	*/
+	Matrix toMatrix() const
+	{
+		Matrix converted = Matrix::createDense(NumRows, NumColumns, 0.0);
+
+		for (size_t r = 0; r < NumRows; r++)
+		{
+			for (size_t c = 0; c < NumColumns; c++)
+			{
+				converted.setCell(r, c, getCell(r, c));
+			}
+		}
+
+		return converted;
+	}
+	/**
+	* Converts a Matrix into a FixedMatrix. The dimensions of the Matrix are only known at run time, so they are checked here.
+	* @param source The Matrix to convert.
+	* @param out_fixed The converted matrix is written here. It is not modified if the conversion fails.
+	* @return True if the conversion is successful; false if the dimensions don't match (or the Matrix is invalid).
+	*/
+	static bool fromMatrix(const Matrix& source, FixedMatrix* out_fixed)
+	{
+		if (source.getNumRows() != NumRows || source.getNumColumns() != NumColumns)
+		{
+			return false;
+		}
+
+		for (size_t r = 0; r < NumRows; r++)
+		{
+			for (size_t c = 0; c < NumColumns; c++)
+			{
+				out_fixed->setCell(r, c, source.getCell(r, c));
+			}
+		}
+
+		return true;
+	}
+
+private:
+	/**
+	* The cells of the matrix, row by row.
+	*/
+	double cells[NumRows * NumColumns];
+
+	/**
+	* The six 2x2 minors of the top two rows and of the bottom two rows of a 4x4 matrix. The minors are ordered by their column pairs: (0,1), (0,2), (0,3), (1,2), (1,3), (2,3).
+	*/
+	struct TwoByTwoMinors
+	{
+		double top[6];
+		double bottom[6];
+	};
+
+	/**
+	* Calculates the 2x2 minors which are shared by the determinant and the inverse of a 4x4 matrix.
+	*/
+	constexpr TwoByTwoMinors getTwoByTwoMinors() const
+	{
+		TwoByTwoMinors minors{};
+		const size_t columnPairs[6][2] = { { 0, 1 }, { 0, 2 }, { 0, 3 }, { 1, 2 }, { 1, 3 }, { 2, 3 } };
+
+		for (size_t i = 0; i < 6; i++)
+		{
+			size_t c0 = columnPairs[i][0];
+			size_t c1 = columnPairs[i][1];
+
+			minors.top[i] = getCell(0, c0) * getCell(1, c1) - getCell(1, c0) * getCell(0, c1);
+			minors.bottom[i] = getCell(2, c0) * getCell(3, c1) - getCell(3, c0) * getCell(2, c1);
+		}
+
+		return minors;
+	}
+	/**
+	* Calculates every cell of the product (this * right). Each index in Indices is one cell of the product, in row-major order.
+	*/
+	template <size_t RightNumColumns, size_t... Indices>
+	constexpr FixedMatrix<NumRows, RightNumColumns> multiplyCells(const FixedMatrix<NumColumns, RightNumColumns>& right, std::index_sequence<Indices...>) const
+	{
+		FixedMatrix<NumRows, RightNumColumns> product;
+
+		((product.setCell(Indices / RightNumColumns, Indices % RightNumColumns, dotRowColumn(right, Indices / RightNumColumns, Indices % RightNumColumns, std::make_index_sequence<NumColumns>()))), ...);
+
+		return product;
+	}
+	/**
+	* Calculates the dot product of a row of this matrix and a column of the right matrix, as a single unrolled sum.
+	*/
+	template <size_t RightNumColumns, size_t... Ks>
+	constexpr double dotRowColumn(const FixedMatrix<NumColumns, RightNumColumns>& right, size_t row, size_t column, std::index_sequence<Ks...>) const
+	{
+		return (0.0 + ... + (getCell(row, Ks) * right.getCell(Ks, column)));
+	}
+};
+
+/**
+* Scales every cell of a FixedMatrix and returns the result (scalar * matrix).
+* @param scalar Scalar value to scale each cell.
+* @param matrix The matrix to scale.
+*/
+template <size_t NumRows, size_t NumColumns>
+constexpr FixedMatrix<NumRows, NumColumns> operator*(double scalar, const FixedMatrix<NumRows, NumColumns>& matrix)
+{
+	return matrix * scalar;
+}
+
+/**
+* 2x2 matrix of doubles.
+*/
+typedef FixedMatrix<2, 2> FixedMatrix2;
+/**
+* 3x3 matrix of doubles.
+*/
+typedef FixedMatrix<3, 3> FixedMatrix3;
+/**
+* 4x4 matrix of doubles.
+*/
+typedef FixedMatrix<4, 4> FixedMatrix4;
+
+#endif // FIXED_MATRIX_H
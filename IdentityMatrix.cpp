@@ -0,0 +1,96 @@
+#include "IdentityMatrix.h"
+#include "MatCalcUtil.h"
+
+// Public members
+
+IdentityMatrix::IdentityMatrix(size_t numDimensions)
+{
+	this->numDimensions = numDimensions;
+}
+
+size_t IdentityMatrix::getNumRows() const
+{
+	return numDimensions;
+}
+
+size_t IdentityMatrix::getNumColumns() const
+{
+	return numDimensions;
+}
+
+double IdentityMatrix::getCell(size_t row, size_t column) const
+{
+	return (row == column) ? 1.0 : 0.0;
+}
+
+void IdentityMatrix::setCell(size_t row, size_t column, double value)
+{
+	// See canSetCell.
+	(void)row;
+	(void)column;
+	(void)value;
+}
+
+bool IdentityMatrix::canSetCell(size_t row, size_t column, double value) const
+{
+	return mcu::doubleAlmostEqual(value, getCell(row, column));
+}
+
+bool IdentityMatrix::canScale(double scalar) const
+{
+	return mcu::doubleAlmostEqual(scalar, 1.0);
+}
+
+void IdentityMatrix::transpose()
+{
+	// The identity matrix is symmetric.
+}
+
+size_t IdentityMatrix::getNumNonZeros() const
+{
+	return numDimensions;
+}
+
+MatrixBase* IdentityMatrix::clone() const
+{
+	return new IdentityMatrix(*this);
+}
+
+void IdentityMatrix::forEachNonZero(const std::function<void(size_t row, size_t column, double value)>& visitor) const
+{
+	for (size_t d = 0; d < numDimensions; d++)
+	{
+		visitor(d, d, 1.0);
+	}
+}
+
+void IdentityMatrix::scale(double scalar)
+{
+	(void)scalar; // See canScale.
+}
+
+MatrixBase* IdentityMatrix::multiplyByRight(const MatrixBase& right) const
+{
+	return right.clone();
+}
+
+MatrixBase* IdentityMatrix::multiplyByLeft(const MatrixBase& left) const
+{
+	return left.clone();
+}
+
+double IdentityMatrix::getDeterminant() const
+{
+	return 1.0;
+}
+
+MatrixBase* IdentityMatrix::getInverse(double determinant) const
+{
+	(void)determinant;
+	return clone();
+}
+
+size_t IdentityMatrix::getRank() const
+{
+	return numDimensions;
+}
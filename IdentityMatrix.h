@@ -0,0 +1,94 @@
+#ifndef IDENTITY_MATRIX_H
+#define IDENTITY_MATRIX_H
+
+#include "StructuredMatrix.h"
+
+/**
+* The identity matrix. Only its number of dimensions is stored (O(1) memory).
+* Multiplying by the identity matrix returns a copy of the other operand, and the identity matrix is its own inverse.
+*/
+class IdentityMatrix : public StructuredMatrix
+{
+public:
+	/**
+	* Creates an identity matrix.
+	* @param numDimensions The number of rows (and columns) of the matrix.
+	*/
+	IdentityMatrix(size_t numDimensions);
+	/**
+	* Returns the number of rows of this matrix.
+	*/
+	virtual size_t getNumRows() const override;
+	/**
+	* Returns the number of columns of this matrix.
+	*/
+	virtual size_t getNumColumns() const override;
+	/**
+	* Returns 1.0 for the cells of the diagonal, and 0.0 for the others.
+	* @param row Row index of the matrix.
+	* @param column Column index of the matrix.
+	*/
+	virtual double getCell(size_t row, size_t column) const override;
+	/**
+	* Does nothing. Only the values which are already in the cells can be set (see canSetCell).
+	*/
+	virtual void setCell(size_t row, size_t column, double value) override;
+	/**
+	* Checks whether or not a cell can be set to a value. True only if the cell already has that value.
+	*/
+	virtual bool canSetCell(size_t row, size_t column, double value) const override;
+	/**
+	* Checks whether or not this matrix can be scaled. True only if the scalar is one.
+	*/
+	virtual bool canScale(double scalar) const override;
+	/**
+	* Does nothing. The identity matrix is its own transpose.
+	*/
+	virtual void transpose() override;
+	/**
+	* Returns the number of dimensions.
+	*/
+	virtual size_t getNumNonZeros() const override;
+	/**
+	* Creates a deep copy of this matrix.
+	* @return A raw pointer to MatrixBase instance.
+	*/
+	virtual MatrixBase* clone() const override;
+	/**
+	* Calls the visitor for every cell of the diagonal, from the top left to the bottom right.
+	*/
+	virtual void forEachNonZero(const std::function<void(size_t row, size_t column, double value)>& visitor) const override;
+	/**
+	* Does nothing. Only a scalar of one can be applied (see canScale).
+	*/
+	virtual void scale(double scalar) override;
+	/**
+	* Returns a copy of right.
+	*/
+	virtual MatrixBase* multiplyByRight(const MatrixBase& right) const override;
+	/**
+	* Returns a copy of left.
+	*/
+	virtual MatrixBase* multiplyByLeft(const MatrixBase& left) const override;
+	/**
+	* Returns 1.0.
+	*/
+	virtual double getDeterminant() const override;
+	/**
+	* Returns a copy of this matrix.
+	* @param determinant The determinant of this matrix (ignored).
+	*/
+	virtual MatrixBase* getInverse(double determinant) const override;
+	/**
+	* Returns the number of dimensions.
+	*/
+	virtual size_t getRank() const override;
+
+private:
+	/**
+	* The number of rows (and columns) of the matrix.
+	*/
+	size_t numDimensions;
+};
+
+#endif // IDENTITY_MATRIX_H
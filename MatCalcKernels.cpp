@@ -0,0 +1,3492 @@
+#include "MatCalcKernels.h"
+#include "MatCalcUtil.h"
+#include "NonZeroVisitor.h"
+#include "SymmetricMatrix.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <system_error>
+#include <thread>
+
+/**
+* The number of columns which are factorized together, and applied to the rest of the matrix as a single block reflector.
+*/
+static const size_t QRBlockSize = 32;
+
+/**
+* The maximum number of sweeps of the one-sided Jacobi SVD. Each sweep rotates every pair of columns once; convergence is quadratic, so a few sweeps are usually enough.
+*/
+static const size_t JacobiMaxSweeps = 60;
+
+/**
+* The maximum number of implicit QR steps of the symmetric eigensolver per eigenvalue. Convergence is cubic with the Wilkinson shift, so two or three steps are usually enough.
+*/
+static const size_t SymmetricQRMaxIterations = 60;
+
+/**
+* The maximum number of Francis double-shift steps of the nonsymmetric eigensolver per eigenvalue (or pair of eigenvalues). Exceptional shifts are tried after 10 and 30 steps without deflation. The steps with the shifts of one try of aggressive early deflation count as a single step.
+*/
+static const size_t FrancisQRMaxIterations = 60;
+
+/**
+* The number of dimensions of the unreduced block from which the nonsymmetric eigensolver tries aggressive early deflation before its Francis steps. Smaller blocks deflate about as fast from the subdiagonal alone.
+*/
+static const size_t AggressiveEarlyDeflationMinDimensions = 75;
+
+/**
+* The ratio of the number of dimensions of the unreduced block to the size of the trailing window of aggressive early deflation, whose real Schur form is computed for each try.
+*/
+static const size_t AggressiveEarlyDeflationWindowRatio = 8;
+
+/**
+* The fraction of the window which a try of aggressive early deflation must deflate to be tried again right away. After a try which deflated less, the Francis steps with its shifts are made first.
+*/
+static const double AggressiveEarlyDeflationMinYield = 0.14;
+
+/**
+* The number of columns of a panel of the blocked Cholesky factorization. The trailing update of each panel is a symmetric rank-CholeskyBlockSize update.
+*/
+static const size_t CholeskyBlockSize = 64;
+
+/**
+* The number of columns of the trailing matrix which are updated together by subtractSymmetricRankUpdate, so that their panel rows stay in the cache.
+*/
+static const size_t SymmetricUpdateTileSize = 64;
+
+/**
+* The number of columns of a panel of the blocked LU factorization. The panel is factorized with unblocked partial pivoting, and the trailing update of each panel is a rank-LUBlockSize product.
+*/
+static const size_t LUBlockSize = 64;
+
+/**
+* The number of multiply-adds under which a trailing update of the LU factorization is performed on the calling thread. Starting the threads costs more than a smaller update.
+*/
+static const size_t LUParallelMinWork = 1 << 21;
+
+/**
+* The minimum number of rows of the trailing matrix which a worker thread of the LU factorization updates.
+*/
+static const size_t LUParallelMinRows = 32;
+
+/**
+* The number of columns under which the recursive LU factorization stops splitting a panel, and factorizes it with unblocked partial pivoting instead.
+*/
+static const size_t LURecursiveMinColumns = 16;
+
+/**
+* The largest number of dimensions for which factorizeLU uses the recursive LU factorization. A larger matrix is factorized by the blocked one, whose look-ahead keeps the worker threads busy.
+*/
+static const size_t LURecursiveMaxDimensions = 4096;
+
+/**
+* The number of rows of the triangle which solveTriangularInPlace solves for at a time. The solved rows of the right hand sides are then subtracted from the remaining ones in one product, while they are in the cache.
+*/
+static const size_t TriangularSolveBlockSize = 64;
+
+/**
+* The number of columns of the right hand sides which solveTriangularInPlace solves for at a time, so that a block of their rows stays in the cache.
+*/
+static const size_t TriangularSolveColumnTileSize = 256;
+
+/**
+* The maximum number of refinement steps of solveMixedPrecision. Each step gains about as many digits as float has (for a well-conditioned matrix), so two or three steps are usually enough.
+*/
+static const size_t MixedPrecisionMaxRefinementSteps = 30;
+
+/**
+* The factor by which each refinement step of solveMixedPrecision must at least reduce the backward error. Refinement which improves less than this has stagnated, and the system is solved with double precision LU instead.
+*/
+static const double MixedPrecisionMinImprovement = 0.5;
+
+/**
+* Turns a matrix into a zero matrix of the given dimensions.
+* @param matrix The matrix to be resized. Its old elements are discarded.
+* @param numRows The new number of rows.
+* @param numColumns The new number of columns.
+*/
+static void resizeToZeroMatrix(DenseMatrix* matrix, size_t numRows, size_t numColumns)
+{
+	matrix->resize(0, 0);
+	matrix->resize(numRows, numColumns);
+}
+
+/**
+* Computes the Householder reflection which eliminates the elements of column j below row j, in place: the diagonal element becomes beta, and the elements below it become the Householder vector (whose first element, 1, is implicit).
+* @param data The row-major elements of the matrix.
+* @param rowStride The distance between two rows of the matrix.
+* @param numRows The number of rows of the matrix.
+* @param j The index of the column (and the first row) of the reflection.
+* @return The scalar factor tau of the reflection (I - tau * v * transpose(v)). Zero if there is nothing to eliminate, in which case the reflection is the identity.
+*/
+static double computeReflection(double* data, size_t rowStride, size_t numRows, size_t j)
+{
+	double alpha = data[j * rowStride + j];
+	double tailSquaredNorm = 0.0;
+
+	for (size_t i = j + 1; i < numRows; i++)
+	{
+		double value = data[i * rowStride + j];
+		tailSquaredNorm += value * value;
+	}
+
+	if (tailSquaredNorm == 0.0)
+	{
+		return 0.0;
+	}
+
+	double norm = std::sqrt(alpha * alpha + tailSquaredNorm);
+	double beta = (alpha >= 0.0) ? -norm : norm; // The sign which avoids cancellation in (alpha - beta).
+	double vectorScale = 1.0 / (alpha - beta);
+
+	data[j * rowStride + j] = beta;
+
+	for (size_t i = j + 1; i < numRows; i++)
+	{
+		data[i * rowStride + j] *= vectorScale;
+	}
+
+	return (beta - alpha) / beta;
+}
+
+/**
+* Applies the reflection of column j (see computeReflection) to the columns [columnBegin, columnEnd): A -= tau * v * (transpose(v) * A), row by row.
+* @param data The row-major elements of the matrix.
+* @param rowStride The distance between two rows of the matrix.
+* @param numRows The number of rows of the matrix.
+* @param j The index of the column which holds the Householder vector.
+* @param tau The scalar factor of the reflection.
+* @param columnBegin The index of the first column which is updated.
+* @param columnEnd The index after the last column which is updated.
+* @param dotProducts Scratch memory for the products (transpose(v) * A), reused between the calls.
+*/
+static void applyReflection(double* data, size_t rowStride, size_t numRows, size_t j, double tau, size_t columnBegin, size_t columnEnd, std::vector<double>& dotProducts)
+{
+	if (tau == 0.0 || columnBegin >= columnEnd)
+	{
+		return;
+	}
+
+	dotProducts.assign(columnEnd - columnBegin, 0.0);
+
+	for (size_t i = j; i < numRows; i++)
+	{
+		double v = (i == j) ? 1.0 : data[i * rowStride + j];
+		const double* rowData = data + i * rowStride + columnBegin;
+
+		for (size_t c = 0; c < dotProducts.size(); c++)
+		{
+			dotProducts[c] += v * rowData[c];
+		}
+	}
+
+	for (size_t i = j; i < numRows; i++)
+	{
+		double scaledV = tau * ((i == j) ? 1.0 : data[i * rowStride + j]);
+		double* rowData = data + i * rowStride + columnBegin;
+
+		for (size_t c = 0; c < dotProducts.size(); c++)
+		{
+			rowData[c] -= scaledV * dotProducts[c];
+		}
+	}
+}
+
+/**
+* Factorizes the columns [panelBegin, panelEnd) of a matrix with Householder reflections, one column at a time. The reflections are only applied to the columns of the panel.
+* @param data The row-major elements of the matrix.
+* @param rowStride The distance between two rows of the matrix.
+* @param numRows The number of rows of the matrix.
+* @param panelBegin The index of the first column of the panel. The reflection of column j starts at row j.
+* @param panelEnd The index after the last column of the panel.
+* @param tau The scalar factors of the reflections, indexed by column.
+*/
+static void factorizeQRPanel(double* data, size_t rowStride, size_t numRows, size_t panelBegin, size_t panelEnd, double* tau)
+{
+	std::vector<double> dotProducts;
+
+	for (size_t j = panelBegin; j < panelEnd; j++)
+	{
+		tau[j] = computeReflection(data, rowStride, numRows, j);
+		applyReflection(data, rowStride, numRows, j, tau[j], j + 1, panelEnd, dotProducts);
+	}
+}
+
+/**
+* Forms the upper triangular T of the compact WY representation of a block of reflections, such that (H_0 * H_1 * ... H_(blockSize-1)) == (I - V * T * transpose(V)).
+* @param data The row-major elements of the factorized matrix, which hold the Householder vectors below the diagonal.
+* @param rowStride The distance between two rows of the matrix.
+* @param numRows The number of rows of the matrix.
+* @param blockBegin The index of the first column of the block. Its Householder vector starts at row blockBegin.
+* @param blockSize The number of reflections in the block.
+* @param tau The scalar factors of the reflections, indexed by column.
+* @param out_t A pointer to the (blockSize x blockSize) row-major matrix to which T is meant to be stored. This is an output variable, the user must declare the necessary variable before calling this method.
+*/
+static void formBlockReflectorFactor(const double* data, size_t rowStride, size_t numRows, size_t blockBegin, size_t blockSize, const double* tau, DenseMatrix::CellStorage* out_t)
+{
+	DenseMatrix::CellStorage& t = *out_t;
+	t.assign(blockSize * blockSize, 0.0);
+
+	std::vector<double> dotProducts(blockSize);
+
+	for (size_t p = 0; p < blockSize; p++)
+	{
+		double tauP = tau[blockBegin + p];
+		t[p * blockSize + p] = tauP;
+
+		if (tauP == 0.0 || p == 0)
+		{
+			continue;
+		}
+
+		// dotProducts = -tau_p * transpose(V(:, 0:p)) * v_p
+		std::fill(dotProducts.begin(), dotProducts.begin() + p, 0.0);
+
+		for (size_t r = blockBegin + p; r < numRows; r++)
+		{
+			const double* rowData = data + r * rowStride + blockBegin;
+			double vP = (r == blockBegin + p) ? 1.0 : rowData[p];
+
+			for (size_t q = 0; q < p; q++)
+			{
+				dotProducts[q] += rowData[q] * vP;
+			}
+		}
+
+		// T(0:p, p) = T(0:p, 0:p) * dotProducts
+		for (size_t q = 0; q < p; q++)
+		{
+			double sum = 0.0;
+
+			for (size_t s = q; s < p; s++)
+			{
+				sum += t[q * blockSize + s] * dotProducts[s];
+			}
+
+			t[q * blockSize + p] = -tauP * sum;
+		}
+	}
+}
+
+/**
+* Replaces the columns [targetColumnBegin, targetColumnEnd) of the target by ((I - V * T * transpose(V)) * target), or by its transpose times the target, in three matrix-matrix products.
+* @param data The row-major elements of the factorized matrix, which hold the Householder vectors (V) below the diagonal.
+* @param rowStride The distance between two rows of the factorized matrix.
+* @param numRows The number of rows of the factorized matrix and the target.
+* @param blockBegin The index of the first column of the block. Its Householder vector starts at row blockBegin.
+* @param blockSize The number of reflections in the block.
+* @param t The upper triangular factor of the block (see formBlockReflectorFactor).
+* @param targetData The row-major elements of the target. May be the factorized matrix itself, if the columns of the target don't overlap the block.
+* @param targetRowStride The distance between two rows of the target.
+* @param targetColumnBegin The index of the first column of the target which is updated.
+* @param targetColumnEnd The index after the last column of the target which is updated.
+* @param isTransposed True to apply the transpose of the block reflector (transpose(Q), in a factorization), false to apply the block reflector itself (Q).
+*/
+static void applyBlockReflector(const double* data, size_t rowStride, size_t numRows, size_t blockBegin, size_t blockSize, const DenseMatrix::CellStorage& t,
+	double* targetData, size_t targetRowStride, size_t targetColumnBegin, size_t targetColumnEnd, bool isTransposed)
+{
+	size_t numTargetColumns = targetColumnEnd - targetColumnBegin;
+
+	if (numTargetColumns == 0)
+	{
+		return;
+	}
+
+	MatrixScratchScope scratchScope;
+	DenseMatrix::CellStorage w(blockSize * numTargetColumns, 0.0, scratchScope.getAllocator());
+
+	// W = transpose(V) * C
+	for (size_t r = blockBegin; r < numRows; r++)
+	{
+		const double* vRow = data + r * rowStride + blockBegin;
+		const double* targetRow = targetData + r * targetRowStride + targetColumnBegin;
+		size_t numVectors = std::min(blockSize, r - blockBegin + 1); // V is unit lower trapezoidal.
+
+		for (size_t p = 0; p < numVectors; p++)
+		{
+			double v = (r == blockBegin + p) ? 1.0 : vRow[p];
+
+			if (v == 0.0)
+			{
+				continue;
+			}
+
+			double* wRow = &w[p * numTargetColumns];
+
+			for (size_t c = 0; c < numTargetColumns; c++)
+			{
+				wRow[c] += v * targetRow[c];
+			}
+		}
+	}
+
+	if (isTransposed)
+	{
+		// W = transpose(T) * W. transpose(T) is lower triangular, so the rows are updated from the bottom up.
+		for (size_t p = blockSize; p-- > 0; )
+		{
+			double* wRow = &w[p * numTargetColumns];
+			double diagonal = t[p * blockSize + p];
+
+			for (size_t c = 0; c < numTargetColumns; c++)
+			{
+				wRow[c] *= diagonal;
+			}
+
+			for (size_t q = 0; q < p; q++)
+			{
+				double factor = t[q * blockSize + p];
+
+				if (factor == 0.0)
+				{
+					continue;
+				}
+
+				const double* wRowQ = &w[q * numTargetColumns];
+
+				for (size_t c = 0; c < numTargetColumns; c++)
+				{
+					wRow[c] += factor * wRowQ[c];
+				}
+			}
+		}
+	}
+	else
+	{
+		// W = T * W. T is upper triangular, so the rows are updated from the top down.
+		for (size_t p = 0; p < blockSize; p++)
+		{
+			double* wRow = &w[p * numTargetColumns];
+			double diagonal = t[p * blockSize + p];
+
+			for (size_t c = 0; c < numTargetColumns; c++)
+			{
+				wRow[c] *= diagonal;
+			}
+
+			for (size_t q = p + 1; q < blockSize; q++)
+			{
+				double factor = t[p * blockSize + q];
+
+				if (factor == 0.0)
+				{
+					continue;
+				}
+
+				const double* wRowQ = &w[q * numTargetColumns];
+
+				for (size_t c = 0; c < numTargetColumns; c++)
+				{
+					wRow[c] += factor * wRowQ[c];
+				}
+			}
+		}
+	}
+
+	// C = C - V * W
+	for (size_t r = blockBegin; r < numRows; r++)
+	{
+		const double* vRow = data + r * rowStride + blockBegin;
+		double* targetRow = targetData + r * targetRowStride + targetColumnBegin;
+		size_t numVectors = std::min(blockSize, r - blockBegin + 1);
+
+		for (size_t p = 0; p < numVectors; p++)
+		{
+			double v = (r == blockBegin + p) ? 1.0 : vRow[p];
+
+			if (v == 0.0)
+			{
+				continue;
+			}
+
+			const double* wRow = &w[p * numTargetColumns];
+
+			for (size_t c = 0; c < numTargetColumns; c++)
+			{
+				targetRow[c] -= v * wRow[c];
+			}
+		}
+	}
+}
+
+/**
+* Factorizes a panel of the Cholesky factorization in place, column by column (left-looking within the panel): the diagonal block becomes L11, and the rows below it become L21 = A21 * inverse(transpose(L11)).
+* The panel is assumed to be updated by the previous panels already. Only the lower triangle is read and written.
+* @param data The row-major elements of the matrix.
+* @param rowStride The distance between two rows of the matrix.
+* @param numRows The number of rows (and columns) of the matrix.
+* @param panelBegin The index of the first column (and row) of the panel.
+* @param panelEnd The index after the last column of the panel.
+* @return True on success. False if a pivot isn't positive, in which case the matrix isn't positive definite and the factorization stops right away.
+*/
+static bool factorizeCholeskyPanel(double* data, size_t rowStride, size_t numRows, size_t panelBegin, size_t panelEnd)
+{
+	for (size_t j = panelBegin; j < panelEnd; j++)
+	{
+		double* rowJ = data + j * rowStride;
+		double pivot = rowJ[j];
+
+		for (size_t k = panelBegin; k < j; k++)
+		{
+			pivot -= rowJ[k] * rowJ[k];
+		}
+
+		if (!(pivot > 0.0)) // Also fails for NaN.
+		{
+			return false;
+		}
+
+		double diagonal = std::sqrt(pivot);
+		rowJ[j] = diagonal;
+
+		// Column j below the diagonal: each element is a dot product of two contiguous row segments of the panel.
+		for (size_t i = j + 1; i < numRows; i++)
+		{
+			double* rowI = data + i * rowStride;
+			double value = rowI[j];
+
+			for (size_t k = panelBegin; k < j; k++)
+			{
+				value -= rowI[k] * rowJ[k];
+			}
+
+			rowI[j] = value / diagonal;
+		}
+	}
+
+	return true;
+}
+
+/**
+* Subtracts the symmetric rank-k update (L21 * transpose(L21)) of a Cholesky panel from the lower triangle of the trailing matrix (SYRK): A22 -= L21 * transpose(L21).
+* Every element is a dot product of two contiguous rows of the panel. The columns are processed in tiles, so that the panel rows of a tile are reused from the cache by every row below them.
+* @param data The row-major elements of the matrix.
+* @param rowStride The distance between two rows of the matrix.
+* @param numRows The number of rows (and columns) of the matrix.
+* @param panelBegin The index of the first column of the panel.
+* @param panelEnd The index after the last column of the panel, which is also the index of the first row (and column) of the trailing matrix.
+*/
+static void subtractSymmetricRankUpdate(double* data, size_t rowStride, size_t numRows, size_t panelBegin, size_t panelEnd)
+{
+	size_t panelSize = panelEnd - panelBegin;
+
+	for (size_t tileBegin = panelEnd; tileBegin < numRows; tileBegin += SymmetricUpdateTileSize)
+	{
+		size_t tileEnd = std::min(numRows, tileBegin + SymmetricUpdateTileSize);
+
+		for (size_t i = tileBegin; i < numRows; i++)
+		{
+			double* rowI = data + i * rowStride;
+			const double* panelRowI = rowI + panelBegin;
+			size_t columnEnd = std::min(tileEnd, i + 1);
+
+			for (size_t j = tileBegin; j < columnEnd; j++)
+			{
+				const double* panelRowJ = data + j * rowStride + panelBegin;
+				double dotProduct = 0.0;
+
+				for (size_t k = 0; k < panelSize; k++)
+				{
+					dotProduct += panelRowI[k] * panelRowJ[k];
+				}
+
+				rowI[j] -= dotProduct;
+			}
+		}
+	}
+}
+
+/**
+* Checks the cheap necessary conditions of positive definiteness (a square, symmetric matrix with a positive diagonal), and factorizes a DenseMatrix copy of the matrix with factorizeCholesky if they hold.
+* @param matrix The matrix to be factorized.
+* @param allocator The allocator of the copy. The factor is usually a temporary, in the arena of a MatrixScratchScope.
+* @return A raw pointer to the factorized DenseMatrix copy. nullptr if the matrix isn't symmetric positive definite.
+*/
+static DenseMatrix* getCholeskyFactor(const MatrixBase& matrix, MatrixAllocator* allocator)
+{
+	size_t numDimensions = matrix.getNumRows();
+
+	if (numDimensions == 0 || numDimensions != matrix.getNumColumns())
+	{
+		return nullptr;
+	}
+
+	for (size_t d = 0; d < numDimensions; d++)
+	{
+		if (!(matrix.getCell(d, d) > 0.0))
+		{
+			return nullptr;
+		}
+	}
+
+	if (!mck::isSymmetric(matrix, mcu::EPSILON))
+	{
+		return nullptr;
+	}
+
+	DenseMatrix* factor = DenseMatrix::createCopy(matrix, allocator);
+
+	if (!mck::factorizeCholesky(*factor))
+	{
+		delete factor;
+		return nullptr;
+	}
+
+	return factor;
+}
+
+/**
+* Factorizes a panel of the LU factorization in place with partial pivoting (unblocked, right-looking within the panel). Only the columns of the panel are updated and swapped; the swaps of the other columns are left to applyRowSwaps, so that they are done in a batch.
+* The LU helpers are templates on the type of the elements: double, or float for the single precision factorization of solveMixedPrecision.
+* @param data The row-major elements of the matrix.
+* @param rowStride The distance between two rows of the matrix.
+* @param numRows The number of rows of the matrix.
+* @param panelBegin The index of the first column (and row) of the panel.
+* @param panelEnd The index after the last column of the panel.
+* @param rowPivots The pivots of the whole factorization: row j was swapped with row rowPivots[j] at step j. The elements [panelBegin, panelEnd) are written.
+* @return True if every pivot of the panel is non-zero. False if a column has no non-zero pivot, in which case the column is skipped (the matrix is singular).
+*/
+template <typename Element>
+static bool factorizeLUPanel(Element* data, size_t rowStride, size_t numRows, size_t panelBegin, size_t panelEnd, size_t* rowPivots)
+{
+	bool isNonSingular = true;
+
+	for (size_t j = panelBegin; j < panelEnd; j++)
+	{
+		size_t pivotRow = j;
+		Element pivotMagnitude = std::abs(data[j * rowStride + j]);
+
+		for (size_t i = j + 1; i < numRows; i++)
+		{
+			Element magnitude = std::abs(data[i * rowStride + j]);
+
+			if (magnitude > pivotMagnitude)
+			{
+				pivotRow = i;
+				pivotMagnitude = magnitude;
+			}
+		}
+
+		rowPivots[j] = pivotRow;
+
+		if (pivotRow != j)
+		{
+			std::swap_ranges(data + j * rowStride + panelBegin, data + j * rowStride + panelEnd, data + pivotRow * rowStride + panelBegin);
+		}
+
+		const Element* rowJ = data + j * rowStride;
+		Element pivot = rowJ[j];
+
+		if (pivot == 0.0)
+		{
+			isNonSingular = false;
+			continue;
+		}
+
+		for (size_t i = j + 1; i < numRows; i++)
+		{
+			Element* rowI = data + i * rowStride;
+			Element multiplier = rowI[j] / pivot;
+			rowI[j] = multiplier;
+
+			if (multiplier == 0.0)
+			{
+				continue;
+			}
+
+			for (size_t c = j + 1; c < panelEnd; c++)
+			{
+				rowI[c] -= multiplier * rowJ[c];
+			}
+		}
+	}
+
+	return isNonSingular;
+}
+
+/**
+* Applies the row swaps of the pivots [pivotBegin, pivotEnd) to the columns [columnBegin, columnEnd), in order.
+* @param data The row-major elements of the matrix.
+* @param rowStride The distance between two rows of the matrix.
+* @param rowPivots The pivots: row j is swapped with row rowPivots[j].
+* @param pivotBegin The index of the first pivot which is applied.
+* @param pivotEnd The index after the last pivot which is applied.
+* @param columnBegin The index of the first column which is swapped.
+* @param columnEnd The index after the last column which is swapped.
+*/
+template <typename Element>
+static void applyRowSwaps(Element* data, size_t rowStride, const size_t* rowPivots, size_t pivotBegin, size_t pivotEnd, size_t columnBegin, size_t columnEnd)
+{
+	if (columnBegin >= columnEnd)
+	{
+		return;
+	}
+
+	for (size_t j = pivotBegin; j < pivotEnd; j++)
+	{
+		if (rowPivots[j] != j)
+		{
+			std::swap_ranges(data + j * rowStride + columnBegin, data + j * rowStride + columnEnd, data + rowPivots[j] * rowStride + columnBegin);
+		}
+	}
+}
+
+/**
+* Overwrites the rows of a factorized LU panel in a block of columns with U12 = inverse(L11) * A12, where L11 is the unit lower triangle of the panel (TRSM).
+* @param data The row-major elements of the matrix.
+* @param rowStride The distance between two rows of the matrix.
+* @param panelBegin The index of the first column (and row) of the panel.
+* @param panelEnd The index after the last column of the panel.
+* @param columnBegin The index of the first column of the block.
+* @param columnEnd The index after the last column of the block.
+*/
+template <typename Element>
+static void solveUnitLowerPanel(Element* data, size_t rowStride, size_t panelBegin, size_t panelEnd, size_t columnBegin, size_t columnEnd)
+{
+	for (size_t i = panelBegin + 1; i < panelEnd; i++)
+	{
+		Element* rowI = data + i * rowStride;
+
+		for (size_t k = panelBegin; k < i; k++)
+		{
+			Element multiplier = rowI[k];
+
+			if (multiplier == 0.0)
+			{
+				continue;
+			}
+
+			const Element* rowK = data + k * rowStride;
+
+			for (size_t c = columnBegin; c < columnEnd; c++)
+			{
+				rowI[c] -= multiplier * rowK[c];
+			}
+		}
+	}
+}
+
+/**
+* Subtracts the product of a factorized LU panel and its rows of U from a block of the trailing matrix (GEMM): A22 -= L21 * U12, row by row.
+* @param data The row-major elements of the matrix.
+* @param rowStride The distance between two rows of the matrix.
+* @param panelBegin The index of the first column (and of the first row of U12) of the panel.
+* @param panelEnd The index after the last column of the panel.
+* @param rowBegin The index of the first row of the block which is updated.
+* @param rowEnd The index after the last row of the block which is updated.
+* @param columnBegin The index of the first column of the block which is updated.
+* @param columnEnd The index after the last column of the block which is updated.
+*/
+template <typename Element>
+static void subtractPanelProduct(Element* data, size_t rowStride, size_t panelBegin, size_t panelEnd, size_t rowBegin, size_t rowEnd, size_t columnBegin, size_t columnEnd)
+{
+	for (size_t i = rowBegin; i < rowEnd; i++)
+	{
+		Element* rowI = data + i * rowStride;
+
+		for (size_t k = panelBegin; k < panelEnd; k++)
+		{
+			Element multiplier = rowI[k];
+
+			if (multiplier == 0.0)
+			{
+				continue;
+			}
+
+			const Element* rowK = data + k * rowStride;
+
+			for (size_t c = columnBegin; c < columnEnd; c++)
+			{
+				rowI[c] -= multiplier * rowK[c];
+			}
+		}
+	}
+}
+
+/**
+* Starts subtractPanelProduct on worker threads, each of which updates a range of rows. A small update is performed on the calling thread right away instead.
+* The caller must join the workers before it touches the block. If a thread can't be started, its rows are updated on the calling thread.
+* @param out_workers A pointer to the vector to which the started threads are meant to be added.
+* @see subtractPanelProduct for the other parameters.
+*/
+template <typename Element>
+static void startPanelProduct(Element* data, size_t rowStride, size_t panelBegin, size_t panelEnd, size_t rowBegin, size_t rowEnd, size_t columnBegin, size_t columnEnd, std::vector<std::thread>* out_workers)
+{
+	if (rowBegin >= rowEnd || columnBegin >= columnEnd)
+	{
+		return;
+	}
+
+	size_t numRows = rowEnd - rowBegin;
+	size_t work = numRows * (columnEnd - columnBegin) * (panelEnd - panelBegin);
+	size_t numWorkers = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), numRows / LUParallelMinRows);
+
+	if (work < LUParallelMinWork || numWorkers <= 1)
+	{
+		subtractPanelProduct(data, rowStride, panelBegin, panelEnd, rowBegin, rowEnd, columnBegin, columnEnd);
+		return;
+	}
+
+	size_t rowsPerWorker = (numRows + numWorkers - 1) / numWorkers;
+
+	for (size_t workerRowBegin = rowBegin; workerRowBegin < rowEnd; workerRowBegin += rowsPerWorker)
+	{
+		size_t workerRowEnd = std::min(rowEnd, workerRowBegin + rowsPerWorker);
+
+		try
+		{
+			out_workers->emplace_back(subtractPanelProduct<Element>, data, rowStride, panelBegin, panelEnd, workerRowBegin, workerRowEnd, columnBegin, columnEnd);
+		}
+		catch (const std::system_error&)
+		{
+			subtractPanelProduct(data, rowStride, panelBegin, panelEnd, workerRowBegin, workerRowEnd, columnBegin, columnEnd);
+		}
+	}
+}
+
+/**
+* Factorizes the columns [panelBegin, panelEnd) of the rows [panelBegin, numRows) in place with partial pivoting, recursively (Toledo): the left half of the columns is factorized, its swaps are applied to the right half, whose rows of U are solved for (TRSM) and whose remaining rows are updated (GEMM), before the right half is factorized and its swaps are applied to the left half.
+* Every level works on blocks which are halved at the next one, so some level fits each cache whatever its size.
+* @param data The row-major elements of the matrix.
+* @param rowStride The distance between two rows of the matrix.
+* @param numRows The number of rows of the matrix.
+* @param panelBegin The index of the first column (and row) of the panel.
+* @param panelEnd The index after the last column of the panel.
+* @param rowPivots The pivots of the whole factorization (see factorizeLUPanel). The elements [panelBegin, panelEnd) are written.
+* @return True if every pivot of the panel is non-zero.
+*/
+template <typename Element>
+static bool factorizeLURecursivePanel(Element* data, size_t rowStride, size_t numRows, size_t panelBegin, size_t panelEnd, size_t* rowPivots)
+{
+	if (panelEnd - panelBegin <= LURecursiveMinColumns)
+	{
+		return factorizeLUPanel(data, rowStride, numRows, panelBegin, panelEnd, rowPivots);
+	}
+
+	size_t panelMiddle = panelBegin + (panelEnd - panelBegin) / 2;
+	bool isNonSingular = factorizeLURecursivePanel(data, rowStride, numRows, panelBegin, panelMiddle, rowPivots);
+
+	applyRowSwaps(data, rowStride, rowPivots, panelBegin, panelMiddle, panelMiddle, panelEnd);
+	solveUnitLowerPanel(data, rowStride, panelBegin, panelMiddle, panelMiddle, panelEnd);
+
+	std::vector<std::thread> workers;
+
+	startPanelProduct(data, rowStride, panelBegin, panelMiddle, panelMiddle, numRows, panelMiddle, panelEnd, &workers);
+
+	for (size_t w = 0; w < workers.size(); w++)
+	{
+		workers[w].join();
+	}
+
+	isNonSingular = factorizeLURecursivePanel(data, rowStride, numRows, panelMiddle, panelEnd, rowPivots) && isNonSingular;
+	applyRowSwaps(data, rowStride, rowPivots, panelMiddle, panelEnd, panelBegin, panelMiddle);
+
+	return isNonSingular;
+}
+
+/**
+* Solves (op(triangle) * X == rightHandSides) in place, block by block (see mck::solveTriangularInPlace). The dimensions and the diagonal must have been checked by the caller.
+* @param triangleData The row-major elements of the triangle.
+* @param triangleStride The distance between two rows of the triangle.
+* @param numDimensions The number of rows (and columns) of the triangle.
+* @param data The row-major elements of the right hand sides, which are overwritten by X.
+* @param numRightHandSides The number of columns (and the distance between two rows) of the right hand sides.
+* @see mck::solveTriangularInPlace for the flags.
+*/
+template <typename Element>
+static void solveTriangularBlocks(const Element* triangleData, size_t triangleStride, size_t numDimensions, Element* data, size_t numRightHandSides, bool isLower, bool isTransposed, bool hasUnitDiagonal)
+{
+	// op(triangle)(i, k), where op transposes if isTransposed is set.
+	auto getCoefficient = [=](size_t i, size_t k)
+	{
+		return isTransposed ? triangleData[k * triangleStride + i] : triangleData[i * triangleStride + k];
+	};
+
+	// op(triangle) is lower triangular (forward substitution, from the top down) or upper triangular (back substitution, from the bottom up).
+	bool isForward = (isLower != isTransposed);
+	size_t numBlocks = (numDimensions + TriangularSolveBlockSize - 1) / TriangularSolveBlockSize;
+
+	for (size_t columnBegin = 0; columnBegin < numRightHandSides; columnBegin += TriangularSolveColumnTileSize)
+	{
+		size_t columnEnd = std::min(numRightHandSides, columnBegin + TriangularSolveColumnTileSize);
+
+		for (size_t b = 0; b < numBlocks; b++)
+		{
+			size_t blockBegin = isForward ? b * TriangularSolveBlockSize : ((numBlocks - b - 1) * TriangularSolveBlockSize);
+			size_t blockEnd = std::min(numDimensions, blockBegin + TriangularSolveBlockSize);
+
+			// Substitution within the diagonal block.
+			for (size_t step = blockBegin; step < blockEnd; step++)
+			{
+				size_t i = isForward ? step : (blockEnd - 1 - (step - blockBegin));
+				Element* rowI = data + i * numRightHandSides;
+				size_t solvedBegin = isForward ? blockBegin : (i + 1);
+				size_t solvedEnd = isForward ? i : blockEnd;
+
+				for (size_t k = solvedBegin; k < solvedEnd; k++)
+				{
+					Element coefficient = getCoefficient(i, k);
+
+					if (coefficient == 0.0)
+					{
+						continue;
+					}
+
+					const Element* rowK = data + k * numRightHandSides;
+
+					for (size_t c = columnBegin; c < columnEnd; c++)
+					{
+						rowI[c] -= coefficient * rowK[c];
+					}
+				}
+
+				if (hasUnitDiagonal == false)
+				{
+					Element diagonal = triangleData[i * triangleStride + i];
+
+					for (size_t c = columnBegin; c < columnEnd; c++)
+					{
+						rowI[c] /= diagonal;
+					}
+				}
+			}
+
+			// The solved block is subtracted from the rows which are still to be solved (GEMM).
+			size_t remainingBegin = isForward ? blockEnd : 0;
+			size_t remainingEnd = isForward ? numDimensions : blockBegin;
+
+			for (size_t i = remainingBegin; i < remainingEnd; i++)
+			{
+				Element* rowI = data + i * numRightHandSides;
+
+				for (size_t k = blockBegin; k < blockEnd; k++)
+				{
+					Element coefficient = getCoefficient(i, k);
+
+					if (coefficient == 0.0)
+					{
+						continue;
+					}
+
+					const Element* rowK = data + k * numRightHandSides;
+
+					for (size_t c = columnBegin; c < columnEnd; c++)
+					{
+						rowI[c] -= coefficient * rowK[c];
+					}
+				}
+			}
+		}
+	}
+}
+
+/**
+* Solves (matrix * X == rightHandSides) in place with the LU factors of the matrix (see mck::factorizeLU), whose pivots must have been checked.
+* @param factors The factorized matrix.
+* @param rowPivots The pivots of the factorization.
+* @param rightHandSides The right hand side(s), one per column, which are overwritten by X.
+*/
+static void solveWithLUFactors(const DenseMatrix& factors, const std::vector<size_t>& rowPivots, DenseMatrix& rightHandSides)
+{
+	size_t numRightHandSides = rightHandSides.getNumColumns();
+
+	// L * Y = P * B, where L has a unit diagonal, then U * X = Y.
+	applyRowSwaps(rightHandSides.getRowData(0), numRightHandSides, rowPivots.data(), 0, rowPivots.size(), 0, numRightHandSides);
+	mck::solveTriangularInPlace(factors, rightHandSides, true, false, true);
+	mck::solveTriangularInPlace(factors, rightHandSides, false, false, false);
+}
+
+/**
+* Solves (matrix * D == residual) with the single precision LU factors of the matrix, and adds D to the solution. The residual is scaled to a largest magnitude of one before it is rounded to float, so that a small residual doesn't underflow.
+* @param factors The row-major single precision factors, as factorizeLURecursivePanel leaves them.
+* @param rowPivots The pivots of the factorization.
+* @param residual The residual (rightHandSides - matrix * solution).
+* @param correction The scratch buffer of (numDimensions * numRightHandSides) floats which holds D.
+* @param solution The solution to be corrected.
+*/
+static void addSinglePrecisionCorrection(const std::vector<float>& factors, const std::vector<size_t>& rowPivots, const DenseMatrix& residual, std::vector<float>& correction, DenseMatrix& solution)
+{
+	size_t numDimensions = residual.getNumRows();
+	size_t numRightHandSides = residual.getNumColumns();
+	const double* residualData = residual.getRowData(0);
+	double scale = 0.0;
+
+	for (size_t i = 0; i < numDimensions * numRightHandSides; i++)
+	{
+		scale = std::max(scale, std::abs(residualData[i]));
+	}
+
+	if (scale == 0.0)
+	{
+		return;
+	}
+
+	for (size_t i = 0; i < numDimensions * numRightHandSides; i++)
+	{
+		correction[i] = (float)(residualData[i] / scale);
+	}
+
+	applyRowSwaps(correction.data(), numRightHandSides, rowPivots.data(), 0, numDimensions, 0, numRightHandSides);
+	solveTriangularBlocks(factors.data(), numDimensions, numDimensions, correction.data(), numRightHandSides, true, false, true);
+	solveTriangularBlocks(factors.data(), numDimensions, numDimensions, correction.data(), numRightHandSides, false, false, false);
+
+	double* solutionData = solution.getRowData(0);
+
+	for (size_t i = 0; i < numDimensions * numRightHandSides; i++)
+	{
+		solutionData[i] += scale * (double)correction[i];
+	}
+}
+
+/**
+* Computes the residual (rightHandSides - matrix * solution) in double precision, and the normwise backward error of the solution: the largest, over the columns, of (infinity norm of the residual) / (matrixNorm * (infinity norm of the solution) + (infinity norm of the right hand side)).
+* @param matrix The square matrix of coefficients.
+* @param matrixNorm The infinity norm (the largest absolute row sum) of the matrix.
+* @param rightHandSides The right hand side(s), one per column.
+* @param solution The solution, one column per right hand side.
+* @param out_residual A pointer to the DenseMatrix to which the residual is meant to be stored. Its dimensions must match those of rightHandSides.
+* @return The backward error. Zero for an exact solution, and infinity if it isn't finite.
+*/
+static double computeBackwardError(const DenseMatrix& matrix, double matrixNorm, const DenseMatrix& rightHandSides, const DenseMatrix& solution, DenseMatrix* out_residual)
+{
+	size_t numDimensions = matrix.getNumRows();
+	size_t numRightHandSides = rightHandSides.getNumColumns();
+
+	for (size_t i = 0; i < numDimensions; i++)
+	{
+		const double* matrixRow = matrix.getRowData(i);
+		const double* rightHandSideRow = rightHandSides.getRowData(i);
+		double* residualRow = out_residual->getRowData(i);
+
+		std::copy(rightHandSideRow, rightHandSideRow + numRightHandSides, residualRow);
+
+		for (size_t k = 0; k < numDimensions; k++)
+		{
+			double coefficient = matrixRow[k];
+
+			if (coefficient == 0.0)
+			{
+				continue;
+			}
+
+			const double* solutionRow = solution.getRowData(k);
+
+			for (size_t c = 0; c < numRightHandSides; c++)
+			{
+				residualRow[c] -= coefficient * solutionRow[c];
+			}
+		}
+	}
+
+	double backwardError = 0.0;
+
+	for (size_t c = 0; c < numRightHandSides; c++)
+	{
+		double residualNorm = 0.0;
+		double solutionNorm = 0.0;
+		double rightHandSideNorm = 0.0;
+
+		for (size_t i = 0; i < numDimensions; i++)
+		{
+			residualNorm = std::max(residualNorm, std::abs(out_residual->getRowData(i)[c]));
+			solutionNorm = std::max(solutionNorm, std::abs(solution.getRowData(i)[c]));
+			rightHandSideNorm = std::max(rightHandSideNorm, std::abs(rightHandSides.getRowData(i)[c]));
+		}
+
+		double denominator = matrixNorm * solutionNorm + rightHandSideNorm;
+
+		if (residualNorm > 0.0)
+		{
+			backwardError = std::max(backwardError, residualNorm / denominator);
+		}
+	}
+
+	return (backwardError == backwardError && backwardError < std::numeric_limits<double>::infinity()) ? backwardError : std::numeric_limits<double>::infinity();
+}
+
+/**
+* Factorizes a copy of a square matrix with factorizeLU, and checks whether it is numerically singular: whether a diagonal element of U is not greater than (mcu::EPSILON * the largest one) in magnitude.
+* @param matrix The matrix to be factorized.
+* @param allocator The allocator of the copy. The factors are usually temporaries, in the arena of a MatrixScratchScope.
+* @param out_rowPivots A pointer to the vector to which the pivots are meant to be stored (see factorizeLU).
+* @return A raw pointer to the factorized DenseMatrix copy. nullptr if the matrix isn't square or is numerically singular.
+*/
+static DenseMatrix* getNonSingularLUFactors(const MatrixBase& matrix, MatrixAllocator* allocator, std::vector<size_t>* out_rowPivots)
+{
+	size_t numDimensions = matrix.getNumRows();
+
+	if (numDimensions == 0 || numDimensions != matrix.getNumColumns())
+	{
+		return nullptr;
+	}
+
+	DenseMatrix* factors = DenseMatrix::createCopy(matrix, allocator);
+	bool isNonSingular = mck::factorizeLU(*factors, out_rowPivots);
+	double largestPivot = 0.0;
+	double smallestPivot = std::numeric_limits<double>::infinity();
+
+	for (size_t d = 0; d < numDimensions && isNonSingular; d++)
+	{
+		double magnitude = std::abs(factors->getRowData(d)[d]);
+		largestPivot = std::max(largestPivot, magnitude);
+		smallestPivot = std::min(smallestPivot, magnitude);
+	}
+
+	if (!isNonSingular || !(smallestPivot > mcu::EPSILON * largestPivot))
+	{
+		delete factors;
+		return nullptr;
+	}
+
+	return factors;
+}
+
+/**
+* Forms Q = (H_0 * H_1 * ... * H_(k-1)) explicitly, from the reflections which tridiagonalize a matrix or reduce it to the Hessenberg form: the vector of H_j is stored in column j below the subdiagonal, and its first element (1, on the subdiagonal) is implicit.
+* The reflections are applied to the identity from the last one to the first one, so that each of them only touches the trailing block.
+* @param factors The reduced matrix, which holds the Householder vectors.
+* @param tau The scalar factors of the reflections.
+* @param out_q A pointer to the square zero DenseMatrix (with the dimensions of factors) to which Q is meant to be stored.
+*/
+static void formSubdiagonalReflectorProduct(const DenseMatrix& factors, const std::vector<double>& tau, DenseMatrix* out_q)
+{
+	size_t numDimensions = factors.getNumRows();
+	std::vector<double> dotProducts;
+
+	for (size_t d = 0; d < numDimensions; d++)
+	{
+		out_q->getRowData(d)[d] = 1.0;
+	}
+
+	for (size_t k = tau.size(); k-- > 0;)
+	{
+		if (tau[k] == 0.0)
+		{
+			continue;
+		}
+
+		dotProducts.assign(numDimensions, 0.0);
+
+		for (size_t i = k + 1; i < numDimensions; i++)
+		{
+			double v = (i == k + 1) ? 1.0 : factors.getRowData(i)[k];
+			const double* rowData = out_q->getRowData(i);
+
+			for (size_t c = k + 1; c < numDimensions; c++)
+			{
+				dotProducts[c] += v * rowData[c];
+			}
+		}
+
+		for (size_t i = k + 1; i < numDimensions; i++)
+		{
+			double scaledV = tau[k] * ((i == k + 1) ? 1.0 : factors.getRowData(i)[k]);
+			double* rowData = out_q->getRowData(i);
+
+			for (size_t c = k + 1; c < numDimensions; c++)
+			{
+				rowData[c] -= scaledV * dotProducts[c];
+			}
+		}
+	}
+}
+
+void mck::factorizeQR(DenseMatrix& matrix, std::vector<double>* out_tau)
+{
+	size_t numRows = matrix.getNumRows();
+	size_t numColumns = matrix.getNumColumns();
+	size_t numReflections = std::min(numRows, numColumns);
+
+	out_tau->assign(numReflections, 0.0);
+
+	if (numReflections == 0)
+	{
+		return;
+	}
+
+	double* data = matrix.getRowData(0);
+
+	for (size_t blockBegin = 0; blockBegin < numReflections; blockBegin += QRBlockSize)
+	{
+		size_t blockSize = std::min(QRBlockSize, numReflections - blockBegin);
+
+		factorizeQRPanel(data, numColumns, numRows, blockBegin, blockBegin + blockSize, out_tau->data());
+
+		if (blockBegin + blockSize < numColumns)
+		{
+			MatrixScratchScope scratchScope;
+			DenseMatrix::CellStorage t(scratchScope.getAllocator());
+
+			formBlockReflectorFactor(data, numColumns, numRows, blockBegin, blockSize, out_tau->data(), &t);
+			applyBlockReflector(data, numColumns, numRows, blockBegin, blockSize, t, data, numColumns, blockBegin + blockSize, numColumns, true);
+		}
+	}
+}
+
+void mck::applyQTransposed(const DenseMatrix& factors, const std::vector<double>& tau, DenseMatrix& target)
+{
+	size_t numRows = factors.getNumRows();
+
+	if (tau.empty() || target.getNumColumns() == 0)
+	{
+		return;
+	}
+
+	const double* data = factors.getRowData(0);
+	size_t rowStride = factors.getNumColumns();
+	double* targetData = target.getRowData(0);
+
+	for (size_t blockBegin = 0; blockBegin < tau.size(); blockBegin += QRBlockSize)
+	{
+		size_t blockSize = std::min(QRBlockSize, tau.size() - blockBegin);
+
+		MatrixScratchScope scratchScope;
+		DenseMatrix::CellStorage t(scratchScope.getAllocator());
+
+		formBlockReflectorFactor(data, rowStride, numRows, blockBegin, blockSize, tau.data(), &t);
+		applyBlockReflector(data, rowStride, numRows, blockBegin, blockSize, t, targetData, target.getNumColumns(), 0, target.getNumColumns(), true);
+	}
+}
+
+void mck::applyQ(const DenseMatrix& factors, const std::vector<double>& tau, DenseMatrix& target)
+{
+	size_t numRows = factors.getNumRows();
+
+	if (tau.empty() || target.getNumColumns() == 0)
+	{
+		return;
+	}
+
+	const double* data = factors.getRowData(0);
+	size_t rowStride = factors.getNumColumns();
+	double* targetData = target.getRowData(0);
+	size_t lastBlockBegin = ((tau.size() - 1) / QRBlockSize) * QRBlockSize;
+
+	// Q == (H_0 * H_1 * ...), so the block of the last reflections is applied first.
+	for (size_t blockBegin = lastBlockBegin + QRBlockSize; blockBegin > 0; )
+	{
+		blockBegin -= QRBlockSize;
+		size_t blockSize = std::min(QRBlockSize, tau.size() - blockBegin);
+
+		MatrixScratchScope scratchScope;
+		DenseMatrix::CellStorage t(scratchScope.getAllocator());
+
+		formBlockReflectorFactor(data, rowStride, numRows, blockBegin, blockSize, tau.data(), &t);
+		applyBlockReflector(data, rowStride, numRows, blockBegin, blockSize, t, targetData, target.getNumColumns(), 0, target.getNumColumns(), false);
+	}
+}
+
+DenseMatrix* mck::solveLeastSquares(const MatrixBase& matrix, const MatrixBase& rightHandSide, double* out_residualNorm)
+{
+	size_t numRows = matrix.getNumRows();
+	size_t numColumns = matrix.getNumColumns();
+	size_t numRightHandSides = rightHandSide.getNumColumns();
+
+	if (rightHandSide.getNumRows() != numRows || numRows < numColumns || numColumns == 0 || numRightHandSides == 0)
+	{
+		return nullptr;
+	}
+
+	DenseMatrix* solution = new DenseMatrix(numColumns, numRightHandSides, 0.0);
+	bool isRankDeficient = false;
+	double residualSquaredNorm = 0.0;
+
+	{
+		MatrixScratchScope scratchScope;
+		DenseMatrix* factors = DenseMatrix::createCopy(matrix, scratchScope.getAllocator());
+		DenseMatrix* transformed = DenseMatrix::createCopy(rightHandSide, scratchScope.getAllocator());
+		std::vector<double> tau;
+
+		factorizeQR(*factors, &tau);
+		applyQTransposed(*factors, tau, *transformed);
+
+		// R is singular (up to the rounding errors) if a diagonal element is negligible compared to the largest one.
+		double maxDiagonal = 0.0;
+
+		for (size_t j = 0; j < numColumns; j++)
+		{
+			maxDiagonal = std::max(maxDiagonal, std::abs(factors->getRowData(j)[j]));
+		}
+
+		for (size_t j = 0; j < numColumns; j++)
+		{
+			if (std::abs(factors->getRowData(j)[j]) <= maxDiagonal * mcu::EPSILON)
+			{
+				isRankDeficient = true;
+			}
+		}
+
+		if (isRankDeficient == false)
+		{
+			// Back substitution: R * X = (transpose(Q) * B)(0:n), for every right hand side at once.
+			for (size_t j = 0; j < numColumns; j++)
+			{
+				const double* transformedRow = transformed->getRowData(j);
+
+				std::copy(transformedRow, transformedRow + numRightHandSides, solution->getRowData(j));
+			}
+
+			solveTriangularInPlace(*factors, *solution, false, false, false);
+
+			// The residual is the part of transpose(Q) * B which R can't reach.
+			for (size_t i = numColumns; i < numRows; i++)
+			{
+				const double* transformedRow = transformed->getRowData(i);
+
+				for (size_t c = 0; c < numRightHandSides; c++)
+				{
+					residualSquaredNorm += transformedRow[c] * transformedRow[c];
+				}
+			}
+		}
+
+		delete factors;
+		delete transformed;
+	}
+
+	if (isRankDeficient)
+	{
+		delete solution;
+		return nullptr;
+	}
+
+	if (out_residualNorm != nullptr)
+	{
+		*out_residualNorm = std::sqrt(residualSquaredNorm);
+	}
+
+	return solution;
+}
+
+void mck::factorizeQRColumnPivoting(DenseMatrix& matrix, std::vector<double>* out_tau, std::vector<size_t>* out_columnPivots)
+{
+	size_t numRows = matrix.getNumRows();
+	size_t numColumns = matrix.getNumColumns();
+	size_t numReflections = std::min(numRows, numColumns);
+
+	out_tau->assign(numReflections, 0.0);
+	out_columnPivots->resize(numColumns);
+
+	for (size_t c = 0; c < numColumns; c++)
+	{
+		(*out_columnPivots)[c] = c;
+	}
+
+	if (numReflections == 0)
+	{
+		return;
+	}
+
+	double* data = matrix.getRowData(0);
+
+	// The norms of the remaining parts of the columns (below the rows which are already reduced), and their values when they were last computed from scratch.
+	std::vector<double> columnNorms(numColumns, 0.0);
+
+	for (size_t r = 0; r < numRows; r++)
+	{
+		const double* rowData = data + r * numColumns;
+
+		for (size_t c = 0; c < numColumns; c++)
+		{
+			columnNorms[c] += rowData[c] * rowData[c];
+		}
+	}
+
+	for (size_t c = 0; c < numColumns; c++)
+	{
+		columnNorms[c] = std::sqrt(columnNorms[c]);
+	}
+
+	std::vector<double> computedNorms(columnNorms);
+	std::vector<double> dotProducts;
+
+	// Downdating loses precision when most of the norm is eliminated; below this ratio, the norm is computed again (LAPACK's threshold).
+	const double recomputeThreshold = std::sqrt(std::numeric_limits<double>::epsilon());
+
+	for (size_t j = 0; j < numReflections; j++)
+	{
+		size_t pivot = j;
+
+		for (size_t c = j + 1; c < numColumns; c++)
+		{
+			if (columnNorms[c] > columnNorms[pivot])
+			{
+				pivot = c;
+			}
+		}
+
+		if (pivot != j)
+		{
+			for (size_t r = 0; r < numRows; r++)
+			{
+				std::swap(data[r * numColumns + j], data[r * numColumns + pivot]);
+			}
+
+			std::swap(columnNorms[j], columnNorms[pivot]);
+			std::swap(computedNorms[j], computedNorms[pivot]);
+			std::swap((*out_columnPivots)[j], (*out_columnPivots)[pivot]);
+		}
+
+		(*out_tau)[j] = computeReflection(data, numColumns, numRows, j);
+		applyReflection(data, numColumns, numRows, j, (*out_tau)[j], j + 1, numColumns, dotProducts);
+
+		// Row j is now final, so it no longer belongs to the remaining parts of the columns.
+		for (size_t c = j + 1; c < numColumns; c++)
+		{
+			if (columnNorms[c] == 0.0)
+			{
+				continue;
+			}
+
+			double ratio = std::abs(data[j * numColumns + c]) / columnNorms[c];
+			double remaining = std::max(0.0, (1.0 + ratio) * (1.0 - ratio));
+			double relativeToComputed = columnNorms[c] / computedNorms[c];
+
+			if (remaining * relativeToComputed * relativeToComputed <= recomputeThreshold)
+			{
+				double squaredNorm = 0.0;
+
+				for (size_t r = j + 1; r < numRows; r++)
+				{
+					double value = data[r * numColumns + c];
+					squaredNorm += value * value;
+				}
+
+				columnNorms[c] = std::sqrt(squaredNorm);
+				computedNorms[c] = columnNorms[c];
+			}
+			else
+			{
+				columnNorms[c] *= std::sqrt(remaining);
+			}
+		}
+	}
+}
+
+size_t mck::getRank(const MatrixBase& matrix, double tolerance, std::vector<size_t>* out_independentColumns)
+{
+	size_t rank = 0;
+	std::vector<size_t> columnPivots;
+
+	{
+		MatrixScratchScope scratchScope;
+		DenseMatrix* factors = DenseMatrix::createCopy(matrix, scratchScope.getAllocator());
+		std::vector<double> tau;
+
+		factorizeQRColumnPivoting(*factors, &tau, &columnPivots);
+
+		size_t numDiagonals = tau.size();
+
+		if (numDiagonals > 0)
+		{
+			double threshold = tolerance * std::max(1.0, std::abs(factors->getRowData(0)[0]));
+
+			// The diagonal of R is non-increasing in magnitude, so the rank ends at the first negligible element.
+			while (rank < numDiagonals && std::abs(factors->getRowData(rank)[rank]) > threshold)
+			{
+				rank++;
+			}
+		}
+
+		delete factors;
+	}
+
+	if (out_independentColumns != nullptr)
+	{
+		out_independentColumns->assign(columnPivots.begin(), columnPivots.begin() + rank);
+	}
+
+	return rank;
+}
+
+void mck::computeSVD(const MatrixBase& matrix, bool isThin, std::vector<double>* out_singularValues, DenseMatrix* out_u, DenseMatrix* out_v)
+{
+	// A wide matrix is decomposed through its transpose: transpose(A) == V * S * transpose(U).
+	bool isWide = matrix.getNumRows() < matrix.getNumColumns();
+	size_t numRows = std::max(matrix.getNumRows(), matrix.getNumColumns());
+	size_t numColumns = std::min(matrix.getNumRows(), matrix.getNumColumns());
+	// The vectors of the (tall) reduced matrix: "left" becomes U, or V for a wide matrix.
+	DenseMatrix* leftVectors = isWide ? out_v : out_u;
+	DenseMatrix* rightVectors = isWide ? out_u : out_v;
+
+	out_singularValues->assign(numColumns, 0.0);
+
+	if (leftVectors != nullptr)
+	{
+		resizeToZeroMatrix(leftVectors, numRows, isThin ? numColumns : numRows);
+	}
+
+	if (rightVectors != nullptr)
+	{
+		resizeToZeroMatrix(rightVectors, numColumns, numColumns);
+	}
+
+	if (numColumns > 0)
+	{
+		MatrixScratchScope scratchScope;
+		DenseMatrix* factors = DenseMatrix::createCopy(matrix, scratchScope.getAllocator());
+		std::vector<double> tau;
+
+		if (isWide)
+		{
+			factors->transpose();
+		}
+
+		factorizeQR(*factors, &tau);
+
+		// The rotations orthogonalize the columns of R, which are the rows of transpose(R), so that they are contiguous.
+		DenseMatrix::CellStorage columns(numColumns * numColumns, 0.0, scratchScope.getAllocator());
+		DenseMatrix::CellStorage rotations(scratchScope.getAllocator());
+
+		for (size_t r = 0; r < numColumns; r++)
+		{
+			const double* rRow = factors->getRowData(r);
+
+			for (size_t c = r; c < numColumns; c++)
+			{
+				columns[c * numColumns + r] = rRow[c];
+			}
+		}
+
+		if (rightVectors != nullptr)
+		{
+			// The rows of transpose(V), rotated together with the columns.
+			rotations.assign(numColumns * numColumns, 0.0);
+
+			for (size_t d = 0; d < numColumns; d++)
+			{
+				rotations[d * numColumns + d] = 1.0;
+			}
+		}
+
+		const double orthogonalityTolerance = std::numeric_limits<double>::epsilon() * numColumns;
+
+		for (size_t sweep = 0; sweep < JacobiMaxSweeps; sweep++)
+		{
+			bool isRotated = false;
+
+			for (size_t p = 0; p + 1 < numColumns; p++)
+			{
+				double* columnP = &columns[p * numColumns];
+
+				for (size_t q = p + 1; q < numColumns; q++)
+				{
+					double* columnQ = &columns[q * numColumns];
+					double alpha = 0.0;
+					double beta = 0.0;
+					double gamma = 0.0;
+
+					for (size_t i = 0; i < numColumns; i++)
+					{
+						alpha += columnP[i] * columnP[i];
+						beta += columnQ[i] * columnQ[i];
+						gamma += columnP[i] * columnQ[i];
+					}
+
+					if (gamma == 0.0 || std::abs(gamma) <= orthogonalityTolerance * std::sqrt(alpha * beta))
+					{
+						continue; // Already orthogonal.
+					}
+
+					isRotated = true;
+
+					// The rotation which makes the two columns orthogonal.
+					double zeta = (beta - alpha) / (2.0 * gamma);
+					double tangent = ((zeta >= 0.0) ? 1.0 : -1.0) / (std::abs(zeta) + std::sqrt(1.0 + zeta * zeta));
+					double cosine = 1.0 / std::sqrt(1.0 + tangent * tangent);
+					double sine = cosine * tangent;
+
+					for (size_t i = 0; i < numColumns; i++)
+					{
+						double x = columnP[i];
+						double y = columnQ[i];
+						columnP[i] = cosine * x - sine * y;
+						columnQ[i] = sine * x + cosine * y;
+					}
+
+					if (rightVectors != nullptr)
+					{
+						double* rotationP = &rotations[p * numColumns];
+						double* rotationQ = &rotations[q * numColumns];
+
+						for (size_t i = 0; i < numColumns; i++)
+						{
+							double x = rotationP[i];
+							double y = rotationQ[i];
+							rotationP[i] = cosine * x - sine * y;
+							rotationQ[i] = sine * x + cosine * y;
+						}
+					}
+				}
+			}
+
+			if (isRotated == false)
+			{
+				break;
+			}
+		}
+
+		// The singular values are the norms of the orthogonal columns.
+		std::vector<double> norms(numColumns, 0.0);
+		std::vector<size_t> order(numColumns);
+
+		for (size_t j = 0; j < numColumns; j++)
+		{
+			const double* column = &columns[j * numColumns];
+
+			for (size_t i = 0; i < numColumns; i++)
+			{
+				norms[j] += column[i] * column[i];
+			}
+
+			norms[j] = std::sqrt(norms[j]);
+			order[j] = j;
+		}
+
+		std::stable_sort(order.begin(), order.end(), [&](size_t left, size_t right) { return norms[left] > norms[right]; });
+
+		for (size_t k = 0; k < numColumns; k++)
+		{
+			(*out_singularValues)[k] = norms[order[k]];
+		}
+
+		if (rightVectors != nullptr)
+		{
+			for (size_t k = 0; k < numColumns; k++)
+			{
+				const double* rotation = &rotations[order[k] * numColumns];
+
+				for (size_t i = 0; i < numColumns; i++)
+				{
+					rightVectors->getRowData(i)[k] = rotation[i];
+				}
+			}
+		}
+
+		if (leftVectors != nullptr)
+		{
+			// The left vectors of R are the normalized columns; those of the matrix are Q times them.
+			for (size_t k = 0; k < numColumns; k++)
+			{
+				const double* column = &columns[order[k] * numColumns];
+				double reciprocal = (norms[order[k]] > 0.0) ? 1.0 / norms[order[k]] : 0.0;
+
+				for (size_t i = 0; i < numColumns; i++)
+				{
+					leftVectors->getRowData(i)[k] = column[i] * reciprocal;
+				}
+			}
+
+			for (size_t d = numColumns; d < leftVectors->getNumColumns(); d++)
+			{
+				leftVectors->getRowData(d)[d] = 1.0; // Completes the full U with the rest of Q.
+			}
+
+			applyQ(*factors, tau, *leftVectors);
+		}
+
+		delete factors;
+	}
+}
+
+DenseMatrix* mck::getPseudoInverse(const MatrixBase& matrix, double tolerance)
+{
+	size_t numRows = matrix.getNumRows();
+	size_t numColumns = matrix.getNumColumns();
+
+	DenseMatrix* pseudoInverse = new DenseMatrix(numColumns, numRows, 0.0);
+
+	MatrixScratchScope scratchScope;
+	std::vector<double> singularValues;
+	DenseMatrix u(0, 0, 0.0, scratchScope.getAllocator());
+	DenseMatrix v(0, 0, 0.0, scratchScope.getAllocator());
+
+	computeSVD(matrix, true, &singularValues, &u, &v);
+
+	if (singularValues.empty())
+	{
+		return pseudoInverse;
+	}
+
+	double threshold = tolerance * std::max(1.0, singularValues[0]);
+	size_t rank = 0;
+
+	while (rank < singularValues.size() && singularValues[rank] > threshold)
+	{
+		rank++;
+	}
+
+	// scaledUTransposed = inverse(S) * transpose(U), for the non-zero singular values.
+	DenseMatrix::CellStorage scaledUTransposed(rank * numRows, 0.0, scratchScope.getAllocator());
+
+	for (size_t r = 0; r < numRows; r++)
+	{
+		const double* uRow = u.getRowData(r);
+
+		for (size_t k = 0; k < rank; k++)
+		{
+			scaledUTransposed[k * numRows + r] = uRow[k] / singularValues[k];
+		}
+	}
+
+	// pseudoInverse = V * scaledUTransposed
+	for (size_t r = 0; r < numColumns; r++)
+	{
+		const double* vRow = v.getRowData(r);
+		double* resultRow = pseudoInverse->getRowData(r);
+
+		for (size_t k = 0; k < rank; k++)
+		{
+			double coefficient = vRow[k];
+			const double* scaledRow = &scaledUTransposed[k * numRows];
+
+			for (size_t c = 0; c < numRows; c++)
+			{
+				resultRow[c] += coefficient * scaledRow[c];
+			}
+		}
+	}
+
+	return pseudoInverse;
+}
+
+double mck::getNorm2(const MatrixBase& matrix)
+{
+	std::vector<double> singularValues;
+	computeSVD(matrix, true, &singularValues, nullptr, nullptr);
+
+	return singularValues.empty() ? 0.0 : singularValues.front();
+}
+
+double mck::getConditionNumber(const MatrixBase& matrix)
+{
+	std::vector<double> singularValues;
+	computeSVD(matrix, true, &singularValues, nullptr, nullptr);
+
+	if (singularValues.empty() || singularValues.back() == 0.0)
+	{
+		return std::numeric_limits<double>::infinity();
+	}
+
+	return singularValues.front() / singularValues.back();
+}
+
+size_t mck::getNumericalRank(const MatrixBase& matrix, double tolerance)
+{
+	std::vector<double> singularValues;
+	computeSVD(matrix, true, &singularValues, nullptr, nullptr);
+
+	if (singularValues.empty())
+	{
+		return 0;
+	}
+
+	double threshold = tolerance * std::max(1.0, singularValues[0]);
+	size_t rank = 0;
+
+	while (rank < singularValues.size() && singularValues[rank] > threshold)
+	{
+		rank++;
+	}
+
+	return rank;
+}
+
+bool mck::isSymmetric(const MatrixBase& matrix, double tolerance)
+{
+	size_t numDimensions = matrix.getNumRows();
+
+	if (numDimensions != matrix.getNumColumns())
+	{
+		return false;
+	}
+
+	if (dynamic_cast<const SymmetricMatrix*>(&matrix) != nullptr)
+	{
+		return true;
+	}
+
+	double largestMagnitude = 0.0;
+
+	mcu::visitNonZeros(matrix, [&](size_t, size_t, double value)
+	{
+		largestMagnitude = std::max(largestMagnitude, std::abs(value));
+	});
+
+	double threshold = tolerance * std::max(1.0, largestMagnitude);
+	bool isSymmetric = true;
+
+	mcu::visitNonZeros(matrix, [&](size_t row, size_t column, double value)
+	{
+		if (isSymmetric && row != column && std::abs(value - matrix.getCell(column, row)) > threshold)
+		{
+			isSymmetric = false;
+		}
+	});
+
+	return isSymmetric;
+}
+
+void mck::tridiagonalize(DenseMatrix& matrix, std::vector<double>* out_diagonal, std::vector<double>* out_offDiagonal, std::vector<double>* out_tau)
+{
+	size_t numDimensions = matrix.getNumRows();
+	double* data = (numDimensions > 0) ? matrix.getRowData(0) : nullptr;
+	size_t rowStride = matrix.getNumColumns();
+
+	out_tau->assign((numDimensions > 2) ? numDimensions - 2 : 0, 0.0);
+
+	std::vector<double> p(numDimensions);
+
+	for (size_t k = 0; k + 2 < numDimensions; k++)
+	{
+		// The reflection of column k below the subdiagonal: the matrix is shifted by a row, so that the subdiagonal element is the "diagonal" one.
+		double tau = computeReflection(data + rowStride, rowStride, numDimensions - 1, k);
+		(*out_tau)[k] = tau;
+
+		if (tau == 0.0)
+		{
+			continue;
+		}
+
+		// The trailing block A becomes H * A * H, where H = I - tau * v * transpose(v): A -= v * transpose(w) + w * transpose(v).
+		// p = tau * A * v
+		double pDotV = 0.0;
+
+		for (size_t r = k + 1; r < numDimensions; r++)
+		{
+			const double* rowData = data + r * rowStride;
+			double sum = rowData[k + 1];
+
+			for (size_t c = k + 2; c < numDimensions; c++)
+			{
+				sum += rowData[c] * data[c * rowStride + k];
+			}
+
+			p[r] = tau * sum;
+			pDotV += p[r] * ((r == k + 1) ? 1.0 : data[r * rowStride + k]);
+		}
+
+		// w = p - (tau / 2) * (transpose(p) * v) * v, which is stored in p.
+		double alpha = -0.5 * tau * pDotV;
+
+		for (size_t r = k + 1; r < numDimensions; r++)
+		{
+			p[r] += alpha * ((r == k + 1) ? 1.0 : data[r * rowStride + k]);
+		}
+
+		for (size_t r = k + 1; r < numDimensions; r++)
+		{
+			double* rowData = data + r * rowStride;
+			double vR = (r == k + 1) ? 1.0 : data[r * rowStride + k];
+			double wR = p[r];
+
+			rowData[k + 1] -= vR * p[k + 1] + wR;
+
+			for (size_t c = k + 2; c < numDimensions; c++)
+			{
+				rowData[c] -= vR * p[c] + wR * data[c * rowStride + k];
+			}
+		}
+	}
+
+	out_diagonal->resize(numDimensions);
+	out_offDiagonal->assign(numDimensions, 0.0);
+
+	for (size_t d = 0; d < numDimensions; d++)
+	{
+		(*out_diagonal)[d] = data[d * rowStride + d];
+
+		if (d + 1 < numDimensions)
+		{
+			(*out_offDiagonal)[d] = data[(d + 1) * rowStride + d];
+		}
+	}
+}
+
+bool mck::computeSymmetricEigen(const MatrixBase& matrix, std::vector<double>* out_eigenvalues, DenseMatrix* out_eigenvectors)
+{
+	out_eigenvalues->clear();
+
+	if (!isSymmetric(matrix, mcu::EPSILON))
+	{
+		return false;
+	}
+
+	size_t numDimensions = matrix.getNumRows();
+
+	if (out_eigenvectors != nullptr)
+	{
+		resizeToZeroMatrix(out_eigenvectors, numDimensions, numDimensions);
+	}
+
+	if (numDimensions == 0)
+	{
+		return true;
+	}
+
+	MatrixScratchScope scratchScope;
+	DenseMatrix* factors = DenseMatrix::createCopy(matrix, scratchScope.getAllocator());
+	std::vector<double> diagonal;
+	std::vector<double> offDiagonal;
+	std::vector<double> tau;
+
+	tridiagonalize(*factors, &diagonal, &offDiagonal, &tau);
+
+	// The rows of transpose(Q * Z), where Z accumulates the rotations of the QR steps, so that a rotation updates two contiguous rows.
+	DenseMatrix* vectors = nullptr;
+
+	if (out_eigenvectors != nullptr)
+	{
+		vectors = new DenseMatrix(numDimensions, numDimensions, 0.0, scratchScope.getAllocator());
+		formSubdiagonalReflectorProduct(*factors, tau, vectors);
+		vectors->transpose();
+	}
+
+	delete factors;
+
+	// Implicit QL steps with the Wilkinson shift on the tridiagonal matrix: offDiagonal[i] couples the elements i and (i + 1).
+	bool hasConverged = true;
+
+	for (size_t l = 0; l < numDimensions && hasConverged; l++)
+	{
+		size_t numIterations = 0;
+		size_t m;
+
+		do
+		{
+			// Find the first negligible off-diagonal element; the block [l, m] is unreduced.
+			for (m = l; m + 1 < numDimensions; m++)
+			{
+				double magnitude = std::abs(diagonal[m]) + std::abs(diagonal[m + 1]);
+
+				if (std::abs(offDiagonal[m]) <= std::numeric_limits<double>::epsilon() * magnitude)
+				{
+					break;
+				}
+			}
+
+			if (m == l)
+			{
+				break; // diagonal[l] is an eigenvalue.
+			}
+
+			if (numIterations++ == SymmetricQRMaxIterations)
+			{
+				hasConverged = false;
+				break;
+			}
+
+			double g = (diagonal[l + 1] - diagonal[l]) / (2.0 * offDiagonal[l]);
+			double r = std::hypot(g, 1.0);
+			g = diagonal[m] - diagonal[l] + offDiagonal[l] / (g + std::copysign(r, g));
+
+			double sine = 1.0;
+			double cosine = 1.0;
+			double p = 0.0;
+			bool hasUnderflown = false;
+
+			// Chase the bulge from the bottom of the block to its top with Givens rotations.
+			for (size_t i = m; i-- > l;)
+			{
+				double f = sine * offDiagonal[i];
+				double b = cosine * offDiagonal[i];
+
+				r = std::hypot(f, g);
+				offDiagonal[i + 1] = r;
+
+				if (r == 0.0)
+				{
+					// The block split: recover, and try again.
+					diagonal[i + 1] -= p;
+					offDiagonal[m] = 0.0;
+					hasUnderflown = true;
+					break;
+				}
+
+				sine = f / r;
+				cosine = g / r;
+				g = diagonal[i + 1] - p;
+				r = (diagonal[i] - g) * sine + 2.0 * cosine * b;
+				p = sine * r;
+				diagonal[i + 1] = g + p;
+				g = cosine * r - b;
+
+				if (vectors != nullptr)
+				{
+					double* upperRow = vectors->getRowData(i);
+					double* lowerRow = vectors->getRowData(i + 1);
+
+					for (size_t c = 0; c < numDimensions; c++)
+					{
+						double lower = lowerRow[c];
+						lowerRow[c] = sine * upperRow[c] + cosine * lower;
+						upperRow[c] = cosine * upperRow[c] - sine * lower;
+					}
+				}
+			}
+
+			if (!hasUnderflown)
+			{
+				diagonal[l] -= p;
+				offDiagonal[l] = g;
+				offDiagonal[m] = 0.0;
+			}
+		} while (true);
+	}
+
+	if (!hasConverged)
+	{
+		delete vectors;
+
+		if (out_eigenvectors != nullptr)
+		{
+			out_eigenvectors->resize(0, 0);
+		}
+
+		return false;
+	}
+
+	// Ascending order; the eigenvectors become the columns.
+	std::vector<size_t> order(numDimensions);
+
+	for (size_t i = 0; i < numDimensions; i++)
+	{
+		order[i] = i;
+	}
+
+	std::stable_sort(order.begin(), order.end(), [&](size_t left, size_t right) { return diagonal[left] < diagonal[right]; });
+
+	out_eigenvalues->resize(numDimensions);
+
+	for (size_t k = 0; k < numDimensions; k++)
+	{
+		(*out_eigenvalues)[k] = diagonal[order[k]];
+	}
+
+	if (vectors != nullptr)
+	{
+		for (size_t k = 0; k < numDimensions; k++)
+		{
+			const double* vector = vectors->getRowData(order[k]);
+
+			for (size_t r = 0; r < numDimensions; r++)
+			{
+				out_eigenvectors->getRowData(r)[k] = vector[r];
+			}
+		}
+
+		delete vectors;
+	}
+
+	return true;
+}
+
+void mck::reduceToHessenberg(DenseMatrix& matrix, std::vector<double>* out_tau)
+{
+	size_t numDimensions = matrix.getNumRows();
+	double* data = (numDimensions > 0) ? matrix.getRowData(0) : nullptr;
+	size_t rowStride = matrix.getNumColumns();
+
+	out_tau->assign((numDimensions > 2) ? numDimensions - 2 : 0, 0.0);
+
+	std::vector<double> dotProducts;
+
+	for (size_t k = 0; k + 2 < numDimensions; k++)
+	{
+		// The reflection of column k below the subdiagonal: the matrix is shifted by a row, so that the subdiagonal element is the "diagonal" one.
+		double tau = computeReflection(data + rowStride, rowStride, numDimensions - 1, k);
+		(*out_tau)[k] = tau;
+
+		if (tau == 0.0)
+		{
+			continue;
+		}
+
+		// From the left, to the rows below row k.
+		applyReflection(data + rowStride, rowStride, numDimensions - 1, k, tau, k + 1, numDimensions, dotProducts);
+
+		// From the right, to every row: A -= tau * (A * v) * transpose(v).
+		for (size_t r = 0; r < numDimensions; r++)
+		{
+			double* rowData = data + r * rowStride;
+			double dotProduct = rowData[k + 1];
+
+			for (size_t c = k + 2; c < numDimensions; c++)
+			{
+				dotProduct += rowData[c] * data[c * rowStride + k];
+			}
+
+			dotProduct *= tau;
+			rowData[k + 1] -= dotProduct;
+
+			for (size_t c = k + 2; c < numDimensions; c++)
+			{
+				rowData[c] -= dotProduct * data[c * rowStride + k];
+			}
+		}
+	}
+}
+
+/**
+* Runs Francis double-shift QR steps on an upper Hessenberg matrix until all of its eigenvalues have deflated from the bottom (see mck::computeEigenvalues). The unreduced blocks of at least AggressiveEarlyDeflationMinDimensions dimensions also try aggressive early deflation (see deflateAggressively), and take the undeflated eigenvalues of its window as their next shifts.
+* @param h The upper Hessenberg matrix; its elements below the subdiagonal are discarded. With isFullUpdate, it becomes the quasi-triangular T of the real Schur form; otherwise only its unreduced blocks are updated, which is enough for the eigenvalues.
+* @param isFullUpdate True to update the whole matrix, false to only update the unreduced blocks.
+* @param schurVectors A pointer to the DenseMatrix (with the dimensions of h) to which the transformations are accumulated from the right. May be nullptr.
+* @param out_realParts A pointer to the vector to which the real parts of the eigenvalues are meant to be stored, in the order of the diagonal of T. This is an output variable, the user must declare the necessary variable before calling this method.
+* @param out_imaginaryParts A pointer to the vector to which the imaginary parts of the eigenvalues are meant to be stored. This is an output variable, the user must declare the necessary variable before calling this method.
+* @return True on success. False if the steps didn't converge.
+*/
+static bool runFrancisQR(DenseMatrix& h, bool isFullUpdate, DenseMatrix* schurVectors, std::vector<double>* out_realParts, std::vector<double>* out_imaginaryParts);
+
+/**
+* Swaps two adjacent diagonal blocks (1x1 or 2x2) of a real Schur form T with an orthogonal similarity transformation Q, which is accumulated into the Schur vectors.
+* Two 1x1 blocks are swapped with a Givens rotation. Otherwise (T11 * X - X * T22 == T12) is solved, and Q comes from the QR factorization of [-X; I], whose columns span the invariant subspace of T22.
+* @param t The quasi-triangular matrix T.
+* @param vectors The Schur vectors, whose columns are transformed together with T.
+* @param begin The index of the first row (and column) of the top block.
+* @param topSize The number of dimensions of the top block.
+* @param bottomSize The number of dimensions of the bottom block.
+* @return True on success. False if the eigenvalues of the blocks are too close to be swapped accurately, in which case T is left untouched.
+*/
+static bool swapSchurBlocks(DenseMatrix& t, DenseMatrix& vectors, size_t begin, size_t topSize, size_t bottomSize)
+{
+	size_t numDimensions = t.getNumRows();
+	double* data = t.getRowData(0);
+	auto cell = [data, numDimensions](size_t row, size_t column) -> double& { return data[row * numDimensions + column]; };
+
+	size_t blockSize = topSize + bottomSize;
+	double q[4][4] = {};
+
+	if (blockSize == 2)
+	{
+		// The rotation which turns (T12, T22 - T11) into (r, 0).
+		double f = cell(begin, begin + 1);
+		double g = cell(begin + 1, begin + 1) - cell(begin, begin);
+		double r = std::hypot(f, g);
+		double cosine = (r != 0.0) ? f / r : 1.0;
+		double sine = (r != 0.0) ? g / r : 0.0;
+
+		q[0][0] = cosine;
+		q[0][1] = -sine;
+		q[1][0] = sine;
+		q[1][1] = cosine;
+	}
+	else
+	{
+		// (T11 * X - X * T22 == T12) in its Kronecker form: at most 4 unknowns, solved by Gaussian elimination with partial pivoting.
+		size_t numUnknowns = topSize * bottomSize;
+		double system[4][5] = {};
+
+		for (size_t i = 0; i < topSize; i++)
+		{
+			for (size_t j = 0; j < bottomSize; j++)
+			{
+				double* equation = system[i * bottomSize + j];
+
+				for (size_t k = 0; k < topSize; k++)
+				{
+					equation[k * bottomSize + j] += cell(begin + i, begin + k);
+				}
+
+				for (size_t k = 0; k < bottomSize; k++)
+				{
+					equation[i * bottomSize + k] -= cell(begin + topSize + k, begin + topSize + j);
+				}
+
+				equation[numUnknowns] = cell(begin + i, begin + topSize + j);
+			}
+		}
+
+		for (size_t k = 0; k < numUnknowns; k++)
+		{
+			size_t pivot = k;
+
+			for (size_t i = k + 1; i < numUnknowns; i++)
+			{
+				if (std::abs(system[i][k]) > std::abs(system[pivot][k]))
+				{
+					pivot = i;
+				}
+			}
+
+			if (system[pivot][k] == 0.0)
+			{
+				return false; // The blocks share an eigenvalue.
+			}
+
+			std::swap(system[k], system[pivot]);
+
+			for (size_t i = k + 1; i < numUnknowns; i++)
+			{
+				double factor = system[i][k] / system[k][k];
+
+				for (size_t c = k; c <= numUnknowns; c++)
+				{
+					system[i][c] -= factor * system[k][c];
+				}
+			}
+		}
+
+		double x[4] = {};
+
+		for (size_t k = numUnknowns; k-- > 0;)
+		{
+			double sum = system[k][numUnknowns];
+
+			for (size_t c = k + 1; c < numUnknowns; c++)
+			{
+				sum -= system[k][c] * x[c];
+			}
+
+			x[k] = sum / system[k][k];
+		}
+
+		// Q is the product of the reflections of the QR factorization of [-X; I].
+		double basis[4][2] = {};
+		std::vector<double> dotProducts;
+
+		for (size_t i = 0; i < blockSize; i++)
+		{
+			for (size_t j = 0; j < bottomSize; j++)
+			{
+				basis[i][j] = (i < topSize) ? -x[i * bottomSize + j] : ((i - topSize == j) ? 1.0 : 0.0);
+			}
+
+			q[i][i] = 1.0;
+		}
+
+		for (size_t j = 0; j < bottomSize; j++)
+		{
+			double tau = computeReflection(basis[0], 2, blockSize, j);
+			applyReflection(basis[0], 2, blockSize, j, tau, j + 1, bottomSize, dotProducts);
+
+			for (size_t r = 0; r < blockSize; r++)
+			{
+				double dotProduct = q[r][j];
+
+				for (size_t i = j + 1; i < blockSize; i++)
+				{
+					dotProduct += q[r][i] * basis[i][j];
+				}
+
+				dotProduct *= tau;
+				q[r][j] -= dotProduct;
+
+				for (size_t i = j + 1; i < blockSize; i++)
+				{
+					q[r][i] -= dotProduct * basis[i][j];
+				}
+			}
+		}
+	}
+
+	// The swapped block transpose(Q) * D * Q.
+	double product[4][4] = {};
+	double swapped[4][4] = {};
+	double magnitude = 0.0;
+
+	for (size_t i = 0; i < blockSize; i++)
+	{
+		for (size_t j = 0; j < blockSize; j++)
+		{
+			magnitude = std::max(magnitude, std::abs(cell(begin + i, begin + j)));
+
+			for (size_t k = 0; k < blockSize; k++)
+			{
+				product[i][j] += cell(begin + i, begin + k) * q[k][j];
+			}
+		}
+	}
+
+	for (size_t i = 0; i < blockSize; i++)
+	{
+		for (size_t j = 0; j < blockSize; j++)
+		{
+			for (size_t k = 0; k < blockSize; k++)
+			{
+				swapped[i][j] += q[k][i] * product[k][j];
+			}
+		}
+	}
+
+	if (blockSize == 2)
+	{
+		// Exact for a rotation.
+		swapped[0][0] = cell(begin + 1, begin + 1);
+		swapped[1][1] = cell(begin, begin);
+	}
+	else
+	{
+		// The block below the new top block must vanish; otherwise the eigenvalues of the blocks are too close to be swapped accurately.
+		double threshold = std::max(10.0 * std::numeric_limits<double>::epsilon() * magnitude, std::numeric_limits<double>::min());
+
+		for (size_t i = bottomSize; i < blockSize; i++)
+		{
+			for (size_t j = 0; j < bottomSize; j++)
+			{
+				if (std::abs(swapped[i][j]) > threshold)
+				{
+					return false;
+				}
+			}
+		}
+	}
+
+	for (size_t i = bottomSize; i < blockSize; i++)
+	{
+		for (size_t j = 0; j < bottomSize; j++)
+		{
+			swapped[i][j] = 0.0;
+		}
+	}
+
+	// Q is applied from the left to the rows of the blocks, and from the right to the rows above them and to the Schur vectors.
+	double rowBuffer[4];
+
+	for (size_t c = begin + blockSize; c < numDimensions; c++)
+	{
+		for (size_t i = 0; i < blockSize; i++)
+		{
+			rowBuffer[i] = 0.0;
+
+			for (size_t k = 0; k < blockSize; k++)
+			{
+				rowBuffer[i] += q[k][i] * cell(begin + k, c);
+			}
+		}
+
+		for (size_t i = 0; i < blockSize; i++)
+		{
+			cell(begin + i, c) = rowBuffer[i];
+		}
+	}
+
+	auto transformRow = [&](double* rowData)
+		{
+			for (size_t j = 0; j < blockSize; j++)
+			{
+				rowBuffer[j] = 0.0;
+
+				for (size_t k = 0; k < blockSize; k++)
+				{
+					rowBuffer[j] += rowData[begin + k] * q[k][j];
+				}
+			}
+
+			std::copy(rowBuffer, rowBuffer + blockSize, rowData + begin);
+		};
+
+	for (size_t r = 0; r < begin; r++)
+	{
+		transformRow(data + r * numDimensions);
+	}
+
+	for (size_t r = 0; r < vectors.getNumRows(); r++)
+	{
+		transformRow(vectors.getRowData(r));
+	}
+
+	for (size_t i = 0; i < blockSize; i++)
+	{
+		std::copy(swapped[i], swapped[i] + blockSize, data + (begin + i) * numDimensions + begin);
+	}
+
+	return true;
+}
+
+/**
+* Moves a diagonal block of a real Schur form T up to a given position, by swapping it with the blocks above it one at a time (see swapSchurBlocks).
+* @param t The quasi-triangular matrix T.
+* @param vectors The Schur vectors, whose columns are transformed together with T.
+* @param begin The index of the first row (and column) of the block.
+* @param blockSize The number of dimensions of the block (1 or 2).
+* @param newBegin The index to which the block is moved. It must be the first index of a block.
+* @return True on success. False if a swap failed, in which case the block has only moved part of the way.
+*/
+static bool moveSchurBlock(DenseMatrix& t, DenseMatrix& vectors, size_t begin, size_t blockSize, size_t newBegin)
+{
+	while (begin > newBegin)
+	{
+		// The block above ends at (begin - 1), and it is a 2x2 block if its subdiagonal element is non-zero.
+		size_t aboveSize = (begin - 1 > newBegin && t.getRowData(begin - 1)[begin - 2] != 0.0) ? 2 : 1;
+
+		if (!swapSchurBlocks(t, vectors, begin - aboveSize, aboveSize, blockSize))
+		{
+			return false;
+		}
+
+		begin -= aboveSize;
+	}
+
+	return true;
+}
+
+/**
+* Aggressive early deflation on the trailing window [n + 1 - windowSize, n] of the unreduced block [l, n] of an upper Hessenberg matrix H: the window is reduced to its real Schur form (T == transpose(V) * window * V).
+* The subdiagonal element left of the window then becomes the "spike" s * transpose(the first row of V), and each eigenvalue of T whose spike elements are negligible has converged, even though the subdiagonal of H isn't.
+* The converged blocks are tested from the bottom of T; the others are moved to its top out of the way (see moveSchurBlock). The undeflated part is reduced back to the Hessenberg form, and V is applied to the rest of H and to the Schur vectors.
+* After the call, the deflated eigenvalues are separated by zero subdiagonal elements at the bottom of the block. The undeflated eigenvalues of T are good shifts for the next Francis steps, because they approximate the eigenvalues which are about to converge.
+* @param h The upper Hessenberg matrix, whose elements below the subdiagonal are zero.
+* @param l The index of the first row of the unreduced block.
+* @param n The index of the last row of the unreduced block.
+* @param windowSize The number of dimensions of the window. It must be smaller than the block.
+* @param isFullUpdate True to update the whole matrix, false to only update the unreduced block (see runFrancisQR).
+* @param schurVectors A pointer to the DenseMatrix to which the transformations are accumulated from the right. May be nullptr.
+* @param out_shifts A pointer to the vector to which the undeflated eigenvalues are meant to be stored, as the pairs of shifts of the next steps: complex conjugate pairs are adjacent, and the real shifts come in pairs too. This is an output variable, the user must declare the necessary variable before calling this method.
+* @return The number of deflated eigenvalues. Zero if none of them has converged, in which case H is left untouched.
+*/
+static size_t deflateAggressively(DenseMatrix& h, size_t l, size_t n, size_t windowSize, bool isFullUpdate, DenseMatrix* schurVectors, std::vector<std::complex<double>>* out_shifts)
+{
+	size_t numDimensions = h.getNumRows();
+	double* data = h.getRowData(0);
+	auto cell = [data, numDimensions](size_t row, size_t column) -> double& { return data[row * numDimensions + column]; };
+
+	size_t windowBegin = n + 1 - windowSize;
+	double spike = cell(windowBegin, windowBegin - 1); // The window is smaller than the block, so (windowBegin > l).
+
+	MatrixScratchScope scratchScope;
+	DenseMatrix window(windowSize, windowSize, 0.0, scratchScope.getAllocator());
+	DenseMatrix vectors(windowSize, windowSize, 0.0, scratchScope.getAllocator());
+
+	for (size_t r = 0; r < windowSize; r++)
+	{
+		double* rowData = window.getRowData(r);
+
+		for (size_t c = (r > 0) ? r - 1 : 0; c < windowSize; c++)
+		{
+			rowData[c] = cell(windowBegin + r, windowBegin + c);
+		}
+
+		vectors.getRowData(r)[r] = 1.0;
+	}
+
+	std::vector<double> realParts;
+	std::vector<double> imaginaryParts;
+	out_shifts->clear();
+
+	if (!runFrancisQR(window, true, &vectors, &realParts, &imaginaryParts))
+	{
+		return 0;
+	}
+
+	double* t = window.getRowData(0);
+	const double* firstRowOfV = vectors.getRowData(0);
+	auto tCell = [t, windowSize](size_t row, size_t column) -> double& { return t[row * windowSize + column]; };
+
+	for (size_t r = 2; r < windowSize; r++)
+	{
+		std::fill(t + r * windowSize, t + r * windowSize + r - 1, 0.0); // Left over by the steps, below the subdiagonal.
+	}
+
+	// The blocks [numUndeflated, windowSize) have deflated, and the blocks [0, numUndeflatable) have been moved out of the way.
+	const double epsilon = std::numeric_limits<double>::epsilon();
+	const double smallNumber = std::numeric_limits<double>::min() * (windowSize / epsilon);
+	size_t numUndeflated = windowSize;
+	size_t numUndeflatable = 0;
+
+	while (numUndeflated > numUndeflatable)
+	{
+		size_t last = numUndeflated - 1;
+		size_t blockSize = (last > numUndeflatable && tCell(last, last - 1) != 0.0) ? 2 : 1;
+		double magnitude = std::abs(tCell(last, last));
+		double spikeMagnitude = std::abs(spike * firstRowOfV[last]);
+
+		if (blockSize == 2)
+		{
+			magnitude += std::sqrt(std::abs(tCell(last, last - 1))) * std::sqrt(std::abs(tCell(last - 1, last)));
+			spikeMagnitude = std::max(spikeMagnitude, std::abs(spike * firstRowOfV[last - 1]));
+		}
+
+		if (magnitude == 0.0)
+		{
+			magnitude = std::abs(spike);
+		}
+
+		if (spikeMagnitude <= std::max(smallNumber, epsilon * magnitude))
+		{
+			numUndeflated -= blockSize;
+			continue;
+		}
+
+		if (!moveSchurBlock(window, vectors, numUndeflated - blockSize, blockSize, numUndeflatable))
+		{
+			break;
+		}
+
+		numUndeflatable += blockSize;
+	}
+
+	// The undeflated eigenvalues are the next shifts: the complex conjugate pairs first, then the real ones in pairs (an odd one out is dropped).
+	std::vector<double> realShifts;
+
+	for (size_t i = 0; i < numUndeflated; i++)
+	{
+		if (i + 1 < numUndeflated && tCell(i + 1, i) != 0.0)
+		{
+			double mean = (tCell(i, i) + tCell(i + 1, i + 1)) / 2.0;
+			double halfDifference = (tCell(i, i) - tCell(i + 1, i + 1)) / 2.0;
+			double discriminant = halfDifference * halfDifference + tCell(i, i + 1) * tCell(i + 1, i);
+
+			if (discriminant < 0.0)
+			{
+				out_shifts->push_back(std::complex<double>(mean, std::sqrt(-discriminant)));
+				out_shifts->push_back(std::complex<double>(mean, -std::sqrt(-discriminant)));
+			}
+			else
+			{
+				realShifts.push_back(mean + std::sqrt(discriminant));
+				realShifts.push_back(mean - std::sqrt(discriminant));
+			}
+
+			i++;
+		}
+		else
+		{
+			realShifts.push_back(tCell(i, i));
+		}
+	}
+
+	out_shifts->insert(out_shifts->end(), realShifts.begin() + (realShifts.size() % 2), realShifts.end());
+
+	if (numUndeflated == windowSize)
+	{
+		return 0;
+	}
+
+	if (numUndeflated > 0)
+	{
+		// The spike and the undeflated part T11 are reduced together, as the matrix [0, 0; spike, T11]: the first reflection turns the spike into a multiple of e1, and the others restore the Hessenberg form of T11.
+		// None of the reflections touches the first row and column, so U is the trailing block of their product.
+		size_t reducedSize = numUndeflated + 1;
+		DenseMatrix reduced(reducedSize, reducedSize, 0.0, scratchScope.getAllocator());
+		DenseMatrix product(reducedSize, reducedSize, 0.0, scratchScope.getAllocator());
+		std::vector<double> tau;
+
+		for (size_t r = 0; r < numUndeflated; r++)
+		{
+			double* rowData = reduced.getRowData(r + 1);
+			rowData[0] = firstRowOfV[r];
+			std::copy(t + r * windowSize, t + r * windowSize + numUndeflated, rowData + 1);
+		}
+
+		mck::reduceToHessenberg(reduced, &tau);
+		formSubdiagonalReflectorProduct(reduced, tau, &product);
+
+		for (size_t r = 0; r < numUndeflated; r++)
+		{
+			const double* rowData = reduced.getRowData(r + 1);
+
+			for (size_t c = 0; c < numUndeflated; c++)
+			{
+				tCell(r, c) = (c + 1 >= r) ? rowData[c + 1] : 0.0;
+			}
+		}
+
+		// T12 = transpose(U) * T12, and V = V * U.
+		std::vector<double> buffer(numUndeflated);
+
+		for (size_t c = numUndeflated; c < windowSize; c++)
+		{
+			for (size_t i = 0; i < numUndeflated; i++)
+			{
+				buffer[i] = 0.0;
+
+				for (size_t k = 0; k < numUndeflated; k++)
+				{
+					buffer[i] += product.getRowData(k + 1)[i + 1] * tCell(k, c);
+				}
+			}
+
+			for (size_t i = 0; i < numUndeflated; i++)
+			{
+				tCell(i, c) = buffer[i];
+			}
+		}
+
+		for (size_t r = 0; r < windowSize; r++)
+		{
+			double* rowData = vectors.getRowData(r);
+
+			for (size_t j = 0; j < numUndeflated; j++)
+			{
+				buffer[j] = 0.0;
+
+				for (size_t k = 0; k < numUndeflated; k++)
+				{
+					buffer[j] += rowData[k] * product.getRowData(k + 1)[j + 1];
+				}
+			}
+
+			std::copy(buffer.begin(), buffer.end(), rowData);
+		}
+	}
+
+	// The window becomes T, whose spike only has its first element left (if anything is undeflated).
+	cell(windowBegin, windowBegin - 1) = (numUndeflated > 0) ? spike * firstRowOfV[0] : 0.0;
+
+	for (size_t r = 0; r < windowSize; r++)
+	{
+		for (size_t c = (r > 0) ? r - 1 : 0; c < windowSize; c++)
+		{
+			cell(windowBegin + r, windowBegin + c) = tCell(r, c);
+		}
+	}
+
+	// V is applied from the left to the columns right of the window, and from the right to the rows above it and to the Schur vectors.
+	const double* v = vectors.getRowData(0);
+
+	if (isFullUpdate && n + 1 < numDimensions)
+	{
+		size_t numRightColumns = numDimensions - n - 1;
+		DenseMatrix::CellStorage rows(windowSize * numRightColumns, 0.0, scratchScope.getAllocator());
+
+		for (size_t k = 0; k < windowSize; k++)
+		{
+			const double* rowData = data + (windowBegin + k) * numDimensions + n + 1;
+
+			for (size_t i = 0; i < windowSize; i++)
+			{
+				double factor = v[k * windowSize + i];
+				double* transformedRow = rows.data() + i * numRightColumns;
+
+				for (size_t c = 0; c < numRightColumns; c++)
+				{
+					transformedRow[c] += factor * rowData[c];
+				}
+			}
+		}
+
+		for (size_t i = 0; i < windowSize; i++)
+		{
+			std::copy(rows.begin() + i * numRightColumns, rows.begin() + (i + 1) * numRightColumns, data + (windowBegin + i) * numDimensions + n + 1);
+		}
+	}
+
+	std::vector<double> buffer(windowSize);
+
+	auto transformRow = [&](double* rowData)
+		{
+			std::fill(buffer.begin(), buffer.end(), 0.0);
+
+			for (size_t k = 0; k < windowSize; k++)
+			{
+				double value = rowData[windowBegin + k];
+				const double* vRow = v + k * windowSize;
+
+				for (size_t j = 0; j < windowSize; j++)
+				{
+					buffer[j] += value * vRow[j];
+				}
+			}
+
+			std::copy(buffer.begin(), buffer.end(), rowData + windowBegin);
+		};
+
+	for (size_t r = (isFullUpdate ? 0 : l); r < windowBegin; r++)
+	{
+		transformRow(data + r * numDimensions);
+	}
+
+	if (schurVectors != nullptr)
+	{
+		for (size_t r = 0; r < numDimensions; r++)
+		{
+			transformRow(schurVectors->getRowData(r));
+		}
+	}
+
+	return windowSize - numUndeflated;
+}
+
+static bool runFrancisQR(DenseMatrix& h, bool isFullUpdate, DenseMatrix* schurVectors, std::vector<double>* out_realParts, std::vector<double>* out_imaginaryParts)
+{
+	size_t numDimensions = h.getNumRows();
+
+	double norm = 0.0;
+
+	for (size_t r = 0; r < numDimensions; r++)
+	{
+		double* rowData = h.getRowData(r);
+
+		for (size_t c = 0; c < numDimensions; c++)
+		{
+			if (c + 1 < r)
+			{
+				rowData[c] = 0.0; // Discard the Householder vectors.
+			}
+			else
+			{
+				norm += std::abs(rowData[c]);
+			}
+		}
+	}
+
+	// Francis double-shift QR steps on the active block [l, n], which shrinks from the bottom as eigenvalues converge.
+	// Without the Schur form, only the active block is updated (the eigenvalues don't depend on the rest).
+	const double epsilon = std::numeric_limits<double>::epsilon();
+	std::vector<double>& realParts = *out_realParts;
+	std::vector<double>& imaginaryParts = *out_imaginaryParts;
+	realParts.assign(numDimensions, 0.0);
+	imaginaryParts.assign(numDimensions, 0.0);
+	double exceptionalShift = 0.0;
+	size_t numIterations = 0;
+	size_t end = numDimensions; // One past n.
+	std::vector<std::complex<double>> shifts; // The pending shifts of aggressive early deflation, used in pairs from the back.
+	bool isNewShiftBatch = false;
+
+	double* data = (numDimensions > 0) ? h.getRowData(0) : nullptr;
+	auto cell = [data, numDimensions](size_t row, size_t column) -> double& { return data[row * numDimensions + column]; };
+
+	while (end > 0)
+	{
+		size_t n = end - 1;
+
+		// Look for a single negligible subdiagonal element.
+		size_t l = n;
+
+		while (l > 0)
+		{
+			double magnitude = std::abs(cell(l - 1, l - 1)) + std::abs(cell(l, l));
+
+			if (magnitude == 0.0)
+			{
+				magnitude = norm;
+			}
+
+			if (std::abs(cell(l, l - 1)) < epsilon * magnitude)
+			{
+				break;
+			}
+
+			l--;
+		}
+
+		if (l > 0)
+		{
+			cell(l, l - 1) = 0.0; // Negligible; the block [l, n] is decoupled from the rest.
+		}
+
+		if (l == n)
+		{
+			// One real eigenvalue.
+			cell(n, n) += exceptionalShift;
+			realParts[n] = cell(n, n);
+			end--;
+			numIterations = 0;
+			continue;
+		}
+
+		double w = cell(n, n - 1) * cell(n - 1, n);
+		double p = (cell(n - 1, n - 1) - cell(n, n)) / 2.0;
+		double q = p * p + w;
+		double x;
+		double y;
+		double z;
+		double r;
+
+		if (l == n - 1)
+		{
+			// Two eigenvalues: the 2x2 block is triangularized if they are real, and kept otherwise.
+			z = std::sqrt(std::abs(q));
+			cell(n, n) += exceptionalShift;
+			cell(n - 1, n - 1) += exceptionalShift;
+			x = cell(n, n);
+
+			if (q >= 0.0)
+			{
+				z = (p >= 0.0) ? p + z : p - z;
+				realParts[n - 1] = x + z;
+				realParts[n] = (z != 0.0) ? x - w / z : x + z;
+
+				x = cell(n, n - 1);
+				double scale = std::abs(x) + std::abs(z);
+				p = x / scale;
+				q = z / scale;
+				r = std::sqrt(p * p + q * q);
+				p /= r;
+				q /= r;
+
+				for (size_t j = n - 1; j < (isFullUpdate ? numDimensions : end); j++)
+				{
+					z = cell(n - 1, j);
+					cell(n - 1, j) = q * z + p * cell(n, j);
+					cell(n, j) = q * cell(n, j) - p * z;
+				}
+
+				for (size_t i = (isFullUpdate ? 0 : n - 1); i <= n; i++)
+				{
+					z = cell(i, n - 1);
+					cell(i, n - 1) = q * z + p * cell(i, n);
+					cell(i, n) = q * cell(i, n) - p * z;
+				}
+
+				cell(n, n - 1) = 0.0;
+
+				if (schurVectors != nullptr)
+				{
+					for (size_t i = 0; i < numDimensions; i++)
+					{
+						double* rowData = schurVectors->getRowData(i);
+						z = rowData[n - 1];
+						rowData[n - 1] = q * z + p * rowData[n];
+						rowData[n] = q * rowData[n] - p * z;
+					}
+				}
+			}
+			else
+			{
+				realParts[n - 1] = x + p;
+				realParts[n] = x + p;
+				imaginaryParts[n - 1] = z;
+				imaginaryParts[n] = -z;
+			}
+
+			end -= 2;
+			numIterations = 0;
+			continue;
+		}
+
+		// Aggressive early deflation: the eigenvalues which have converged in a trailing window are deflated before its subdiagonal becomes negligible.
+		// It is tried again once the shifts of the previous try are used up, or right away after a good yield.
+		if (shifts.size() < 2 && end - l >= AggressiveEarlyDeflationMinDimensions)
+		{
+			size_t windowSize = (end - l) / AggressiveEarlyDeflationWindowRatio;
+			size_t numDeflated = deflateAggressively(h, l, n, windowSize, isFullUpdate, schurVectors, &shifts);
+			isNewShiftBatch = true;
+
+			if (numDeflated > 0)
+			{
+				// The deflated eigenvalues are picked up from the subdiagonal by the next iterations.
+				if (numDeflated >= AggressiveEarlyDeflationMinYield * windowSize)
+				{
+					shifts.clear();
+				}
+
+				continue;
+			}
+		}
+
+		// The shifts are the eigenvalues of the trailing 2x2 block, or the next pair of the shifts of aggressive early deflation; a batch of those counts as a single step.
+		bool isNewStep = (shifts.size() < 2 || isNewShiftBatch);
+		isNewShiftBatch = false;
+
+		if (isNewStep && numIterations++ == FrancisQRMaxIterations)
+		{
+			return false;
+		}
+
+		// Exceptional shifts break the cycles which stall convergence.
+		bool isExceptionalStep = isNewStep && (numIterations == 11 || numIterations == 31);
+		x = cell(n, n);
+		y = cell(n - 1, n - 1);
+
+		if (isExceptionalStep)
+		{
+			shifts.clear();
+		}
+		else if (shifts.size() >= 2)
+		{
+			// A complex conjugate pair, or two real shifts: (x + y) is their sum, and (x * y - w) their product.
+			std::complex<double> shift = shifts.back();
+			y = shifts[shifts.size() - 2].real();
+			x = shift.real();
+			w = -shift.imag() * shift.imag();
+			shifts.resize(shifts.size() - 2);
+		}
+
+		if (isExceptionalStep && numIterations == 11)
+		{
+			exceptionalShift += x;
+
+			for (size_t i = 0; i <= n; i++)
+			{
+				cell(i, i) -= x;
+			}
+
+			double scale = std::abs(cell(n, n - 1)) + std::abs(cell(n - 1, n - 2));
+			x = 0.75 * scale;
+			y = x;
+			w = -0.4375 * scale * scale;
+		}
+
+		if (isExceptionalStep && numIterations == 31)
+		{
+			double scale = (y - x) / 2.0;
+			scale = scale * scale + w;
+
+			if (scale > 0.0)
+			{
+				scale = std::sqrt(scale);
+
+				if (y < x)
+				{
+					scale = -scale;
+				}
+
+				scale = x - w / ((y - x) / 2.0 + scale);
+
+				for (size_t i = 0; i <= n; i++)
+				{
+					cell(i, i) -= scale;
+				}
+
+				exceptionalShift += scale;
+				x = 0.964;
+				y = x;
+				w = x;
+			}
+		}
+
+		// Look for two consecutive small subdiagonal elements, where the step can start.
+		size_t m = n - 2;
+		double magnitude;
+
+		while (true)
+		{
+			z = cell(m, m);
+			r = x - z;
+			magnitude = y - z;
+			p = (r * magnitude - w) / cell(m + 1, m) + cell(m, m + 1);
+			q = cell(m + 1, m + 1) - z - r - magnitude;
+			r = cell(m + 2, m + 1);
+			magnitude = std::abs(p) + std::abs(q) + std::abs(r);
+			p /= magnitude;
+			q /= magnitude;
+			r /= magnitude;
+
+			if (m == l)
+			{
+				break;
+			}
+
+			if (std::abs(cell(m, m - 1)) * (std::abs(q) + std::abs(r)) < epsilon * (std::abs(p) * (std::abs(cell(m - 1, m - 1)) + std::abs(z) + std::abs(cell(m + 1, m + 1)))))
+			{
+				break;
+			}
+
+			m--;
+		}
+
+		for (size_t i = m + 2; i <= n; i++)
+		{
+			cell(i, i - 2) = 0.0;
+
+			if (i > m + 2)
+			{
+				cell(i, i - 3) = 0.0;
+			}
+		}
+
+		// The double step: 3x3 reflections chase the bulge down the block, rows [m, n].
+		for (size_t k = m; k < n; k++)
+		{
+			bool isNotLast = (k != n - 1);
+
+			if (k != m)
+			{
+				p = cell(k, k - 1);
+				q = cell(k + 1, k - 1);
+				r = isNotLast ? cell(k + 2, k - 1) : 0.0;
+				x = std::abs(p) + std::abs(q) + std::abs(r);
+
+				if (x == 0.0)
+				{
+					continue;
+				}
+
+				p /= x;
+				q /= x;
+				r /= x;
+			}
+
+			double s = std::sqrt(p * p + q * q + r * r);
+
+			if (p < 0.0)
+			{
+				s = -s;
+			}
+
+			if (s == 0.0)
+			{
+				continue;
+			}
+
+			if (k != m)
+			{
+				cell(k, k - 1) = -s * x;
+			}
+			else if (l != m)
+			{
+				cell(k, k - 1) = -cell(k, k - 1);
+			}
+
+			p += s;
+			x = p / s;
+			y = q / s;
+			z = r / s;
+			q /= p;
+			r /= p;
+
+			for (size_t j = k; j < (isFullUpdate ? numDimensions : end); j++)
+			{
+				p = cell(k, j) + q * cell(k + 1, j);
+
+				if (isNotLast)
+				{
+					p += r * cell(k + 2, j);
+					cell(k + 2, j) -= p * z;
+				}
+
+				cell(k, j) -= p * x;
+				cell(k + 1, j) -= p * y;
+			}
+
+			for (size_t i = (isFullUpdate ? 0 : l); i <= std::min(n, k + 3); i++)
+			{
+				p = x * cell(i, k) + y * cell(i, k + 1);
+
+				if (isNotLast)
+				{
+					p += z * cell(i, k + 2);
+					cell(i, k + 2) -= p * r;
+				}
+
+				cell(i, k) -= p;
+				cell(i, k + 1) -= p * q;
+			}
+
+			if (schurVectors != nullptr)
+			{
+				for (size_t i = 0; i < numDimensions; i++)
+				{
+					double* rowData = schurVectors->getRowData(i);
+					p = x * rowData[k] + y * rowData[k + 1];
+
+					if (isNotLast)
+					{
+						p += z * rowData[k + 2];
+						rowData[k + 2] -= p * r;
+					}
+
+					rowData[k] -= p;
+					rowData[k + 1] -= p * q;
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+bool mck::computeEigenvalues(const MatrixBase& matrix, std::vector<std::complex<double>>* out_eigenvalues, DenseMatrix* out_schurForm, DenseMatrix* out_schurVectors)
+{
+	out_eigenvalues->clear();
+
+	size_t numDimensions = matrix.getNumRows();
+
+	if (numDimensions != matrix.getNumColumns())
+	{
+		return false;
+	}
+
+	if (isSymmetric(matrix, mcu::EPSILON))
+	{
+		// A symmetric matrix has real eigenvalues, and its Schur form is diagonal.
+		std::vector<double> eigenvalues;
+
+		if (!computeSymmetricEigen(matrix, &eigenvalues, out_schurVectors))
+		{
+			return false;
+		}
+
+		if (out_schurForm != nullptr)
+		{
+			resizeToZeroMatrix(out_schurForm, numDimensions, numDimensions);
+		}
+
+		for (size_t d = 0; d < numDimensions; d++)
+		{
+			out_eigenvalues->push_back(std::complex<double>(eigenvalues[d], 0.0));
+
+			if (out_schurForm != nullptr)
+			{
+				out_schurForm->getRowData(d)[d] = eigenvalues[d];
+			}
+		}
+
+		return true;
+	}
+
+	if (out_schurForm != nullptr)
+	{
+		resizeToZeroMatrix(out_schurForm, numDimensions, numDimensions);
+	}
+
+	if (out_schurVectors != nullptr)
+	{
+		resizeToZeroMatrix(out_schurVectors, numDimensions, numDimensions);
+	}
+
+	MatrixScratchScope scratchScope;
+	DenseMatrix* h = DenseMatrix::createCopy(matrix, scratchScope.getAllocator());
+	std::vector<double> tau;
+
+	reduceToHessenberg(*h, &tau);
+
+	if (out_schurVectors != nullptr)
+	{
+		formSubdiagonalReflectorProduct(*h, tau, out_schurVectors);
+	}
+
+	std::vector<double> realParts;
+	std::vector<double> imaginaryParts;
+	bool hasConverged = runFrancisQR(*h, out_schurForm != nullptr, out_schurVectors, &realParts, &imaginaryParts);
+
+	if (!hasConverged)
+	{
+		delete h;
+
+		if (out_schurForm != nullptr)
+		{
+			out_schurForm->resize(0, 0);
+		}
+
+		if (out_schurVectors != nullptr)
+		{
+			out_schurVectors->resize(0, 0);
+		}
+
+		return false;
+	}
+
+	for (size_t d = 0; d < numDimensions; d++)
+	{
+		out_eigenvalues->push_back(std::complex<double>(realParts[d], imaginaryParts[d]));
+	}
+
+	if (out_schurForm != nullptr)
+	{
+		for (size_t r = 0; r < numDimensions; r++)
+		{
+			const double* rowData = h->getRowData(r);
+			std::copy(rowData + ((r > 0) ? r - 1 : 0), rowData + numDimensions, out_schurForm->getRowData(r) + ((r > 0) ? r - 1 : 0));
+		}
+	}
+
+	delete h;
+
+	return true;
+}
+
+bool mck::solveTriangularInPlace(const DenseMatrix& triangle, DenseMatrix& rightHandSides, bool isLower, bool isTransposed, bool hasUnitDiagonal)
+{
+	size_t numDimensions = triangle.getNumColumns();
+	size_t numRightHandSides = rightHandSides.getNumColumns();
+
+	if (triangle.getNumRows() < numDimensions || rightHandSides.getNumRows() != numDimensions)
+	{
+		return false;
+	}
+
+	if (numDimensions == 0 || numRightHandSides == 0)
+	{
+		return true;
+	}
+
+	const double* triangleData = triangle.getRowData(0);
+	size_t triangleStride = numDimensions;
+
+	if (hasUnitDiagonal == false)
+	{
+		for (size_t d = 0; d < numDimensions; d++)
+		{
+			if (triangleData[d * triangleStride + d] == 0.0)
+			{
+				return false;
+			}
+		}
+	}
+
+	solveTriangularBlocks(triangleData, triangleStride, numDimensions, rightHandSides.getRowData(0), numRightHandSides, isLower, isTransposed, hasUnitDiagonal);
+
+	return true;
+}
+
+DenseMatrix* mck::solveTriangular(const MatrixBase& triangle, const MatrixBase& rightHandSide, bool isLower, bool isTransposed, bool hasUnitDiagonal)
+{
+	size_t numDimensions = triangle.getNumRows();
+
+	if (numDimensions != triangle.getNumColumns() || numDimensions != rightHandSide.getNumRows())
+	{
+		return nullptr;
+	}
+
+	DenseMatrix* solution = rightHandSide.cloneAsDenseMatrix();
+	bool isSolved = false;
+
+	{
+		MatrixScratchScope scratchScope;
+		const DenseMatrix* denseTriangle = dynamic_cast<const DenseMatrix*>(&triangle);
+
+		if (denseTriangle != nullptr)
+		{
+			isSolved = solveTriangularInPlace(*denseTriangle, *solution, isLower, isTransposed, hasUnitDiagonal);
+		}
+		else
+		{
+			DenseMatrix* triangleCopy = DenseMatrix::createCopy(triangle, scratchScope.getAllocator());
+			isSolved = solveTriangularInPlace(*triangleCopy, *solution, isLower, isTransposed, hasUnitDiagonal);
+			delete triangleCopy;
+		}
+	}
+
+	if (isSolved == false)
+	{
+		delete solution;
+		return nullptr;
+	}
+
+	return solution;
+}
+
+bool mck::factorizeCholesky(DenseMatrix& matrix)
+{
+	size_t numDimensions = matrix.getNumRows();
+
+	if (numDimensions == 0)
+	{
+		return true;
+	}
+
+	double* data = matrix.getRowData(0);
+	size_t rowStride = matrix.getNumColumns();
+
+	for (size_t panelBegin = 0; panelBegin < numDimensions; panelBegin += CholeskyBlockSize)
+	{
+		size_t panelEnd = std::min(numDimensions, panelBegin + CholeskyBlockSize);
+
+		if (!factorizeCholeskyPanel(data, rowStride, numDimensions, panelBegin, panelEnd))
+		{
+			return false;
+		}
+
+		subtractSymmetricRankUpdate(data, rowStride, numDimensions, panelBegin, panelEnd);
+	}
+
+	return true;
+}
+
+DenseMatrix* mck::solveCholesky(const MatrixBase& matrix, const MatrixBase& rightHandSide)
+{
+	if (matrix.getNumRows() != rightHandSide.getNumRows())
+	{
+		return nullptr;
+	}
+
+	DenseMatrix* solution = rightHandSide.cloneAsDenseMatrix();
+
+	MatrixScratchScope scratchScope;
+	DenseMatrix* factor = getCholeskyFactor(matrix, scratchScope.getAllocator());
+
+	if (factor == nullptr)
+	{
+		delete solution;
+		return nullptr;
+	}
+
+	// L * Y = B, then transpose(L) * X = Y. The diagonal of L is positive, so neither solve can fail.
+	solveTriangularInPlace(*factor, *solution, true, false, false);
+	solveTriangularInPlace(*factor, *solution, true, true, false);
+
+	delete factor;
+
+	return solution;
+}
+
+bool mck::getCholeskyDeterminant(const MatrixBase& matrix, double* out_determinant)
+{
+	MatrixScratchScope scratchScope;
+	DenseMatrix* factor = getCholeskyFactor(matrix, scratchScope.getAllocator());
+
+	if (factor == nullptr)
+	{
+		return false;
+	}
+
+	// det(A) = det(L) * det(transpose(L)) = (product of the diagonal of L)^2
+	double diagonalProduct = 1.0;
+
+	for (size_t d = 0; d < factor->getNumRows(); d++)
+	{
+		diagonalProduct *= factor->getRowData(d)[d];
+	}
+
+	*out_determinant = diagonalProduct * diagonalProduct;
+
+	delete factor;
+
+	return true;
+}
+
+bool mck::factorizeLU(DenseMatrix& matrix, std::vector<size_t>* out_rowPivots)
+{
+	size_t numDimensions = matrix.getNumRows();
+
+	if (numDimensions > LUBlockSize && numDimensions <= LURecursiveMaxDimensions)
+	{
+		return factorizeLURecursive(matrix, out_rowPivots);
+	}
+
+	return factorizeLUBlocked(matrix, out_rowPivots);
+}
+
+bool mck::factorizeLUBlocked(DenseMatrix& matrix, std::vector<size_t>* out_rowPivots)
+{
+	size_t numDimensions = matrix.getNumRows();
+
+	out_rowPivots->resize(numDimensions);
+
+	if (numDimensions == 0)
+	{
+		return true;
+	}
+
+	double* data = matrix.getRowData(0);
+	size_t rowStride = matrix.getNumColumns();
+	size_t* rowPivots = out_rowPivots->data();
+	bool isNonSingular = factorizeLUPanel(data, rowStride, numDimensions, 0, std::min(numDimensions, LUBlockSize), rowPivots);
+
+	for (size_t panelBegin = 0; panelBegin < numDimensions; panelBegin += LUBlockSize)
+	{
+		size_t panelEnd = std::min(numDimensions, panelBegin + LUBlockSize);
+
+		// The swaps of the (already factorized) panel, applied to the rest of the columns in a batch.
+		applyRowSwaps(data, rowStride, rowPivots, panelBegin, panelEnd, 0, panelBegin);
+		applyRowSwaps(data, rowStride, rowPivots, panelBegin, panelEnd, panelEnd, numDimensions);
+
+		if (panelEnd == numDimensions)
+		{
+			break;
+		}
+
+		solveUnitLowerPanel(data, rowStride, panelBegin, panelEnd, panelEnd, numDimensions);
+
+		// Look-ahead: the columns of the next panel are updated first, so that the next panel is factorized while the worker threads update the rest of the trailing matrix.
+		size_t nextPanelEnd = std::min(numDimensions, panelEnd + LUBlockSize);
+		std::vector<std::thread> workers;
+
+		subtractPanelProduct(data, rowStride, panelBegin, panelEnd, panelEnd, numDimensions, panelEnd, nextPanelEnd);
+		startPanelProduct(data, rowStride, panelBegin, panelEnd, panelEnd, numDimensions, nextPanelEnd, numDimensions, &workers);
+
+		isNonSingular = factorizeLUPanel(data, rowStride, numDimensions, panelEnd, nextPanelEnd, rowPivots) && isNonSingular;
+
+		for (size_t w = 0; w < workers.size(); w++)
+		{
+			workers[w].join();
+		}
+	}
+
+	return isNonSingular;
+}
+
+bool mck::factorizeLURecursive(DenseMatrix& matrix, std::vector<size_t>* out_rowPivots)
+{
+	size_t numDimensions = matrix.getNumRows();
+
+	out_rowPivots->resize(numDimensions);
+
+	if (numDimensions == 0)
+	{
+		return true;
+	}
+
+	return factorizeLURecursivePanel(matrix.getRowData(0), matrix.getNumColumns(), numDimensions, 0, numDimensions, out_rowPivots->data());
+}
+
+DenseMatrix* mck::solveLU(const MatrixBase& matrix, const MatrixBase& rightHandSide)
+{
+	if (matrix.getNumRows() != rightHandSide.getNumRows())
+	{
+		return nullptr;
+	}
+
+	DenseMatrix* solution = rightHandSide.cloneAsDenseMatrix();
+
+	MatrixScratchScope scratchScope;
+	std::vector<size_t> rowPivots;
+	DenseMatrix* factors = getNonSingularLUFactors(matrix, scratchScope.getAllocator(), &rowPivots);
+
+	if (factors == nullptr)
+	{
+		delete solution;
+		return nullptr;
+	}
+
+	solveWithLUFactors(*factors, rowPivots, *solution);
+
+	delete factors;
+
+	return solution;
+}
+
+DenseMatrix* mck::solveMixedPrecision(const MatrixBase& matrix, const MatrixBase& rightHandSide, size_t* out_numRefinementSteps, double* out_backwardError, bool* out_isDoublePrecision)
+{
+	size_t numDimensions = matrix.getNumRows();
+	size_t numRightHandSides = rightHandSide.getNumColumns();
+
+	if (numDimensions == 0 || numDimensions != matrix.getNumColumns() || numDimensions != rightHandSide.getNumRows() || numRightHandSides == 0)
+	{
+		return nullptr;
+	}
+
+	DenseMatrix* solution = new DenseMatrix(numDimensions, numRightHandSides, 0.0);
+	size_t numRefinementSteps = 0;
+	double backwardError = std::numeric_limits<double>::infinity();
+	bool isDoublePrecision = false;
+	bool isSolved = false;
+
+	{
+		MatrixScratchScope scratchScope;
+		DenseMatrix* coefficients = DenseMatrix::createCopy(matrix, scratchScope.getAllocator());
+		DenseMatrix* rightHandSides = DenseMatrix::createCopy(rightHandSide, scratchScope.getAllocator());
+		DenseMatrix* residual = new DenseMatrix(numDimensions, numRightHandSides, 0.0, scratchScope.getAllocator());
+		std::vector<float> factors(numDimensions * numDimensions);
+		std::vector<float> correction(numDimensions * numRightHandSides);
+		std::vector<size_t> rowPivots(numDimensions);
+		const double* coefficientData = coefficients->getRowData(0);
+		double matrixNorm = 0.0;
+		bool isSinglePrecision = true; // False if an element doesn't fit in a float.
+
+		for (size_t i = 0; i < numDimensions; i++)
+		{
+			double rowSum = 0.0;
+
+			for (size_t k = 0; k < numDimensions; k++)
+			{
+				double magnitude = std::abs(coefficientData[i * numDimensions + k]);
+				rowSum += magnitude;
+				isSinglePrecision = isSinglePrecision && magnitude <= std::numeric_limits<float>::max();
+				factors[i * numDimensions + k] = (float)coefficientData[i * numDimensions + k];
+			}
+
+			matrixNorm = std::max(matrixNorm, rowSum);
+		}
+
+		if (isSinglePrecision)
+		{
+			// The single precision factors are checked like getNonSingularLUFactors does, against the machine epsilon of float; refinement takes care of milder ill-conditioning.
+			isSinglePrecision = factorizeLURecursivePanel(factors.data(), numDimensions, numDimensions, 0, numDimensions, rowPivots.data());
+			float largestPivot = 0.0f;
+			float smallestPivot = std::numeric_limits<float>::infinity();
+
+			for (size_t d = 0; d < numDimensions && isSinglePrecision; d++)
+			{
+				float magnitude = std::abs(factors[d * numDimensions + d]);
+				largestPivot = std::max(largestPivot, magnitude);
+				smallestPivot = std::min(smallestPivot, magnitude);
+			}
+
+			isSinglePrecision = isSinglePrecision && smallestPivot > std::numeric_limits<float>::epsilon() * largestPivot;
+		}
+
+		if (isSinglePrecision)
+		{
+			// The solution starts from zero, so the first correction is the single precision solution itself.
+			double convergedBackwardError = std::sqrt((double)numDimensions) * std::numeric_limits<double>::epsilon();
+
+			addSinglePrecisionCorrection(factors, rowPivots, *rightHandSides, correction, *solution);
+			backwardError = computeBackwardError(*coefficients, matrixNorm, *rightHandSides, *solution, residual);
+
+			while (backwardError > convergedBackwardError && numRefinementSteps < MixedPrecisionMaxRefinementSteps)
+			{
+				addSinglePrecisionCorrection(factors, rowPivots, *residual, correction, *solution);
+				numRefinementSteps++;
+
+				double previousBackwardError = backwardError;
+				backwardError = computeBackwardError(*coefficients, matrixNorm, *rightHandSides, *solution, residual);
+
+				if (!(backwardError <= MixedPrecisionMinImprovement * previousBackwardError))
+				{
+					break; // Stagnated, or diverged.
+				}
+			}
+
+			isSolved = (backwardError <= convergedBackwardError);
+		}
+
+		if (isSolved == false)
+		{
+			// Refinement didn't converge (or the matrix doesn't fit in single precision): double precision LU.
+			isDoublePrecision = true;
+			DenseMatrix* doubleFactors = getNonSingularLUFactors(*coefficients, scratchScope.getAllocator(), &rowPivots);
+
+			if (doubleFactors != nullptr)
+			{
+				std::copy(rightHandSides->getRowData(0), rightHandSides->getRowData(0) + numDimensions * numRightHandSides, solution->getRowData(0));
+				solveWithLUFactors(*doubleFactors, rowPivots, *solution);
+				backwardError = computeBackwardError(*coefficients, matrixNorm, *rightHandSides, *solution, residual);
+				isSolved = true;
+				delete doubleFactors;
+			}
+		}
+
+		delete coefficients;
+		delete rightHandSides;
+		delete residual;
+	}
+
+	if (isSolved == false)
+	{
+		delete solution;
+		return nullptr;
+	}
+
+	if (out_numRefinementSteps != nullptr)
+	{
+		*out_numRefinementSteps = numRefinementSteps;
+	}
+
+	if (out_backwardError != nullptr)
+	{
+		*out_backwardError = backwardError;
+	}
+
+	if (out_isDoublePrecision != nullptr)
+	{
+		*out_isDoublePrecision = isDoublePrecision;
+	}
+
+	return solution;
+}
+
+double mck::getLUDeterminant(const MatrixBase& matrix)
+{
+	size_t numDimensions = matrix.getNumRows();
+
+	if (numDimensions != matrix.getNumColumns())
+	{
+		return std::numeric_limits<double>::quiet_NaN();
+	}
+
+	MatrixScratchScope scratchScope;
+	DenseMatrix* factors = DenseMatrix::createCopy(matrix, scratchScope.getAllocator());
+	std::vector<size_t> rowPivots;
+
+	factorizeLU(*factors, &rowPivots);
+
+	// det(A) = det(transpose(P)) * det(L) * det(U), where det(L) is one and each swap negates det(transpose(P)).
+	double determinant = 1.0;
+
+	for (size_t d = 0; d < numDimensions; d++)
+	{
+		determinant *= factors->getRowData(d)[d];
+
+		if (rowPivots[d] != d)
+		{
+			determinant = -determinant;
+		}
+	}
+
+	delete factors;
+
+	return determinant;
+}
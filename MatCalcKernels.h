@@ -0,0 +1,225 @@
+#ifndef MAT_CALC_KERNELS_H
+#define MAT_CALC_KERNELS_H
+
+#include "DenseMatrix.h"
+#include <complex>
+#include <vector>
+
+/**
+* Matrix Calculator Kernels: the dense factorizations (and the solvers built on them) which work directly on the storage of a DenseMatrix.
+* The factorizations are performed in place, in the compact form LAPACK uses; the results which are not matrices are returned through the "out_" arguments.
+* Every kernel accepts any MatrixBase where it makes sense, and works on a DenseMatrix copy of it.
+*/
+namespace mck
+{
+	/**
+	* Factorizes a matrix in place into (Q * R) with Householder reflections, block by block (blocked Householder QR).
+	* After the call, the upper triangle of the matrix holds R. Below the diagonal, column j holds the Householder vector of the j-th reflection, whose first element (1) is implicit.
+	* The reflections of a block are applied to the rest of the matrix at once, in the compact WY representation (I - V * T * transpose(V)), so the trailing update is a matrix-matrix product.
+	* @param matrix The matrix to be factorized. It may have any dimensions.
+	* @param out_tau A pointer to the vector to which the scalar factors of the reflections (H_j = I - tau_j * v_j * transpose(v_j)) are meant to be stored. This is an output variable, the user must declare the necessary variable before calling this method.
+	*/
+	void factorizeQR(DenseMatrix& matrix, std::vector<double>* out_tau);
+	/**
+	* Replaces the target by (transpose(Q) * target), where Q is given by a factorization of factorizeQR. The reflections are applied block by block, just like in the factorization.
+	* @param factors The factorized matrix, as factorizeQR leaves it.
+	* @param tau The scalar factors of the reflections, as factorizeQR returns them.
+	* @param target The matrix to be multiplied. Its number of rows must match the number of rows of factors.
+	*/
+	void applyQTransposed(const DenseMatrix& factors, const std::vector<double>& tau, DenseMatrix& target);
+	/**
+	* Replaces the target by (Q * target), where Q is given by a factorization of factorizeQR. The reflections are applied block by block, in reverse order.
+	* @param factors The factorized matrix, as factorizeQR leaves it.
+	* @param tau The scalar factors of the reflections, as factorizeQR returns them.
+	* @param target The matrix to be multiplied. Its number of rows must match the number of rows of factors.
+	*/
+	void applyQ(const DenseMatrix& factors, const std::vector<double>& tau, DenseMatrix& target);
+	/**
+	* Finds the X which minimizes the 2-norm of (matrix * X - rightHandSide) for each column, using Householder QR. The system may be overdetermined (more rows than columns).
+	* @param matrix The matrix of coefficients. It must have at least as many rows as columns, and full column rank.
+	* @param rightHandSide The right hand side(s), one per column. Its number of rows must match the number of rows of matrix.
+	* @param out_residualNorm A pointer to the double to which the 2-norm (the Frobenius norm, for multiple right hand sides) of the residual (matrix * X - rightHandSide) is meant to be stored. May be nullptr.
+	* @return A raw pointer to a new DenseMatrix instance which holds X. nullptr if the dimensions don't match, or if the matrix is rank deficient.
+	*/
+	DenseMatrix* solveLeastSquares(const MatrixBase& matrix, const MatrixBase& rightHandSide, double* out_residualNorm);
+	/**
+	* Factorizes a matrix in place into (Q * R * transpose(P)) with Householder reflections and column pivoting (rank-revealing QR). At each step, the remaining column with the largest norm is moved to the front, so the magnitudes of the diagonal elements of R are non-increasing.
+	* The column norms are downdated after each reflection instead of being recomputed, so the cost is close to that of factorizeQR. The result has the same compact form as factorizeQR, for the permuted matrix.
+	* @param matrix The matrix to be factorized. It may have any dimensions.
+	* @param out_tau A pointer to the vector to which the scalar factors of the reflections are meant to be stored. This is an output variable, the user must declare the necessary variable before calling this method.
+	* @param out_columnPivots A pointer to the vector to which the permutation is meant to be stored: column j of the factorized matrix is column (*out_columnPivots)[j] of the original one. This is an output variable, the user must declare the necessary variable before calling this method.
+	*/
+	void factorizeQRColumnPivoting(DenseMatrix& matrix, std::vector<double>* out_tau, std::vector<size_t>* out_columnPivots);
+	/**
+	* Calculates the numerical rank of a matrix with rank-revealing QR (see factorizeQRColumnPivoting): the number of diagonal elements of R which are greater than (tolerance * max(1, |R(0, 0)|)) in magnitude.
+	* The tolerance is relative to the largest column norm, so scaling the matrix doesn't change its rank. If the largest column norm is below 1, the tolerance is absolute instead, so (nearly) zero matrices have rank zero.
+	* @param matrix The matrix whose rank is calculated.
+	* @param tolerance The relative tolerance under which a diagonal element of R is considered to be zero. mcu::EPSILON is a good default.
+	* @param out_independentColumns A pointer to the vector to which the indices of "rank" linearly independent columns are meant to be stored, in the order in which they were pivoted. May be nullptr.
+	* @return The numerical rank of the matrix.
+	*/
+	size_t getRank(const MatrixBase& matrix, double tolerance, std::vector<size_t>* out_independentColumns);
+	/**
+	* Computes the singular value decomposition (matrix == U * S * transpose(V)) with one-sided Jacobi rotations. The matrix is first reduced to its triangular factor R with factorizeQR, and the rotations orthogonalize the columns of R, so a tall matrix costs little more than its QR factorization.
+	* A wide matrix is decomposed through its transpose. The singular values are in descending order; the columns of U which belong to zero singular values are zero.
+	* @param matrix The matrix to be decomposed. It may have any dimensions.
+	* @param isThin True for the thin (economy) decomposition: U has min(numRows, numColumns) columns and V has min(numRows, numColumns) columns. False for the full one: U is (numRows x numRows) and V is (numColumns x numColumns).
+	* @param out_singularValues A pointer to the vector to which the min(numRows, numColumns) singular values are meant to be stored. This is an output variable, the user must declare the necessary variable before calling this method.
+	* @param out_u A pointer to the DenseMatrix to which U is meant to be stored; it is resized as needed. May be nullptr.
+	* @param out_v A pointer to the DenseMatrix to which V is meant to be stored; it is resized as needed. May be nullptr, in which case the rotations are not accumulated at all (e.g. for the singular values only).
+	*/
+	void computeSVD(const MatrixBase& matrix, bool isThin, std::vector<double>* out_singularValues, DenseMatrix* out_u, DenseMatrix* out_v);
+	/**
+	* Calculates the Moore-Penrose pseudo-inverse (V * inverse(S) * transpose(U)) from the thin SVD. The singular values which are not greater than (tolerance * max(1, largestSingularValue)) are treated as zeros, so singular and rectangular matrices have a pseudo-inverse too.
+	* @param matrix The matrix to be pseudo-inverted.
+	* @param tolerance The relative tolerance under which a singular value is considered to be zero. mcu::EPSILON is a good default.
+	* @return A raw pointer to a new (numColumns x numRows) DenseMatrix instance.
+	*/
+	DenseMatrix* getPseudoInverse(const MatrixBase& matrix, double tolerance);
+	/**
+	* Returns the 2-norm (spectral norm) of a matrix: its largest singular value. Zero for an empty matrix.
+	*/
+	double getNorm2(const MatrixBase& matrix);
+	/**
+	* Returns the 2-norm condition number of a matrix: the ratio of its largest singular value to its smallest one. Infinity if the smallest singular value is zero.
+	*/
+	double getConditionNumber(const MatrixBase& matrix);
+	/**
+	* Calculates the numerical rank of a matrix from its singular values: the number of singular values which are greater than (tolerance * max(1, largestSingularValue)). The most reliable, but the most expensive, way to find the rank.
+	* @param matrix The matrix whose rank is calculated.
+	* @param tolerance The relative tolerance under which a singular value is considered to be zero. mcu::EPSILON is a good default.
+	* @return The numerical rank of the matrix.
+	*/
+	size_t getNumericalRank(const MatrixBase& matrix, double tolerance);
+	/**
+	* Checks whether a matrix is symmetric: square, and equal to its transpose up to (tolerance * max(1, largestMagnitude)). A SymmetricMatrix is symmetric by its type, and isn't checked element by element.
+	* @param matrix The matrix to be checked.
+	* @param tolerance The relative tolerance under which two mirrored elements are considered to be equal. mcu::EPSILON is a good default.
+	* @return True if the matrix is symmetric, false if not.
+	*/
+	bool isSymmetric(const MatrixBase& matrix, double tolerance);
+	/**
+	* Reduces a symmetric matrix in place to the tridiagonal matrix (transpose(Q) * matrix * Q) with Householder reflections from both sides. Only the lower triangle is used.
+	* After the call, column k holds the Householder vector of the k-th reflection below the subdiagonal, whose first element (1, on the subdiagonal) is implicit. Q is (H_0 * H_1 * ... * H_(n-3)); the upper triangle is unspecified.
+	* @param matrix The symmetric matrix to be reduced.
+	* @param out_diagonal A pointer to the vector to which the diagonal of the tridiagonal matrix is meant to be stored. This is an output variable, the user must declare the necessary variable before calling this method.
+	* @param out_offDiagonal A pointer to the vector to which the subdiagonal (which is equal to the superdiagonal) is meant to be stored: element i couples the rows i and (i + 1). It has numDimensions elements; the last one is zero.
+	* @param out_tau A pointer to the vector to which the scalar factors of the (numDimensions - 2) reflections are meant to be stored. This is an output variable, the user must declare the necessary variable before calling this method.
+	*/
+	void tridiagonalize(DenseMatrix& matrix, std::vector<double>* out_diagonal, std::vector<double>* out_offDiagonal, std::vector<double>* out_tau);
+	/**
+	* Computes the eigenvalues of a symmetric matrix (and optionally its eigenvectors): the matrix is tridiagonalized, then implicit QL steps with the Wilkinson shift diagonalize the tridiagonal matrix.
+	* Without the eigenvectors, the steps only update the tridiagonal matrix, so the cost after the reduction is O(n^2) instead of O(n^3).
+	* @param matrix The matrix whose eigenvalues are computed. Its symmetry is checked (see isSymmetric).
+	* @param out_eigenvalues A pointer to the vector to which the eigenvalues are meant to be stored, in ascending order. This is an output variable, the user must declare the necessary variable before calling this method.
+	* @param out_eigenvectors A pointer to the DenseMatrix to which the orthonormal eigenvectors are meant to be stored as columns, in the order of the eigenvalues; it is resized as needed. May be nullptr, in which case the eigenvectors are not computed at all.
+	* @return True on success. False if the matrix isn't symmetric, or if the QL steps didn't converge (which is very unlikely); the eigenvalues are empty then.
+	*/
+	bool computeSymmetricEigen(const MatrixBase& matrix, std::vector<double>* out_eigenvalues, DenseMatrix* out_eigenvectors);
+	/**
+	* Reduces a square matrix in place to the upper Hessenberg matrix (transpose(Q) * matrix * Q) with Householder reflections from both sides.
+	* After the call, column k holds the Householder vector of the k-th reflection below the subdiagonal, whose first element (1, on the subdiagonal) is implicit, just like in tridiagonalize. Q is (H_0 * H_1 * ... * H_(n-3)).
+	* @param matrix The square matrix to be reduced.
+	* @param out_tau A pointer to the vector to which the scalar factors of the (numDimensions - 2) reflections are meant to be stored. This is an output variable, the user must declare the necessary variable before calling this method.
+	*/
+	void reduceToHessenberg(DenseMatrix& matrix, std::vector<double>* out_tau);
+	/**
+	* Computes the eigenvalues of a real square matrix, and optionally its real Schur decomposition (matrix == Z * T * transpose(Z)), where Z is orthogonal and T is upper quasi-triangular: each complex conjugate pair of eigenvalues is a 2x2 block on its diagonal.
+	* The matrix is reduced to the Hessenberg form, then Francis double-shift QR steps (implicit, in real arithmetic) deflate the eigenvalues from the bottom. A symmetric matrix (see isSymmetric) is passed to computeSymmetricEigen instead, and its T is diagonal.
+	* Large unreduced blocks also use aggressive early deflation: the real Schur form of a trailing window reveals the eigenvalues which have converged before the subdiagonal shows it, which saves many of the steps.
+	* Without the Schur form, the steps only update the unreduced block, which saves about half of the work.
+	* @param matrix The matrix whose eigenvalues are computed.
+	* @param out_eigenvalues A pointer to the vector to which the eigenvalues are meant to be stored, in the order in which they appear on the diagonal of T. The two eigenvalues of a complex conjugate pair are adjacent, the one with the positive imaginary part first. This is an output variable, the user must declare the necessary variable before calling this method.
+	* @param out_schurForm A pointer to the DenseMatrix to which T is meant to be stored; it is resized as needed. May be nullptr.
+	* @param out_schurVectors A pointer to the DenseMatrix to which Z (the Schur vectors, as columns) is meant to be stored; it is resized as needed. May be nullptr, in which case the transformations are not accumulated at all.
+	* @return True on success. False if the matrix isn't square, or if the QR steps didn't converge (which is very unlikely); the eigenvalues are empty then.
+	*/
+	bool computeEigenvalues(const MatrixBase& matrix, std::vector<std::complex<double>>* out_eigenvalues, DenseMatrix* out_schurForm, DenseMatrix* out_schurVectors);
+	/**
+	* Solves (op(triangle) * X == rightHandSides) in place by forward or back substitution, where op transposes triangle if isTransposed is set (TRSM; with a single right hand side, TRSV).
+	* Only the lower (or upper) triangle of triangle is read, so the packed factors of LU or Cholesky can be passed as they are. The rows of X are solved for block by block, and each solved block is subtracted from the remaining rows at once; wide right hand sides are solved for in tiles of columns.
+	* @param triangle The triangular matrix. Its leading square block is used, so it may have more rows than columns (like the R of a tall QR factorization).
+	* @param rightHandSides The right hand side(s), one per column, which are overwritten by X. Its number of rows must match the number of columns of triangle.
+	* @param isLower True if the lower triangle of triangle is used, false for the upper one.
+	* @param isTransposed True to solve with the transpose of the triangle.
+	* @param hasUnitDiagonal True if the diagonal of the triangle is taken to be ones (as for the L of LU). The stored diagonal isn't read then.
+	* @return True on success. False if the dimensions don't match, or if the diagonal has a zero; rightHandSides is unchanged then.
+	*/
+	bool solveTriangularInPlace(const DenseMatrix& triangle, DenseMatrix& rightHandSides, bool isLower, bool isTransposed, bool hasUnitDiagonal);
+	/**
+	* Solves (op(triangle) * X == rightHandSide) with solveTriangularInPlace. Triangles which aren't Dense are copied into a DenseMatrix first.
+	* @param triangle The square triangular matrix. Only its lower (or upper) triangle is read.
+	* @param rightHandSide The right hand side(s), one per column. Its number of rows must match the number of rows of triangle.
+	* @see solveTriangularInPlace for the flags.
+	* @return A raw pointer to a new DenseMatrix instance which holds X. nullptr if the dimensions don't match, or if the diagonal has a zero.
+	*/
+	DenseMatrix* solveTriangular(const MatrixBase& triangle, const MatrixBase& rightHandSide, bool isLower, bool isTransposed, bool hasUnitDiagonal);
+	/**
+	* Factorizes a symmetric positive definite matrix in place into (L * transpose(L)), panel by panel (blocked right-looking Cholesky). It needs half the flops of LU, and no pivoting.
+	* Each panel is factorized column by column, then its symmetric rank-k update is subtracted from the trailing matrix at once. Only the lower triangle is read; after the call it holds L, and the upper triangle is unchanged.
+	* @param matrix The matrix to be factorized. Its symmetry isn't checked.
+	* @return True on success. False as soon as a pivot isn't positive, which means that the matrix isn't positive definite; the matrix is partially factorized then.
+	*/
+	bool factorizeCholesky(DenseMatrix& matrix);
+	/**
+	* Solves (matrix * X == rightHandSide) with the Cholesky factorization, if the matrix is symmetric positive definite. The cheap necessary conditions (square, positive diagonal, symmetric) are checked first, so other matrices fail fast.
+	* @param matrix The matrix of coefficients.
+	* @param rightHandSide The right hand side(s), one per column. Its number of rows must match the number of rows of matrix.
+	* @return A raw pointer to a new DenseMatrix instance which holds X. nullptr if the dimensions don't match, or if the matrix isn't symmetric positive definite.
+	*/
+	DenseMatrix* solveCholesky(const MatrixBase& matrix, const MatrixBase& rightHandSide);
+	/**
+	* Calculates the determinant of a symmetric positive definite matrix with the Cholesky factorization: the square of the product of the diagonal of L.
+	* @param matrix The matrix whose determinant is calculated.
+	* @param out_determinant A pointer to the double to which the determinant is meant to be stored. Unchanged on failure.
+	* @return True on success. False if the matrix isn't symmetric positive definite (see solveCholesky).
+	*/
+	bool getCholeskyDeterminant(const MatrixBase& matrix, double* out_determinant);
+	/**
+	* Factorizes a square matrix in place into (transpose(P) * L * U) with partial pivoting. After the call, the strictly lower triangle holds L (whose unit diagonal is implicit), and the upper triangle holds U.
+	* Dispatches by size: a matrix of up to a few thousand dimensions (but more than one panel) is factorized by factorizeLURecursive, any other by factorizeLUBlocked. Both find the same pivots, barring rounding.
+	* @param matrix The square matrix to be factorized.
+	* @param out_rowPivots A pointer to the vector to which the pivots are meant to be stored: row j was swapped with row (*out_rowPivots)[j] at step j. This is an output variable, the user must declare the necessary variable before calling this method.
+	* @return True if every pivot is non-zero. False if the matrix is (exactly) singular; the factorization is still completed, with zeros on the diagonal of U.
+	*/
+	bool factorizeLU(DenseMatrix& matrix, std::vector<size_t>* out_rowPivots);
+	/**
+	* Factorizes a square matrix in place like factorizeLU, panel by panel (blocked right-looking LU).
+	* Each panel is factorized with unblocked partial pivoting on its own columns only; its row swaps are then applied to the rest of the matrix in a batch. The trailing update (A22 -= L21 * U12) is split between std::threads by rows.
+	* With look-ahead, the columns of the next panel are updated first, and the next panel is factorized while the worker threads update the rest of the trailing matrix.
+	* @see factorizeLU for the parameters and the return value.
+	*/
+	bool factorizeLUBlocked(DenseMatrix& matrix, std::vector<size_t>* out_rowPivots);
+	/**
+	* Factorizes a square matrix in place like factorizeLU, by recursively splitting the columns in half (Toledo's recursive LU): the left half is factorized, the top right block is solved for (TRSM) and the bottom right block is updated (GEMM), then the right half is factorized.
+	* The blocks halve at each level, so the factorization uses the caches well without a block size tuned to them. Large updates are split between std::threads by rows.
+	* @see factorizeLU for the parameters and the return value.
+	*/
+	bool factorizeLURecursive(DenseMatrix& matrix, std::vector<size_t>* out_rowPivots);
+	/**
+	* Solves (matrix * X == rightHandSide) with the LU factorization (see factorizeLU).
+	* @param matrix The square matrix of coefficients.
+	* @param rightHandSide The right hand side(s), one per column. Its number of rows must match the number of rows of matrix.
+	* @return A raw pointer to a new DenseMatrix instance which holds X. nullptr if the dimensions don't match, or if the matrix is numerically singular (a pivot is not greater than mcu::EPSILON times the largest pivot, in magnitude).
+	*/
+	DenseMatrix* solveLU(const MatrixBase& matrix, const MatrixBase& rightHandSide);
+	/**
+	* Solves (matrix * X == rightHandSide) with mixed precision iterative refinement: the matrix is factorized in single precision (see factorizeLURecursive), and the solution is corrected with residuals computed in double precision until its normwise backward error is below (sqrt(n) * the machine epsilon of double).
+	* If refinement stagnates (a step doesn't halve the backward error), if it doesn't converge in 30 steps, or if the matrix doesn't fit in single precision or is singular in it, the system is solved with double precision LU instead.
+	* @param matrix The square matrix of coefficients. Refinement converges when it is well-conditioned (its condition number is well below the reciprocal of the machine epsilon of float).
+	* @param rightHandSide The right hand side(s), one per column. Its number of rows must match the number of rows of matrix.
+	* @param out_numRefinementSteps A pointer to the size_t to which the number of refinement steps (after the first single precision solve) is meant to be stored. May be nullptr.
+	* @param out_backwardError A pointer to the double to which the final normwise backward error, max over the columns of ||B - A * X|| / (||A|| * ||X|| + ||B||) in the infinity norm, is meant to be stored. May be nullptr.
+	* @param out_isDoublePrecision A pointer to the bool to which true is meant to be stored if the system was solved with double precision LU instead. May be nullptr.
+	* @return A raw pointer to a new DenseMatrix instance which holds X. nullptr if the dimensions don't match, or if the matrix is numerically singular (see solveLU). The outputs are unchanged then.
+	*/
+	DenseMatrix* solveMixedPrecision(const MatrixBase& matrix, const MatrixBase& rightHandSide, size_t* out_numRefinementSteps, double* out_backwardError, bool* out_isDoublePrecision);
+	/**
+	* Calculates the determinant of a square matrix with the LU factorization: the product of the diagonal of U, negated once for each row swap.
+	* @param matrix The square matrix whose determinant is calculated.
+	* @return The determinant. Quiet NaN (Not a Number) if the matrix isn't square.
+	*/
+	double getLUDeterminant(const MatrixBase& matrix);
+}
+
+#endif // MAT_CALC_KERNELS_H
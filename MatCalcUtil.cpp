@@ -26,7 +26,7 @@ bool mcu::doubleAlmostEqual(double left, double right, double epsilon)
 	// Default epsilon (DBL_EPSILON * 1000) works for: (11 zeroes + 1 non-zero) digits.
 
 	double absoluteTolerance = epsilon;
-	double relativeTolerance = epsilon * std::max(left, right);
+	double relativeTolerance = epsilon * std::max(std::abs(left), std::abs(right)); // Magnitudes, so that negative values get a relative tolerance too.
 	double absDiff = std::abs(left - right);
 
 	if ((absDiff <= absoluteTolerance) || (absDiff <= relativeTolerance))
@@ -14,6 +14,7 @@ namespace mcu
 	extern const double EPSILON;
 	/**
 	* Checks whether left and right doubles are approximately equal, based on the epsilon value. NaN (Not a Number) cases are also handled. If both numbers are NaN, returns true; otherwise false.
+	* The numbers are equal if their difference is within epsilon, or within epsilon times the larger of their magnitudes (so the relative tolerance applies to negative numbers as well).
 	* @see mcu::EPSILON
 	* @param left Left double.
 	* @param right Right double.
@@ -1,5 +1,12 @@
 #include "Matrix.h"
 #include "MatCalcUtil.h"
+#include "MatCalcKernels.h"
+#include "DiagonalMatrix.h"
+#include "IdentityMatrix.h"
+#include "PermutationMatrix.h"
+#include "TriangularMatrix.h"
+#include "SymmetricMatrix.h"
+#include "MatrixCostModel.h"
 #include <sstream>
 #include <iostream>
 #include <iomanip>
@@ -12,10 +19,14 @@ Matrix::Matrix()
 {
 	// Invalid state.
 	matrixPtr = nullptr;
+	isTransposed = false;
 }
 
 Matrix::Matrix(const Matrix& other)
 {
+	matrixPtr = nullptr; // Invalid state, unless the other Matrix is valid.
+	isTransposed = false;
+
 	if (&other == this)
 	{
 		return;
@@ -24,9 +35,18 @@ Matrix::Matrix(const Matrix& other)
 	if (other.matrixPtr != nullptr) // Else Invalid state.
 	{
 		matrixPtr = other.matrixPtr->clone();
+		isTransposed = other.isTransposed;
 	}
 }
 
+Matrix::Matrix(Matrix&& other) noexcept
+{
+	matrixPtr = other.matrixPtr;
+	isTransposed = other.isTransposed;
+	other.matrixPtr = nullptr; // Invalid state.
+	other.isTransposed = false;
+}
+
 bool Matrix::operator==(const Matrix& right)
 {
 	if (this->matrixPtr == nullptr || right.matrixPtr == nullptr)
@@ -34,6 +54,9 @@ bool Matrix::operator==(const Matrix& right)
 		return false; // Invalid state.
 	}
 
+	// Two transposes are equal if the resources are equal; otherwise this resource takes the layout of the other one first.
+	setResourceLayout(right.isTransposed);
+
 	return this->matrixPtr->equal((*right.matrixPtr));
 }
 
@@ -42,81 +65,61 @@ bool Matrix::operator!=(const Matrix& right)
 	return !((*this) == right);
 }
 
-Matrix Matrix::operator+(const Matrix& right)
+Matrix Matrix::operator*(const Matrix& right) const
 {
-	Matrix result;
-
-	if (this->matrixPtr == nullptr || right.matrixPtr == nullptr)
-	{
-		return result; // Invalid state.
-	}
-
-	result.matrixPtr = this->matrixPtr->add(*(right.matrixPtr));
-
-	return result;
+	return multiply(right, false, false);
 }
 
-Matrix Matrix::operator-(const Matrix& right)
+Matrix& Matrix::operator+=(const Matrix& right)
 {
-	Matrix result;
-
-	if (this->matrixPtr == nullptr || right.matrixPtr == nullptr)
-	{
-		return result; // Invalid state.
-	}
-
-	result.matrixPtr = this->matrixPtr->subtract(*(right.matrixPtr));
+	axpy(1.0, right);
 
-	return result;
+	return *this;
 }
 
-Matrix Matrix::operator*(const Matrix& right)
+Matrix& Matrix::operator-=(const Matrix& right)
 {
-	Matrix result;
+	axpy(-1.0, right);
 
-	if (this->matrixPtr == nullptr || right.matrixPtr == nullptr)
-	{
-		return result; // Invalid state.
-	}
-
-	result.matrixPtr = this->matrixPtr->multiply(*(right.matrixPtr));
-
-	return result;
+	return *this;
 }
 
-Matrix Matrix::operator*(double scalar)
+Matrix& Matrix::operator*=(double scalar)
 {
-	Matrix result;
-
-	if (this->matrixPtr == nullptr)
+	if (matrixPtr != nullptr)
 	{
-		return result; // Invalid state.
-	}
-
-	result = (*this);
+		if (matrixPtr->canScale(scalar) == false)
+		{
+			generalizeStructure();
+		}
 
-	result.matrixPtr->scale(scalar);
+		matrixPtr->scale(scalar);
+	}
+	// else Invalid state.
 
-	return result;
+	return *this;
 }
 
-Matrix operator*(double scalar, const Matrix& right)
+Matrix& Matrix::operator=(const Matrix& other)
 {
-	Matrix result;
-
-	if (right.matrixPtr == nullptr)
+	if (&other == this)
 	{
-		return result; // Invalid state.
+		return *this;
 	}
 
-	result = right;
+	destroyResource();
 
-	result.matrixPtr->scale(scalar);
+	if (other.matrixPtr != nullptr)
+	{
+		matrixPtr = other.matrixPtr->clone();
+		isTransposed = other.isTransposed;
+	}
+	//else Invalid State.
 
-	return result;
+	return *this;
 }
 
-Matrix& Matrix::operator=(const Matrix& other)
+Matrix& Matrix::operator=(Matrix&& other) noexcept
 {
 	if (&other == this)
 	{
@@ -125,11 +128,10 @@ Matrix& Matrix::operator=(const Matrix& other)
 
 	destroyResource();
 
-	if (other.matrixPtr != nullptr)
-	{
-		matrixPtr = other.matrixPtr->clone();
-	}
-	//else Invalid State.
+	matrixPtr = other.matrixPtr;
+	isTransposed = other.isTransposed;
+	other.matrixPtr = nullptr; // Invalid state.
+	other.isTransposed = false;
 
 	return *this;
 }
@@ -147,7 +149,9 @@ std::string Matrix::getPrintStr(size_t precision) const
 		return ret; // Invalid state.
 	}
 
-	ret = matrixPtr->getPrintStr(precision);
+	MatrixBase* transposedCopy = nullptr;
+	ret = getResourceInLayout(&transposedCopy)->getPrintStr(precision);
+	delete transposedCopy;
 
 	return ret;
 }
@@ -156,7 +160,7 @@ size_t Matrix::getNumRows() const
 {
 	if (matrixPtr != nullptr)
 	{
-		return matrixPtr->getNumRows();
+		return isTransposed ? matrixPtr->getNumColumns() : matrixPtr->getNumRows();
 	}
 
 	return 0; // Invalid state.
@@ -166,7 +170,7 @@ size_t Matrix::getNumColumns() const
 {
 	if (matrixPtr != nullptr)
 	{
-		return matrixPtr->getNumColumns();
+		return isTransposed ? matrixPtr->getNumRows() : matrixPtr->getNumColumns();
 	}
 
 	return 0; // Invalid state.
@@ -176,7 +180,7 @@ double Matrix::getCell(size_t row, size_t column) const
 {
 	if (matrixPtr != nullptr)
 	{
-		return matrixPtr->getCell(row, column);
+		return isTransposed ? matrixPtr->getCell(column, row) : matrixPtr->getCell(row, column);
 	}
 
 	return std::numeric_limits<double>::quiet_NaN(); // Invalid state.
@@ -186,16 +190,43 @@ void Matrix::setCell(size_t row, size_t column, double value)
 {
 	if (matrixPtr != nullptr)
 	{
+		if (isTransposed)
+		{
+			std::swap(row, column);
+		}
+
+		if (matrixPtr->canSetCell(row, column, value) == false)
+		{
+			generalizeStructure();
+		}
+
 		matrixPtr->setCell(row, column, value);
 	}
 
 	// else invalid state.
 }
 
+void Matrix::setSymmetricCell(size_t row, size_t column, double value)
+{
+	SymmetricMatrix* symmetric = dynamic_cast<SymmetricMatrix*>(matrixPtr);
+
+	if (symmetric != nullptr)
+	{
+		symmetric->setCell(row, column, value); // Both of the mirror cells share one packed cell.
+	}
+	else
+	{
+		setCell(row, column, value);
+		setCell(column, row, value);
+	}
+}
+
 void Matrix::resizeNumRows(size_t newNumRows)
 {
 	if (matrixPtr != nullptr)
 	{
+		applyTranspose();
+		generalizeStructure();
 		matrixPtr->resizeNumRows(newNumRows);
 	}
 
@@ -206,6 +237,8 @@ void Matrix::resizeNumColumns(size_t newNumColumns)
 {
 	if (matrixPtr != nullptr)
 	{
+		applyTranspose();
+		generalizeStructure();
 		matrixPtr->resizeNumColumns(newNumColumns);
 	}
 
@@ -222,12 +255,17 @@ void Matrix::transpose()
 {
 	if (matrixPtr != nullptr)
 	{
-		matrixPtr->transpose();
+		isTransposed = !isTransposed;
 	}
 
 	// else invalid state.
 }
 
+void Matrix::applyTranspose()
+{
+	setResourceLayout(false);
+}
+
 double Matrix::getSparsity() const
 {
 	if (matrixPtr != nullptr)
@@ -248,6 +286,16 @@ double Matrix::getDensity() const
 	return std::numeric_limits<double>::quiet_NaN(); // Invalid state.
 }
 
+size_t Matrix::getNumNonZeros() const
+{
+	if (matrixPtr != nullptr)
+	{
+		return matrixPtr->getNumNonZeros();
+	}
+
+	return 0; // Invalid state.
+}
+
 bool Matrix::isSparse() const
 {
 	if (matrixPtr != nullptr)
@@ -292,6 +340,18 @@ void Matrix::toSparse()
 	delete oldPtr;
 }
 
+void Matrix::toTiled(size_t tileSize)
+{
+	if (matrixPtr == nullptr)
+	{
+		return; // Invalid state.
+	}
+
+	MatrixBase* oldPtr = matrixPtr;
+	matrixPtr = TiledMatrix::fromMatrix(*oldPtr, tileSize);
+	delete oldPtr;
+}
+
 bool Matrix::requiresConversion() const
 {
 	if (matrixPtr == nullptr)
@@ -324,7 +384,10 @@ Matrix Matrix::mergeByColumns(const Matrix& right)
 		return result; // Invalid state.
 	}
 
-	result.matrixPtr = this->matrixPtr->mergeByColumns(*(right.matrixPtr));
+	applyTranspose();
+	MatrixBase* transposedRight = nullptr;
+	result.matrixPtr = this->matrixPtr->mergeByColumns(*right.getResourceInLayout(&transposedRight));
+	delete transposedRight;
 
 	return result;
 }
@@ -338,7 +401,10 @@ Matrix Matrix::mergeByRows(const Matrix& right)
 		return result; // Invalid state.
 	}
 
-	result.matrixPtr = this->matrixPtr->mergeByRows(*(right.matrixPtr));
+	applyTranspose();
+	MatrixBase* transposedRight = nullptr;
+	result.matrixPtr = this->matrixPtr->mergeByRows(*right.getResourceInLayout(&transposedRight));
+	delete transposedRight;
 
 	return result;
 }
@@ -352,7 +418,9 @@ Matrix Matrix::splitByColumn(size_t leftNewNumColumns, bool returnLeftMatrix) co
 		return result; // Invalid state.
 	}
 
-	result.matrixPtr = this->matrixPtr->splitByColumn(leftNewNumColumns, returnLeftMatrix);
+	// The columns of the transpose are the rows of the resource, so the result is a transposed split by row.
+	result.matrixPtr = isTransposed ? this->matrixPtr->splitByRow(leftNewNumColumns, returnLeftMatrix) : this->matrixPtr->splitByColumn(leftNewNumColumns, returnLeftMatrix);
+	result.isTransposed = (result.matrixPtr != nullptr) && isTransposed;
 
 	return result;
 }
@@ -366,7 +434,9 @@ Matrix Matrix::splitByRow(size_t topNewNumRows, bool returnTopMatrix) const
 		return result; // Invalid state.
 	}
 
-	result.matrixPtr = this->matrixPtr->splitByRow(topNewNumRows, returnTopMatrix);
+	// The rows of the transpose are the columns of the resource, so the result is a transposed split by column.
+	result.matrixPtr = isTransposed ? this->matrixPtr->splitByColumn(topNewNumRows, returnTopMatrix) : this->matrixPtr->splitByRow(topNewNumRows, returnTopMatrix);
+	result.isTransposed = (result.matrixPtr != nullptr) && isTransposed;
 
 	return result;
 }
@@ -380,7 +450,9 @@ Matrix Matrix::getSubMatrix(size_t subRowBeginIndex, size_t subNumRows, size_t s
 		return result; // Invalid state.
 	}
 
-	result.matrixPtr = this->matrixPtr->getSubMatrix(subRowBeginIndex, subNumRows, subColumnBeginIndex, subNumColumns);
+	// The sub-matrix of the transpose is the transposed sub-matrix with the row & column ranges swapped.
+	result.matrixPtr = isTransposed ? this->matrixPtr->getSubMatrix(subColumnBeginIndex, subNumColumns, subRowBeginIndex, subNumRows) : this->matrixPtr->getSubMatrix(subRowBeginIndex, subNumRows, subColumnBeginIndex, subNumColumns);
+	result.isTransposed = (result.matrixPtr != nullptr) && isTransposed;
 
 	return result; // Possible invalid state (getSubMatrix could have returned nullptr).
 }
@@ -394,7 +466,9 @@ Matrix Matrix::getSubMatrix(size_t ignoredRowIndex, size_t ignoredColumnIndex) c
 		return result; // Invalid state.
 	}
 
-	result.matrixPtr = this->matrixPtr->getSubMatrix(ignoredRowIndex, ignoredColumnIndex);
+	// The sub-matrix of the transpose is the transposed sub-matrix with the ignored row & column swapped.
+	result.matrixPtr = isTransposed ? this->matrixPtr->getSubMatrix(ignoredColumnIndex, ignoredRowIndex) : this->matrixPtr->getSubMatrix(ignoredRowIndex, ignoredColumnIndex);
+	result.isTransposed = (result.matrixPtr != nullptr) && isTransposed;
 
 	return result;
 }
@@ -408,7 +482,9 @@ Matrix Matrix::getSubMatrixTopLeft(size_t ignoredRowIndex, size_t ignoredColumnI
 		return result; // Invalid state.
 	}
 
-	result.matrixPtr = this->matrixPtr->getSubMatrixTopLeft(ignoredRowIndex, ignoredColumnIndex);
+	// The top left part of the transpose is the transposed top left part of the resource, with the ignored row & column swapped.
+	result.matrixPtr = isTransposed ? this->matrixPtr->getSubMatrixTopLeft(ignoredColumnIndex, ignoredRowIndex) : this->matrixPtr->getSubMatrixTopLeft(ignoredRowIndex, ignoredColumnIndex);
+	result.isTransposed = (result.matrixPtr != nullptr) && isTransposed;
 
 	return result; // Possible invalid state (getSubMatrixTopLeft could have returned nullptr).
 }
@@ -422,7 +498,9 @@ Matrix Matrix::getSubMatrixTopRight(size_t ignoredRowIndex, size_t ignoredColumn
 		return result; // Invalid state.
 	}
 
-	result.matrixPtr = this->matrixPtr->getSubMatrixTopRight(ignoredRowIndex, ignoredColumnIndex);
+	// The top right part of the transpose is the transposed bottom left part of the resource, with the ignored row & column swapped.
+	result.matrixPtr = isTransposed ? this->matrixPtr->getSubMatrixBottomLeft(ignoredColumnIndex, ignoredRowIndex) : this->matrixPtr->getSubMatrixTopRight(ignoredRowIndex, ignoredColumnIndex);
+	result.isTransposed = (result.matrixPtr != nullptr) && isTransposed;
 
 	return result; // Possible invalid state (getSubMatrixTopRight could have returned nullptr).
 }
@@ -436,7 +514,9 @@ Matrix Matrix::getSubMatrixBottomLeft(size_t ignoredRowIndex, size_t ignoredColu
 		return result; // Invalid state.
 	}
 
-	result.matrixPtr = this->matrixPtr->getSubMatrixBottomLeft(ignoredRowIndex, ignoredColumnIndex);
+	// The bottom left part of the transpose is the transposed top right part of the resource, with the ignored row & column swapped.
+	result.matrixPtr = isTransposed ? this->matrixPtr->getSubMatrixTopRight(ignoredColumnIndex, ignoredRowIndex) : this->matrixPtr->getSubMatrixBottomLeft(ignoredRowIndex, ignoredColumnIndex);
+	result.isTransposed = (result.matrixPtr != nullptr) && isTransposed;
 
 	return result; // Possible invalid state (getSubMatrixBottomLeft could have returned nullptr).
 }
@@ -450,11 +530,36 @@ Matrix Matrix::getSubMatrixBottomRight(size_t ignoredRowIndex, size_t ignoredCol
 		return result; // Invalid state.
 	}
 
-	result.matrixPtr = this->matrixPtr->getSubMatrixBottomRight(ignoredRowIndex, ignoredColumnIndex);
+	// The bottom right part of the transpose is the transposed bottom right part of the resource, with the ignored row & column swapped.
+	result.matrixPtr = isTransposed ? this->matrixPtr->getSubMatrixBottomRight(ignoredColumnIndex, ignoredRowIndex) : this->matrixPtr->getSubMatrixBottomRight(ignoredRowIndex, ignoredColumnIndex);
+	result.isTransposed = (result.matrixPtr != nullptr) && isTransposed;
 
 	return result; // Possible invalid state (getSubMatrixBottomRight could have returned nullptr).
 }
 
+bool Matrix::getSubView(size_t subRowBeginIndex, size_t subNumRows, size_t subColumnBeginIndex, size_t subNumColumns, DenseMatrixView* out_view) const
+{
+	const DenseMatrix* dense = dynamic_cast<const DenseMatrix*>(matrixPtr);
+
+	if (dense == nullptr || subNumRows == 0 || subNumColumns == 0
+		|| subRowBeginIndex + subNumRows > getNumRows() || subColumnBeginIndex + subNumColumns > getNumColumns())
+	{
+		return false;
+	}
+
+	// The part of the transpose is the transposed part of the resource, with the row & column ranges swapped.
+	if (isTransposed)
+	{
+		*out_view = dense->getSubView(subColumnBeginIndex, subNumColumns, subRowBeginIndex, subNumRows).getTransposedView();
+	}
+	else
+	{
+		*out_view = dense->getSubView(subRowBeginIndex, subNumRows, subColumnBeginIndex, subNumColumns);
+	}
+
+	return true;
+}
+
 Matrix Matrix::getMinorMatrix() const
 {
 	Matrix result;
@@ -464,7 +569,9 @@ Matrix Matrix::getMinorMatrix() const
 		return result; // Invalid state.
 	}
 
+	// The minors of the transpose are the transposed minors.
 	result.matrixPtr = this->matrixPtr->getMinorMatrix();
+	result.isTransposed = isTransposed;
 
 	return result;
 }
@@ -473,6 +580,8 @@ void Matrix::applyCheckerboardPattern()
 {
 	if (this->matrixPtr != nullptr)
 	{
+		// The pattern is symmetric, so it can be applied to the resource even if this Matrix is transposed.
+		generalizeStructure();
 		matrixPtr->applyCheckerboardPattern();
 	}
 
@@ -485,7 +594,7 @@ double Matrix::getDeterminant() const
 
 	if (matrixPtr != nullptr)
 	{
-		determinant = matrixPtr->getDeterminant();
+		determinant = matrixPtr->getDeterminant(); // det(transpose(A)) == det(A)
 	}
 
 	return determinant;
@@ -500,7 +609,9 @@ Matrix Matrix::getInverse(double determinant) const
 		return result; // Invalid state.
 	}
 
+	// The inverse of the transpose is the transposed inverse.
 	result.matrixPtr = this->matrixPtr->getInverse(determinant);
+	result.isTransposed = (result.matrixPtr != nullptr) && isTransposed;
 
 	return result; // Possible invalid state (getInverse could have returned nullptr).
 }
@@ -513,7 +624,11 @@ std::string Matrix::solveFor(const Matrix& augmentedColumn, bool verbose, size_t
 		return ret; // Invalid state.
 	}
 
-	ret = matrixPtr->solveFor(*(augmentedColumn.matrixPtr), verbose, doublePrecision);
+	MatrixBase* transposedCopy = nullptr;
+	MatrixBase* transposedAugmentedColumn = nullptr;
+	ret = getResourceInLayout(&transposedCopy)->solveFor(*augmentedColumn.getResourceInLayout(&transposedAugmentedColumn), verbose, doublePrecision);
+	delete transposedCopy;
+	delete transposedAugmentedColumn;
 
 	return ret;
 }
@@ -525,7 +640,410 @@ size_t Matrix::getRank() const
 		return 0; // Invalid state.
 	}
 
-	return matrixPtr->getRank();
+	return matrixPtr->getRank(); // rank(transpose(A)) == rank(A)
+}
+
+size_t Matrix::getRank(double tolerance, std::vector<size_t>* out_independentColumns) const
+{
+	if (matrixPtr == nullptr)
+	{
+		if (out_independentColumns != nullptr)
+		{
+			out_independentColumns->clear();
+		}
+
+		return 0; // Invalid state.
+	}
+
+	// The independent columns depend on the layout.
+	MatrixBase* transposedCopy = nullptr;
+	size_t rank = mck::getRank(*getResourceInLayout(&transposedCopy), tolerance, out_independentColumns);
+	delete transposedCopy;
+
+	return rank;
+}
+
+void Matrix::getSVD(bool isThin, Matrix* out_u, std::vector<double>* out_singularValues, Matrix* out_v) const
+{
+	out_singularValues->clear();
+
+	if (out_u != nullptr)
+	{
+		out_u->destroyResource();
+	}
+
+	if (out_v != nullptr)
+	{
+		out_v->destroyResource();
+	}
+
+	if (matrixPtr == nullptr)
+	{
+		return; // Invalid state.
+	}
+
+	DenseMatrix* u = (out_u != nullptr) ? new DenseMatrix() : nullptr;
+	DenseMatrix* v = (out_v != nullptr) ? new DenseMatrix() : nullptr;
+
+	// transpose(A) == V * S * transpose(U), so the singular vectors of the transpose are those of the resource, swapped.
+	mck::computeSVD(*matrixPtr, isThin, out_singularValues, isTransposed ? v : u, isTransposed ? u : v);
+
+	if (out_u != nullptr)
+	{
+		out_u->matrixPtr = u;
+	}
+
+	if (out_v != nullptr)
+	{
+		out_v->matrixPtr = v;
+	}
+}
+
+Matrix Matrix::getPseudoInverse(double tolerance) const
+{
+	Matrix result;
+
+	if (this->matrixPtr == nullptr)
+	{
+		return result; // Invalid state.
+	}
+
+	// The pseudo-inverse of the transpose is the transposed pseudo-inverse.
+	result.matrixPtr = mck::getPseudoInverse(*matrixPtr, tolerance);
+	result.isTransposed = (result.matrixPtr != nullptr) && isTransposed;
+
+	return result;
+}
+
+double Matrix::getNorm2() const
+{
+	if (matrixPtr == nullptr)
+	{
+		return std::numeric_limits<double>::quiet_NaN(); // Invalid state.
+	}
+
+	return mck::getNorm2(*matrixPtr); // The singular values of the transpose are the same.
+}
+
+double Matrix::getConditionNumber() const
+{
+	if (matrixPtr == nullptr)
+	{
+		return std::numeric_limits<double>::quiet_NaN(); // Invalid state.
+	}
+
+	return mck::getConditionNumber(*matrixPtr);
+}
+
+size_t Matrix::getNumericalRank(double tolerance) const
+{
+	if (matrixPtr == nullptr)
+	{
+		return 0; // Invalid state.
+	}
+
+	return mck::getNumericalRank(*matrixPtr, tolerance);
+}
+
+bool Matrix::getSymmetricEigen(std::vector<double>* out_eigenvalues, Matrix* out_eigenvectors) const
+{
+	out_eigenvalues->clear();
+
+	if (out_eigenvectors != nullptr)
+	{
+		out_eigenvectors->destroyResource();
+	}
+
+	if (matrixPtr == nullptr)
+	{
+		return false; // Invalid state.
+	}
+
+	// No need to apply the transpose flag: a symmetric matrix is its own transpose, and the transpose of a nonsymmetric one isn't symmetric either.
+	DenseMatrix* eigenvectors = (out_eigenvectors != nullptr) ? new DenseMatrix() : nullptr;
+
+	if (!mck::computeSymmetricEigen(*matrixPtr, out_eigenvalues, eigenvectors))
+	{
+		delete eigenvectors;
+		return false;
+	}
+
+	if (out_eigenvectors != nullptr)
+	{
+		out_eigenvectors->matrixPtr = eigenvectors;
+	}
+
+	return true;
+}
+
+bool Matrix::getEigenvalues(std::vector<std::complex<double>>* out_eigenvalues, Matrix* out_schurForm, Matrix* out_schurVectors) const
+{
+	out_eigenvalues->clear();
+
+	if (out_schurForm != nullptr)
+	{
+		out_schurForm->destroyResource();
+	}
+
+	if (out_schurVectors != nullptr)
+	{
+		out_schurVectors->destroyResource();
+	}
+
+	if (matrixPtr == nullptr)
+	{
+		return false; // Invalid state.
+	}
+
+	// The eigenvalues of the transpose are the same, but its Schur decomposition isn't.
+	MatrixBase* transposedCopy = nullptr;
+	const MatrixBase* resource = (out_schurForm != nullptr || out_schurVectors != nullptr) ? getResourceInLayout(&transposedCopy) : matrixPtr;
+
+	DenseMatrix* schurForm = (out_schurForm != nullptr) ? new DenseMatrix() : nullptr;
+	DenseMatrix* schurVectors = (out_schurVectors != nullptr) ? new DenseMatrix() : nullptr;
+
+	bool isConverged = mck::computeEigenvalues(*resource, out_eigenvalues, schurForm, schurVectors);
+	delete transposedCopy;
+
+	if (!isConverged)
+	{
+		delete schurForm;
+		delete schurVectors;
+		return false;
+	}
+
+	if (out_schurForm != nullptr)
+	{
+		out_schurForm->matrixPtr = schurForm;
+	}
+
+	if (out_schurVectors != nullptr)
+	{
+		out_schurVectors->matrixPtr = schurVectors;
+	}
+
+	return true;
+}
+
+void Matrix::axpy(double alpha, const Matrix& x)
+{
+	if (matrixPtr == nullptr)
+	{
+		return; // Invalid state.
+	}
+
+	if (x.matrixPtr == nullptr || x.getNumRows() != getNumRows() || x.getNumColumns() != getNumColumns())
+	{
+		destroyResource(); // Invalid state, just like A = A + B would be.
+		return;
+	}
+
+	if (&x == this)
+	{
+		*this *= (1.0 + alpha);
+		return;
+	}
+
+	// The sum of two transposes is the transposed sum; otherwise this resource takes the layout of the other one first.
+	setResourceLayout(x.isTransposed);
+	generalizeStructure();
+	matrixPtr->addInPlace(*(x.matrixPtr), alpha);
+}
+
+void Matrix::gemm(double alpha, const Matrix& left, const Matrix& right, double beta)
+{
+	if (matrixPtr == nullptr)
+	{
+		return; // Invalid state.
+	}
+
+	if (left.matrixPtr == nullptr || right.matrixPtr == nullptr
+		|| left.getNumColumns() != right.getNumRows()
+		|| left.getNumRows() != getNumRows() || right.getNumColumns() != getNumColumns())
+	{
+		destroyResource(); // Invalid state.
+		return;
+	}
+
+	applyTranspose();
+	generalizeStructure();
+
+	MatrixBase* transposedLeft = nullptr;
+	MatrixBase* transposedRight = nullptr;
+	const MatrixBase* leftOperand = left.getResourceInLayout(&transposedLeft);
+	const MatrixBase* rightOperand = right.getResourceInLayout(&transposedRight);
+
+	if (&left == this || &right == this)
+	{
+		// This matrix is one of the operands, so the product can't be accumulated into it directly.
+		MatrixBase* product = leftOperand->multiply(*rightOperand);
+		delete transposedLeft;
+		delete transposedRight;
+
+		if (beta == 0.0)
+		{
+			destroyResource();
+			matrixPtr = product;
+			matrixPtr->scale(alpha);
+			return;
+		}
+
+		matrixPtr->scale(beta);
+		matrixPtr->addInPlace(*product, alpha);
+		delete product;
+		return;
+	}
+
+	matrixPtr->multiplyAccumulate(alpha, *leftOperand, *rightOperand, beta);
+	delete transposedLeft;
+	delete transposedRight;
+}
+
+Matrix Matrix::multiply(const Matrix& right, bool transposeThis, bool transposeRight) const
+{
+	Matrix result;
+
+	if (this->matrixPtr == nullptr || right.matrixPtr == nullptr)
+	{
+		return result; // Invalid state.
+	}
+
+	// The flags are relative to the resources, which may be transposed already.
+	bool transposeLeftResource = (transposeThis != isTransposed);
+	bool transposeRightResource = (transposeRight != right.isTransposed);
+
+	size_t innerDimension = transposeLeftResource ? matrixPtr->getNumRows() : matrixPtr->getNumColumns();
+	size_t rightInnerDimension = transposeRightResource ? right.matrixPtr->getNumColumns() : right.matrixPtr->getNumRows();
+
+	if (innerDimension != rightInnerDimension)
+	{
+		return result; // Invalid state.
+	}
+
+	if (transposeLeftResource == false && transposeRightResource == false)
+	{
+		result.matrixPtr = this->matrixPtr->multiply(*(right.matrixPtr));
+		return result;
+	}
+
+	const DenseMatrix* denseRight = dynamic_cast<const DenseMatrix*>(right.matrixPtr);
+
+	if (denseRight != nullptr)
+	{
+		result.matrixPtr = DenseMatrix::multiplyTransposed(*matrixPtr, transposeLeftResource, *denseRight, transposeRightResource);
+		return result;
+	}
+
+	if (transposeLeftResource && transposeRightResource)
+	{
+		// transpose(A) * transpose(B) == transpose(B * A), so the product is just flagged as transposed.
+		result.matrixPtr = right.matrixPtr->multiply(*matrixPtr);
+		result.isTransposed = (result.matrixPtr != nullptr);
+		return result;
+	}
+
+	const SparseMatrix* sparseRight = dynamic_cast<const SparseMatrix*>(right.matrixPtr);
+	const DenseMatrix* denseLeft = dynamic_cast<const DenseMatrix*>(matrixPtr);
+
+	if (sparseRight != nullptr && denseLeft != nullptr)
+	{
+		if (transposeRightResource)
+		{
+			result.matrixPtr = SparseMatrix::multiplyTransposedRight(*denseLeft, *sparseRight);
+		}
+		else
+		{
+			// transpose(A) * B == transpose(transpose(B) * A).
+			result.matrixPtr = SparseMatrix::multiplyTransposedLeft(*sparseRight, *denseLeft);
+			result.isTransposed = true;
+		}
+
+		return result;
+	}
+
+	// There is no transpose-free kernel for the other operands (e.g. two SparseMatrix operands, one of them transposed); transpose copies of the flagged operands instead.
+	MatrixBase* transposedLeft = nullptr;
+	MatrixBase* transposedRight = nullptr;
+
+	if (transposeLeftResource)
+	{
+		transposedLeft = matrixPtr->clone();
+		transposedLeft->transpose();
+	}
+
+	if (transposeRightResource)
+	{
+		transposedRight = right.matrixPtr->clone();
+		transposedRight->transpose();
+	}
+
+	const MatrixBase* leftOperand = transposeLeftResource ? transposedLeft : matrixPtr;
+	const MatrixBase* rightOperand = transposeRightResource ? transposedRight : right.matrixPtr;
+
+	result.matrixPtr = leftOperand->multiply(*rightOperand);
+
+	delete transposedLeft;
+	delete transposedRight;
+
+	return result;
+}
+
+Matrix Matrix::solveMixedPrecision(const Matrix& rightHandSide, size_t* out_numRefinementSteps, double* out_backwardError, bool* out_isDoublePrecision) const
+{
+	Matrix result;
+
+	if (this->matrixPtr == nullptr || rightHandSide.matrixPtr == nullptr)
+	{
+		return result; // Invalid state.
+	}
+
+	MatrixBase* transposedCopy = nullptr;
+	MatrixBase* transposedRightHandSide = nullptr;
+	result.matrixPtr = mck::solveMixedPrecision(*getResourceInLayout(&transposedCopy), *rightHandSide.getResourceInLayout(&transposedRightHandSide), out_numRefinementSteps, out_backwardError, out_isDoublePrecision);
+	delete transposedCopy;
+	delete transposedRightHandSide;
+
+	return result; // Possible invalid state (solveMixedPrecision could have returned nullptr).
+}
+
+Matrix Matrix::solveTriangular(const Matrix& rightHandSide, bool isLower, bool transposeThis, bool hasUnitDiagonal) const
+{
+	Matrix result;
+
+	if (this->matrixPtr == nullptr || rightHandSide.matrixPtr == nullptr)
+	{
+		return result; // Invalid state.
+	}
+
+	// The flags are relative to the resource, which may be transposed already: the lower triangle of its transpose is its upper triangle.
+	// A TriangularMatrix knows its own triangle, so only the other resources are taken to be the given one.
+	const TriangularMatrix* triangular = dynamic_cast<const TriangularMatrix*>(matrixPtr);
+	bool isLowerResource = (triangular != nullptr) ? (triangular->isUpper() == false) : (isLower != isTransposed);
+	bool transposeResource = (transposeThis != isTransposed);
+
+	MatrixBase* transposedRightHandSide = nullptr;
+	result.matrixPtr = mck::solveTriangular(*matrixPtr, *rightHandSide.getResourceInLayout(&transposedRightHandSide), isLowerResource, transposeResource, hasUnitDiagonal);
+	delete transposedRightHandSide;
+
+	return result; // Possible invalid state (solveTriangular could have returned nullptr).
+}
+
+Matrix Matrix::solveLeastSquares(const Matrix& rightHandSide, double* out_residualNorm) const
+{
+	Matrix result;
+
+	if (this->matrixPtr == nullptr || rightHandSide.matrixPtr == nullptr)
+	{
+		return result; // Invalid state.
+	}
+
+	MatrixBase* transposedCopy = nullptr;
+	MatrixBase* transposedRightHandSide = nullptr;
+	result.matrixPtr = mck::solveLeastSquares(*getResourceInLayout(&transposedCopy), *rightHandSide.getResourceInLayout(&transposedRightHandSide), out_residualNorm);
+	delete transposedCopy;
+	delete transposedRightHandSide;
+
+	return result; // Possible invalid state (solveLeastSquares could have returned nullptr).
 }
 
 // Public static members
@@ -537,6 +1055,43 @@ Matrix Matrix::createDense(size_t numRows, size_t numColumns, double initialValu
 	return dense;
 }
 
+Matrix Matrix::createFromView(const DenseMatrixView& view)
+{
+	Matrix copy;
+	size_t numRows = view.getNumRows();
+	size_t numColumns = view.getNumColumns();
+
+	if (numRows == 0 || numColumns == 0)
+	{
+		return copy; // Invalid state.
+	}
+
+	if (MatrixCostModel::getInstance().shouldConvertToSparse(numRows, numColumns, view.getNumNonZeros()) == false)
+	{
+		copy.matrixPtr = view.materialize();
+		return copy;
+	}
+
+	SparseMatrix* sparse = new SparseMatrix(numRows, numColumns);
+
+	for (size_t r = 0; r < numRows; r++)
+	{
+		for (size_t c = 0; c < numColumns; c++)
+		{
+			double value = view.getCell(r, c);
+
+			if (mcu::doubleAlmostEqual(value, 0.0) == false)
+			{
+				sparse->setCell(r, c, value);
+			}
+		}
+	}
+
+	copy.matrixPtr = sparse;
+
+	return copy;
+}
+
 Matrix Matrix::createSparse(size_t numRows, size_t numColumns)
 {
 	Matrix sparse;
@@ -549,16 +1104,52 @@ Matrix Matrix::createZero(size_t numRows, size_t numColumns)
 	return createSparse(numRows, numColumns);
 }
 
+Matrix Matrix::createTiled(size_t numRows, size_t numColumns, size_t tileSize)
+{
+	Matrix tiled;
+	tiled.matrixPtr = new TiledMatrix(numRows, numColumns, tileSize);
+	return tiled;
+}
+
 Matrix Matrix::createIdentity(size_t numDimensions)
 {
-	Matrix identity = createZero(numDimensions, numDimensions);
+	Matrix identity;
+	identity.matrixPtr = new IdentityMatrix(numDimensions);
+	return identity;
+}
+
+Matrix Matrix::createDiagonal(const std::vector<double>& diagonal)
+{
+	Matrix diagonalMatrix;
+	diagonalMatrix.matrixPtr = new DiagonalMatrix(diagonal);
+	return diagonalMatrix;
+}
+
+Matrix Matrix::createPermutation(const std::vector<size_t>& columnOfRow)
+{
+	Matrix permutation;
 
-	for (size_t d = 0; d < numDimensions; d++)
+	if (PermutationMatrix::isPermutation(columnOfRow) == false)
 	{
-		identity.setCell(d, d, 1.0);
+		return permutation; // Invalid state.
 	}
 
-	return identity;
+	permutation.matrixPtr = new PermutationMatrix(columnOfRow);
+	return permutation;
+}
+
+Matrix Matrix::createTriangular(size_t numDimensions, bool isUpper)
+{
+	Matrix triangular;
+	triangular.matrixPtr = new TriangularMatrix(numDimensions, isUpper);
+	return triangular;
+}
+
+Matrix Matrix::createSymmetric(size_t numDimensions)
+{
+	Matrix symmetric;
+	symmetric.matrixPtr = new SymmetricMatrix(numDimensions);
+	return symmetric;
 }
 
 // Private members
@@ -568,5 +1159,43 @@ void Matrix::destroyResource()
 	if (matrixPtr != nullptr)
 	{
 		delete matrixPtr;
+		matrixPtr = nullptr;
+	}
+
+	isTransposed = false;
+}
+
+void Matrix::generalizeStructure()
+{
+	StructuredMatrix* structured = dynamic_cast<StructuredMatrix*>(matrixPtr);
+
+	if (structured != nullptr)
+	{
+		matrixPtr = structured->toGeneral();
+		delete structured;
 	}
 }
+
+void Matrix::setResourceLayout(bool newIsTransposed)
+{
+	if (matrixPtr != nullptr && isTransposed != newIsTransposed)
+	{
+		matrixPtr->transpose();
+		isTransposed = newIsTransposed;
+	}
+}
+
+const MatrixBase* Matrix::getResourceInLayout(MatrixBase** out_transposedCopy) const
+{
+	*out_transposedCopy = nullptr;
+
+	if (!isTransposed)
+	{
+		return matrixPtr;
+	}
+
+	*out_transposedCopy = matrixPtr->clone();
+	(*out_transposedCopy)->transpose();
+
+	return *out_transposedCopy;
+}
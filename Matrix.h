@@ -4,11 +4,16 @@
 #include "MatrixBase.h"
 #include "DenseMatrix.h"
 #include "SparseMatrix.h"
+#include "TiledMatrix.h"
+#include "MatrixExpression.h"
+#include <complex>
 
 /**
 * Wrapper class for MatrixBase instances. Manages the the raw pointer resource. If the resource is nullptr, then the Matrix is considered to be in an invalid state; and is called invalid matrix.
+* Element-wise arithmetic (+, - and scaling) is lazy. It builds a MatrixExpression, which is evaluated in a single fused pass when it is assigned to a Matrix.
+* @see MatrixExpression
 */
-class Matrix
+class Matrix : public MatrixExpression<Matrix>
 {
 public:
 	/**
@@ -20,6 +25,18 @@ public:
 	* @param other The other Matrix to copy from.
 	*/
 	Matrix(const Matrix& other);
+	/**
+	* Move Constructor. Takes over the resource of the argument Matrix without copying it. The argument Matrix is left in an invalid state.
+	* @param other The other Matrix to move from.
+	*/
+	Matrix(Matrix&& other) noexcept;
+	/**
+	* Evaluates an element-wise expression (e.g. A + B - 2.0 * C) in a single pass, with a single allocation for the result. The result is a DenseMatrix if any of the operands is a DenseMatrix, otherwise it is a SparseMatrix.
+	* The matrix is invalid if any of the operands is invalid, or if the dimensions of the operands do not match.
+	* @param expression The expression to be evaluated.
+	*/
+	template <typename Expression>
+	Matrix(const MatrixExpression<Expression>& expression);
 
 	/**
 	* Checks whether or not this Matrix and the argument Matrix are equal. Returns false if either of the matrices is in an invalid state.
@@ -34,41 +51,46 @@ public:
 	*/
 	bool operator!=(const Matrix& right);
 	/**
-	* Performs matrix addition. Returns an invalid matrix if either of the arguments were invalid.
+	* Performs matrix multiplication. Returns an invalid matrix if either of the arguments were invalid or if the dimensions do not match. Products are always evaluated eagerly.
+	* Transposed matrices (see transpose) are multiplied without being transposed first.
 	* @param right The other Matrix.
-	* @return The result of the addition.
+	* @return The result of the multiplication.
 	*/
-	Matrix operator+(const Matrix& right);
+	Matrix operator*(const Matrix& right) const;
 	/**
-	* Performs matrix subtraction. Returns an invalid matrix if either of the arguments were invalid.
+	* Adds the argument to this matrix in place. If the formats match, no memory is allocated. This matrix becomes invalid if the argument is invalid or if the dimensions do not match.
 	* @param right The other Matrix.
-	* @return The result of the subtraction.
+	* @return Reference to this matrix.
 	*/
-	Matrix operator-(const Matrix& right);
+	Matrix& operator+=(const Matrix& right);
 	/**
-	* Performs matrix multiplication. Returns an invalid matrix if either of the arguments were invalid.
+	* Subtracts the argument from this matrix in place. If the formats match, no memory is allocated. This matrix becomes invalid if the argument is invalid or if the dimensions do not match.
 	* @param right The other Matrix.
-	* @return The result of the multiplication.
-	*/
-	Matrix operator*(const Matrix& right);
-	/**
-	* Returns a scaled copy of the matrix. Returns an invalid matrix if the current matrix was invalid.
-	* @param scalar Double precision floating point value by which to scale the matrix.
-	* @return The result of the scaling operation.
+	* @return Reference to this matrix.
 	*/
-	Matrix operator*(double scalar);
+	Matrix& operator-=(const Matrix& right);
 	/**
-	* Returns a scaled copy of the matrix. Returns an invalid matrix if the current matrix was invalid. This particular method is for when the scalar is on the right hand side.
-	* @param scalar Double precision floating point value by which to scale the matrix.
-	* @param right The other Matrix.
-	* @return The result of the scaling operation.
+	* Scales this matrix in place. Does nothing if this matrix is invalid.
+	* @param scalar Double precision floating point value by which to scale this matrix.
+	* @return Reference to this matrix.
 	*/
-	friend Matrix operator*(double scalar, const Matrix& right);
+	Matrix& operator*=(double scalar);
 	/**
 	* Copy Assignment Operator. Performs a deep copy on the argument Matrix's resource and deletes the old resource.
 	*/
 	Matrix& operator=(const Matrix& other);
 	/**
+	* Move Assignment Operator. Deletes the old resource and takes over the resource of the argument Matrix without copying it. The argument Matrix is left in an invalid state.
+	*/
+	Matrix& operator=(Matrix&& other) noexcept;
+	/**
+	* Evaluates an element-wise expression in a single pass and assigns the result to this matrix. The expression is allowed to refer to this matrix (e.g. A = A + B).
+	* @param expression The expression to be evaluated.
+	* @see Matrix(const MatrixExpression<Expression>&)
+	*/
+	template <typename Expression>
+	Matrix& operator=(const MatrixExpression<Expression>& expression);
+	/**
 	* Destructor. Calls destroyResource method. Deallocates the resource if it's not nullptr.
 	* @see destroyResource()
 	*/
@@ -104,6 +126,14 @@ public:
 	*/
 	void setCell(size_t row, size_t column, double value);
 	/**
+	* Sets a cell and its mirror cell (column, row) to the given value, so a symmetric matrix (see createSymmetric) stays symmetric. The method is a "no-op" if the matrix is invalid.
+	* setCell changes exactly one cell, so setting an off-diagonal cell of a symmetric matrix with it turns the matrix into a general matrix.
+	* @param row Row index of the matrix.
+	* @param column Column index of the matrix.
+	* @param value The value to be set in the cells.
+	*/
+	void setSymmetricCell(size_t row, size_t column, double value);
+	/**
 	* Resizes the number of rows of the matrix. The method is a "no-op" if the matrix is invalid.
 	* @param newNumRows If the argument is less than current num rows, the 'extra part' is truncated. If the argument is greater, then the new cells are initialized to zero.
 	*/
@@ -120,10 +150,16 @@ public:
 	*/
 	void resize(size_t newNumRows, size_t newNumColumns);
 	/**
-	* Transposes the matrix. The method is a "no-op" if the matrix is invalid.
+	* Transposes the matrix in O(1), by flipping a flag; the elements are not moved. The method is a "no-op" if the matrix is invalid.
+	* Multiplication, the determinant, the rank, the inverse, the sub-matrices and the other operations which can work on the transpose directly respect the flag. The non-const operations which need the transposed layout (e.g. resizing) transpose the elements once, and clear the flag; the const ones (e.g. printing) work on a transposed copy, so that they never modify a Matrix which may be read concurrently.
 	*/
 	void transpose();
 	/**
+	* Transposes the resource in place if this matrix is flagged as transposed (see transpose), and clears the flag. The value of the matrix doesn't change. The method is a "no-op" if the matrix is invalid.
+	* The const members read a flagged matrix through a transposed copy, made again on every call (e.g. getPrintStr, solveFor, getRank, solveLeastSquares). Call this once before reading a transposed matrix repeatedly. The non-const members call it themselves when they need to.
+	*/
+	void applyTranspose();
+	/**
 	* Gets the Sparsity value of the matrix. Sparsity is the ratio of numZeroElements/numTotalElements. Returns quiet NaN (Not a Number) if the matrix is invalid.
 	* @see MatrixBase::SparsityThreshold
 	* @return Sparsity floating point value between 0 and 1. The SparsityThreshold value itself is NOT considered Sparse. It is reserved for Density.
@@ -136,6 +172,10 @@ public:
 	*/
 	double getDensity() const;
 	/**
+	* Returns the number of non-zero elements of the matrix. Returns zero if the matrix is invalid.
+	*/
+	size_t getNumNonZeros() const;
+	/**
 	* Checks if the matrix's Sparsity is greater than SparsityThreshold. Also returns false if the matrix is invalid.
 	* @see MatrixBase::SparsityThreshold
 	* @see getSparsity()
@@ -158,8 +198,14 @@ public:
 	*/
 	void toSparse();
 	/**
-	* Checks whether or not the MatrixBase instance requires conversion to another MatrixBase instance. Also returns false if the matrix is invalid.
-	* @see MatrixBase::DensityThreshold
+	* Converts the underlying resource to TiledMatrix, whose tiles pick their own storage. The method is a "no-op" if the matrix is invalid.
+	* @param tileSize The number of rows (and columns) of a tile.
+	* @see TiledMatrix
+	*/
+	void toTiled(size_t tileSize = TiledMatrix::DefaultTileSize);
+	/**
+	* Checks whether or not the MatrixBase instance requires conversion to another MatrixBase instance, according to the cost model. Also returns false if the matrix is invalid.
+	* @see MatrixCostModel
 	* @see getDensity()
 	* @see isDense()
 	* @return True if it requires conversion, false if not. Also returns false if the matrix is invalid.
@@ -241,6 +287,17 @@ public:
 	*/
 	Matrix getSubMatrixBottomRight(size_t ignoredRowIndex, size_t ignoredColumnIndex) const;
 	/**
+	* Gets a non-owning view over a rectangular part of this matrix, without copying anything (see DenseMatrixView). The methods above return a Matrix, which owns a copy of its cells; read the part through a view instead when it is only read.
+	* Only a dense matrix can be viewed. The view of a transposed matrix swaps the strides, so it doesn't copy either. The view is invalidated when this matrix is modified or destroyed (see createFromView to keep its cells).
+	* @param subRowBeginIndex The beginning INDEX of the row of the view.
+	* @param subNumRows The number of rows of the view. This is not an index, it's a SIZE.
+	* @param subColumnBeginIndex The beginning INDEX of the column of the view.
+	* @param subNumColumns The number of columns of the view. This is not an index, it's a SIZE.
+	* @param out_view The view is stored into it. Left unchanged if the method returns false.
+	* @return False if this matrix is invalid or not dense, or the part is empty or out of bounds.
+	*/
+	bool getSubView(size_t subRowBeginIndex, size_t subNumRows, size_t subColumnBeginIndex, size_t subNumColumns, DenseMatrixView* out_view) const;
+	/**
 	* Calculates the determinant of the matrix using Laplace Expansion. The matrix is assumed to be square. Returns quiet NaN (Not a Number) if the matrix is invalid.
 	* @return A double precision floating point value containing the determinant of this matrix.
 	*/
@@ -271,11 +328,117 @@ public:
 	*/
 	std::string solveFor(const Matrix& augmentedColumn, bool verbose, size_t doublePrecision) const;
 	/**
-	* Performs Gaussian Elimination and finds the rank from the Reduced Echelon Form of this matrix. Uses a DenseMatrix copy to perform the operation. Returns zero if the matrix was invalid.
+	* Calculates the rank of this matrix. Structured matrices know their rank; the others use rank-revealing QR on a DenseMatrix copy. Returns zero if the matrix was invalid.
 	* @see DenseMatrix::getRank()
 	* @return The rank of this matrix.
 	*/
 	size_t getRank() const;
+	/**
+	* Calculates the numerical rank of this matrix with rank-revealing QR, using the given tolerance, and finds the columns which make up a basis of its column space. Uses a DenseMatrix copy to perform the operation. Returns zero if the matrix was invalid.
+	* @see mck::getRank()
+	* @param tolerance The relative tolerance under which the diagonal elements of R are considered to be zero.
+	* @param out_independentColumns A pointer to the vector to which the indices of "rank" linearly independent columns are meant to be stored, in the order in which they were pivoted. May be nullptr.
+	* @return The rank of this matrix.
+	*/
+	size_t getRank(double tolerance, std::vector<size_t>* out_independentColumns) const;
+	/**
+	* Computes the singular value decomposition (this == U * S * transpose(V)) on a DenseMatrix copy (see mck::computeSVD). If the matrix is invalid, the singular values are empty and U and V are invalid.
+	* @param isThin True for the thin (economy) decomposition, which keeps only min(numRows, numColumns) columns of U and V. Prefer it for tall matrices.
+	* @param out_u A pointer to the Matrix to which U is meant to be stored. May be nullptr.
+	* @param out_singularValues A pointer to the vector to which the singular values are meant to be stored, in descending order. This is an output variable, the user must declare the necessary variable before calling this method.
+	* @param out_v A pointer to the Matrix to which V is meant to be stored. May be nullptr.
+	*/
+	void getSVD(bool isThin, Matrix* out_u, std::vector<double>* out_singularValues, Matrix* out_v) const;
+	/**
+	* Returns the Moore-Penrose pseudo-inverse of this matrix, from its singular value decomposition. Unlike getInverse, it exists for singular and rectangular matrices as well. Returns an invalid matrix if the matrix was invalid.
+	* @see mck::getPseudoInverse()
+	* @param tolerance The relative tolerance under which a singular value is considered to be zero.
+	* @return The (numColumns x numRows) pseudo-inverse.
+	*/
+	Matrix getPseudoInverse(double tolerance) const;
+	/**
+	* Returns the 2-norm (the largest singular value) of this matrix. Returns quiet NaN (Not a Number) if the matrix is invalid.
+	*/
+	double getNorm2() const;
+	/**
+	* Returns the 2-norm condition number (the ratio of the largest singular value to the smallest one) of this matrix. Infinity if the matrix is singular. Returns quiet NaN (Not a Number) if the matrix is invalid.
+	*/
+	double getConditionNumber() const;
+	/**
+	* Calculates the numerical rank of this matrix from its singular values, which is the most reliable way to find the rank of an ill-conditioned matrix. Returns zero if the matrix was invalid.
+	* @see mck::getNumericalRank()
+	* @param tolerance The relative tolerance under which a singular value is considered to be zero.
+	* @return The numerical rank of this matrix.
+	*/
+	size_t getNumericalRank(double tolerance) const;
+	/**
+	* Computes the eigenvalues, and optionally the eigenvectors, of this matrix if it is symmetric (see mck::computeSymmetricEigen). Symmetry is detected automatically.
+	* @param out_eigenvalues A pointer to the vector to which the eigenvalues are meant to be stored, in ascending order. This is an output variable, the user must declare the necessary variable before calling this method.
+	* @param out_eigenvectors A pointer to the Matrix to which the orthonormal eigenvectors are meant to be stored as columns. May be nullptr, which skips computing them (much faster for large matrices).
+	* @return True on success. False if the matrix is invalid or not symmetric; the eigenvalues are empty and the eigenvectors are invalid then.
+	*/
+	bool getSymmetricEigen(std::vector<double>* out_eigenvalues, Matrix* out_eigenvectors) const;
+	/**
+	* Computes the (possibly complex) eigenvalues of this matrix, and optionally its real Schur decomposition (this == Z * T * transpose(Z)), with Hessenberg reduction and Francis QR steps (see mck::computeEigenvalues). Symmetric matrices are detected automatically, and take the faster symmetric path.
+	* @param out_eigenvalues A pointer to the vector to which the eigenvalues are meant to be stored, in the order in which they appear on the diagonal of T; complex conjugate pairs are adjacent. This is an output variable, the user must declare the necessary variable before calling this method.
+	* @param out_schurForm A pointer to the Matrix to which the quasi-triangular T is meant to be stored. May be nullptr.
+	* @param out_schurVectors A pointer to the Matrix to which the orthogonal Z (the Schur vectors, as columns) is meant to be stored. May be nullptr.
+	* @return True on success. False if the matrix is invalid or not square; the eigenvalues are empty and the other outputs are invalid then.
+	*/
+	bool getEigenvalues(std::vector<std::complex<double>>* out_eigenvalues, Matrix* out_schurForm, Matrix* out_schurVectors) const;
+	/**
+	* Performs the BLAS-style "axpy" operation in place: this = alpha * x + this. If the formats match, no memory is allocated. This matrix becomes invalid if the argument is invalid or if the dimensions do not match.
+	* @param alpha Scalar value by which x is scaled.
+	* @param x The Matrix which is scaled and added to this matrix.
+	*/
+	void axpy(double alpha, const Matrix& x);
+	/**
+	* Performs the BLAS-style "gemm" operation in place: this = alpha * left * right + beta * this. If every matrix is Dense, no memory is allocated. If beta is zero, the existing values of this matrix are ignored.
+	* This matrix may be one of the operands, in which case the product is computed into a temporary first. This matrix becomes invalid if any of the arguments is invalid or if the dimensions do not match.
+	* @param alpha Scalar value by which the product is scaled.
+	* @param left The left operand of the product.
+	* @param right The right operand of the product.
+	* @param beta Scalar value by which this matrix is scaled before the product is accumulated.
+	*/
+	void gemm(double alpha, const Matrix& left, const Matrix& right, double beta);
+	/**
+	* Calculates (op(this) * op(right)), where op transposes its operand if its flag is set. Returns an invalid matrix if either of the matrices is invalid or if the dimensions of the (transposed) operands do not match.
+	* The transposes are not materialized when right is Dense (see DenseMatrix::multiplyTransposed), when right is Sparse and this matrix is Dense (see SparseMatrix::multiplyTransposedRight and SparseMatrix::multiplyTransposedLeft), or when both flags are set (the product is the transpose of (right * this)).
+	* Otherwise the flagged operand is transposed into a temporary copy.
+	* @param right The right operand.
+	* @param transposeThis True to multiply the transpose of this matrix.
+	* @param transposeRight True to multiply by the transpose of right.
+	* @return The result of the multiplication.
+	*/
+	Matrix multiply(const Matrix& right, bool transposeThis, bool transposeRight) const;
+	/**
+	* Solves (this * X = rightHandSide) with a single precision LU factorization and double precision iterative refinement, which falls back to double precision LU if refinement stagnates (see mck::solveMixedPrecision).
+	* Returns an invalid matrix if either of the matrices is invalid, if this matrix isn't square, if the number of rows don't match, or if this matrix is numerically singular.
+	* @param rightHandSide The right hand side(s), one per column.
+	* @param out_numRefinementSteps A pointer to the size_t to which the number of refinement steps is meant to be stored. May be nullptr.
+	* @param out_backwardError A pointer to the double to which the final normwise backward error is meant to be stored. May be nullptr.
+	* @param out_isDoublePrecision A pointer to the bool to which true is meant to be stored if refinement fell back to double precision LU. May be nullptr.
+	* @return The solution.
+	*/
+	Matrix solveMixedPrecision(const Matrix& rightHandSide, size_t* out_numRefinementSteps, double* out_backwardError, bool* out_isDoublePrecision) const;
+	/**
+	* Solves (op(this) * X = rightHandSide) for a triangular matrix by forward or back substitution, where op transposes this matrix if transposeThis is set (see mck::solveTriangular). A transpose of this matrix is never materialized.
+	* Only the given triangle of this matrix is read. Returns an invalid matrix if either of the matrices is invalid, if this matrix isn't square, if the number of rows don't match, or if the diagonal has a zero.
+	* @param rightHandSide The right hand side(s), one per column.
+	* @param isLower True if this matrix is lower triangular, false if it is upper triangular. Ignored for a triangular matrix (see createTriangular), whose triangle is known by its type.
+	* @param transposeThis True to solve with the transpose of this matrix.
+	* @param hasUnitDiagonal True if the diagonal of this matrix is taken to be ones, whatever is stored there.
+	* @return The solution.
+	*/
+	Matrix solveTriangular(const Matrix& rightHandSide, bool isLower, bool transposeThis, bool hasUnitDiagonal) const;
+	/**
+	* Finds the least-squares solution X of (this * X = rightHandSide): the X which minimizes the 2-norm of the residual (this * X - rightHandSide), column by column. Uses Householder QR on a DenseMatrix copy (see mck::solveLeastSquares).
+	* Unlike solveFor, the system may be overdetermined. Returns an invalid matrix if either of the matrices is invalid, if the number of rows don't match, if this matrix has fewer rows than columns, or if its columns are linearly dependent.
+	* @param rightHandSide The right hand side(s), one per column.
+	* @param out_residualNorm A pointer to the double to which the 2-norm of the residual is meant to be stored (the Frobenius norm, for multiple right hand sides). May be nullptr.
+	* @return The least-squares solution.
+	*/
+	Matrix solveLeastSquares(const Matrix& rightHandSide, double* out_residualNorm) const;
 
 	/**
 	* A static method to create a DenseMatrix. If any of the dimensions is less than 1, the DenseMatrix is in invalid state, but no exception is thrown. Use at your own risk.
@@ -286,6 +449,12 @@ public:
 	*/
 	static Matrix createDense(size_t numRows, size_t numColumns, double initialValues);
 	/**
+	* A static method to copy the cells of a view (see getSubView) into a new matrix. The non-zeros are counted on the view first, so the cells are copied once, straight into the storage which suits them (see MatrixCostModel).
+	* @param view The view to be copied. If it is empty, the matrix is in invalid state.
+	* @return A DenseMatrix or a SparseMatrix, which has the same cells as the view.
+	*/
+	static Matrix createFromView(const DenseMatrixView& view);
+	/**
 	* A static method to create a SparseMatrix. Initially, every cell of a SparseMatrix is set to zero. If any of the dimensions is less than 1, the SparseMatrix is in invalid state, but no exception is thrown. Use at your own risk.
 	* @param numRows The number of rows for the SparseMatrix.
 	* @param numColumns The number of columns for the SparseMatrix.
@@ -300,22 +469,183 @@ public:
 	*/
 	static Matrix createZero(size_t numRows, size_t numColumns);
 	/**
-	* A static method to create an identity matrix. An identity matrix is inherently Sparse, so it will return a Sparse Matrix. An identity matrix is square, therefore there's only a single parameter to specify the dimensions. If the dimension is less than 1, the matrix is in an invalid state, but no exception is thrown. Use at your own risk.
+	* A static method to create a zero TiledMatrix. Every tile is an all-zero tile until its cells are set.
+	* @param numRows The number of rows for the matrix.
+	* @param numColumns The number of columns for the matrix.
+	* @param tileSize The number of rows (and columns) of a tile.
+	* @return A tiled zero matrix, as requested.
+	*/
+	static Matrix createTiled(size_t numRows, size_t numColumns, size_t tileSize = TiledMatrix::DefaultTileSize);
+	/**
+	* A static method to create an identity matrix. It only stores its dimensions (see IdentityMatrix), and is replaced by a general matrix as soon as it is modified. An identity matrix is square, therefore there's only a single parameter to specify the dimensions. If the dimension is less than 1, the matrix is in an invalid state, but no exception is thrown. Use at your own risk.
 	* @param numDimensions The number of rows and columns for the identity matrix.
 	* @return An identity matrix, as requsted.
 	*/
 	static Matrix createIdentity(size_t numDimensions);
+	/**
+	* A static method to create a diagonal matrix, which only stores its diagonal (see DiagonalMatrix).
+	* @param diagonal The elements of the main diagonal, from the top left to the bottom right.
+	* @return A diagonal matrix, as requested.
+	*/
+	static Matrix createDiagonal(const std::vector<double>& diagonal);
+	/**
+	* A static method to create a permutation matrix, which only stores the column index of the 1.0 of each row (see PermutationMatrix). Returns an invalid matrix if the argument is not a permutation.
+	* @param columnOfRow The column index of the 1.0 of each row. Each index in [0, columnOfRow.size()) must appear exactly once.
+	* @return A permutation matrix, as requested.
+	*/
+	static Matrix createPermutation(const std::vector<size_t>& columnOfRow);
+	/**
+	* A static method to create a zero triangular matrix, which only stores its triangle (see TriangularMatrix). Setting a cell outside of the triangle to a non-zero value turns it into a general matrix.
+	* @param numDimensions The number of rows and columns for the triangular matrix.
+	* @param isUpper True for an upper triangular matrix, false for a lower triangular matrix.
+	* @return A triangular matrix, as requested.
+	*/
+	static Matrix createTriangular(size_t numDimensions, bool isUpper);
+	/**
+	* A static method to create a zero symmetric matrix, which only stores its upper triangle (see SymmetricMatrix). Use setSymmetricCell to fill it: setCell changes a single cell, so it turns the matrix into a general matrix when the mirror cell holds another value.
+	* @param numDimensions The number of rows and columns for the symmetric matrix.
+	* @return A symmetric matrix, as requested.
+	*/
+	static Matrix createSymmetric(size_t numDimensions);
 
 private:
 	/**
 	* The resource MatrixBase wrapped by this class Matrix.
 	*/
 	MatrixBase* matrixPtr;
+	/**
+	* True if this Matrix is the transpose of the resource (see transpose). The const members never clear it: they read the resource through a transposed view or a transposed copy (see getResourceInLayout).
+	*/
+	bool isTransposed;
 
 	/**
 	* Deallocates the resource if it's not nullptr. Mainly used in the Destructor and the Copy Assignment Operator.
 	*/
 	void destroyResource();
+	/**
+	* Replaces a structured resource (see StructuredMatrix) by a general copy of it (DenseMatrix or SparseMatrix). Called before the in-place operations which would break the structure. Does nothing for the other resources.
+	*/
+	void generalizeStructure();
+	/**
+	* Transposes the resource if the transpose flag differs from the given value, and sets the flag to it. The Matrix represents the same values before and after the call.
+	* @param newIsTransposed The new value of the transpose flag.
+	*/
+	void setResourceLayout(bool newIsTransposed);
+	/**
+	* Returns the resource in the order it is seen through this Matrix without modifying it: the resource itself, or a transposed copy of it if the transpose flag is set.
+	* Used by the const members and for the const operands, so that concurrent reads of a Matrix never write to its resource.
+	* @param out_transposedCopy A pointer to the pointer to which the transposed copy is meant to be stored, or nullptr if no copy was needed. The caller must delete it.
+	* @return A raw pointer to the resource or to its transposed copy.
+	*/
+	const MatrixBase* getResourceInLayout(MatrixBase** out_transposedCopy) const;
+	/**
+	* Evaluates an element-wise expression into a newly allocated MatrixBase instance. Returns nullptr if the expression is invalid.
+	* @param expression The expression to be evaluated.
+	* @return A raw pointer to MatrixBase instance.
+	*/
+	template <typename Expression>
+	static MatrixBase* evaluateExpression(const Expression& expression);
+
+	friend class MatrixExpressionLeaf;
 };
 
+// Expression template members. These must be defined in the header.
+
+inline MatrixExpressionLeaf::MatrixExpressionLeaf(const Matrix& matrix)
+	: matrixPtr(matrix.matrixPtr),
+	denseOperand(dynamic_cast<const DenseMatrix*>(matrix.matrixPtr)),
+	isTransposed(matrix.isTransposed)
+{
+}
+
+template <typename Expression>
+Matrix::Matrix(const MatrixExpression<Expression>& expression)
+{
+	matrixPtr = evaluateExpression(expression.derived());
+	isTransposed = false;
+}
+
+template <typename Expression>
+Matrix& Matrix::operator=(const MatrixExpression<Expression>& expression)
+{
+	// Evaluate before destroying the old resource, because the expression may refer to this matrix.
+	MatrixBase* evaluated = evaluateExpression(expression.derived());
+
+	destroyResource();
+	matrixPtr = evaluated;
+
+	return *this;
+}
+
+template <typename Expression>
+MatrixBase* Matrix::evaluateExpression(const Expression& expression)
+{
+	if (expression.isValidExpression() == false)
+	{
+		return nullptr; // Invalid state.
+	}
+
+	size_t numRows = expression.getNumRows();
+	size_t numColumns = expression.getNumColumns();
+
+	if (expression.hasDenseOperand())
+	{
+		// Each row of the result is written once, while it is in the cache, by streaming the rows of the operands into it. No temporaries are created for the intermediate nodes.
+		DenseMatrix* dense = DenseMatrix::createUninitialized(numRows, numColumns);
+
+		for (size_t r = 0; r < numRows; r++)
+		{
+			expression.writeRow(r, 1.0, false, dense->getRowData(r));
+		}
+
+		return dense;
+	}
+
+	// Every operand is sparse (a SparseMatrix or a structured matrix). Only the coordinates which are non-zero in at least one operand can be non-zero in the result.
+	SparseMatrix* sparse = new SparseMatrix(numRows, numColumns);
+
+	expression.forEachNonZeroCoordinate([&](size_t row, size_t column)
+		{
+			sparse->setCell(row, column, expression.getCell(row, column));
+		});
+
+	return sparse;
+}
+
+/**
+* Helper for the product of expressions. A Matrix is used as it is; no copies are made.
+* @param matrix The Matrix operand.
+* @return The same Matrix.
+*/
+inline const Matrix& evaluateMatrixOperand(const Matrix& matrix)
+{
+	return matrix;
+}
+
+/**
+* Helper for the product of expressions. An expression is evaluated into a Matrix.
+* @param expression The expression operand.
+* @return The evaluated Matrix.
+*/
+template <typename Expression>
+Matrix evaluateMatrixOperand(const MatrixExpression<Expression>& expression)
+{
+	return Matrix(expression);
+}
+
+/**
+* Performs matrix multiplication of two expressions. Products are not fused: the operands are evaluated (if they are not matrices already), and then multiplied eagerly.
+* @param left The left operand.
+* @param right The right operand.
+* @return The result of the multiplication.
+*/
+template <typename Left, typename Right>
+Matrix operator*(const MatrixExpression<Left>& left, const MatrixExpression<Right>& right)
+{
+	const Matrix& evaluatedLeft = evaluateMatrixOperand(left.derived());
+	const Matrix& evaluatedRight = evaluateMatrixOperand(right.derived());
+
+	return evaluatedLeft * evaluatedRight;
+}
+
 #endif // MATRIX_H
@@ -1,6 +1,7 @@
 #ifndef MATRIX_BASE_H
 #define MATRIX_BASE_H
 
+#include "MatrixMemory.h"
 #include <vector>
 #include <functional>
 #include <sstream>
@@ -47,6 +48,21 @@ public:
 	*/
 	virtual ~MatrixBase() = default;
 	/**
+	* Allocates every matrix object through MatrixMemory, so that the default allocator (e.g. a pool) serves it.
+	* @see MatrixMemory
+	*/
+	static void* operator new(size_t numBytes)
+	{
+		return MatrixMemory::allocate(numBytes);
+	}
+	/**
+	* Releases a matrix object through the allocator which served it.
+	*/
+	static void operator delete(void* block)
+	{
+		MatrixMemory::deallocate(block);
+	}
+	/**
 	* Returns the number of rows of this matrix.
 	*/
 	virtual size_t getNumRows() const = 0;
@@ -69,6 +85,19 @@ public:
 	*/
 	virtual void setCell(size_t row, size_t column, double value) = 0;
 	/**
+	* Checks whether or not setCell can set a cell to a value without changing any other cell. True by default; a StructuredMatrix returns false when the value would break its structure, and the Matrix wrapper replaces it with a general copy first.
+	* @param row Row index of the matrix.
+	* @param column Column index of the matrix.
+	* @param value The value to be set in the cell.
+	*/
+	virtual bool canSetCell(size_t row, size_t column, double value) const
+	{
+		(void)row;
+		(void)column;
+		(void)value;
+		return true;
+	}
+	/**
 	* Resizes the number of rows of the matrix.
 	* @param newNumRows If the argument is less than current num rows, the 'extra part' is truncated. If the argument is greater, then the new cells are initialized to zero.
 	*/
@@ -95,6 +124,10 @@ public:
 	*/
 	virtual double getSparsity() const = 0;
 	/**
+	* Returns the number of non-zero elements of this matrix. Elements which are approximately equal to zero (see mcu::doubleAlmostEqual) are considered zero.
+	*/
+	virtual size_t getNumNonZeros() const = 0;
+	/**
 	* Gets the Density value of the matrix. Density is the ratio of numNonZeroElements/numTotalElements.
 	* @see MatrixBase::DensityThreshold
 	* @return Density floating point value between 0 and 1. The DensityThreshold value itself IS considered Density.
@@ -115,8 +148,8 @@ public:
 	*/
 	virtual bool isDense() const = 0;
 	/**
-	* Checks whether or not the MatrixBase instance requires conversion to another MatrixBase instance.
-	* @see MatrixBase::DensityThreshold
+	* Checks whether or not the MatrixBase instance requires conversion to another MatrixBase instance. The decision is made by the cost model, not by DensityThreshold, so that matrices near the break-even point are not converted back and forth.
+	* @see MatrixCostModel
 	* @see getDensity()
 	* @see isDense()
 	* @return True if it requires conversion, false if not.
@@ -146,16 +179,51 @@ public:
 	*/
 	virtual SparseMatrix* cloneAsSparseMatrix() const = 0;
 	/**
-	* Creates a vector of 3-tuples. The first two size_t are the row & column data; the double is the value at the row & column coordinate. It makes it easier to use SparseMatrix. Acts as a short hack instead of writing a custom iterator.
-	* @return A vector of 3-tuples, which contains row & column coordinates; and their corresponding double value.
+	* Calls the visitor for every non-zero cell of this matrix, in row-major order. Nothing is allocated, unlike building a list of the cells would.
+	* @param visitor A function which takes the row index, the column index and the value of the cell.
 	*/
-	virtual std::vector<std::tuple<size_t, size_t, double>> getCellDataList() const = 0;
+	virtual void forEachNonZero(const std::function<void(size_t row, size_t column, double value)>& visitor) const = 0;
 	/**
 	* Scales every cell of this matrix by the given scalar value.
 	* @param scalar Scalar value to scale each cell.
 	*/
 	virtual void scale(double scalar) = 0;
 	/**
+	* Checks whether or not scale can apply the scalar to this matrix. True by default; a StructuredMatrix returns false when the scalar would break its structure (see canSetCell).
+	* @param scalar Scalar value to scale each cell.
+	*/
+	virtual bool canScale(double scalar) const
+	{
+		(void)scalar;
+		return true;
+	}
+	/**
+	* Adds the argument matrix, scaled by alpha, to this matrix in place (this = this + alpha * right). Method implements Double Dispatch. This particular method just calls the addScaledTo method on the argument to activate polymorphism. The dimensions must match, and the argument must not be this matrix.
+	* @param right The other MatrixBase.
+	* @param alpha Scalar value by which the argument is scaled before it is added.
+	*/
+	virtual void addInPlace(const MatrixBase& right, double alpha) = 0;
+	/**
+	* Adds this matrix, scaled by alpha, to the target DenseMatrix in place (target = target + alpha * this). Method implements Double Dispatch. This is meant to be called by the addInPlace method. Allocates nothing.
+	* @param target The DenseMatrix which is modified.
+	* @param alpha Scalar value by which this matrix is scaled before it is added.
+	*/
+	virtual void addScaledTo(DenseMatrix& target, double alpha) const = 0;
+	/**
+	* Adds this matrix, scaled by alpha, to the target SparseMatrix in place (target = target + alpha * this). Method implements Double Dispatch. This is meant to be called by the addInPlace method.
+	* @param target The SparseMatrix which is modified.
+	* @param alpha Scalar value by which this matrix is scaled before it is added.
+	*/
+	virtual void addScaledTo(SparseMatrix& target, double alpha) const = 0;
+	/**
+	* Performs the BLAS-style "gemm" operation in place: this = alpha * left * right + beta * this. The dimensions must match, and neither of the arguments may be this matrix. If beta is zero, the existing values of this matrix are ignored.
+	* @param alpha Scalar value by which the product is scaled.
+	* @param left The left operand of the product.
+	* @param right The right operand of the product.
+	* @param beta Scalar value by which this matrix is scaled before the product is accumulated.
+	*/
+	virtual void multiplyAccumulate(double alpha, const MatrixBase& left, const MatrixBase& right, double beta) = 0;
+	/**
 	* Checks if this matrix is equal to the argument matrix. Method implements Double Dispatch. This particular method just calls the equal method on the argument to activate polymorphism.
 	* @param right The other MatrixBase.
 	* @return True if equal, false if not equal.
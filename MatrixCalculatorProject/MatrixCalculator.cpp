@@ -95,6 +95,14 @@ void MatrixCalculator::initializeCommands()
 	commands["det"] = Command::det;
 	commands["rank"] = Command::rank;
 	commands["solvefor"] = Command::solvefor;
+	commands["lstsq"] = Command::lstsq;
+	commands["trisolve"] = Command::trisolve;
+	commands["mpsolve"] = Command::mpsolve;
+	commands["svd"] = Command::svd;
+	commands["pinv"] = Command::pinv;
+	commands["norm2"] = Command::norm2;
+	commands["cond"] = Command::cond;
+	commands["eig"] = Command::eig;
 	commands["getcell"] = Command::getcell;
 	commands["setcell"] = Command::setcell;
 	commands["density"] = Command::density;
@@ -223,6 +231,31 @@ bool MatrixCalculator::variableNameExists(std::string varName)
 	return varName_matrix_map.find(varName) != varName_matrix_map.end();
 }
 
+void MatrixCalculator::storeVariableInLayout(std::string varName)
+{
+	varName_matrix_map[varName].applyTranspose();
+}
+
+bool MatrixCalculator::readOperandName(std::string str, std::string* out_varName, bool* out_isTransposed)
+{
+	*out_varName = str;
+	*out_isTransposed = false;
+
+	if (variableNameExists(str))
+	{
+		return true;
+	}
+
+	if (str.size() > 1 && str.back() == '\'')
+	{
+		*out_varName = str.substr(0, str.size() - 1);
+		*out_isTransposed = true;
+		return variableNameExists(*out_varName);
+	}
+
+	return false;
+}
+
 bool MatrixCalculator::readStringToUInt(std::string str, size_t* out_uint)
 {
 	if (out_uint == nullptr)
@@ -419,6 +452,30 @@ void MatrixCalculator::handleCommand(Command cmd)
 	case Command::solvefor:
 		handleCommand_solvefor();
 		break;
+	case Command::lstsq:
+		handleCommand_lstsq();
+		break;
+	case Command::trisolve:
+		handleCommand_trisolve();
+		break;
+	case Command::mpsolve:
+		handleCommand_mpsolve();
+		break;
+	case Command::svd:
+		handleCommand_svd();
+		break;
+	case Command::pinv:
+		handleCommand_pinv();
+		break;
+	case Command::norm2:
+		handleCommand_norm2();
+		break;
+	case Command::cond:
+		handleCommand_cond();
+		break;
+	case Command::eig:
+		handleCommand_eig();
+		break;
 	case Command::getcell:
 		handleCommand_getcell();
 		break;
@@ -461,15 +518,23 @@ void MatrixCalculator::handleCommand_help()
 	std::cout << "> resize <matrix> <arg1> <arg2>\n\targ1: R to resize rows; C to resize columns\n\targ2: New num rows or columns\n\texample1: resize mat1 R 5\n\texample2: resize mat1 C 3" << std::endl;
 	std::cout << "> add <result> <operand1> <operand2>\n\texample: add mat3 mat1 mat2" << std::endl;
 	std::cout << "> sub <result> <operand1> <operand2>\n\tSubtracts operand2 from operand1 and stores the result in result.\n\texample: sub mat3 mat1 mat2" << std::endl;
-	std::cout << "> mul <result> <operand1> <operand2>\n\texample: mul mat3 mat1 mat2" << std::endl;
+	std::cout << "> mul <result> <operand1> <operand2>\n\tAn operand followed by an apostrophe is transposed, without being modified.\n\texample1: mul mat3 mat1 mat2\n\texample2: mul mat3 mat1' mat2" << std::endl;
 	std::cout << "> scale <operand> <scalar>\n\texample: scale mat1 -3.1415" << std::endl;
 	std::cout << "> transpose <operand>\n\texample: transpose mat1" << std::endl;
 	std::cout << "> split <result> <operand> <arg1> <arg2>\n\targ1: T for top; B for bottom; L for left; R for right.\n\targ2: If arg1 is T or B, then arg2 is 'topNumRows'. If arg1 is L or R, then arg2 is 'leftNumColumns'.\n\texample1: split mat1Top mat1 T 3\n\texample2: split mat1Bot mat B 3\n\texample3: split mat1Left mat1 L 5\n\texample4: split mat1Right mat1 R 5" << std::endl;
 	std::cout << "> merge <result> <operand1> <operand2> <arg1>\n\targ1: R to merge by rows; C to merge by columns.\n\texample1: merge mat1and2 mat1 mat2 R\n\texample2: merge mat1and2 mat1 mat2 C" << std::endl;
 	std::cout << "> invert <matrix>\n\texample: invert mat1" << std::endl;
 	std::cout << "> det <matrix>\n\texample: det mat1" << std::endl;
-	std::cout << "> rank <matrix>\n\texample: rank mat1" << std::endl;
+	std::cout << "> rank <matrix> <option1>\n\toption1: Tolerance (relative to the largest column norm). If specified, the indices of the linearly independent columns are shown as well.\n\texample1: rank mat1\n\texample2: rank mat1 1e-9" << std::endl;
 	std::cout << "> solvefor <matrix> <augmentedColumn> <arg1> <option1>\n\taugmentedColumn: Number of columns must be 1.\n\targ1: V for verbose; C for concise.\n\toption1: File name. File name cannot have white spaces. The '.txt' extension will be appended automatically.\n\tIf option1 is unspecified, the program will output to the console by default.\n\texample1: solvefor mat1 augCol1 V\n\texample2: solvefor mat1 augCol1 C\n\texample3: solvefor mat1 augCol1 V solution_set\n\texample4: solvefor mat1 augCol1 C solution_set" << std::endl;
+	std::cout << "> lstsq <result> <matrix> <rightHandSide>\n\tFinds the least-squares solution of (matrix * result = rightHandSide), and prints the norm of the residual.\n\tmatrix: Must have at least as many rows as columns, and linearly independent columns.\n\trightHandSide: May have more than 1 column; each column is solved separately.\n\texample: lstsq x mat1 col1" << std::endl;
+	std::cout << "> trisolve <result> <matrix> <rightHandSide> <arg1> <option1> <option2>\n\tSolves (matrix * result = rightHandSide) by forward or back substitution, reading only one triangle of matrix.\n\targ1: L for the lower triangle; U for the upper one.\n\toption1, option2: T to solve with the transpose of the triangle; 1 to take its diagonal as ones.\n\trightHandSide: May have more than 1 column.\n\texample1: trisolve x mat1 col1 L\n\texample2: trisolve x mat1 col1 U T 1" << std::endl;
+	std::cout << "> mpsolve <result> <matrix> <rightHandSide>\n\tSolves (matrix * result = rightHandSide) with a single precision LU factorization refined in double precision, and prints the number of refinement steps and the backward error.\n\tIf refinement stagnates (an ill-conditioned matrix), double precision LU is used instead.\n\trightHandSide: May have more than 1 column.\n\texample: mpsolve x mat1 col1" << std::endl;
+	std::cout << "> svd <U> <S> <V> <matrix> <option1>\n\tStores the factors of (matrix = U * S * transpose(V)); the singular values on the diagonal of S are in descending order.\n\toption1: E for the economy (thin) decomposition (default); F for the full one.\n\texample1: svd u s v mat1\n\texample2: svd u s v mat1 F" << std::endl;
+	std::cout << "> pinv <result> <matrix> <option1>\n\toption1: Tolerance (relative to the largest singular value) under which singular values are treated as zeros.\n\texample1: pinv mat1Pinv mat1\n\texample2: pinv mat1Pinv mat1 1e-9" << std::endl;
+	std::cout << "> norm2 <matrix>\n\tOutputs the 2-norm (the largest singular value) of the matrix.\n\texample: norm2 mat1" << std::endl;
+	std::cout << "> cond <matrix>\n\tOutputs the 2-norm condition number (the ratio of the largest singular value to the smallest one) of the matrix.\n\texample: cond mat1" << std::endl;
+	std::cout << "> eig <matrix> <option1>\n\tOutputs the eigenvalues of a square matrix. Those of a symmetric matrix are real, and in ascending order; the others may be complex conjugate pairs.\n\toption1: Variable name. If specified, the eigenvectors of a symmetric matrix (or the Schur vectors of a nonsymmetric one) are stored into it as columns.\n\texample1: eig mat1\n\texample2: eig mat1 mat1Vectors" << std::endl;
 	std::cout << "> getcell <matrix> <row> <column>\n\tRow and column indices are zero based.\n\texample: getcell mat1 2 3" << std::endl;
 	std::cout << "> setcell <matrix> <row> <column> <value>\n\tRow and column indices are zero based.\n\texample: setcell mat1 2 3 -3.1415" << std::endl;
 	std::cout << "> density <matrix>\n\tOutputs a value between 0 and 1 which represents the density of the matrix.\n\texample: density mat1" << std::endl;
@@ -728,6 +793,8 @@ void MatrixCalculator::handleCommand_print()
 		return;
 	}
 
+	storeVariableInLayout(varName);
+
 	std::string fileName = "";
 	bool outputToFile = false;
 	if (inputList.size() == 3)
@@ -1150,26 +1217,31 @@ void MatrixCalculator::handleCommand_mul()
 	}
 
 	std::string resultName = inputList[1];
-	std::string operand1Name = inputList[2];
-	std::string operand2Name = inputList[3];
+	std::string operand1Name;
+	std::string operand2Name;
+	bool isOperand1Transposed;
+	bool isOperand2Transposed;
 
-	if (!variableNameExists(operand1Name))
+	if (!readOperandName(inputList[2], &operand1Name, &isOperand1Transposed))
 	{
-		doPrint_varNameDoesNotExist(operand1Name);
+		doPrint_varNameDoesNotExist(inputList[2]);
 		return;
 	}
 
-	if (!variableNameExists(operand2Name))
+	if (!readOperandName(inputList[3], &operand2Name, &isOperand2Transposed))
 	{
-		doPrint_varNameDoesNotExist(operand2Name);
+		doPrint_varNameDoesNotExist(inputList[3]);
 		return;
 	}
 
 	bool overwriteExistingVariable = variableNameExists(resultName);
 
-	size_t op1numCols = varName_matrix_map[operand1Name].getNumColumns();
+	const Matrix& operand1 = varName_matrix_map[operand1Name];
+	const Matrix& operand2 = varName_matrix_map[operand2Name];
 
-	size_t op2numRows = varName_matrix_map[operand2Name].getNumRows();
+	size_t op1numCols = isOperand1Transposed ? operand1.getNumRows() : operand1.getNumColumns();
+
+	size_t op2numRows = isOperand2Transposed ? operand2.getNumColumns() : operand2.getNumRows();
 
 	if (op1numCols != op2numRows)
 	{
@@ -1177,7 +1249,16 @@ void MatrixCalculator::handleCommand_mul()
 		return;
 	}
 
-	varName_matrix_map[resultName] = varName_matrix_map[operand1Name] * varName_matrix_map[operand2Name];
+	if (isOperand1Transposed || isOperand2Transposed)
+	{
+		// The transposes are passed to the multiplication as flags, instead of being copied.
+		Matrix product = operand1.multiply(operand2, isOperand1Transposed, isOperand2Transposed);
+		varName_matrix_map[resultName] = std::move(product);
+	}
+	else
+	{
+		varName_matrix_map[resultName] = operand1 * operand2;
+	}
 
 	if (varName_matrix_map[resultName].requiresConversion())
 	{
@@ -1189,7 +1270,7 @@ void MatrixCalculator::handleCommand_mul()
 		doPrint_overwrittenExistingVariable(resultName);
 	}
 
-	std::cout << "Multiplied '" << operand1Name << "' by '" << operand2Name << "' and the result was stored into '" << resultName << "'." << std::endl << std::endl;
+	std::cout << "Multiplied '" << inputList[2] << "' by '" << inputList[3] << "' and the result was stored into '" << resultName << "'." << std::endl << std::endl;
 }
 
 void MatrixCalculator::handleCommand_scale()
@@ -1283,6 +1364,12 @@ void MatrixCalculator::handleCommand_split()
 	size_t opNumRows = varName_matrix_map[operandName].getNumRows();
 	size_t opNumCols = varName_matrix_map[operandName].getNumColumns();
 
+	// The requested part of the operand.
+	size_t subRowBeginIndex = 0;
+	size_t subNumRows = opNumRows;
+	size_t subColumnBeginIndex = 0;
+	size_t subNumColumns = opNumCols;
+
 	// Do checks for rows and columns based on which part of the matrix is requested.
 	if (arg1 == 't')
 	{
@@ -1297,7 +1384,7 @@ void MatrixCalculator::handleCommand_split()
 			return;
 		}
 
-		varName_matrix_map[resultName] = varName_matrix_map[operandName].splitByRow(arg2, true);
+		subNumRows = arg2;
 	}
 	else if (arg1 == 'b')
 	{
@@ -1312,7 +1399,8 @@ void MatrixCalculator::handleCommand_split()
 			return;
 		}
 
-		varName_matrix_map[resultName] = varName_matrix_map[operandName].splitByRow(arg2, false);
+		subRowBeginIndex = arg2;
+		subNumRows = opNumRows - arg2;
 	}
 	else if (arg1 == 'l')
 	{
@@ -1327,7 +1415,7 @@ void MatrixCalculator::handleCommand_split()
 			return;
 		}
 
-		varName_matrix_map[resultName] = varName_matrix_map[operandName].splitByColumn(arg2, true);
+		subNumColumns = arg2;
 	}
 	else /*if (arg1 == 'r') */
 	{
@@ -1342,7 +1430,21 @@ void MatrixCalculator::handleCommand_split()
 			return;
 		}
 
-		varName_matrix_map[resultName] = varName_matrix_map[operandName].splitByColumn(arg2, false);
+		subColumnBeginIndex = arg2;
+		subNumColumns = opNumCols - arg2;
+	}
+
+	// A dense operand is read through a view, so the part is copied once, straight into the storage which suits it.
+	const Matrix& operand = varName_matrix_map[operandName];
+	DenseMatrixView part;
+
+	if (operand.getSubView(subRowBeginIndex, subNumRows, subColumnBeginIndex, subNumColumns, &part))
+	{
+		varName_matrix_map[resultName] = Matrix::createFromView(part);
+	}
+	else
+	{
+		varName_matrix_map[resultName] = operand.getSubMatrix(subRowBeginIndex, subNumRows, subColumnBeginIndex, subNumColumns);
 	}
 
 	if (varName_matrix_map[resultName].requiresConversion())
@@ -1538,7 +1640,7 @@ void MatrixCalculator::handleCommand_det()
 
 void MatrixCalculator::handleCommand_rank()
 {
-	if (inputList.size() != 2)
+	if (inputList.size() != 2 && inputList.size() != 3)
 	{
 		doPrint_invalidInput();
 		return;
@@ -1551,7 +1653,33 @@ void MatrixCalculator::handleCommand_rank()
 		return;
 	}
 
-	std::cout << "rk(" << varName << ") = " << varName_matrix_map[varName].getRank() << std::endl << std::endl;
+	storeVariableInLayout(varName);
+
+	if (inputList.size() == 2)
+	{
+		std::cout << "rk(" << varName << ") = " << varName_matrix_map[varName].getRank() << std::endl << std::endl;
+		return;
+	}
+
+	double tolerance;
+	if (!readStringToDouble(inputList[2], &tolerance) || tolerance < 0)
+	{
+		std::cout << "Invalid input: The tolerance must be a non-negative number." << std::endl;
+		return;
+	}
+
+	std::vector<size_t> independentColumns;
+	size_t rank = varName_matrix_map[varName].getRank(tolerance, &independentColumns);
+
+	std::cout << "rk(" << varName << ") = " << rank << std::endl;
+	std::cout << "Independent columns:";
+
+	for (size_t i = 0; i < independentColumns.size(); i++)
+	{
+		std::cout << " " << independentColumns[i];
+	}
+
+	std::cout << std::endl << std::endl;
 }
 
 void MatrixCalculator::handleCommand_solvefor()
@@ -1608,6 +1736,8 @@ void MatrixCalculator::handleCommand_solvefor()
 		verbose = true;
 	}
 
+	storeVariableInLayout(matName);
+	storeVariableInLayout(augColName);
 	std::string solutionStr = varName_matrix_map[matName].solveFor(varName_matrix_map[augColName], verbose, doublePrintPrecision);
 
 	// Output
@@ -1643,6 +1773,473 @@ void MatrixCalculator::handleCommand_solvefor()
 	}
 }
 
+void MatrixCalculator::handleCommand_lstsq()
+{
+	if (inputList.size() != 4)
+	{
+		doPrint_invalidInput();
+		return;
+	}
+
+	std::string resultName = inputList[1];
+	std::string matName = inputList[2];
+	std::string rhsName = inputList[3];
+
+	if (!variableNameExists(matName))
+	{
+		doPrint_varNameDoesNotExist(matName);
+		return;
+	}
+
+	if (!variableNameExists(rhsName))
+	{
+		doPrint_varNameDoesNotExist(rhsName);
+		return;
+	}
+
+	storeVariableInLayout(matName);
+	storeVariableInLayout(rhsName);
+	const Matrix& matrix = varName_matrix_map[matName];
+	const Matrix& rightHandSide = varName_matrix_map[rhsName];
+
+	if (matrix.getNumRows() != rightHandSide.getNumRows())
+	{
+		std::cout << "Invalid input: The matrix and the right hand side have mismatching number of rows." << std::endl;
+		return;
+	}
+
+	if (matrix.getNumRows() < matrix.getNumColumns())
+	{
+		std::cout << "Invalid input: The matrix has fewer rows than columns (underdetermined system)." << std::endl;
+		return;
+	}
+
+	double residualNorm = 0.0;
+	Matrix solution = matrix.solveLeastSquares(rightHandSide, &residualNorm);
+
+	if (solution.getNumRows() == 0)
+	{
+		std::cout << "Least squares failed: The columns of matrix '" << matName << "' are linearly dependent (rank deficient)." << std::endl;
+		return;
+	}
+
+	bool overwriteExistingVariable = variableNameExists(resultName);
+
+	varName_matrix_map[resultName] = std::move(solution);
+
+	if (overwriteExistingVariable)
+	{
+		doPrint_overwrittenExistingVariable(resultName);
+	}
+
+	std::cout << "Stored the least-squares solution of '" << matName << "' and '" << rhsName << "' into '" << resultName << "'." << std::endl;
+	std::cout << "Residual norm = " << std::setprecision(doublePrintPrecision) << residualNorm << std::endl << std::endl;
+}
+
+void MatrixCalculator::handleCommand_trisolve()
+{
+	if (inputList.size() < 5 || inputList.size() > 7)
+	{
+		doPrint_invalidInput();
+		return;
+	}
+
+	std::string resultName = inputList[1];
+	std::string matName = inputList[2];
+	std::string rhsName = inputList[3];
+	std::string triangleArg = inputList[4];
+
+	if (!variableNameExists(matName))
+	{
+		doPrint_varNameDoesNotExist(matName);
+		return;
+	}
+
+	if (!variableNameExists(rhsName))
+	{
+		doPrint_varNameDoesNotExist(rhsName);
+		return;
+	}
+
+	if (triangleArg != "L" && triangleArg != "U")
+	{
+		doPrint_invalidInput();
+		return;
+	}
+
+	bool isTransposed = false;
+	bool hasUnitDiagonal = false;
+
+	for (size_t i = 5; i < inputList.size(); i++)
+	{
+		if (inputList[i] == "T")
+		{
+			isTransposed = true;
+		}
+		else if (inputList[i] == "1")
+		{
+			hasUnitDiagonal = true;
+		}
+		else
+		{
+			doPrint_invalidInput();
+			return;
+		}
+	}
+
+	storeVariableInLayout(rhsName); // The transposed triangle is solved for as it is.
+	const Matrix& matrix = varName_matrix_map[matName];
+	const Matrix& rightHandSide = varName_matrix_map[rhsName];
+
+	if (matrix.getNumRows() != matrix.getNumColumns())
+	{
+		std::cout << "Invalid input: The matrix is not square." << std::endl;
+		return;
+	}
+
+	if (matrix.getNumRows() != rightHandSide.getNumRows())
+	{
+		std::cout << "Invalid input: The matrix and the right hand side have mismatching number of rows." << std::endl;
+		return;
+	}
+
+	Matrix solution = matrix.solveTriangular(rightHandSide, triangleArg == "L", isTransposed, hasUnitDiagonal);
+
+	if (solution.getNumRows() == 0)
+	{
+		std::cout << "Triangular solve failed: The diagonal of matrix '" << matName << "' has a zero." << std::endl;
+		return;
+	}
+
+	bool overwriteExistingVariable = variableNameExists(resultName);
+
+	varName_matrix_map[resultName] = std::move(solution);
+
+	if (overwriteExistingVariable)
+	{
+		doPrint_overwrittenExistingVariable(resultName);
+	}
+
+	std::cout << "Stored the solution of '" << matName << "' and '" << rhsName << "' into '" << resultName << "'." << std::endl << std::endl;
+}
+
+void MatrixCalculator::handleCommand_mpsolve()
+{
+	if (inputList.size() != 4)
+	{
+		doPrint_invalidInput();
+		return;
+	}
+
+	std::string resultName = inputList[1];
+	std::string matName = inputList[2];
+	std::string rhsName = inputList[3];
+
+	if (!variableNameExists(matName))
+	{
+		doPrint_varNameDoesNotExist(matName);
+		return;
+	}
+
+	if (!variableNameExists(rhsName))
+	{
+		doPrint_varNameDoesNotExist(rhsName);
+		return;
+	}
+
+	storeVariableInLayout(matName);
+	storeVariableInLayout(rhsName);
+	const Matrix& matrix = varName_matrix_map[matName];
+	const Matrix& rightHandSide = varName_matrix_map[rhsName];
+
+	if (matrix.getNumRows() != matrix.getNumColumns())
+	{
+		std::cout << "Invalid input: The matrix is not square." << std::endl;
+		return;
+	}
+
+	if (matrix.getNumRows() != rightHandSide.getNumRows())
+	{
+		std::cout << "Invalid input: The matrix and the right hand side have mismatching number of rows." << std::endl;
+		return;
+	}
+
+	size_t numRefinementSteps = 0;
+	double backwardError = 0.0;
+	bool isDoublePrecision = false;
+	Matrix solution = matrix.solveMixedPrecision(rightHandSide, &numRefinementSteps, &backwardError, &isDoublePrecision);
+
+	if (solution.getNumRows() == 0)
+	{
+		std::cout << "Mixed precision solve failed: Matrix '" << matName << "' is singular." << std::endl;
+		return;
+	}
+
+	bool overwriteExistingVariable = variableNameExists(resultName);
+
+	varName_matrix_map[resultName] = std::move(solution);
+
+	if (overwriteExistingVariable)
+	{
+		doPrint_overwrittenExistingVariable(resultName);
+	}
+
+	std::cout << "Stored the solution of '" << matName << "' and '" << rhsName << "' into '" << resultName << "'." << std::endl;
+
+	if (isDoublePrecision)
+	{
+		std::cout << "Refinement stagnated after " << numRefinementSteps << " steps; solved with double precision LU instead." << std::endl;
+	}
+	else
+	{
+		std::cout << "Refinement steps = " << numRefinementSteps << std::endl;
+	}
+
+	// The backward error is tiny, so it is printed in scientific notation whatever the current format is.
+	std::ios_base::fmtflags previousFlags = std::cout.flags();
+	std::cout << "Backward error = " << std::scientific << std::setprecision(doublePrintPrecision) << backwardError << std::endl << std::endl;
+	std::cout.flags(previousFlags);
+}
+
+void MatrixCalculator::handleCommand_svd()
+{
+	if (inputList.size() != 5 && inputList.size() != 6)
+	{
+		doPrint_invalidInput();
+		return;
+	}
+
+	std::string uName = inputList[1];
+	std::string sName = inputList[2];
+	std::string vName = inputList[3];
+	std::string matName = inputList[4];
+
+	if (!variableNameExists(matName))
+	{
+		doPrint_varNameDoesNotExist(matName);
+		return;
+	}
+
+	if (uName == sName || uName == vName || sName == vName)
+	{
+		std::cout << "Invalid input: U, S and V must be different variables." << std::endl;
+		return;
+	}
+
+	bool isThin = true;
+
+	if (inputList.size() == 6)
+	{
+		if (inputList[5] == "F")
+		{
+			isThin = false;
+		}
+		else if (inputList[5] != "E")
+		{
+			doPrint_invalidInput();
+			return;
+		}
+	}
+
+	const Matrix& matrix = varName_matrix_map[matName];
+	size_t numRows = matrix.getNumRows();
+	size_t numColumns = matrix.getNumColumns();
+
+	Matrix u;
+	Matrix v;
+	std::vector<double> singularValues;
+	matrix.getSVD(isThin, &u, &singularValues, &v);
+
+	Matrix s;
+
+	if (isThin)
+	{
+		s = Matrix::createDiagonal(singularValues);
+	}
+	else
+	{
+		s = Matrix::createSparse(numRows, numColumns);
+
+		for (size_t d = 0; d < singularValues.size(); d++)
+		{
+			s.setCell(d, d, singularValues[d]);
+		}
+	}
+
+	std::string names[3] = { uName, sName, vName };
+	Matrix* factors[3] = { &u, &s, &v };
+
+	for (size_t i = 0; i < 3; i++)
+	{
+		bool overwriteExistingVariable = variableNameExists(names[i]);
+
+		varName_matrix_map[names[i]] = std::move(*factors[i]);
+
+		if (overwriteExistingVariable)
+		{
+			doPrint_overwrittenExistingVariable(names[i]);
+		}
+	}
+
+	std::cout << "Stored the singular value decomposition of '" << matName << "' into '" << uName << "', '" << sName << "' and '" << vName << "'." << std::endl << std::endl;
+}
+
+void MatrixCalculator::handleCommand_pinv()
+{
+	if (inputList.size() != 3 && inputList.size() != 4)
+	{
+		doPrint_invalidInput();
+		return;
+	}
+
+	std::string resultName = inputList[1];
+	std::string matName = inputList[2];
+
+	if (!variableNameExists(matName))
+	{
+		doPrint_varNameDoesNotExist(matName);
+		return;
+	}
+
+	double tolerance = mcu::EPSILON;
+
+	if (inputList.size() == 4 && (!readStringToDouble(inputList[3], &tolerance) || tolerance < 0))
+	{
+		std::cout << "Invalid input: The tolerance must be a non-negative number." << std::endl;
+		return;
+	}
+
+	Matrix pseudoInverse = varName_matrix_map[matName].getPseudoInverse(tolerance);
+
+	bool overwriteExistingVariable = variableNameExists(resultName);
+
+	varName_matrix_map[resultName] = std::move(pseudoInverse);
+
+	if (overwriteExistingVariable)
+	{
+		doPrint_overwrittenExistingVariable(resultName);
+	}
+
+	std::cout << "Stored the pseudo-inverse of '" << matName << "' into '" << resultName << "'." << std::endl << std::endl;
+}
+
+void MatrixCalculator::handleCommand_norm2()
+{
+	if (inputList.size() != 2)
+	{
+		doPrint_invalidInput();
+		return;
+	}
+
+	std::string varName = inputList[1];
+	if (!variableNameExists(varName))
+	{
+		doPrint_varNameDoesNotExist(varName);
+		return;
+	}
+
+	std::cout << "norm2(" << varName << ") = " << std::setprecision(doublePrintPrecision) << varName_matrix_map[varName].getNorm2() << std::endl << std::endl;
+}
+
+void MatrixCalculator::handleCommand_cond()
+{
+	if (inputList.size() != 2)
+	{
+		doPrint_invalidInput();
+		return;
+	}
+
+	std::string varName = inputList[1];
+	if (!variableNameExists(varName))
+	{
+		doPrint_varNameDoesNotExist(varName);
+		return;
+	}
+
+	std::cout << "cond(" << varName << ") = " << std::setprecision(doublePrintPrecision) << varName_matrix_map[varName].getConditionNumber() << std::endl << std::endl;
+}
+
+void MatrixCalculator::handleCommand_eig()
+{
+	if (inputList.size() != 2 && inputList.size() != 3)
+	{
+		doPrint_invalidInput();
+		return;
+	}
+
+	std::string matName = inputList[1];
+	if (!variableNameExists(matName))
+	{
+		doPrint_varNameDoesNotExist(matName);
+		return;
+	}
+
+	storeVariableInLayout(matName);
+	const Matrix& matrix = varName_matrix_map[matName];
+
+	if (matrix.getNumRows() != matrix.getNumColumns())
+	{
+		std::cout << "Invalid input: Matrix '" << matName << "' is not square." << std::endl;
+		return;
+	}
+
+	Matrix vectors;
+	Matrix* vectorsPtr = (inputList.size() == 3) ? &vectors : nullptr;
+	std::vector<double> eigenvalues;
+	bool isSymmetric = matrix.getSymmetricEigen(&eigenvalues, vectorsPtr);
+
+	std::cout << "Eigenvalues of '" << matName << "':" << std::setprecision(doublePrintPrecision);
+
+	if (isSymmetric)
+	{
+		for (size_t i = 0; i < eigenvalues.size(); i++)
+		{
+			std::cout << " " << eigenvalues[i];
+		}
+	}
+	else
+	{
+		std::vector<std::complex<double>> complexEigenvalues;
+
+		if (!matrix.getEigenvalues(&complexEigenvalues, nullptr, vectorsPtr))
+		{
+			std::cout << std::endl << "Eigenvalue computation failed: The QR iterations did not converge." << std::endl;
+			return;
+		}
+
+		for (size_t i = 0; i < complexEigenvalues.size(); i++)
+		{
+			double imaginaryPart = complexEigenvalues[i].imag();
+
+			std::cout << " " << complexEigenvalues[i].real();
+
+			if (imaginaryPart != 0.0)
+			{
+				std::cout << ((imaginaryPart < 0.0) ? "-" : "+") << std::abs(imaginaryPart) << "i";
+			}
+		}
+	}
+
+	std::cout << std::endl;
+
+	if (inputList.size() == 3)
+	{
+		std::string vectorsName = inputList[2];
+		bool overwriteExistingVariable = variableNameExists(vectorsName);
+
+		varName_matrix_map[vectorsName] = std::move(vectors);
+
+		if (overwriteExistingVariable)
+		{
+			doPrint_overwrittenExistingVariable(vectorsName);
+		}
+
+		std::cout << "Stored the " << (isSymmetric ? "eigenvectors" : "Schur vectors") << " of '" << matName << "' into '" << vectorsName << "'." << std::endl;
+	}
+
+	std::cout << std::endl;
+}
+
 void MatrixCalculator::handleCommand_getcell()
 {
 	if (inputList.size() != 4)
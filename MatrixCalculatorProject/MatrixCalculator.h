@@ -93,6 +93,14 @@ private:
 		det,					/**< Calculates and prints the determinant of a matrix. */
 		rank,					/**< Calculates and prints the rank of a matrix. */
 		solvefor,				/**< Solves Systems of Linear Equations. */
+		lstsq,					/**< Finds the least-squares solution of a (possibly overdetermined) System of Linear Equations. */
+		trisolve,				/**< Solves a triangular System of Linear Equations by forward or back substitution. */
+		mpsolve,				/**< Solves a System of Linear Equations in mixed precision, and prints the refinement steps and the backward error. */
+		svd,					/**< Computes the singular value decomposition of a matrix and stores its factors into variables. */
+		pinv,					/**< Calculates the Moore-Penrose pseudo-inverse of a matrix and stores it into a variable. */
+		norm2,					/**< Calculates and prints the 2-norm of a matrix. */
+		cond,					/**< Calculates and prints the condition number of a matrix. */
+		eig,					/**< Calculates and prints the eigenvalues of a matrix, and optionally stores its eigenvectors (or Schur vectors) into a variable. */
 		getcell,				/**< Gets a cell of a matrix. */
 		setcell,				/**< Sets the cell of a matrix by a value. */
 		density,				/**< Gets the density value of a matrix. */
@@ -163,6 +171,19 @@ private:
 	*/
 	bool variableNameExists(std::string varName);
 	/**
+	* Transposes the storage of a variable which the transpose command has flagged as transposed (see Matrix::applyTranspose). The commands which read a variable through the const members of Matrix call it first, so that every later read uses the storage directly instead of a transposed copy.
+	* @param varName The name of an existing variable.
+	*/
+	void storeVariableInLayout(std::string varName);
+	/**
+	* Reads the name of an operand which may be transposed with a trailing apostrophe (e.g. mat1'). A name which exists as is is never considered transposed.
+	* @param str The operand, as it was typed.
+	* @param out_varName A pointer to the string to which the name of the variable is meant to be stored. This is an output variable, the user must declare the necessary variable before calling this method.
+	* @param out_isTransposed A pointer to the bool to which the transpose flag is meant to be stored. This is an output variable, the user must declare the necessary variable before calling this method.
+	* @return Returns true if the variable exists, false if not.
+	*/
+	bool readOperandName(std::string str, std::string* out_varName, bool* out_isTransposed);
+	/**
 	* Safely converts a string to an unsigned 32-bit integer. Exceptions are handled with a simple, default C++ try-catch block.
 	* @param str The string from which the unsigned 32-bit integer is meant to be read.
 	* @param out_uint A pointer to the unsigned 32-bit integer to which the result is meant to be stored. This is an output variable, the user must declare the necessary variable before calling this method.
@@ -306,6 +327,38 @@ private:
 	*/
 	void handleCommand_solvefor();
 	/**
+	* Finds the least-squares solution of a System of Linear Equations which may have more equations than unknowns, stores it into a variable, and outputs the norm of the residual.
+	*/
+	void handleCommand_lstsq();
+	/**
+	* Solves a System of Linear Equations with a (lower or upper, optionally transposed or unit) triangular matrix of coefficients, and stores the solution into a variable.
+	*/
+	void handleCommand_trisolve();
+	/**
+	* Solves a System of Linear Equations with a single precision LU factorization refined in double precision, stores the solution into a variable, and outputs the number of refinement steps and the backward error.
+	*/
+	void handleCommand_mpsolve();
+	/**
+	* Computes the singular value decomposition (U * S * transpose(V)) of a matrix, and stores U, S and V into three variables.
+	*/
+	void handleCommand_svd();
+	/**
+	* Calculates the Moore-Penrose pseudo-inverse of a matrix and stores it into a variable.
+	*/
+	void handleCommand_pinv();
+	/**
+	* Calculates and outputs the 2-norm (largest singular value) of a matrix.
+	*/
+	void handleCommand_norm2();
+	/**
+	* Calculates and outputs the 2-norm condition number of a matrix.
+	*/
+	void handleCommand_cond();
+	/**
+	* Calculates and outputs the eigenvalues of a square matrix, and optionally stores its eigenvectors (if it is symmetric) or its Schur vectors (if not) into a variable, as columns.
+	*/
+	void handleCommand_eig();
+	/**
 	* Shows the value of a cell of a matrix at a row and column coordinate. The coordinates are zero based.
 	*/
 	void handleCommand_getcell();
@@ -0,0 +1,189 @@
+#include "MatrixCostModel.h"
+#include <algorithm>
+#include <chrono>
+#include <limits> // Required by g++ (std::numeric_limits<double>)
+#include <map>
+#include <vector>
+
+// Public members
+
+MatrixCostModel::MatrixCostModel(double denseBytesPerCell, double sparseBytesPerNonZero, double denseNanosecondsPerCell, double sparseNanosecondsPerNonZero, double hysteresisBand)
+{
+	this->denseBytesPerCell = denseBytesPerCell;
+	this->sparseBytesPerNonZero = sparseBytesPerNonZero;
+	this->denseNanosecondsPerCell = denseNanosecondsPerCell;
+	this->sparseNanosecondsPerNonZero = sparseNanosecondsPerNonZero;
+	this->hysteresisBand = hysteresisBand;
+}
+
+const MatrixCostModel& MatrixCostModel::getInstance()
+{
+	// Initialized once (and thread-safely) on the first call.
+	static const MatrixCostModel instance = calibrate();
+
+	return instance;
+}
+
+double MatrixCostModel::getDenseBytesPerCell() const
+{
+	return denseBytesPerCell;
+}
+
+double MatrixCostModel::getSparseBytesPerNonZero() const
+{
+	return sparseBytesPerNonZero;
+}
+
+double MatrixCostModel::getDenseNanosecondsPerCell() const
+{
+	return denseNanosecondsPerCell;
+}
+
+double MatrixCostModel::getSparseNanosecondsPerNonZero() const
+{
+	return sparseNanosecondsPerNonZero;
+}
+
+double MatrixCostModel::getBreakEvenDensity() const
+{
+	// denseCost(cells) == sparseCost(density * cells)
+	// 2 * cells == density * cells * sparseCostPerNonZero
+	double sparseCostPerNonZero = getSparseCost(1);
+	double breakEvenDensity = getDenseCost(1, 1) / sparseCostPerNonZero;
+
+	return std::min(breakEvenDensity, 1.0);
+}
+
+double MatrixCostModel::getHysteresisBand() const
+{
+	return hysteresisBand;
+}
+
+double MatrixCostModel::getDenseCost(size_t numRows, size_t numColumns) const
+{
+	// A dense cell costs one unit of memory and one unit of time, by definition.
+	double numCells = (double)numRows * (double)numColumns;
+
+	return numCells * 2.0;
+}
+
+double MatrixCostModel::getSparseCost(size_t numNonZeros) const
+{
+	double relativeFootprint = sparseBytesPerNonZero / denseBytesPerCell;
+	double relativeVisitTime = sparseNanosecondsPerNonZero / denseNanosecondsPerCell;
+
+	return (double)numNonZeros * (relativeFootprint + relativeVisitTime);
+}
+
+bool MatrixCostModel::shouldConvertToSparse(size_t numRows, size_t numColumns, size_t numNonZeros) const
+{
+	double numCells = (double)numRows * (double)numColumns;
+
+	if (numCells == 0.0)
+	{
+		return false; // Nothing to gain.
+	}
+
+	double density = (double)numNonZeros / numCells;
+	double lowerEdge = getBreakEvenDensity() * (1.0 - hysteresisBand);
+
+	return density < lowerEdge;
+}
+
+bool MatrixCostModel::shouldConvertToDense(size_t numRows, size_t numColumns, size_t numNonZeros) const
+{
+	double numCells = (double)numRows * (double)numColumns;
+
+	if (numCells == 0.0)
+	{
+		return false; // Nothing to gain.
+	}
+
+	double density = (double)numNonZeros / numCells;
+	double upperEdge = std::min(getBreakEvenDensity() * (1.0 + hysteresisBand), 1.0);
+
+	return density > upperEdge;
+}
+
+bool MatrixCostModel::isDenseCheaper(size_t numRows, size_t numColumns, size_t numNonZeros) const
+{
+	return getDenseCost(numRows, numColumns) < getSparseCost(numNonZeros);
+}
+
+// Private members
+
+MatrixCostModel MatrixCostModel::calibrate()
+{
+	// Memory footprint. A node of std::map holds the element, three pointers (parent, left, right) and the color, which is padded to a pointer.
+	typedef std::map<std::pair<size_t, size_t>, double> SparseContainer;
+	double denseBytesPerCell = sizeof(double);
+	double sparseBytesPerNonZero = sizeof(SparseContainer::value_type) + 4 * sizeof(void*);
+
+	// Throughput. Visit the same number of elements in both containers a few times, and keep the fastest run of each (the least disturbed one).
+	const size_t numElements = 4096;
+	const size_t numRepetitions = 8;
+	const size_t numTrials = 5;
+
+	std::vector<double> dense(numElements, 1.0);
+	SparseContainer sparse;
+
+	for (size_t i = 0; i < numElements; i++)
+	{
+		sparse[std::make_pair(i / 64, i % 64)] = 1.0;
+	}
+
+	volatile double sink = 0.0; // Prevents the compiler from removing the loops.
+	double bestDenseNanoseconds = std::numeric_limits<double>::max();
+	double bestSparseNanoseconds = std::numeric_limits<double>::max();
+
+	for (size_t trial = 0; trial < numTrials; trial++)
+	{
+		auto denseBegin = std::chrono::steady_clock::now();
+		for (size_t repetition = 0; repetition < numRepetitions; repetition++)
+		{
+			double sum = 0.0;
+			for (size_t i = 0; i < numElements; i++)
+			{
+				sum += dense[i];
+			}
+			sink = sink + sum;
+		}
+		auto denseEnd = std::chrono::steady_clock::now();
+
+		auto sparseBegin = std::chrono::steady_clock::now();
+		for (size_t repetition = 0; repetition < numRepetitions; repetition++)
+		{
+			double sum = 0.0;
+			for (auto iter = sparse.begin(); iter != sparse.end(); ++iter)
+			{
+				sum += (*iter).second;
+			}
+			sink = sink + sum;
+		}
+		auto sparseEnd = std::chrono::steady_clock::now();
+
+		double denseNanoseconds = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(denseEnd - denseBegin).count();
+		double sparseNanoseconds = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(sparseEnd - sparseBegin).count();
+
+		bestDenseNanoseconds = std::min(bestDenseNanoseconds, denseNanoseconds);
+		bestSparseNanoseconds = std::min(bestSparseNanoseconds, sparseNanoseconds);
+	}
+
+	double numVisits = (double)(numElements * numRepetitions);
+	double denseNanosecondsPerCell = bestDenseNanoseconds / numVisits;
+	double sparseNanosecondsPerNonZero = bestSparseNanoseconds / numVisits;
+
+	// A clock which is too coarse may measure zero. Fall back to typical values in that case.
+	if (denseNanosecondsPerCell <= 0.0 || sparseNanosecondsPerNonZero <= 0.0)
+	{
+		denseNanosecondsPerCell = 0.5;
+		sparseNanosecondsPerNonZero = 5.0;
+	}
+
+	// The sparse format can't be faster to visit than the dense one (at least one pointer chase per element), so a faster measurement is noise.
+	sparseNanosecondsPerNonZero = std::max(sparseNanosecondsPerNonZero, denseNanosecondsPerCell);
+
+	const double hysteresisBand = 0.25;
+
+	return MatrixCostModel(denseBytesPerCell, sparseBytesPerNonZero, denseNanosecondsPerCell, sparseNanosecondsPerNonZero, hysteresisBand);
+}
@@ -0,0 +1,113 @@
+#ifndef MATRIX_COST_MODEL_H
+#define MATRIX_COST_MODEL_H
+
+#include <cstddef> // Required by g++ (size_t)
+
+/**
+* Decides which storage format (DenseMatrix or SparseMatrix) is cheaper for a matrix, based on the memory footprint and the throughput of each format.
+* The memory footprint is derived from the sizes of the underlying containers. The throughput (nanoseconds to visit one element) is calibrated on the running machine once, the first time getInstance is called.
+* The cost of an element is its memory footprint relative to a dense cell, plus its visit time relative to a dense cell. A dense cell therefore costs 2 units. The density where both formats cost the same is the "break-even density".
+* To prevent matrices near the break-even density from being converted back and forth, conversions only happen outside of a hysteresis band around it.
+*/
+class MatrixCostModel
+{
+public:
+	/**
+	* Creates a cost model out of given measurements, without any calibration. Mostly useful for testing.
+	* @param denseBytesPerCell Memory footprint of a single cell of DenseMatrix, in bytes.
+	* @param sparseBytesPerNonZero Memory footprint of a single non-zero element of SparseMatrix, in bytes.
+	* @param denseNanosecondsPerCell Time it takes to visit a single cell of DenseMatrix, in nanoseconds.
+	* @param sparseNanosecondsPerNonZero Time it takes to visit a single non-zero element of SparseMatrix, in nanoseconds.
+	* @param hysteresisBand Relative width of the band around the break-even density in which no conversion happens (e.g. 0.25 means +-25%).
+	*/
+	MatrixCostModel(double denseBytesPerCell, double sparseBytesPerNonZero, double denseNanosecondsPerCell, double sparseNanosecondsPerNonZero, double hysteresisBand);
+	/**
+	* Returns the cost model of this machine. It is calibrated only once, the first time this method is called.
+	*/
+	static const MatrixCostModel& getInstance();
+	/**
+	* Returns the memory footprint of a single cell of DenseMatrix, in bytes.
+	*/
+	double getDenseBytesPerCell() const;
+	/**
+	* Returns the memory footprint of a single non-zero element of SparseMatrix, in bytes.
+	*/
+	double getSparseBytesPerNonZero() const;
+	/**
+	* Returns the time it takes to visit a single cell of DenseMatrix, in nanoseconds.
+	*/
+	double getDenseNanosecondsPerCell() const;
+	/**
+	* Returns the time it takes to visit a single non-zero element of SparseMatrix, in nanoseconds.
+	*/
+	double getSparseNanosecondsPerNonZero() const;
+	/**
+	* Returns the density where DenseMatrix and SparseMatrix cost the same. Below it, SparseMatrix is cheaper.
+	*/
+	double getBreakEvenDensity() const;
+	/**
+	* Returns the relative width of the band around the break-even density in which no conversion happens.
+	*/
+	double getHysteresisBand() const;
+	/**
+	* Returns the cost of storing a matrix as DenseMatrix, in "dense cell" units.
+	* @param numRows The number of rows of the matrix.
+	* @param numColumns The number of columns of the matrix.
+	*/
+	double getDenseCost(size_t numRows, size_t numColumns) const;
+	/**
+	* Returns the cost of storing a matrix as SparseMatrix, in "dense cell" units.
+	* @param numNonZeros The number of non-zero elements of the matrix.
+	*/
+	double getSparseCost(size_t numNonZeros) const;
+	/**
+	* Checks whether or not a DenseMatrix should be converted to SparseMatrix. True only if its density is below the lower edge of the hysteresis band.
+	* @param numRows The number of rows of the matrix.
+	* @param numColumns The number of columns of the matrix.
+	* @param numNonZeros The number of non-zero elements of the matrix.
+	*/
+	bool shouldConvertToSparse(size_t numRows, size_t numColumns, size_t numNonZeros) const;
+	/**
+	* Checks whether or not a SparseMatrix should be converted to DenseMatrix. True only if its density is above the upper edge of the hysteresis band.
+	* @param numRows The number of rows of the matrix.
+	* @param numColumns The number of columns of the matrix.
+	* @param numNonZeros The number of non-zero elements of the matrix.
+	*/
+	bool shouldConvertToDense(size_t numRows, size_t numColumns, size_t numNonZeros) const;
+	/**
+	* Checks whether or not DenseMatrix is cheaper than SparseMatrix for a new matrix. Unlike the conversion checks, there is no hysteresis, because nothing has to be converted yet.
+	* @param numRows The number of rows of the matrix.
+	* @param numColumns The number of columns of the matrix.
+	* @param numNonZeros The (estimated) number of non-zero elements of the matrix.
+	*/
+	bool isDenseCheaper(size_t numRows, size_t numColumns, size_t numNonZeros) const;
+
+private:
+	/**
+	* Memory footprint of a single cell of DenseMatrix, in bytes.
+	*/
+	double denseBytesPerCell;
+	/**
+	* Memory footprint of a single non-zero element of SparseMatrix, in bytes.
+	*/
+	double sparseBytesPerNonZero;
+	/**
+	* Time it takes to visit a single cell of DenseMatrix, in nanoseconds.
+	*/
+	double denseNanosecondsPerCell;
+	/**
+	* Time it takes to visit a single non-zero element of SparseMatrix, in nanoseconds.
+	*/
+	double sparseNanosecondsPerNonZero;
+	/**
+	* Relative width of the band around the break-even density in which no conversion happens.
+	*/
+	double hysteresisBand;
+
+	/**
+	* Measures the footprint and the throughput of both formats on this machine.
+	*/
+	static MatrixCostModel calibrate();
+};
+
+#endif // MATRIX_COST_MODEL_H
@@ -0,0 +1,385 @@
+#ifndef MATRIX_EXPRESSION_H
+#define MATRIX_EXPRESSION_H
+
+#include "MatrixBase.h"
+#include "DenseMatrix.h"
+#include "NonZeroVisitor.h"
+#include <cstddef> // Required by g++ (size_t)
+
+class Matrix;
+
+/**
+* Base class of the expression templates of Matrix (Curiously Recurring Template Pattern). An expression such as (A + B - 2.0 * C) is not evaluated when it is written.
+* Instead, it builds a small tree of lightweight nodes, which is evaluated in a single pass (with a single output allocation) when it is assigned to a Matrix.
+* Every expression type must provide getNumRows, getNumColumns, getCell, writeRow, isValidExpression, hasDenseOperand and forEachNonZeroCoordinate.
+* WARNING: Expressions keep references to the Matrix operands. Assign them to a Matrix before the operands go out of scope (don't store them in 'auto' variables).
+*/
+template <typename Expression>
+class MatrixExpression
+{
+public:
+	/**
+	* Returns this expression as its actual (derived) type.
+	*/
+	const Expression& derived() const
+	{
+		return static_cast<const Expression&>(*this);
+	}
+};
+
+/**
+* The leaf node of the expression templates. It wraps a Matrix operand without copying its resource.
+*/
+class MatrixExpressionLeaf : public MatrixExpression<MatrixExpressionLeaf>
+{
+public:
+	/**
+	* Creates a leaf out of a Matrix. The Matrix must outlive the leaf. Defined in Matrix.h, because it needs the complete Matrix type.
+	* @param matrix The Matrix operand.
+	*/
+	MatrixExpressionLeaf(const Matrix& matrix);
+	/**
+	* Returns the number of rows of the operand. Returns zero if the operand is invalid.
+	*/
+	size_t getNumRows() const
+	{
+		if (matrixPtr == nullptr)
+		{
+			return 0;
+		}
+
+		return isTransposed ? matrixPtr->getNumColumns() : matrixPtr->getNumRows();
+	}
+	/**
+	* Returns the number of columns of the operand. Returns zero if the operand is invalid.
+	*/
+	size_t getNumColumns() const
+	{
+		if (matrixPtr == nullptr)
+		{
+			return 0;
+		}
+
+		return isTransposed ? matrixPtr->getNumRows() : matrixPtr->getNumColumns();
+	}
+	/**
+	* Returns the value of the operand at a given cell. The operand is assumed to be valid.
+	* @param row Row index of the matrix.
+	* @param column Column index of the matrix.
+	*/
+	double getCell(size_t row, size_t column) const
+	{
+		return isTransposed ? matrixPtr->getCell(column, row) : matrixPtr->getCell(row, column);
+	}
+	/**
+	* Writes (factor * the row of the operand) into a row of the result, or adds it to the row. A Dense operand is read straight from its storage (a row span, or a column of the resource if the operand is transposed); the others cell by cell.
+	* @param row Row index of the matrix.
+	* @param factor The factor by which the row is scaled.
+	* @param isAccumulated True to add to the elements of rowData, false to overwrite them.
+	* @param rowData The getNumColumns() elements of the row of the result.
+	*/
+	void writeRow(size_t row, double factor, bool isAccumulated, double* rowData) const
+	{
+		size_t numColumns = getNumColumns();
+		const double* operandRowData = nullptr;
+		size_t operandStride = 1;
+
+		if (denseOperand != nullptr && numColumns > 0)
+		{
+			// The row of a transposed operand is a column of the resource, whose elements are one resource row apart.
+			operandRowData = isTransposed ? (denseOperand->getRowData(0) + row) : denseOperand->getRowData(row);
+			operandStride = isTransposed ? denseOperand->getNumColumns() : 1;
+		}
+
+		if (isAccumulated == false)
+		{
+			for (size_t c = 0; c < numColumns; c++)
+			{
+				rowData[c] = factor * ((operandRowData != nullptr) ? operandRowData[c * operandStride] : getCell(row, c));
+			}
+		}
+		else
+		{
+			for (size_t c = 0; c < numColumns; c++)
+			{
+				rowData[c] += factor * ((operandRowData != nullptr) ? operandRowData[c * operandStride] : getCell(row, c));
+			}
+		}
+	}
+	/**
+	* Checks whether or not the operand is a valid matrix.
+	*/
+	bool isValidExpression() const
+	{
+		return matrixPtr != nullptr;
+	}
+	/**
+	* Checks whether or not the operand is a DenseMatrix. Used to pick the type of the result of the expression.
+	*/
+	bool hasDenseOperand() const
+	{
+		return denseOperand != nullptr;
+	}
+	/**
+	* Calls the visitor for every coordinate of the operand which may hold a non-zero value. Only meaningful for SparseMatrix operands.
+	* @param visitor A callable which takes (size_t row, size_t column).
+	*/
+	template <typename Visitor>
+	void forEachNonZeroCoordinate(Visitor visitor) const
+	{
+		mcu::visitNonZeros(*matrixPtr, [&](size_t row, size_t column, double)
+			{
+				if (isTransposed)
+				{
+					visitor(column, row);
+				}
+				else
+				{
+					visitor(row, column);
+				}
+			});
+	}
+
+private:
+	/**
+	* The resource of the wrapped Matrix. It is not owned by the leaf.
+	*/
+	const MatrixBase* matrixPtr;
+	/**
+	* The wrapped resource if it is a DenseMatrix, whose rows are read directly. nullptr otherwise.
+	*/
+	const DenseMatrix* denseOperand;
+	/**
+	* True if the wrapped Matrix is the transpose of its resource. The leaf then reads the resource with the row & column indices swapped, instead of transposing it.
+	*/
+	bool isTransposed;
+};
+
+/**
+* Maps an expression type to the type which is stored inside the nodes. Nodes are stored by value, while matrices are stored as leaves (by reference).
+*/
+template <typename Expression>
+struct MatrixExpressionStorage
+{
+	typedef Expression type;
+};
+
+/**
+* Matrices are stored as leaves (by reference) inside the nodes.
+*/
+template <>
+struct MatrixExpressionStorage<Matrix>
+{
+	typedef MatrixExpressionLeaf type;
+};
+
+/**
+* Expression node for element-wise addition and subtraction of two expressions.
+*/
+template <typename Left, typename Right, bool IsSubtraction>
+class MatrixSumExpression : public MatrixExpression<MatrixSumExpression<Left, Right, IsSubtraction>>
+{
+public:
+	/**
+	* Creates the node. Does not evaluate anything.
+	* @param left The left operand.
+	* @param right The right operand.
+	*/
+	MatrixSumExpression(const Left& left, const Right& right)
+		: left(left), right(right)
+	{
+	}
+	/**
+	* Returns the number of rows of the expression.
+	*/
+	size_t getNumRows() const
+	{
+		return left.getNumRows();
+	}
+	/**
+	* Returns the number of columns of the expression.
+	*/
+	size_t getNumColumns() const
+	{
+		return left.getNumColumns();
+	}
+	/**
+	* Evaluates the expression at a given cell.
+	* @param row Row index of the matrix.
+	* @param column Column index of the matrix.
+	*/
+	double getCell(size_t row, size_t column) const
+	{
+		if (IsSubtraction)
+		{
+			return left.getCell(row, column) - right.getCell(row, column);
+		}
+
+		return left.getCell(row, column) + right.getCell(row, column);
+	}
+	/**
+	* Writes (factor * the row of the expression) into a row of the result, or adds it to the row: the left operand is written, and the right one is added (or subtracted).
+	* @see MatrixExpressionLeaf::writeRow
+	*/
+	void writeRow(size_t row, double factor, bool isAccumulated, double* rowData) const
+	{
+		left.writeRow(row, factor, isAccumulated, rowData);
+		right.writeRow(row, IsSubtraction ? -factor : factor, true, rowData);
+	}
+	/**
+	* An expression is valid if both operands are valid and their dimensions match.
+	*/
+	bool isValidExpression() const
+	{
+		return left.isValidExpression() && right.isValidExpression()
+			&& (left.getNumRows() == right.getNumRows())
+			&& (left.getNumColumns() == right.getNumColumns());
+	}
+	/**
+	* Checks whether or not any of the operands is a DenseMatrix.
+	*/
+	bool hasDenseOperand() const
+	{
+		return left.hasDenseOperand() || right.hasDenseOperand();
+	}
+	/**
+	* Calls the visitor for every coordinate which may hold a non-zero value. Coordinates may be visited more than once.
+	* @param visitor A callable which takes (size_t row, size_t column).
+	*/
+	template <typename Visitor>
+	void forEachNonZeroCoordinate(Visitor visitor) const
+	{
+		left.forEachNonZeroCoordinate(visitor);
+		right.forEachNonZeroCoordinate(visitor);
+	}
+
+private:
+	typename MatrixExpressionStorage<Left>::type left;
+	typename MatrixExpressionStorage<Right>::type right;
+};
+
+/**
+* Expression node for scaling an expression by a scalar.
+*/
+template <typename Operand>
+class MatrixScaledExpression : public MatrixExpression<MatrixScaledExpression<Operand>>
+{
+public:
+	/**
+	* Creates the node. Does not evaluate anything.
+	* @param operand The operand to be scaled.
+	* @param scalar The scalar value.
+	*/
+	MatrixScaledExpression(const Operand& operand, double scalar)
+		: operand(operand), scalar(scalar)
+	{
+	}
+	/**
+	* Returns the number of rows of the expression.
+	*/
+	size_t getNumRows() const
+	{
+		return operand.getNumRows();
+	}
+	/**
+	* Returns the number of columns of the expression.
+	*/
+	size_t getNumColumns() const
+	{
+		return operand.getNumColumns();
+	}
+	/**
+	* Evaluates the expression at a given cell.
+	* @param row Row index of the matrix.
+	* @param column Column index of the matrix.
+	*/
+	double getCell(size_t row, size_t column) const
+	{
+		return scalar * operand.getCell(row, column);
+	}
+	/**
+	* Writes (factor * the row of the expression) into a row of the result, or adds it to the row. The scalar is folded into the factor.
+	* @see MatrixExpressionLeaf::writeRow
+	*/
+	void writeRow(size_t row, double factor, bool isAccumulated, double* rowData) const
+	{
+		operand.writeRow(row, factor * scalar, isAccumulated, rowData);
+	}
+	/**
+	* The expression is valid if the operand is valid.
+	*/
+	bool isValidExpression() const
+	{
+		return operand.isValidExpression();
+	}
+	/**
+	* Checks whether or not the operand contains a DenseMatrix.
+	*/
+	bool hasDenseOperand() const
+	{
+		return operand.hasDenseOperand();
+	}
+	/**
+	* Calls the visitor for every coordinate which may hold a non-zero value.
+	* @param visitor A callable which takes (size_t row, size_t column).
+	*/
+	template <typename Visitor>
+	void forEachNonZeroCoordinate(Visitor visitor) const
+	{
+		operand.forEachNonZeroCoordinate(visitor);
+	}
+
+private:
+	typename MatrixExpressionStorage<Operand>::type operand;
+	double scalar;
+};
+
+/**
+* Lazy matrix addition. The result is an expression which is evaluated when it is assigned to a Matrix. The result is an invalid matrix if either of the operands is invalid, or if the dimensions do not match.
+* @param left The left operand.
+* @param right The right operand.
+* @return The expression node.
+*/
+template <typename Left, typename Right>
+MatrixSumExpression<Left, Right, false> operator+(const MatrixExpression<Left>& left, const MatrixExpression<Right>& right)
+{
+	return MatrixSumExpression<Left, Right, false>(left.derived(), right.derived());
+}
+
+/**
+* Lazy matrix subtraction. The result is an expression which is evaluated when it is assigned to a Matrix. The result is an invalid matrix if either of the operands is invalid, or if the dimensions do not match.
+* @param left The left operand.
+* @param right The right operand, which is subtracted from the left operand.
+* @return The expression node.
+*/
+template <typename Left, typename Right>
+MatrixSumExpression<Left, Right, true> operator-(const MatrixExpression<Left>& left, const MatrixExpression<Right>& right)
+{
+	return MatrixSumExpression<Left, Right, true>(left.derived(), right.derived());
+}
+
+/**
+* Lazy scaling, for when the scalar is on the right hand side. The result is an invalid matrix if the operand is invalid.
+* @param operand The expression to be scaled.
+* @param scalar Double precision floating point value by which to scale the expression.
+* @return The expression node.
+*/
+template <typename Operand>
+MatrixScaledExpression<Operand> operator*(const MatrixExpression<Operand>& operand, double scalar)
+{
+	return MatrixScaledExpression<Operand>(operand.derived(), scalar);
+}
+
+/**
+* Lazy scaling, for when the scalar is on the left hand side. The result is an invalid matrix if the operand is invalid.
+* @param scalar Double precision floating point value by which to scale the expression.
+* @param operand The expression to be scaled.
+* @return The expression node.
+*/
+template <typename Operand>
+MatrixScaledExpression<Operand> operator*(double scalar, const MatrixExpression<Operand>& operand)
+{
+	return MatrixScaledExpression<Operand>(operand.derived(), scalar);
+}
+
+#endif // MATRIX_EXPRESSION_H
@@ -0,0 +1,291 @@
+#include "MatrixMemory.h"
+#include <atomic>
+#include <cstddef>
+
+namespace
+{
+	/**
+	* Every block of MatrixMemory starts with this header, which remembers the allocator which served the block.
+	*/
+	struct BlockHeader
+	{
+		MatrixAllocator* owner;
+		size_t numBytes;
+	};
+
+	// The header is padded, so that the block after it stays aligned for any scalar type.
+	const size_t Alignment = alignof(std::max_align_t);
+	const size_t HeaderSize = ((sizeof(BlockHeader) + Alignment - 1) / Alignment) * Alignment;
+
+	HeapMatrixAllocator heapAllocator;
+	std::atomic<MatrixAllocator*> defaultAllocator(&heapAllocator);
+
+	std::atomic<size_t> numRequests(0);
+	std::atomic<size_t> numReleases(0);
+	std::atomic<size_t> numSystemAllocations(0);
+	std::atomic<size_t> numSystemDeallocations(0);
+
+	size_t roundUpToAlignment(size_t numBytes)
+	{
+		return ((numBytes + Alignment - 1) / Alignment) * Alignment;
+	}
+}
+
+// Public members
+
+void* HeapMatrixAllocator::allocate(size_t numBytes)
+{
+	return MatrixMemory::systemAllocate(numBytes);
+}
+
+void HeapMatrixAllocator::deallocate(void* block, size_t numBytes)
+{
+	(void)numBytes;
+	MatrixMemory::systemDeallocate(block);
+}
+
+PoolMatrixAllocator::PoolMatrixAllocator()
+{
+	freeLists.resize(MaxSizeClassShift - MinSizeClassShift + 1);
+}
+
+PoolMatrixAllocator::~PoolMatrixAllocator()
+{
+	for (size_t i = 0; i < freeLists.size(); i++)
+	{
+		for (size_t b = 0; b < freeLists[i].size(); b++)
+		{
+			MatrixMemory::systemDeallocate(freeLists[i][b]);
+		}
+	}
+}
+
+void* PoolMatrixAllocator::allocate(size_t numBytes)
+{
+	if (numBytes > ((size_t)1 << MaxSizeClassShift))
+	{
+		return MatrixMemory::systemAllocate(numBytes); // Too large to be pooled.
+	}
+
+	size_t sizeClassIndex = getSizeClassIndex(numBytes);
+
+	{
+		std::lock_guard<std::mutex> lock(freeListsMutex);
+		std::vector<void*>& freeList = freeLists[sizeClassIndex];
+
+		if (freeList.empty() == false)
+		{
+			void* block = freeList.back();
+			freeList.pop_back();
+			return block;
+		}
+	}
+
+	// Allocate the whole size class, so that the block fits any later request of the same class.
+	return MatrixMemory::systemAllocate((size_t)1 << (sizeClassIndex + MinSizeClassShift));
+}
+
+void PoolMatrixAllocator::deallocate(void* block, size_t numBytes)
+{
+	if (numBytes > ((size_t)1 << MaxSizeClassShift))
+	{
+		MatrixMemory::systemDeallocate(block);
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(freeListsMutex);
+	freeLists[getSizeClassIndex(numBytes)].push_back(block);
+}
+
+ArenaMatrixAllocator::ArenaMatrixAllocator(size_t chunkSize)
+{
+	this->chunkSize = roundUpToAlignment(chunkSize);
+	currentChunkIndex = 0;
+	currentOffset = 0;
+}
+
+ArenaMatrixAllocator::~ArenaMatrixAllocator()
+{
+	reset();
+
+	for (size_t i = 0; i < chunks.size(); i++)
+	{
+		MatrixMemory::systemDeallocate(chunks[i]);
+	}
+}
+
+void* ArenaMatrixAllocator::allocate(size_t numBytes)
+{
+	numBytes = roundUpToAlignment(numBytes);
+
+	if (numBytes > chunkSize)
+	{
+		char* oversizedChunk = static_cast<char*>(MatrixMemory::systemAllocate(numBytes));
+		oversizedChunks.push_back(oversizedChunk);
+		return oversizedChunk;
+	}
+
+	if (currentChunkIndex < chunks.size() && currentOffset + numBytes > chunkSize)
+	{
+		// The current chunk is full. Move on to the next one (which may be a reused chunk).
+		currentChunkIndex++;
+		currentOffset = 0;
+	}
+
+	if (currentChunkIndex == chunks.size())
+	{
+		chunks.push_back(static_cast<char*>(MatrixMemory::systemAllocate(chunkSize)));
+		currentOffset = 0;
+	}
+
+	char* block = chunks[currentChunkIndex] + currentOffset;
+	currentOffset += numBytes;
+
+	return block;
+}
+
+void ArenaMatrixAllocator::deallocate(void* block, size_t numBytes)
+{
+	// Released all at once by rewind or reset.
+	(void)block;
+	(void)numBytes;
+}
+
+ArenaMatrixAllocator::Marker ArenaMatrixAllocator::getMarker() const
+{
+	Marker marker;
+	marker.chunkIndex = currentChunkIndex;
+	marker.offset = currentOffset;
+	marker.numOversizedChunks = oversizedChunks.size();
+
+	return marker;
+}
+
+void ArenaMatrixAllocator::rewind(const Marker& marker)
+{
+	for (size_t i = marker.numOversizedChunks; i < oversizedChunks.size(); i++)
+	{
+		MatrixMemory::systemDeallocate(oversizedChunks[i]);
+	}
+
+	oversizedChunks.resize(marker.numOversizedChunks);
+	currentChunkIndex = marker.chunkIndex;
+	currentOffset = marker.offset;
+}
+
+void ArenaMatrixAllocator::reset()
+{
+	Marker beginning;
+	beginning.chunkIndex = 0;
+	beginning.offset = 0;
+	beginning.numOversizedChunks = 0;
+
+	rewind(beginning);
+}
+
+void* MatrixMemory::allocate(size_t numBytes, MatrixAllocator* allocator)
+{
+	MatrixAllocator* owner = allocator;
+
+	if (owner == nullptr)
+	{
+		owner = defaultAllocator.load();
+	}
+
+	numRequests++;
+
+	char* rawBlock = static_cast<char*>(owner->allocate(HeaderSize + numBytes));
+
+	BlockHeader* header = reinterpret_cast<BlockHeader*>(rawBlock);
+	header->owner = owner;
+	header->numBytes = HeaderSize + numBytes;
+
+	return rawBlock + HeaderSize;
+}
+
+void MatrixMemory::deallocate(void* block)
+{
+	if (block == nullptr)
+	{
+		return;
+	}
+
+	numReleases++;
+
+	char* rawBlock = static_cast<char*>(block) - HeaderSize;
+	BlockHeader* header = reinterpret_cast<BlockHeader*>(rawBlock);
+
+	header->owner->deallocate(rawBlock, header->numBytes);
+}
+
+void MatrixMemory::setDefaultAllocator(MatrixAllocator* allocator)
+{
+	defaultAllocator.store((allocator != nullptr) ? allocator : &heapAllocator);
+}
+
+MatrixAllocationStats MatrixMemory::getStats()
+{
+	MatrixAllocationStats stats;
+	stats.numRequests = numRequests.load();
+	stats.numReleases = numReleases.load();
+	stats.numSystemAllocations = numSystemAllocations.load();
+	stats.numSystemDeallocations = numSystemDeallocations.load();
+
+	return stats;
+}
+
+void MatrixMemory::resetStats()
+{
+	numRequests = 0;
+	numReleases = 0;
+	numSystemAllocations = 0;
+	numSystemDeallocations = 0;
+}
+
+void* MatrixMemory::systemAllocate(size_t numBytes)
+{
+	numSystemAllocations++;
+	return ::operator new(numBytes);
+}
+
+void MatrixMemory::systemDeallocate(void* block)
+{
+	numSystemDeallocations++;
+	::operator delete(block);
+}
+
+MatrixScratchScope::MatrixScratchScope()
+{
+	beginMarker = getThreadArena().getMarker();
+}
+
+MatrixScratchScope::~MatrixScratchScope()
+{
+	getThreadArena().rewind(beginMarker);
+}
+
+MatrixAllocator* MatrixScratchScope::getAllocator() const
+{
+	return &getThreadArena();
+}
+
+// Private members
+
+size_t PoolMatrixAllocator::getSizeClassIndex(size_t numBytes)
+{
+	size_t shift = MinSizeClassShift;
+
+	while (((size_t)1 << shift) < numBytes)
+	{
+		shift++;
+	}
+
+	return shift - MinSizeClassShift;
+}
+
+ArenaMatrixAllocator& MatrixScratchScope::getThreadArena()
+{
+	thread_local ArenaMatrixAllocator arena;
+
+	return arena;
+}
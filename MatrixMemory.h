@@ -0,0 +1,403 @@
+#ifndef MATRIX_MEMORY_H
+#define MATRIX_MEMORY_H
+
+#include <cstddef> // Required by g++ (size_t)
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+* Counters of the memory requests of the matrices. A "request" is any allocation made by a matrix (a MatrixBase object or its element storage). A "system allocation" is a request which actually reaches the global heap (operator new).
+* The difference between the two is the number of requests which were served by a pool or an arena.
+*/
+struct MatrixAllocationStats
+{
+	/**
+	* The number of allocations requested by the matrices.
+	*/
+	size_t numRequests = 0;
+	/**
+	* The number of deallocations requested by the matrices.
+	*/
+	size_t numReleases = 0;
+	/**
+	* The number of allocations which reached the global heap.
+	*/
+	size_t numSystemAllocations = 0;
+	/**
+	* The number of deallocations which reached the global heap.
+	*/
+	size_t numSystemDeallocations = 0;
+};
+
+/**
+* Interface of the allocators which can serve the memory of the matrices. Allocators don't have to be thread-safe, unless they are shared between threads (see MatrixMemory::setDefaultAllocator).
+* @see MatrixMemory
+*/
+class MatrixAllocator
+{
+public:
+	/**
+	* Virtual Destructor.
+	*/
+	virtual ~MatrixAllocator() = default;
+	/**
+	* Allocates a block of memory, which is aligned for any scalar type.
+	* @param numBytes The size of the block.
+	* @return Pointer to the block. Never nullptr (throws std::bad_alloc instead).
+	*/
+	virtual void* allocate(size_t numBytes) = 0;
+	/**
+	* Deallocates a block of memory which was allocated by this allocator.
+	* @param block Pointer to the block.
+	* @param numBytes The size of the block, which was passed to allocate.
+	*/
+	virtual void deallocate(void* block, size_t numBytes) = 0;
+};
+
+/**
+* Serves every request from the global heap. This is the default allocator.
+*/
+class HeapMatrixAllocator : public MatrixAllocator
+{
+public:
+	/**
+	* Allocates the block with operator new.
+	*/
+	virtual void* allocate(size_t numBytes) override;
+	/**
+	* Deallocates the block with operator delete.
+	*/
+	virtual void deallocate(void* block, size_t numBytes) override;
+};
+
+/**
+* Keeps the released blocks in free lists (one per power-of-two size class), and reuses them for later requests of the same size class. Useful when matrices of the same shapes are created and destroyed repeatedly.
+* Blocks larger than the largest size class are served by the global heap directly. Thread-safe.
+*/
+class PoolMatrixAllocator : public MatrixAllocator
+{
+public:
+	/**
+	* Creates an empty pool.
+	*/
+	PoolMatrixAllocator();
+	/**
+	* The pool can't be copied, because it owns its free blocks.
+	*/
+	PoolMatrixAllocator(const PoolMatrixAllocator& other) = delete;
+	/**
+	* The pool can't be copied, because it owns its free blocks.
+	*/
+	PoolMatrixAllocator& operator=(const PoolMatrixAllocator& other) = delete;
+	/**
+	* Returns the free blocks to the global heap. The blocks which are still in use are not owned by the pool anymore; the pool must outlive them.
+	*/
+	~PoolMatrixAllocator();
+	/**
+	* Pops a block from the free list of the size class, or allocates a new block if the free list is empty.
+	*/
+	virtual void* allocate(size_t numBytes) override;
+	/**
+	* Pushes the block to the free list of its size class.
+	*/
+	virtual void deallocate(void* block, size_t numBytes) override;
+
+private:
+	/**
+	* The smallest size class is (1 << MinSizeClassShift) bytes.
+	*/
+	static const size_t MinSizeClassShift = 5;
+	/**
+	* The largest size class is (1 << MaxSizeClassShift) bytes.
+	*/
+	static const size_t MaxSizeClassShift = 20;
+	/**
+	* Free blocks of each size class. Index i holds the blocks of (1 << (i + MinSizeClassShift)) bytes.
+	*/
+	std::vector<std::vector<void*>> freeLists;
+	/**
+	* Protects the free lists.
+	*/
+	std::mutex freeListsMutex;
+
+	/**
+	* Returns the index of the smallest size class which can hold a block.
+	* @param numBytes The size of the block.
+	*/
+	static size_t getSizeClassIndex(size_t numBytes);
+};
+
+/**
+* Serves the requests by bumping a pointer through large chunks of memory. Deallocation does nothing; the blocks are released at once by rewinding the arena to an earlier position (like a stack), and the chunks are reused afterwards.
+* Meant for the short-lived temporaries of a single operation (see MatrixScratchScope). Not thread-safe.
+*/
+class ArenaMatrixAllocator : public MatrixAllocator
+{
+public:
+	/**
+	* A position of the arena. Every block allocated after the position is released by rewinding to it.
+	*/
+	struct Marker
+	{
+		size_t chunkIndex;
+		size_t offset;
+		size_t numOversizedChunks;
+	};
+
+	/**
+	* Creates an empty arena. No memory is allocated until the first request.
+	* @param chunkSize The size of the chunks, in bytes. Larger requests get a chunk of their own.
+	*/
+	ArenaMatrixAllocator(size_t chunkSize = 64 * 1024);
+	/**
+	* The arena can't be copied, because it owns its chunks.
+	*/
+	ArenaMatrixAllocator(const ArenaMatrixAllocator& other) = delete;
+	/**
+	* The arena can't be copied, because it owns its chunks.
+	*/
+	ArenaMatrixAllocator& operator=(const ArenaMatrixAllocator& other) = delete;
+	/**
+	* Returns all of the chunks to the global heap.
+	*/
+	~ArenaMatrixAllocator();
+	/**
+	* Returns the next free part of the current chunk, or starts a new chunk if it doesn't fit.
+	*/
+	virtual void* allocate(size_t numBytes) override;
+	/**
+	* Does nothing. The memory is released by rewind or reset.
+	*/
+	virtual void deallocate(void* block, size_t numBytes) override;
+	/**
+	* Returns the current position of the arena.
+	*/
+	Marker getMarker() const;
+	/**
+	* Releases every block which was allocated after the given position. The regular chunks are kept for reuse; the oversized ones are returned to the global heap.
+	* @param marker A position which was returned by getMarker. Rewinding to a later position than the current one is not allowed.
+	*/
+	void rewind(const Marker& marker);
+	/**
+	* Releases every block of the arena at once. Every block allocated from the arena is invalid afterwards.
+	*/
+	void reset();
+
+private:
+	/**
+	* The size of the regular chunks, in bytes.
+	*/
+	size_t chunkSize;
+	/**
+	* The regular chunks. Chunks before currentChunkIndex are full.
+	*/
+	std::vector<char*> chunks;
+	/**
+	* Chunks of requests which are larger than chunkSize.
+	*/
+	std::vector<char*> oversizedChunks;
+	/**
+	* Index of the chunk which serves the requests. Equal to chunks.size() if there is no chunk yet.
+	*/
+	size_t currentChunkIndex;
+	/**
+	* Offset of the first free byte of the current chunk.
+	*/
+	size_t currentOffset;
+};
+
+/**
+* Routes the memory requests of the matrices (the MatrixBase objects and their element storage) to an allocator. By default, every request goes to the global heap.
+* A request may name its allocator explicitly (see MatrixStorageAllocator), otherwise it goes to the default allocator.
+* Every block remembers the allocator which served it, so it is always released correctly, even if the default allocator was switched in the meantime.
+*/
+class MatrixMemory
+{
+public:
+	/**
+	* Allocates a block for a matrix.
+	* @param numBytes The size of the block.
+	* @param allocator The allocator which serves the block. nullptr means the default allocator.
+	*/
+	static void* allocate(size_t numBytes, MatrixAllocator* allocator = nullptr);
+	/**
+	* Releases a block which was allocated by MatrixMemory::allocate, through the allocator which served it.
+	* @param block Pointer to the block. Nothing happens if it is nullptr.
+	*/
+	static void deallocate(void* block);
+	/**
+	* Sets the allocator which serves the requests of every thread which don't name an allocator. It must be thread-safe if matrices are created on several threads.
+	* @param allocator The new default allocator. nullptr restores the global heap. It must outlive every matrix it allocates.
+	*/
+	static void setDefaultAllocator(MatrixAllocator* allocator);
+	/**
+	* Returns the counters of the memory requests of the matrices, summed over every thread.
+	*/
+	static MatrixAllocationStats getStats();
+	/**
+	* Sets every counter back to zero.
+	*/
+	static void resetStats();
+	/**
+	* Allocates a block from the global heap, and counts it as a system allocation. Used by the allocators.
+	* @param numBytes The size of the block.
+	*/
+	static void* systemAllocate(size_t numBytes);
+	/**
+	* Deallocates a block which was allocated by systemAllocate, and counts it as a system deallocation. Used by the allocators.
+	* @param block Pointer to the block.
+	*/
+	static void systemDeallocate(void* block);
+};
+
+/**
+* Lends the scratch arena of the calling thread for the temporaries of an operation, for as long as the scope object lives. Everything allocated from the arena inside the scope is released at once when the scope ends.
+* Nothing is redirected: only the storage which is explicitly given the allocator of the scope comes from the arena (e.g. DenseMatrix::CellStorage temp(n, 0.0, scratchScope.getAllocator()), or DenseMatrix::createCopy). Every other matrix is allocated as usual, so it may safely outlive the scope.
+* Nested scopes share the arena, and each of them rewinds it to where it started, so recursive algorithms can open a scope at every level. The scratch storage of an outer scope must not grow while an inner scope is active, and the storage of a scope must be destroyed before the scope ends.
+*/
+class MatrixScratchScope
+{
+public:
+	/**
+	* Remembers the current position of the scratch arena of the calling thread.
+	*/
+	MatrixScratchScope();
+	/**
+	* Scopes can't be copied.
+	*/
+	MatrixScratchScope(const MatrixScratchScope& other) = delete;
+	/**
+	* Scopes can't be copied.
+	*/
+	MatrixScratchScope& operator=(const MatrixScratchScope& other) = delete;
+	/**
+	* Rewinds the arena to where it was when the scope began.
+	*/
+	~MatrixScratchScope();
+	/**
+	* Returns the scratch arena, to be passed to the temporaries of the scope. It must only be used on the thread which created the scope.
+	*/
+	MatrixAllocator* getAllocator() const;
+
+private:
+	/**
+	* The position of the arena when the scope began.
+	*/
+	ArenaMatrixAllocator::Marker beginMarker;
+
+	/**
+	* Returns the scratch arena of the calling thread.
+	*/
+	static ArenaMatrixAllocator& getThreadArena();
+};
+
+/**
+* Standard-library-compatible allocator, which routes the element storage of the matrices (std::vector, std::map) through MatrixMemory, to the allocator which it was created with (the default allocator unless one is given).
+* A copy of a container doesn't inherit the allocator (see select_on_container_copy_construction), so copying a scratch matrix gives an ordinary one. Containers with different allocators never exchange their buffers: assignment copies or moves the elements instead.
+*/
+template <typename T>
+class MatrixStorageAllocator
+{
+public:
+	/**
+	* The type of the allocated elements.
+	*/
+	typedef T value_type;
+
+	/**
+	* Creates an allocator which serves the storage from the default allocator.
+	*/
+	MatrixStorageAllocator() noexcept
+		: allocator(nullptr)
+	{
+	}
+	/**
+	* Creates an allocator which serves the storage from the given allocator (e.g. the arena of a MatrixScratchScope).
+	* @param allocator The allocator of the storage. nullptr means the default allocator. It must outlive the storage.
+	*/
+	MatrixStorageAllocator(MatrixAllocator* allocator) noexcept
+		: allocator(allocator)
+	{
+	}
+	/**
+	* Converting constructor (used by containers which allocate their nodes).
+	*/
+	template <typename U>
+	MatrixStorageAllocator(const MatrixStorageAllocator<U>& other) noexcept
+		: allocator(other.getAllocator())
+	{
+	}
+	/**
+	* Returns the allocator which serves the storage. nullptr means the default allocator.
+	*/
+	MatrixAllocator* getAllocator() const noexcept
+	{
+		return allocator;
+	}
+	/**
+	* The copy of a container gets the default allocator, so that it may outlive the allocator of the original.
+	*/
+	MatrixStorageAllocator select_on_container_copy_construction() const noexcept
+	{
+		return MatrixStorageAllocator();
+	}
+	/**
+	* Allocates memory for numElements elements.
+	*/
+	T* allocate(size_t numElements)
+	{
+		return static_cast<T*>(MatrixMemory::allocate(numElements * sizeof(T), allocator));
+	}
+	/**
+	* Releases memory which was allocated by allocate.
+	*/
+	void deallocate(T* elements, size_t)
+	{
+		MatrixMemory::deallocate(elements);
+	}
+	/**
+	* Default-initializes an element, which leaves a scalar uninitialized. So resize(n) without a value doesn't fill the new elements; pass the value (e.g. resize(n, 0.0)) to fill them.
+	*/
+	template <typename U>
+	void construct(U* element) noexcept(std::is_nothrow_default_constructible<U>::value)
+	{
+		::new (static_cast<void*>(element)) U;
+	}
+	/**
+	* Constructs an element from the given arguments.
+	*/
+	template <typename U, typename... Args>
+	void construct(U* element, Args&&... args)
+	{
+		::new (static_cast<void*>(element)) U(std::forward<Args>(args)...);
+	}
+
+private:
+	/**
+	* The allocator which serves the storage. nullptr means the default allocator.
+	*/
+	MatrixAllocator* allocator;
+};
+
+/**
+* Two MatrixStorageAllocator instances are equal if they serve the storage from the same allocator.
+*/
+template <typename T, typename U>
+bool operator==(const MatrixStorageAllocator<T>& left, const MatrixStorageAllocator<U>& right)
+{
+	return left.getAllocator() == right.getAllocator();
+}
+
+/**
+* Two MatrixStorageAllocator instances are equal if they serve the storage from the same allocator.
+*/
+template <typename T, typename U>
+bool operator!=(const MatrixStorageAllocator<T>& left, const MatrixStorageAllocator<U>& right)
+{
+	return !(left == right);
+}
+
+#endif // MATRIX_MEMORY_H
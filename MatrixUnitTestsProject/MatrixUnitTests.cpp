@@ -1,5 +1,12 @@
 #include "Matrix.h"
 #include "MatCalcUtil.h"
+#include "MatCalcKernels.h"
+#include "MatrixCostModel.h"
+#include "FixedMatrix.h"
+#include "SparseMatrix.h"
+#include "TriangularMatrix.h"
+#include "NonZeroVisitor.h"
+#include <algorithm>
 #include <iostream>
 #include <assert.h>
 
@@ -2380,5 +2387,1257 @@ int main()
 	std::string m107_print_str = m107.getPrintStr(2);
 	assert(streq(m107_print_str, m107_print_str_test));
 
+	// ****************************** Expression templates ******************************
+	// Chained element-wise operations (Dense, Sparse, Dense)
+	Matrix m108 = Matrix::createDense(2, 2, 1);
+	Matrix m109 = Matrix::createIdentity(2);
+	Matrix m110 = Matrix::createDense(2, 2, 3);
+	Matrix m108plusm109minusm110 = m108 + m109 - m110;
+	assert(deq(m108plusm109minusm110.getCell(0, 0), -1));
+	assert(deq(m108plusm109minusm110.getCell(0, 1), -2));
+	assert(deq(m108plusm109minusm110.getCell(1, 0), -2));
+	assert(deq(m108plusm109minusm110.getCell(1, 1), -1));
+
+	// Scaled chain (2 * Dense + Sparse * 3)
+	Matrix number2timesm108plusm109times3 = 2.0 * m108 + m109 * 3;
+	assert(deq(number2timesm108plusm109times3.getCell(0, 0), 5));
+	assert(deq(number2timesm108plusm109times3.getCell(0, 1), 2));
+	assert(deq(number2timesm108plusm109times3.getCell(1, 0), 2));
+	assert(deq(number2timesm108plusm109times3.getCell(1, 1), 5));
+
+	// Chain of Sparse matrices stays Sparse and cancels out.
+	Matrix m111 = Matrix::createIdentity(3);
+	Matrix m111minusm111 = m111 + m111 - 2 * m111;
+	assert(m111minusm111 == Matrix::createZero(3, 3));
+	assert(deq(m111minusm111.getDensity(), 0));
+
+	// Aliasing assignment (the expression refers to the result).
+	m108 = m108 + m108 * 2;
+	assert(m108 == Matrix::createDense(2, 2, 3));
+
+	// Nested chain over a rectangular Dense result, row by row: the scalar of a sum is folded into its operands, and the non-zero count is recounted.
+	Matrix m231 = Matrix::createDense(3, 4, 0);
+	Matrix m232 = Matrix::createSparse(3, 4);
+	for (size_t r = 0; r < 3; r++)
+	{
+		for (size_t c = 0; c < 4; c++)
+		{
+			m231.setCell(r, c, (double)(r * 4 + c));
+		}
+	}
+	m232.setCell(1, 2, 6);
+	m232.setCell(2, 3, -1);
+	Matrix m233 = 0.5 * (m231 - m232 * 2) + m232 - m231 * 0.5;
+	for (size_t r = 0; r < 3; r++)
+	{
+		for (size_t c = 0; c < 4; c++)
+		{
+			assert(deq(m233.getCell(r, c), 0));
+		}
+	}
+	assert(m233.getNumNonZeros() == 0);
+
+	// Products fall back to eager evaluation.
+	Matrix m108plusm110timesm109 = (m108 + m110) * m109;
+	assert(m108plusm110timesm109 == Matrix::createDense(2, 2, 6));
+
+	// Dimension mismatch results in an invalid matrix.
+	Matrix m112 = m108 + Matrix::createDense(3, 3, 1);
+	assert(m112.getNumRows() == 0);
+	assert(m112.getNumColumns() == 0);
+
+	// ****************************** In-place operations ******************************
+	// Compound assignment (Dense += Dense, Dense -= Sparse, scalar *=)
+	Matrix m113 = Matrix::createDense(2, 2, 1);
+	m113 += Matrix::createDense(2, 2, 2);
+	assert(m113 == Matrix::createDense(2, 2, 3));
+	m113 -= Matrix::createIdentity(2);
+	assert(deq(m113.getCell(0, 0), 2));
+	assert(deq(m113.getCell(0, 1), 3));
+	m113 *= 2;
+	assert(deq(m113.getCell(1, 1), 4));
+	assert(deq(m113.getCell(1, 0), 6));
+
+	// Sparse += Sparse cancels out, and aliasing works.
+	Matrix m114 = Matrix::createIdentity(3);
+	m114 -= Matrix::createIdentity(3);
+	assert(m114 == Matrix::createZero(3, 3));
+	Matrix m115 = Matrix::createIdentity(2);
+	m115 += m115;
+	assert(deq(m115.getCell(0, 0), 2));
+	assert(deq(m115.getCell(0, 1), 0));
+
+	// axpy
+	Matrix m116 = Matrix::createDense(2, 2, 1);
+	m116.axpy(-0.5, Matrix::createDense(2, 2, 4));
+	assert(m116 == Matrix::createDense(2, 2, -1));
+
+	// gemm: C = 2 * A * B + 3 * C
+	Matrix m117 = Matrix::createDense(2, 3, 1);
+	Matrix m118 = Matrix::createDense(3, 2, 2);
+	Matrix m119 = Matrix::createIdentity(2);
+	m119.toDense();
+	m119.gemm(2, m117, m118, 3);
+	assert(deq(m119.getCell(0, 0), 15));
+	assert(deq(m119.getCell(0, 1), 12));
+
+	// gemm with a Sparse result and a Sparse operand.
+	Matrix m120 = Matrix::createZero(2, 2);
+	m120.gemm(1, Matrix::createIdentity(2), Matrix::createDense(2, 2, 5), 0);
+	assert(m120 == Matrix::createDense(2, 2, 5));
+
+	// Sparse gemm over the rows of Sparse and Dense operands: an existing element cancels out and is erased, new ones are inserted, the others are updated.
+	Matrix m234 = Matrix::createSparse(40, 30);
+	Matrix m235 = Matrix::createSparse(40, 50);
+	Matrix m236 = Matrix::createDense(50, 30, 0);
+	for (size_t r = 0; r < 50; r++)
+	{
+		for (size_t c = 0; c < 30; c++)
+		{
+			m236.setCell(r, c, (double)((r * 7 + c * 3) % 5) - 2.0);
+		}
+	}
+	for (size_t r = 0; r < 40; r++)
+	{
+		m234.setCell(r, (r * 11) % 30, 1.5);
+		m235.setCell(r, (r * 13) % 50, 1.0);
+		m235.setCell(r, (r * 17 + 3) % 50, -0.5);
+	}
+	m234.setCell(0, 5, 4.0 * (m236.getCell(0, 5) - 0.5 * m236.getCell(3, 5)));
+	Matrix m237 = Matrix::createDense(40, 30, 0);
+	m237.gemm(1, m234, Matrix::createIdentity(30), 0);
+	m237.gemm(-2, m235, m236, 0.5);
+	m234.gemm(-2, m235, m236, 0.5);
+	assert(m234.getCell(0, 5) == 0.0);
+	for (size_t r = 0; r < 40; r++)
+	{
+		for (size_t c = 0; c < 30; c++)
+		{
+			assert(deq(m234.getCell(r, c), m237.getCell(r, c)));
+		}
+	}
+	m234.gemm(1, Matrix::createIdentity(40), m234 * -1.0, 1);
+	assert(m234.getNumNonZeros() == 0);
+
+	// gemm where the result is also an operand (C = C * C).
+	Matrix m121 = Matrix::createDense(2, 2, 1);
+	m121.gemm(1, m121, m121, 0);
+	assert(m121 == Matrix::createDense(2, 2, 2));
+
+	// Dimension mismatch results in an invalid matrix.
+	Matrix m122 = Matrix::createDense(2, 2, 1);
+	m122 += Matrix::createDense(3, 3, 1);
+	assert(m122.getNumRows() == 0);
+
+	// ****************************** Mixed-type kernels ******************************
+	// Dense and Sparse operands (the Sparse operand is iterated by its non-zero elements).
+	Matrix m123 = Matrix::createDense(2, 3, 1);
+	Matrix m124 = Matrix::createSparse(2, 3);
+	m124.setCell(0, 2, 4);
+	m124.setCell(1, 0, -2);
+	Matrix m124minusm123 = m124 - m123;
+	assert(deq(m124minusm123.getCell(0, 0), -1));
+	assert(deq(m124minusm123.getCell(0, 2), 3));
+	assert(deq(m124minusm123.getCell(1, 0), -3));
+	Matrix m123mergem124 = m123.mergeByRows(m124);
+	assert(m123mergem124.getNumRows() == 4);
+	assert(deq(m123mergem124.getCell(2, 2), 4));
+	assert(deq(m123mergem124.getCell(3, 1), 0));
+	Matrix m124mergem123 = m124.mergeByColumns(m123);
+	assert(deq(m124mergem123.getCell(1, 0), -2));
+	assert(deq(m124mergem123.getCell(1, 5), 1));
+	m124.transpose();
+	Matrix m123timesm124 = m123 * m124;
+	assert(deq(m123timesm124.getCell(0, 0), 4));
+	assert(deq(m123timesm124.getCell(1, 1), -2));
+	Matrix m124timesm123 = m124 * m123;
+	assert(deq(m124timesm123.getCell(2, 1), 4));
+	assert(deq(m124timesm123.getCell(0, 0), -2));
+	Matrix m125 = Matrix::createDense(3, 2, 0);
+	m125.setCell(2, 0, 4);
+	m125.setCell(0, 1, -2);
+	assert(m125 == m124);
+	assert(m124 == m125);
+	m125.setCell(1, 1, 1e-3);
+	assert(m125 != m124);
+
+	// ****************************** Views over DenseMatrix ******************************
+	// Sub matrices and splits are copied out of strided views in a single pass.
+	Matrix m126 = Matrix::createDense(3, 4, 0);
+	for (size_t r = 0; r < 3; r++)
+	{
+		for (size_t c = 0; c < 4; c++)
+		{
+			m126.setCell(r, c, (double)(r * 10 + c + 1));
+		}
+	}
+	Matrix m126sub = m126.getSubMatrix(1, 2);
+	assert(m126sub.getNumRows() == 2 && m126sub.getNumColumns() == 3);
+	assert(deq(m126sub.getCell(0, 0), 1));
+	assert(deq(m126sub.getCell(0, 2), 4));
+	assert(deq(m126sub.getCell(1, 1), 22));
+	assert(deq(m126sub.getCell(1, 2), 24));
+	Matrix m126right = m126.splitByColumn(3, false);
+	assert(m126right.getNumColumns() == 1);
+	assert(deq(m126right.getCell(2, 0), 24));
+	Matrix m126bottomRight = m126.getSubMatrix(1, 2, 2, 2);
+	assert(deq(m126bottomRight.getCell(1, 0), 23));
+	DenseMatrixView m126view;
+	assert(m126.getSubView(1, 2, 2, 2, &m126view) && deq(m126view.getCell(1, 0), 23) && m126view.getNumNonZeros() == 4);
+	assert(!m126.getSubView(2, 2, 0, 1, &m126view) && !Matrix::createSparse(3, 4).getSubView(0, 1, 0, 1, &m126view));
+	Matrix m251 = Matrix::createFromView(m126view);
+	assert(m251.isDense() && m251 == m126bottomRight);
+
+	// Transpose and resize re-arrange the contiguous storage.
+	Matrix m127 = m126;
+	m127.transpose();
+	assert(m127.getNumRows() == 4 && m127.getNumColumns() == 3);
+	assert(deq(m127.getCell(3, 1), 14));
+	m127.resizeNumColumns(2);
+	assert(deq(m127.getCell(3, 1), 14));
+	m127.resize(5, 4);
+	assert(deq(m127.getCell(3, 1), 14));
+	assert(deq(m127.getCell(4, 3), 0));
+	assert(deq(m127.getCell(0, 3), 0));
+
+	// ****************************** Non-zero count ******************************
+	// setCell keeps the count of DenseMatrix up to date.
+	Matrix m128 = Matrix::createDense(4, 4, 0);
+	assert(m128.getNumNonZeros() == 0);
+	m128.setCell(0, 0, 5);
+	m128.setCell(1, 1, 5);
+	m128.setCell(1, 1, 6);
+	assert(m128.getNumNonZeros() == 2);
+	m128.setCell(0, 0, 0);
+	assert(m128.getNumNonZeros() == 1);
+	assert(deq(m128.getDensity(), 1.0 / 16));
+
+	// Bulk operations (resize, in-place arithmetic, products) leave a correct count behind.
+	m128.resize(2, 2);
+	assert(m128.getNumNonZeros() == 1);
+	m128 += Matrix::createDense(2, 2, 1);
+	assert(m128.getNumNonZeros() == 4);
+	m128 *= 0;
+	assert(m128.getNumNonZeros() == 0);
+	Matrix m129 = Matrix::createDense(3, 3, 2) * Matrix::createDense(3, 3, 1);
+	assert(m129.getNumNonZeros() == 9);
+	m129.resizeNumColumns(1);
+	assert(m129.getNumNonZeros() == 3);
+	assert(m129.isDense());
+
+	// ****************************** Cost model ******************************
+	// Break-even density = 2 / ((64 / 8) + (10 / 1)) = 1/9. No conversions within +-25% of it.
+	MatrixCostModel costModel(8, 64, 1, 10, 0.25);
+	assert(deq(costModel.getBreakEvenDensity(), 1.0 / 9));
+	assert(costModel.shouldConvertToSparse(10, 10, 5));
+	assert(costModel.shouldConvertToSparse(10, 10, 10) == false);
+	assert(costModel.shouldConvertToDense(10, 10, 12) == false);
+	assert(costModel.shouldConvertToDense(10, 10, 20));
+	assert(costModel.shouldConvertToSparse(0, 0, 0) == false);
+
+	// Empty DenseMatrix and full SparseMatrix always require conversion, regardless of the calibration.
+	Matrix m130 = Matrix::createDense(8, 8, 0);
+	assert(m130.requiresConversion());
+	m130.convertToAppropriateMatrixType();
+	assert(m130.requiresConversion() == false);
+	Matrix m131 = Matrix::createSparse(2, 2);
+	m131 += Matrix::createDense(2, 2, 1);
+	assert(m131.requiresConversion());
+	assert(MatrixCostModel::getInstance().getBreakEvenDensity() > 0);
+	assert(costModel.isDenseCheaper(10, 10, 12));
+	assert(costModel.isDenseCheaper(10, 10, 10) == false);
+
+	// ****************************** Sparse products ******************************
+	// The estimate is exact for small matrices (it only ignores cancellation).
+	SparseMatrix sm1(3, 3); // Diagonal.
+	SparseMatrix sm2(3, 3); // Single non-zero column.
+	SparseMatrix sm3(3, 3); // Single non-zero row.
+	for (size_t i = 0; i < 3; i++)
+	{
+		sm1.setCell(i, i, (double)(i + 1));
+		sm2.setCell(i, 1, 2.0);
+		sm3.setCell(0, i, 1.0);
+	}
+	assert(sm2.estimateProductNumNonZeros(sm1) == 3);
+	assert(sm2.estimateProductNumNonZeros(sm3) == 1);
+	assert(sm3.estimateProductNumNonZeros(sm2) == 0);
+	assert(sm2.estimateProductNumNonZeros(sm2) == 3);
+	assert(SparseMatrix(3, 3).estimateProductNumNonZeros(sm1) == 0);
+
+	Matrix m132 = Matrix::createSparse(3, 3);
+	Matrix m133 = Matrix::createSparse(3, 3);
+	for (size_t i = 0; i < 3; i++)
+	{
+		m132.setCell(i, i, (double)(i + 1));
+		m133.setCell(i, 1, 2.0);
+	}
+	Matrix m134 = m132 * m133;
+	assert(m134.getNumNonZeros() == 3);
+	assert(deq(m134.getCell(0, 1), 2) && deq(m134.getCell(1, 1), 4) && deq(m134.getCell(2, 1), 6));
+
+	// A full product of two sparse matrices, cancellation included.
+	Matrix m135 = Matrix::createSparse(2, 2);
+	m135.setCell(0, 0, 1); m135.setCell(0, 1, 1); m135.setCell(1, 0, 1); m135.setCell(1, 1, -1);
+	Matrix m136 = m135 * m135;
+	assert(deq(m136.getCell(0, 0), 2) && deq(m136.getCell(0, 1), 0) && deq(m136.getCell(1, 0), 0) && deq(m136.getCell(1, 1), 2));
+	assert(m136.getNumNonZeros() == 2);
+
+	// ****************************** Tolerance ******************************
+	// The relative tolerance is based on the magnitudes, so it works the same for negative numbers.
+	assert(mcu::doubleAlmostEqual(1e6, 1e6 + 1e-7));
+	assert(mcu::doubleAlmostEqual(-1e6, -1e6 - 1e-7));
+	assert(mcu::doubleAlmostEqual(-484, -484 + 1e-11));
+	assert(mcu::doubleAlmostEqual(-1e6, -1e6 - 1) == false);
+	assert(mcu::doubleAlmostEqual(-1e6, 1e6) == false);
+	assert(mcu::doubleAlmostEqual(0, -1e-14));
+	assert(mcu::doubleAlmostEqual(NAN, NAN) && mcu::doubleAlmostEqual(NAN, 0) == false);
+
+	// ****************************** Fixed-size matrices ******************************
+	constexpr FixedMatrix2 fx1 = FixedMatrix2::createIdentity() * 3.0;
+	static_assert((fx1 * fx1).getCell(1, 1) == 9.0, "FixedMatrix multiplication should be constexpr.");
+	static_assert(fx1.getDeterminant() == 9.0, "FixedMatrix determinant should be constexpr.");
+
+	// Compare against Matrix for 3x3 and 4x4.
+	Matrix m138 = Matrix::createDense(4, 4, 0);
+	double fxValues[16] = { 2, -1, 0, 3, 1, 4, 2, 0, 0, 5, -2, 1, 3, 0, 1, 6 };
+	for (size_t i = 0; i < 16; i++)
+	{
+		m138.setCell(i / 4, i % 4, fxValues[i]);
+	}
+	FixedMatrix4 fx2;
+	assert(FixedMatrix4::fromMatrix(m138, &fx2));
+	assert(FixedMatrix3::fromMatrix(m138, nullptr) == false);
+	double m138det = m138.getDeterminant();
+	assert(deq(fx2.getDeterminant(), m138det));
+	assert(fx2.getInverse(m138det).toMatrix() == m138.getInverse(m138det));
+	assert((fx2 * fx2.getInverse(fx2.getDeterminant())) == FixedMatrix4::createIdentity());
+	Matrix m138t = m138;
+	m138t.transpose();
+	assert((fx2 * fx2.getTransposed()).toMatrix() == m138 * m138t);
+
+	Matrix m139 = m138.getSubMatrix(0, 3, 1, 3);
+	FixedMatrix3 fx3;
+	assert(FixedMatrix3::fromMatrix(m139, &fx3));
+	double m139det = m139.getDeterminant();
+	assert(deq(fx3.getDeterminant(), m139det));
+	assert(fx3.getInverse(m139det).toMatrix() == m139.getInverse(m139det));
+
+	FixedMatrix<2, 3> fx4;
+	fx4.setCell(0, 2, 1);
+	FixedMatrix<3, 1> fx5;
+	fx5.setCell(2, 0, 5);
+	FixedMatrix<2, 1> fx6 = fx4 * fx5;
+	assert(deq(fx6.getCell(0, 0), 5) && deq(fx6.getCell(1, 0), 0));
+
+	// ****************************** Matrix memory ******************************
+	// The temporary sub-matrices of a (Laplace expansion) determinant come from the scratch arena (a few chunks instead of one heap allocation each). Dense determinants use LU, which needs a single copy.
+	Matrix m140 = Matrix::createSparse(6, 6);
+	for (size_t i = 0; i < 36; i++)
+	{
+		m140.setCell(i / 6, i % 6, (double)((i * 7) % 11) - 5);
+	}
+	double m140det = m140.getDeterminant(); // Warms up the arena of this thread.
+	MatrixMemory::resetStats();
+	assert(deq(m140.getDeterminant(), m140det));
+	MatrixAllocationStats memoryStats = MatrixMemory::getStats();
+	assert(memoryStats.numRequests > 100);
+	assert(memoryStats.numSystemAllocations == 0);
+	assert(memoryStats.numReleases == memoryStats.numRequests);
+
+	// Only the storage which is given the arena comes from it; copies of it, and the other matrices of the scope, outlive the scope.
+	Matrix m238 = Matrix::createSparse(3, 3);
+	DenseMatrix* dm238 = nullptr;
+	{
+		MatrixScratchScope scratchScope;
+		m238.setCell(1, 2, 5);
+		m238 = m238 * 2;
+		MatrixMemory::resetStats();
+		DenseMatrix scratchMatrix(3, 3, 7.0, scratchScope.getAllocator());
+		DenseMatrix::CellStorage scratchCells(100, 1.0, scratchScope.getAllocator());
+		assert(MatrixMemory::getStats().numSystemAllocations == 0);
+		dm238 = scratchMatrix.cloneAsDenseMatrix();
+	}
+	{
+		MatrixScratchScope scratchScope;
+		DenseMatrix::CellStorage scratchCells(1000, -1.0, scratchScope.getAllocator()); // Reuses the chunks of the previous scope.
+	}
+	assert(deq(m238.getCell(1, 2), 10) && m238.getNumNonZeros() == 1);
+	assert(deq(dm238->getCell(2, 2), 7) && dm238->getNumNonZeros() == 9);
+	delete dm238;
+
+	// A pool reuses the blocks of repeated shapes.
+	PoolMatrixAllocator pool;
+	MatrixMemory::setDefaultAllocator(&pool);
+	{
+		Matrix m141 = Matrix::createSparse(4, 4);
+		m141.setCell(1, 2, 3);
+	}
+	MatrixMemory::resetStats();
+	for (size_t i = 0; i < 10; i++)
+	{
+		Matrix m141 = Matrix::createSparse(4, 4);
+		m141.setCell(1, 2, 3);
+	}
+	memoryStats = MatrixMemory::getStats();
+	assert(memoryStats.numRequests >= 20);
+	assert(memoryStats.numSystemAllocations == 0);
+	MatrixMemory::setDefaultAllocator(nullptr);
+
+	// Blocks which were allocated after a marker are released by rewinding to it.
+	ArenaMatrixAllocator arena(256);
+	void* block1 = arena.allocate(100);
+	ArenaMatrixAllocator::Marker marker = arena.getMarker();
+	void* block2 = arena.allocate(100);
+	arena.allocate(1000); // Oversized.
+	arena.rewind(marker);
+	assert(arena.allocate(100) == block2);
+	arena.reset();
+	assert(arena.allocate(100) == block1);
+
+	// ****************************** Structured matrices ******************************
+	// A dense operand for the structured kernels, and its general copy for the reference results.
+	Matrix m142 = Matrix::createDense(3, 3, 0);
+	for (size_t i = 0; i < 9; i++)
+	{
+		m142.setCell(i / 3, i % 3, (double)((i * 5) % 7) - 2);
+	}
+	Matrix m143 = Matrix::createSparse(3, 3);
+	for (size_t i = 0; i < 9; i += 2)
+	{
+		m143.setCell(i / 3, i % 3, m142.getCell(i / 3, i % 3));
+	}
+
+	// Identity: O(1) storage, a copy of the other operand, the old output.
+	Matrix m144 = Matrix::createIdentity(3);
+	assert(m144 * m142 == m142 && m142 * m144 == m142 && m143 * m144 == m143);
+	assert(deq(m144.getDeterminant(), 1) && m144.getRank() == 3);
+	Matrix m145 = Matrix::createSparse(3, 3);
+	for (size_t d = 0; d < 3; d++)
+	{
+		m145.setCell(d, d, 1);
+	}
+	assert(m144 == m145 && m144.getPrintStr(2) == m145.getPrintStr(2));
+	m144 *= 2; // Turns into a general matrix.
+	assert(deq(m144.getCell(1, 1), 2) && deq(m144.getCell(0, 1), 0));
+
+	// Diagonal: scales rows from the left and columns from the right.
+	Matrix m146 = Matrix::createDiagonal({ 2, -1, 3 });
+	Matrix m147 = m146;
+	m147.toDense();
+	assert(m146 * m142 == m147 * m142 && m142 * m146 == m142 * m147);
+	assert(m146 * m143 == m147 * m143 && m143 * m146 == m143 * m147);
+	assert(m146 * m146 == m147 * m147);
+	assert(deq(m146.getDeterminant(), -6) && m146.getInverse(-6) * m146 == Matrix::createIdentity(3));
+	m146.setCell(1, 1, 0); // Stays diagonal.
+	assert(m146.getRank() == 2 && m146.getNumNonZeros() == 2);
+	m146.setCell(0, 2, 4); // Turns into a general matrix.
+	assert(deq(m146.getCell(0, 2), 4) && deq(m146.getCell(2, 2), 3));
+
+	// Permutation: an index remap.
+	Matrix m148 = Matrix::createPermutation({ 2, 0, 1 });
+	Matrix m149 = m148;
+	m149.toDense();
+	assert(m148 * m142 == m149 * m142 && m142 * m148 == m142 * m149);
+	assert(m148 * m143 == m149 * m143 && m143 * m148 == m143 * m149);
+	assert(m148 * m148 == m149 * m149);
+	assert(deq(m148.getDeterminant(), m149.getDeterminant()));
+	assert(m148.getInverse(1) * m148 == Matrix::createIdentity(3));
+	assert(Matrix::createPermutation({ 0, 0, 1 }).getNumRows() == 0); // Not a permutation: invalid.
+	Matrix m150 = Matrix::createPermutation({ 1, 0, 3, 2, 4 });
+	assert(deq(m150.getDeterminant(), 1));
+
+	// Triangular: packed storage, substitution.
+	Matrix m151 = Matrix::createTriangular(3, true);
+	TriangularMatrix lower(3, false);
+	for (size_t r = 0; r < 3; r++)
+	{
+		for (size_t c = r; c < 3; c++)
+		{
+			m151.setCell(r, c, (double)(r + c + 1));
+			lower.setCell(c, r, (double)(r + c + 1));
+		}
+	}
+	Matrix m152 = m151;
+	m152.toDense();
+	assert(m151 * m142 == m152 * m142 && m142 * m151 == m142 * m152);
+	assert(deq(m151.getDeterminant(), m152.getDeterminant()));
+	m151.transpose();
+	m152.transpose();
+	assert(m151 == m152 && m151.getCell(2, 0) == 3);
+	DenseMatrix rightHandSide(3, 2, 1.0);
+	rightHandSide.setCell(2, 1, 5);
+	MatrixBase* solution = lower.solve(rightHandSide);
+	MatrixBase* product = lower.multiply(*solution);
+	assert(product->equal(rightHandSide));
+	delete product;
+	delete solution;
+	assert(TriangularMatrix(2, true).solve(rightHandSide) == nullptr);
+	// The non-zeros are visited in row-major order, by the typed loops of Dense and Sparse, and by forEachNonZero otherwise.
+	DenseMatrix* lowerDense = lower.cloneAsDenseMatrix();
+	SparseMatrix* lowerSparse = lower.cloneAsSparseMatrix();
+	std::vector<double> lowerVisits[3];
+	mcu::visitNonZeros(lower, [&](size_t row, size_t column, double value) { lowerVisits[0].push_back(row * 100 + column * 10 + value); });
+	mcu::visitNonZeros(*lowerDense, [&](size_t row, size_t column, double value) { lowerVisits[1].push_back(row * 100 + column * 10 + value); });
+	mcu::visitNonZeros(*lowerSparse, [&](size_t row, size_t column, double value) { lowerVisits[2].push_back(row * 100 + column * 10 + value); });
+	assert(lowerVisits[0].size() == 6 && lowerVisits[0] == lowerVisits[1] && lowerVisits[0] == lowerVisits[2]);
+	delete lowerDense;
+	delete lowerSparse;
+	m151.setCell(0, 2, 1); // Outside of the lower triangle: turns into a general matrix.
+	assert(deq(m151.getCell(0, 2), 1) && deq(m151.getCell(2, 0), 3));
+
+	// Symmetric: only the upper half is stored, both halves are set.
+	Matrix m153 = Matrix::createSymmetric(3);
+	m153.setSymmetricCell(0, 1, 4);
+	m153.setSymmetricCell(2, 1, -2);
+	m153.setCell(2, 2, 1);
+	m153.setCell(1, 0, 4); // The mirror cell already holds the value.
+	assert(deq(m153.getCell(1, 0), 4) && deq(m153.getCell(1, 2), -2) && m153.getNumNonZeros() == 5);
+	Matrix m250 = m153;
+	m250.setCell(0, 2, 7); // Changes exactly one cell: turns into a general matrix.
+	assert(deq(m250.getCell(0, 2), 7) && deq(m250.getCell(2, 0), 0) && deq(m250.getCell(1, 0), 4) && m250.getNumNonZeros() == 6);
+	m250 *= 2;
+	assert(deq(m250.getCell(0, 2), 14) && deq(m250.getCell(2, 1), -4));
+	Matrix m154 = m153;
+	m154.toDense();
+	assert(m153 * m142 == m154 * m142 && m142 * m153 == m142 * m154);
+	assert(Matrix(m153 + m142) == Matrix(m154 + m142) && Matrix(m142 - m153) == Matrix(m142 - m154));
+	m153.resize(3, 4); // Turns into a general matrix.
+	assert(m153.getNumColumns() == 4 && deq(m153.getCell(1, 0), 4));
+
+	// ****************************** Tiled matrices ******************************
+	// Dense 4x4 blocks on the diagonal, and a sparse far field.
+	Matrix m155 = Matrix::createDense(12, 12, 0);
+	DenseMatrix blocks(12, 12, 0.0);
+	for (size_t r = 0; r < 12; r++)
+	{
+		for (size_t c = 0; c < 12; c++)
+		{
+			if (r / 4 == c / 4)
+			{
+				m155.setCell(r, c, (double)((r * 3 + c) % 5) + 1);
+				blocks.setCell(r, c, (double)((r * 3 + c) % 5) + 1);
+			}
+		}
+	}
+	m155.setCell(0, 11, 2);
+	m155.setCell(11, 1, -3);
+	blocks.setCell(0, 11, 2);
+	TiledMatrix* tiled = TiledMatrix::fromMatrix(blocks, 4);
+	assert(tiled->getNumTileRows() == 3 && tiled->getNumNonZeros() == 49);
+	assert(tiled->getTileStorage(1, 1) == TiledMatrix::TileStorage::Dense);
+	assert(tiled->getTileStorage(0, 2) == TiledMatrix::TileStorage::Sparse);
+	assert(tiled->getTileStorage(1, 2) == TiledMatrix::TileStorage::Zero);
+	tiled->setCell(0, 11, 0);
+	tiled->updateTileStorage();
+	assert(tiled->getTileStorage(0, 2) == TiledMatrix::TileStorage::Zero);
+	delete tiled;
+
+	// Products and sums match the general ones, with tiled, dense and sparse operands.
+	Matrix m156 = m155;
+	m156.toTiled(4);
+	Matrix m157 = m155;
+	m157.toSparse();
+	assert(m156 == m155 && m155 == m156 && m157 == m156);
+	assert(m156 * m156 == m155 * m155 && m155 * m156 == m155 * m155 && m156 * m157 == m155 * m155);
+	assert(Matrix(m156 + m155) == Matrix(m155 + m155) && Matrix(m156 - m157).getNumNonZeros() == 0);
+	Matrix m158 = Matrix::createTiled(12, 12, 4);
+	m158.gemm(2.0, m156, m155, 0.0);
+	Matrix m159 = m155 * m155;
+	m159 *= 2;
+	assert(m158 == m159);
+	m158 += m156;
+	assert(m158 == Matrix(m159 + m155));
+
+	// The edge tiles are smaller than the others (tile size 5).
+	Matrix m160 = m155;
+	m160.toTiled(5);
+	assert(m160 * m156 == m155 * m155);
+	m160.transpose();
+	Matrix m161 = m155;
+	m161.transpose();
+	assert(m160 == m161 && deq(m160.getCell(1, 11), -3));
+	m160.applyCheckerboardPattern();
+	m161.applyCheckerboardPattern();
+	assert(m160 == m161);
+	m160.resize(7, 13);
+	m161.resize(7, 13);
+	assert(m160 == m161 && m160.getNumColumns() == 13);
+
+	// Transposed operands are multiplied without being materialized. 300 rows span more than one packed panel.
+	Matrix m162 = Matrix::createDense(300, 5, 0);
+	Matrix m163 = Matrix::createDense(300, 7, 0);
+	for (size_t r = 0; r < 300; r++)
+	{
+		for (size_t c = 0; c < 7; c++)
+		{
+			if (c < 5)
+			{
+				m162.setCell(r, c, (double)((r * 3 + c) % 11) - 5);
+			}
+			m163.setCell(r, c, (double)((r + c * 5) % 7) - 3);
+		}
+	}
+	Matrix m164 = m162;
+	m164.transpose();
+	Matrix m165 = m163;
+	m165.transpose();
+	assert(m162.multiply(m163, true, false) == m164 * m163);
+	assert(m164.multiply(m165, false, true) == m164 * m163);
+	assert(m165.multiply(m164, false, true) == m165 * m162);
+	assert(m163.multiply(m164, true, true) == m165 * m162);
+	assert(m162.multiply(m164, false, false) == m162 * m164);
+	assert(m162.multiply(m163, false, false).getNumRows() == 0 && m162.multiply(m163, false, true).getNumRows() == 0);
+
+	Matrix m166 = m162;
+	m166.toSparse();
+	assert(m166.multiply(m163, true, false) == m164 * m163);
+	assert(m166.multiply(m162, false, true) == m162 * m164);
+	assert(m166.multiply(m162, true, false) == m164 * m162);
+	Matrix m167 = m163;
+	m167.toSparse();
+	assert(m162.multiply(m167, true, false) == m164 * m163);
+	assert(m166.multiply(m167, true, false) == m164 * m163);
+
+	// In-place transpose: a square matrix larger than a transpose block, a rectangular matrix and a single row.
+	Matrix m168 = Matrix::createDense(37, 37, 0);
+	Matrix m169 = Matrix::createDense(23, 41, 0);
+	for (size_t r = 0; r < 41; r++)
+	{
+		for (size_t c = 0; c < 41; c++)
+		{
+			if (r < 37 && c < 37)
+			{
+				m168.setCell(r, c, (double)(r * 100 + c));
+			}
+			if (r < 23)
+			{
+				m169.setCell(r, c, (double)(r * 100 + c));
+			}
+		}
+	}
+	Matrix m170 = m168;
+	m170.transpose();
+	Matrix m171 = m169;
+	m171.transpose();
+	assert(m171.getNumRows() == 41 && m171.getNumColumns() == 23);
+	for (size_t r = 0; r < 41; r++)
+	{
+		for (size_t c = 0; c < 41; c++)
+		{
+			if (r < 37 && c < 37)
+			{
+				assert(deq(m170.getCell(r, c), (double)(c * 100 + r)));
+			}
+			if (c < 23)
+			{
+				assert(deq(m171.getCell(r, c), (double)(c * 100 + r)));
+			}
+		}
+	}
+	m170.transpose();
+	m171.transpose();
+	assert(m170 == m168 && m171 == m169);
+	Matrix m172 = m169.getSubMatrix(3, 1, 0, 41);
+	m172.transpose();
+	assert(m172.getNumRows() == 41 && deq(m172.getCell(40, 0), 340));
+
+	// Lazy transpose: the flag is respected without moving the elements, and applied once when the layout is needed.
+	Matrix m173 = m169;
+	m173.transpose();
+	Matrix m174 = Matrix::createDense(41, 23, 0);
+	for (size_t r = 0; r < 41; r++)
+	{
+		for (size_t c = 0; c < 23; c++)
+		{
+			m174.setCell(r, c, (double)(c * 100 + r));
+		}
+	}
+	assert(m173.getNumRows() == 41 && deq(m173.getCell(40, 3), 340));
+	assert(m173 * m169 == m174 * m169 && m169 * m173 == m169 * m174);
+	assert(m173.multiply(m169, true, true) == m169 * m174);
+	m173.setCell(40, 3, -1);
+	assert(deq(m173.getCell(40, 3), -1) && deq(m169.getCell(3, 40), 340) && m173.getNumNonZeros() == m169.getNumNonZeros());
+	m173.setCell(40, 3, 340);
+	assert(m173 == m174 && Matrix(m173 + m174) == Matrix(m174 + m174) && m173.getPrintStr(2) == m174.getPrintStr(2));
+	m173.resizeNumColumns(24);
+	assert(m173.getNumColumns() == 24 && deq(m173.getCell(40, 3), 340) && deq(m173.getCell(40, 23), 0));
+	Matrix m175 = Matrix::createDense(3, 3, 0);
+	m175.setCell(0, 0, 2);
+	m175.setCell(0, 1, 1);
+	m175.setCell(1, 1, 3);
+	m175.setCell(2, 0, 1);
+	m175.setCell(2, 2, 1);
+	Matrix m176 = m175;
+	m176.transpose();
+	Matrix m177 = m176.getInverse(m176.getDeterminant());
+	assert(deq(m176.getDeterminant(), m175.getDeterminant()) && m176.getRank() == 3);
+	assert(m177 * m176 == Matrix::createIdentity(3) && m176 * m177 == Matrix::createIdentity(3));
+	m176 *= 2;
+	m175 *= 2;
+	m175.transpose();
+	assert(m176 == m175);
+	m176.gemm(1.0, m177, m177, 1.0);
+	m175 += m177 * m177;
+	assert(m176 == m175);
+
+	// The const members read a transposed matrix through views or copies, and never transpose its resource (which may be read concurrently).
+	Matrix m239 = Matrix::createDense(4, 3, 0);
+	Matrix m240 = Matrix::createDense(3, 4, 0);
+	Matrix m241 = Matrix::createSparse(4, 3);
+	for (size_t i = 0; i < 12; i++)
+	{
+		m239.setCell(i / 3, i % 3, (double)((i * 5) % 7) - 2);
+		m240.setCell(i % 3, i / 3, (double)((i * 5) % 7) - 2);
+		m241.setCell(i / 3, i % 3, (i % 2 == 0) ? (double)i : 0);
+	}
+	m239.transpose();
+	m241.transpose();
+	const Matrix& m239t = m239;
+	const Matrix& m241t = m241;
+	assert(m239t.getPrintStr(3) == m240.getPrintStr(3));
+	assert(m239t.getSubMatrix(1, 2, 0, 3) == m240.getSubMatrix(1, 2, 0, 3) && m239t.getSubMatrix(2, 1) == m240.getSubMatrix(2, 1));
+	assert(m239t.getSubMatrixTopLeft(1, 2) == m240.getSubMatrixTopLeft(1, 2) && m239t.getSubMatrixTopRight(1, 2) == m240.getSubMatrixTopRight(1, 2));
+	assert(m239t.getSubMatrixBottomLeft(1, 2) == m240.getSubMatrixBottomLeft(1, 2) && m239t.getSubMatrixBottomRight(1, 2) == m240.getSubMatrixBottomRight(1, 2));
+	assert(m239t.splitByColumn(1, false) == m240.splitByColumn(1, false) && m239t.splitByRow(2, true) == m240.splitByRow(2, true));
+	Matrix m258 = m239;
+	m258.applyTranspose(); // Moves the elements once; the value doesn't change.
+	assert(m258 == m240 && m258.getPrintStr(3) == m240.getPrintStr(3));
+	DenseMatrixView m239view;
+	assert(m239t.getSubView(1, 2, 1, 3, &m239view) && Matrix::createFromView(m239view) == m240.getSubMatrix(1, 2, 1, 3));
+	assert(m239t.getPseudoInverse(1e-10) == m240.getPseudoInverse(1e-10));
+	Matrix m242, m243;
+	std::vector<double> singularValues239;
+	m239t.getSVD(true, &m242, &singularValues239, &m243);
+	assert(m242.getNumRows() == 3 && m243.getNumRows() == 4);
+	assert(Matrix(m242 * Matrix::createDiagonal(singularValues239)).multiply(m243, false, true) == m240);
+	assert(Matrix(m239t + m240) == Matrix(m240 + m240) && Matrix(m241t - m241t).getNumNonZeros() == 0);
+	assert(deq(Matrix(m241t + m240).getCell(2, 2), m240.getCell(2, 2) + 8) && m241t.getNumRows() == 3);
+	assert(m239t.getNumRows() == 3 && m240 == m239t);
+
+	// Least squares: fitting a line through 4 points has a known solution (0.9, 0.9) and residual sqrt(0.7).
+	Matrix m178 = Matrix::createDense(4, 2, 1);
+	Matrix m179 = Matrix::createDense(4, 1, 0);
+	for (size_t r = 0; r < 4; r++)
+	{
+		m178.setCell(r, 1, (double)r);
+	}
+	m179.setCell(0, 0, 1);
+	m179.setCell(1, 0, 2);
+	m179.setCell(2, 0, 2);
+	m179.setCell(3, 0, 4);
+	double residualNorm = 0;
+	Matrix m180 = m178.solveLeastSquares(m179, &residualNorm);
+	assert(m180.getNumRows() == 2 && deq(m180.getCell(0, 0), 0.9) && deq(m180.getCell(1, 0), 0.9) && deq(residualNorm, std::sqrt(0.7)));
+	m178.setCell(3, 1, 0);
+	m178.setCell(2, 1, 0);
+	m178.setCell(1, 1, 0);
+	assert(m178.solveLeastSquares(m179, nullptr).getNumRows() == 0); // Rank deficient.
+	assert(m178.getSubMatrix(0, 1, 0, 2).solveLeastSquares(m179.getSubMatrix(0, 1, 0, 1), nullptr).getNumRows() == 0); // Underdetermined.
+
+	// A consistent tall system with more columns than a block of reflections, and several right hand sides.
+	Matrix m181 = Matrix::createDense(1000, 45, 0);
+	Matrix m182 = Matrix::createDense(45, 3, 0);
+	for (size_t r = 0; r < 1000; r++)
+	{
+		for (size_t c = 0; c < 45; c++)
+		{
+			m181.setCell(r, c, (double)((r * 37 + c * 91 + r * c) % 101) / 50.0 - 1.0);
+			if (r < 45 && c < 3)
+			{
+				m182.setCell(r, c, (double)(r + 1) * (c == 1 ? -1.0 : 1.0) / (c + 1));
+			}
+		}
+	}
+	Matrix m183 = m181 * m182;
+	Matrix m184 = m181.solveLeastSquares(m183, &residualNorm);
+	assert(m184.getNumRows() == 45 && m184.getNumColumns() == 3 && residualNorm < 1e-8);
+	for (size_t r = 0; r < 45; r++)
+	{
+		for (size_t c = 0; c < 3; c++)
+		{
+			assert(mcu::doubleAlmostEqual(m184.getCell(r, c), m182.getCell(r, c), 1e-9));
+		}
+	}
+
+	// Rank-revealing QR: the pivots identify the independent columns, and the tolerance decides what is negligible.
+	Matrix m185 = Matrix::createDense(5, 4, 0);
+	for (size_t r = 0; r < 5; r++)
+	{
+		m185.setCell(r, 0, (double)(r + 1));
+		m185.setCell(r, 1, (double)(r * r));
+		m185.setCell(r, 2, 2.0 * (r + 1) - 3.0 * (r * r)); // Linear combination of the first two columns.
+		m185.setCell(r, 3, 1e-7 * (r % 2));
+	}
+	std::vector<size_t> independentColumns;
+	assert(m185.getRank() == 3 && m185.getRank(1e-9, &independentColumns) == 3);
+	assert(independentColumns.size() == 3 && independentColumns[2] == 3 && independentColumns[0] != 3 && independentColumns[1] != 3);
+	assert(m185.getRank(1e-6, &independentColumns) == 2 && independentColumns.size() == 2);
+	m185 *= 1e9;
+	assert(m185.getRank(1e-6, nullptr) == 2 && Matrix::createDense(3, 3, 0).getRank() == 0);
+	m185.transpose();
+	assert(m185.getRank(1e-9, &independentColumns) == 3 && independentColumns.size() == 3);
+
+	// SVD: U * S * transpose(V) reconstructs tall and wide matrices, in thin and full form.
+	Matrix m186 = Matrix::createDense(6, 3, 0);
+	for (size_t r = 0; r < 6; r++)
+	{
+		for (size_t c = 0; c < 3; c++)
+		{
+			m186.setCell(r, c, (double)((r * 7 + c * 3 + r * c) % 11) - 5.0);
+		}
+	}
+	Matrix m187 = m186;
+	m187.transpose(); // Wide.
+	for (size_t i = 0; i < 4; i++)
+	{
+		Matrix u;
+		Matrix v;
+		std::vector<double> singularValues;
+		const Matrix& decomposed = (i % 2 == 0) ? m186 : m187;
+		decomposed.getSVD(i < 2, &u, &singularValues, &v);
+		assert(singularValues.size() == 3 && singularValues[0] >= singularValues[1] && singularValues[1] >= singularValues[2]);
+		assert(u.getNumRows() == decomposed.getNumRows() && v.getNumRows() == decomposed.getNumColumns());
+		assert(u.getNumColumns() == (i < 2 ? 3 : u.getNumRows()) && v.getNumColumns() == (i < 2 ? 3 : v.getNumRows()));
+		Matrix s = Matrix::createDense(u.getNumColumns(), v.getNumColumns(), 0);
+		for (size_t d = 0; d < 3; d++)
+		{
+			s.setCell(d, d, singularValues[d]);
+		}
+		Matrix reconstructed = u.multiply(s, false, false).multiply(v, false, true);
+		for (size_t r = 0; r < decomposed.getNumRows(); r++)
+		{
+			for (size_t c = 0; c < decomposed.getNumColumns(); c++)
+			{
+				assert(mcu::doubleAlmostEqual(reconstructed.getCell(r, c), decomposed.getCell(r, c), 1e-9));
+			}
+		}
+		Matrix uOrthogonality = u.multiply(u, true, false);
+		for (size_t r = 0; r < uOrthogonality.getNumRows(); r++)
+		{
+			for (size_t c = 0; c < uOrthogonality.getNumColumns(); c++)
+			{
+				assert(mcu::doubleAlmostEqual(uOrthogonality.getCell(r, c), (r == c) ? 1.0 : 0.0, 1e-9));
+			}
+		}
+	}
+
+	// Pseudo-inverse of a singular matrix, and the SVD based norm, condition number and rank.
+	Matrix m188 = Matrix::createDense(4, 4, 0);
+	for (size_t r = 0; r < 4; r++)
+	{
+		m188.setCell(r, 0, (double)(r + 1));
+		m188.setCell(r, 1, (double)(r * r) - 2.0);
+		m188.setCell(r, 2, m188.getCell(r, 0) + m188.getCell(r, 1));
+		m188.setCell(r, 3, (r == 2) ? 4.0 : 1.0);
+	}
+	Matrix m189 = m188.getPseudoInverse(mcu::EPSILON);
+	assert(m189.getNumRows() == 4 && m189.getNumColumns() == 4 && m188.getNumericalRank(mcu::EPSILON) == 3);
+	Matrix m190 = m188 * m189 * m188;
+	Matrix m191 = m189 * m188 * m189;
+	for (size_t r = 0; r < 4; r++)
+	{
+		for (size_t c = 0; c < 4; c++)
+		{
+			assert(mcu::doubleAlmostEqual(m190.getCell(r, c), m188.getCell(r, c), 1e-9));
+			assert(mcu::doubleAlmostEqual(m191.getCell(r, c), m189.getCell(r, c), 1e-9));
+		}
+	}
+	Matrix m192 = Matrix::createDiagonal({ 2.0, -8.0, 0.5 });
+	assert(mcu::doubleAlmostEqual(m192.getNorm2(), 8.0, 1e-12) && mcu::doubleAlmostEqual(m192.getConditionNumber(), 16.0, 1e-12));
+	assert(m192.getPseudoInverse(mcu::EPSILON) == m192.getInverse(m192.getDeterminant()) && m192.getNumericalRank(mcu::EPSILON) == 3);
+	assert(m188.getConditionNumber() > 1e12); // Singular.
+
+	// Symmetric eigensolver: A * V == V * diag(eigenvalues), with orthonormal V, and the values-only path agrees.
+	Matrix m193 = Matrix::createSymmetric(6);
+	for (size_t r = 0; r < 6; r++)
+	{
+		for (size_t c = 0; c <= r; c++)
+		{
+			m193.setSymmetricCell(r, c, (double)((r * 5 + c * 3 + r * c) % 7) - 3.0);
+		}
+	}
+	std::vector<double> eigenvalues;
+	std::vector<double> eigenvaluesOnly;
+	Matrix m194;
+	assert(m193.getSymmetricEigen(&eigenvalues, &m194) && m193.getSymmetricEigen(&eigenvaluesOnly, nullptr));
+	assert(eigenvalues.size() == 6 && m194.getNumRows() == 6 && m194.getNumColumns() == 6);
+	Matrix m195 = m193 * m194;
+	Matrix m196 = m194.multiply(m194, true, false);
+	for (size_t r = 0; r < 6; r++)
+	{
+		assert(mcu::doubleAlmostEqual(eigenvalues[r], eigenvaluesOnly[r], 1e-9) && (r == 0 || eigenvalues[r - 1] <= eigenvalues[r]));
+		for (size_t c = 0; c < 6; c++)
+		{
+			assert(mcu::doubleAlmostEqual(m195.getCell(r, c), m194.getCell(r, c) * eigenvalues[c], 1e-9));
+			assert(mcu::doubleAlmostEqual(m196.getCell(r, c), (r == c) ? 1.0 : 0.0, 1e-9));
+		}
+	}
+	Matrix m197 = Matrix::createDense(6, 6, 0);
+	for (size_t r = 0; r < 6; r++)
+	{
+		for (size_t c = 0; c < 6; c++)
+		{
+			m197.setCell(r, c, m193.getCell(r, c) + ((r == 0 && c == 5) ? 1e-3 : 0.0)); // A SymmetricMatrix would mirror the change.
+		}
+	}
+	assert(!m197.getSymmetricEigen(&eigenvalues, nullptr) && eigenvalues.empty());
+	assert(!Matrix::createDense(2, 3, 1).getSymmetricEigen(&eigenvalues, nullptr));
+
+	// The second difference matrix has the known eigenvalues 2 - 2 * cos(k * pi / (n + 1)).
+	Matrix m198 = Matrix::createDense(80, 80, 0);
+	for (size_t d = 0; d < 80; d++)
+	{
+		m198.setCell(d, d, 2.0);
+		if (d > 0)
+		{
+			m198.setCell(d, d - 1, -1.0);
+			m198.setCell(d - 1, d, -1.0);
+		}
+	}
+	assert(m198.getSymmetricEigen(&eigenvalues, nullptr) && eigenvalues.size() == 80);
+	for (size_t k = 0; k < 80; k++)
+	{
+		assert(mcu::doubleAlmostEqual(eigenvalues[k], 2.0 - 2.0 * std::cos((k + 1) * 3.14159265358979323846 / 81.0), 1e-10));
+	}
+
+	// Nonsymmetric eigenvalues: the companion matrix of (x - 1)(x - 2)(x^2 + 1)(x^2 - 2x + 5) has its roots as eigenvalues.
+	Matrix m199 = Matrix::createDense(6, 6, 0);
+	double companionRow[6] = { 5, -14, 24, -23, 19, -10 };
+	for (size_t c = 0; c < 6; c++)
+	{
+		m199.setCell(0, c, companionRow[c]);
+		if (c < 5)
+		{
+			m199.setCell(c + 1, c, 1.0);
+		}
+	}
+	std::vector<std::complex<double>> complexEigenvalues;
+	Matrix m200;
+	Matrix m201;
+	assert(m199.getEigenvalues(&complexEigenvalues, &m200, &m201) && complexEigenvalues.size() == 6);
+	std::complex<double> roots[6] = { { 1, 0 }, { 2, 0 }, { 0, 1 }, { 0, -1 }, { 1, 2 }, { 1, -2 } };
+	for (size_t i = 0; i < 6; i++)
+	{
+		bool isFound = false;
+		for (size_t j = 0; j < 6; j++)
+		{
+			isFound = isFound || std::abs(complexEigenvalues[j] - roots[i]) < 1e-8;
+		}
+		assert(isFound);
+	}
+	// Z * T * transpose(Z) == A, Z is orthogonal and T is quasi-triangular.
+	Matrix m202 = m201.multiply(m200, false, false).multiply(m201, false, true);
+	Matrix m203 = m201.multiply(m201, true, false);
+	for (size_t r = 0; r < 6; r++)
+	{
+		for (size_t c = 0; c < 6; c++)
+		{
+			assert(mcu::doubleAlmostEqual(m202.getCell(r, c), m199.getCell(r, c), 1e-9));
+			assert(mcu::doubleAlmostEqual(m203.getCell(r, c), (r == c) ? 1.0 : 0.0, 1e-9));
+			assert(c + 1 >= r || m200.getCell(r, c) == 0.0);
+		}
+		if (r > 0 && m200.getCell(r, r - 1) != 0.0)
+		{
+			assert(complexEigenvalues[r].imag() != 0.0 && complexEigenvalues[r] == std::conj(complexEigenvalues[r - 1]));
+		}
+	}
+	std::vector<std::complex<double>> valuesOnly;
+	assert(m199.getEigenvalues(&valuesOnly, nullptr, nullptr) && valuesOnly.size() == 6);
+	for (size_t i = 0; i < 6; i++)
+	{
+		assert(std::abs(valuesOnly[i] - complexEigenvalues[i]) < 1e-8);
+	}
+	// The symmetric path is taken automatically, and a transposed matrix has the same eigenvalues.
+	assert(m193.getEigenvalues(&valuesOnly, nullptr, nullptr) && valuesOnly.size() == 6 && valuesOnly[5].imag() == 0.0);
+	assert(mcu::doubleAlmostEqual(valuesOnly[5].real(), eigenvaluesOnly[5], 1e-9));
+	m199.transpose();
+	assert(m199.getEigenvalues(&valuesOnly, &m200, nullptr) && valuesOnly.size() == 6);
+	std::complex<double> eigenvalueSum = 0.0;
+	double trace = 0.0;
+	for (size_t i = 0; i < 6; i++)
+	{
+		eigenvalueSum += valuesOnly[i];
+		trace += m200.getCell(i, i);
+	}
+	assert(std::abs(eigenvalueSum - 5.0) < 1e-9 && mcu::doubleAlmostEqual(trace, 5.0, 1e-9));
+	assert(!Matrix::createDense(2, 3, 1).getEigenvalues(&valuesOnly, nullptr, nullptr) && valuesOnly.empty());
+
+	// Aggressive early deflation takes over for large blocks. A permuted triangular matrix has its diagonal as eigenvalues.
+	Matrix m244 = Matrix::createDense(120, 120, 0);
+	for (size_t r = 0; r < 120; r++)
+	{
+		for (size_t c = r; c < 120; c++)
+		{
+			m244.setCell((r * 7) % 120, (c * 7) % 120, (c == r) ? (double)(r + 1) : (double)((r * 31 + c * 17) % 13) / 4.0 - 1.5);
+		}
+	}
+	assert(m244.getEigenvalues(&valuesOnly, nullptr, nullptr) && valuesOnly.size() == 120);
+	std::vector<double> realEigenvalues;
+	for (size_t i = 0; i < 120; i++)
+	{
+		assert(std::abs(valuesOnly[i].imag()) < 1e-8);
+		realEigenvalues.push_back(valuesOnly[i].real());
+	}
+	std::sort(realEigenvalues.begin(), realEigenvalues.end());
+	for (size_t i = 0; i < 120; i++)
+	{
+		assert(mcu::doubleAlmostEqual(realEigenvalues[i], (double)(i + 1), 1e-8));
+	}
+	// A general matrix, with complex eigenvalues: Z * T * transpose(Z) == A, Z is orthogonal, and the eigenvalues don't depend on the Schur form being requested.
+	Matrix m245 = Matrix::createDense(150, 150, 0);
+	double m245Trace = 0.0;
+	for (size_t r = 0; r < 150; r++)
+	{
+		for (size_t c = 0; c < 150; c++)
+		{
+			m245.setCell(r, c, (double)((r * 37 + c * 91 + r * c * 13) % 101) / 50.0 - 1.0);
+		}
+		m245Trace += m245.getCell(r, r);
+	}
+	Matrix m246;
+	Matrix m247;
+	assert(m245.getEigenvalues(&complexEigenvalues, &m246, &m247) && complexEigenvalues.size() == 150);
+	Matrix m248 = m247.multiply(m246, false, false).multiply(m247, false, true);
+	Matrix m249 = m247.multiply(m247, true, false);
+	eigenvalueSum = 0.0;
+	size_t numComplexEigenvalues = 0;
+	for (size_t r = 0; r < 150; r++)
+	{
+		for (size_t c = 0; c < 150; c++)
+		{
+			assert(std::abs(m248.getCell(r, c) - m245.getCell(r, c)) < 1e-10);
+			assert(std::abs(m249.getCell(r, c) - ((r == c) ? 1.0 : 0.0)) < 1e-10);
+			assert(c + 1 >= r || m246.getCell(r, c) == 0.0);
+		}
+		eigenvalueSum += complexEigenvalues[r];
+		numComplexEigenvalues += (complexEigenvalues[r].imag() != 0.0) ? 1 : 0;
+	}
+	assert(numComplexEigenvalues > 0 && std::abs(eigenvalueSum - m245Trace) < 1e-9);
+	assert(m245.getEigenvalues(&valuesOnly, nullptr, nullptr) && valuesOnly.size() == 150);
+	for (size_t i = 0; i < 150; i++)
+	{
+		assert(std::abs(valuesOnly[i] - complexEigenvalues[i]) < 1e-8);
+	}
+
+	// Cholesky: symmetric positive definite matrices are solved, inverted and have their determinant calculated with it.
+	Matrix m204 = Matrix::createDense(3, 3, 0);
+	double m204Cells[9] = { 4, 1, 0, 1, 3, 1, 0, 1, 2 };
+	for (size_t i = 0; i < 9; i++)
+	{
+		m204.setCell(i / 3, i % 3, m204Cells[i]);
+	}
+	Matrix m204_aug = Matrix::createDense(3, 1, 0);
+	m204_aug.setCell(0, 0, 1);
+	m204_aug.setCell(1, 0, 2);
+	m204_aug.setCell(2, 0, 3);
+	assert(streq(m204.solveFor(m204_aug, false, 2), "\nSolution:\n\nx1 = + 0.222222\nx2 = + 0.111111\nx3 = + 1.44444\n"));
+	assert(mcu::doubleAlmostEqual(m204.getDeterminant(), 18.0));
+	m204.setCell(0, 0, 0.25); // Symmetric, but indefinite: the general algorithms are used.
+	assert(mcu::doubleAlmostEqual(m204.getDeterminant(), -0.75));
+	Matrix m205 = Matrix::createDense(150, 150, 0);
+	for (size_t r = 0; r < 150; r++)
+	{
+		for (size_t c = 0; c <= r; c++)
+		{
+			double value = (r == c) ? 2.0 : ((double)((r * 13 + c * 7) % 11) - 5.0) / 1000.0;
+			m205.setCell(r, c, value);
+			m205.setCell(c, r, value);
+		}
+	}
+	double m205Determinant = m205.getDeterminant();
+	assert(m205Determinant > 0.0 && m205Determinant < std::pow(2.1, 150));
+	Matrix m206 = m205.getInverse(m205Determinant) * m205;
+	for (size_t r = 0; r < 150; r++)
+	{
+		for (size_t c = 0; c < 150; c++)
+		{
+			assert(mcu::doubleAlmostEqual(m206.getCell(r, c), (r == c) ? 1.0 : 0.0, 1e-10));
+		}
+	}
+
+	// LU: the rows of an upper triangular matrix in reverse order (130 * 129 / 2 swaps, an odd number), across several panels.
+	Matrix m207 = Matrix::createDense(130, 130, 0);
+	for (size_t r = 0; r < 130; r++)
+	{
+		for (size_t c = r; c < 130; c++)
+		{
+			m207.setCell(129 - r, c, (r == c) ? ((r % 2 == 0) ? 2.0 : 0.5) : ((double)((r * 3 + c) % 7) - 3.0));
+		}
+	}
+	assert(mcu::doubleAlmostEqual(m207.getDeterminant(), -1.0, 1e-9));
+	// A large nonsymmetric system, whose trailing updates are split between threads.
+	Matrix m208 = Matrix::createDense(300, 300, 0);
+	Matrix m209 = Matrix::createDense(300, 1, 0);
+	for (size_t r = 0; r < 300; r++)
+	{
+		for (size_t c = 0; c < 300; c++)
+		{
+			m208.setCell(r, c, ((double)((r * 31 + c * 17 + r * c) % 23) - 11.0) / 23.0 + ((r == c) ? 3.0 : 0.0));
+		}
+		m209.setCell(r, 0, (double)(r % 5) - 2.0);
+	}
+	Matrix m210 = m208 * m209;
+	Matrix m211 = m208.getInverse(m208.getDeterminant()) * m210;
+	for (size_t r = 0; r < 300; r++)
+	{
+		assert(mcu::doubleAlmostEqual(m211.getCell(r, 0), m209.getCell(r, 0), 1e-9));
+	}
+	// The recursive and the blocked LU find the same factors; a zero column is reported as singular by both.
+	DenseMatrix m212(200, 200, 0.0);
+	unsigned int m212Seed = 12345;
+	for (size_t r = 0; r < 200; r++)
+	{
+		for (size_t c = 0; c < 200; c++)
+		{
+			m212Seed = m212Seed * 1103515245u + 12345u;
+			m212.getRowData(r)[c] = (double)((m212Seed >> 16) % 1000) / 500.0 - 1.0;
+		}
+	}
+	DenseMatrix m213(m212);
+	std::vector<size_t> recursivePivots;
+	std::vector<size_t> blockedPivots;
+	assert(mck::factorizeLURecursive(m212, &recursivePivots));
+	assert(mck::factorizeLUBlocked(m213, &blockedPivots));
+	assert(recursivePivots == blockedPivots);
+	for (size_t r = 0; r < 200; r++)
+	{
+		for (size_t c = 0; c < 200; c++)
+		{
+			assert(mcu::doubleAlmostEqual(m212.getRowData(r)[c], m213.getRowData(r)[c], 1e-9));
+		}
+		m212.getRowData(r)[77] = 0.0;
+		m213.getRowData(r)[77] = 0.0;
+	}
+	assert(!mck::factorizeLURecursive(m212, &recursivePivots));
+	assert(!mck::factorizeLUBlocked(m213, &blockedPivots));
+
+	// Triangular solves read only their triangle of a full matrix, across several blocks and column tiles, in every variant.
+	Matrix m214 = Matrix::createDense(150, 150, 0);
+	Matrix m215 = Matrix::createDense(150, 300, 0);
+	for (size_t r = 0; r < 150; r++)
+	{
+		for (size_t c = 0; c < 150; c++)
+		{
+			m214.setCell(r, c, (r == c) ? 2.0 + (double)(r % 3) : ((double)((r * 7 + c * 5) % 11) - 5.0) / 20.0);
+		}
+		for (size_t c = 0; c < 300; c++)
+		{
+			m215.setCell(r, c, (double)((r + c * 3) % 7) - 3.0);
+		}
+	}
+	for (int variant = 0; variant < 8; variant++)
+	{
+		bool isLower = (variant & 1) != 0;
+		bool transposeThis = (variant & 2) != 0;
+		bool hasUnitDiagonal = (variant & 4) != 0;
+		Matrix m216 = Matrix::createDense(150, 150, 0);
+		for (size_t r = 0; r < 150; r++)
+		{
+			for (size_t c = 0; c < 150; c++)
+			{
+				if (r == c)
+				{
+					m216.setCell(r, c, hasUnitDiagonal ? 1.0 : m214.getCell(r, c));
+				}
+				else if ((r > c) == isLower)
+				{
+					m216.setCell(r, c, m214.getCell(r, c));
+				}
+			}
+		}
+		Matrix m217 = m214.solveTriangular(m215, isLower, transposeThis, hasUnitDiagonal);
+		Matrix m218 = m216.multiply(m217, transposeThis, false);
+		assert(m218.getNumRows() == 150 && m218.getNumColumns() == 300);
+		for (size_t r = 0; r < 150; r++)
+		{
+			for (size_t c = 0; c < 300; c++)
+			{
+				assert(mcu::doubleAlmostEqual(m218.getCell(r, c), m215.getCell(r, c), 1e-9));
+			}
+		}
+	}
+	// The transpose of a lower triangular matrix is solved as an upper one, without being materialized; a zero on the diagonal fails.
+	Matrix m219 = m214.solveTriangular(m215, true, true, false);
+	Matrix m220 = m214;
+	m220.transpose();
+	Matrix m221 = m220.solveTriangular(m215, false, false, false);
+	for (size_t r = 0; r < 150; r++)
+	{
+		assert(mcu::doubleAlmostEqual(m221.getCell(r, 299), m219.getCell(r, 299), 1e-12));
+	}
+	m220.setCell(70, 70, 0.0);
+	assert(m220.solveTriangular(m215, false, false, false).getNumRows() == 0);
+	assert(m220.solveTriangular(m215, false, false, true).getNumRows() == 150);
+	// A Sparse right operand is multiplied as if it were transposed, without being transposed.
+	Matrix m254 = Matrix::createSparse(4, 3);
+	m254.setCell(0, 2, 3);
+	m254.setCell(2, 0, -1);
+	m254.setCell(3, 1, 2);
+	Matrix m255 = Matrix::createDense(4, 3, 1);
+	m255.setCell(1, 2, 5);
+	Matrix m256 = m254;
+	m256.toDense();
+	assert(m255.multiply(m254, false, true) == m255.multiply(m256, false, true));
+	assert(m255.multiply(m254, true, false) == m255.multiply(m256, true, false));
+	Matrix m257 = Matrix::createDense(2, 4, 2);
+	m257.setCell(1, 3, -4);
+	assert(m254.multiply(m257, true, true) == m256.multiply(m257, true, true) && m254.multiply(m257, true, true).getNumRows() == 3);
+	assert(m254.multiply(m254, false, true) == m256.multiply(m256, false, true));
+	// A triangular matrix is solved by its own triangle, whatever isLower says; its transpose is the other triangle.
+	Matrix m252 = Matrix::createTriangular(3, true);
+	m252.setCell(0, 0, 2);
+	m252.setCell(0, 2, 1);
+	m252.setCell(1, 1, 4);
+	m252.setCell(1, 2, -2);
+	m252.setCell(2, 2, 0.5);
+	Matrix m253 = Matrix::createDense(3, 2, 1);
+	assert(m252 * m252.solveTriangular(m253, true, false, false) == m253);
+	assert(m252.multiply(m252.solveTriangular(m253, true, true, false), true, false) == m253);
+	m252.transpose();
+	assert(m252 * m252.solveTriangular(m253, false, false, false) == m253);
+
+	// Mixed precision: a well-conditioned system is refined to double precision accuracy from single precision factors.
+	Matrix m222 = Matrix::createDense(300, 2, 0);
+	for (size_t r = 0; r < 300; r++)
+	{
+		m222.setCell(r, 0, m209.getCell(r, 0));
+		m222.setCell(r, 1, (double)(r % 3) + 0.125);
+	}
+	Matrix m223 = m208 * m222;
+	size_t refinementSteps = 0;
+	double backwardError = 1.0;
+	bool isDoublePrecision = true;
+	Matrix m224 = m208.solveMixedPrecision(m223, &refinementSteps, &backwardError, &isDoublePrecision);
+	assert(!isDoublePrecision);
+	assert(refinementSteps >= 1 && refinementSteps <= 5);
+	assert(backwardError <= std::sqrt(300.0) * std::numeric_limits<double>::epsilon());
+	for (size_t r = 0; r < 300; r++)
+	{
+		assert(mcu::doubleAlmostEqual(m224.getCell(r, 0), m222.getCell(r, 0), 1e-12));
+		assert(mcu::doubleAlmostEqual(m224.getCell(r, 1), m222.getCell(r, 1), 1e-12));
+	}
+	// An ill-conditioned (Hilbert) matrix, and one which doesn't fit in a float, fall back to double precision LU; a singular one fails.
+	Matrix m225 = Matrix::createDense(9, 9, 0);
+	Matrix m226 = Matrix::createDense(9, 1, 1);
+	for (size_t r = 0; r < 9; r++)
+	{
+		for (size_t c = 0; c < 9; c++)
+		{
+			m225.setCell(r, c, 1.0 / (double)(r + c + 1));
+		}
+	}
+	Matrix m227 = m225.solveMixedPrecision(m226, &refinementSteps, &backwardError, &isDoublePrecision);
+	assert(isDoublePrecision && m227.getNumRows() == 9);
+	assert(backwardError < 1e-12);
+	Matrix m228 = Matrix::createDense(2, 2, 1e50);
+	m228.setCell(1, 1, 3e50);
+	Matrix m229 = Matrix::createDense(2, 1, 2e50);
+	m229.setCell(1, 0, 4e50);
+	Matrix m230 = m228.solveMixedPrecision(m229, &refinementSteps, &backwardError, &isDoublePrecision);
+	assert(isDoublePrecision && refinementSteps == 0);
+	assert(mcu::doubleAlmostEqual(m230.getCell(0, 0), 1.0) && mcu::doubleAlmostEqual(m230.getCell(1, 0), 1.0));
+	m228.setCell(1, 1, 1e50);
+	assert(m228.solveMixedPrecision(m229, nullptr, nullptr, nullptr).getNumRows() == 0);
+
 	return 0;
 }
\ No newline at end of file
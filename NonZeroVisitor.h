@@ -0,0 +1,38 @@
+#ifndef NON_ZERO_VISITOR_H
+#define NON_ZERO_VISITOR_H
+
+#include "DenseMatrix.h"
+#include "SparseMatrix.h"
+
+namespace mcu
+{
+	/**
+	* Calls the visitor for every non-zero cell of a matrix, in row-major order. A DenseMatrix or a SparseMatrix is visited by its own loop (see DenseMatrix::visitNonZeros and SparseMatrix::visitNonZeros), which calls the visitor directly.
+	* Only the other matrices are visited through the virtual MatrixBase::forEachNonZero, which costs a call through std::function per cell.
+	* @param matrix The matrix to be visited.
+	* @param visitor A callable which takes the row index, the column index and the value of the cell.
+	*/
+	template <typename Visitor>
+	void visitNonZeros(const MatrixBase& matrix, Visitor visitor)
+	{
+		const DenseMatrix* dense = dynamic_cast<const DenseMatrix*>(&matrix);
+
+		if (dense != nullptr)
+		{
+			dense->visitNonZeros(visitor);
+			return;
+		}
+
+		const SparseMatrix* sparse = dynamic_cast<const SparseMatrix*>(&matrix);
+
+		if (sparse != nullptr)
+		{
+			sparse->visitNonZeros(visitor);
+			return;
+		}
+
+		matrix.forEachNonZero(visitor);
+	}
+}
+
+#endif // NON_ZERO_VISITOR_H
@@ -0,0 +1,238 @@
+#include "PermutationMatrix.h"
+#include "DenseMatrix.h"
+#include "SparseMatrix.h"
+#include "MatCalcUtil.h"
+#include "NonZeroVisitor.h"
+#include <algorithm>
+
+// Public members
+
+PermutationMatrix::PermutationMatrix(size_t numDimensions)
+{
+	columnOfRow.resize(numDimensions);
+
+	for (size_t r = 0; r < numDimensions; r++)
+	{
+		columnOfRow[r] = r;
+	}
+}
+
+PermutationMatrix::PermutationMatrix(const std::vector<size_t>& columnOfRow)
+{
+	this->columnOfRow.assign(columnOfRow.begin(), columnOfRow.end());
+}
+
+bool PermutationMatrix::isPermutation(const std::vector<size_t>& columnOfRow)
+{
+	std::vector<bool> isUsed(columnOfRow.size(), false);
+
+	for (size_t r = 0; r < columnOfRow.size(); r++)
+	{
+		if (columnOfRow[r] >= columnOfRow.size() || isUsed[columnOfRow[r]])
+		{
+			return false;
+		}
+
+		isUsed[columnOfRow[r]] = true;
+	}
+
+	return true;
+}
+
+size_t PermutationMatrix::getNumRows() const
+{
+	return columnOfRow.size();
+}
+
+size_t PermutationMatrix::getNumColumns() const
+{
+	return columnOfRow.size();
+}
+
+double PermutationMatrix::getCell(size_t row, size_t column) const
+{
+	return (columnOfRow[row] == column) ? 1.0 : 0.0;
+}
+
+void PermutationMatrix::setCell(size_t row, size_t column, double value)
+{
+	// See canSetCell.
+	(void)row;
+	(void)column;
+	(void)value;
+}
+
+bool PermutationMatrix::canSetCell(size_t row, size_t column, double value) const
+{
+	return mcu::doubleAlmostEqual(value, getCell(row, column));
+}
+
+bool PermutationMatrix::canScale(double scalar) const
+{
+	return mcu::doubleAlmostEqual(scalar, 1.0);
+}
+
+void PermutationMatrix::transpose()
+{
+	IndexStorage rowOfColumn(columnOfRow.size());
+
+	for (size_t r = 0; r < columnOfRow.size(); r++)
+	{
+		rowOfColumn[columnOfRow[r]] = r;
+	}
+
+	columnOfRow.swap(rowOfColumn);
+}
+
+size_t PermutationMatrix::getNumNonZeros() const
+{
+	return columnOfRow.size();
+}
+
+MatrixBase* PermutationMatrix::clone() const
+{
+	return new PermutationMatrix(*this);
+}
+
+void PermutationMatrix::forEachNonZero(const std::function<void(size_t row, size_t column, double value)>& visitor) const
+{
+	for (size_t r = 0; r < columnOfRow.size(); r++)
+	{
+		visitor(r, columnOfRow[r], 1.0);
+	}
+}
+
+void PermutationMatrix::scale(double scalar)
+{
+	(void)scalar; // See canScale.
+}
+
+MatrixBase* PermutationMatrix::multiplyByRight(const MatrixBase& right) const
+{
+	const PermutationMatrix* permutationRight = dynamic_cast<const PermutationMatrix*>(&right);
+
+	if (permutationRight != nullptr)
+	{
+		PermutationMatrix* product = new PermutationMatrix(*this);
+
+		for (size_t r = 0; r < columnOfRow.size(); r++)
+		{
+			product->columnOfRow[r] = permutationRight->columnOfRow[columnOfRow[r]];
+		}
+
+		return product;
+	}
+
+	const DenseMatrix* denseRight = dynamic_cast<const DenseMatrix*>(&right);
+	size_t rightNumColumns = right.getNumColumns();
+
+	if (denseRight != nullptr)
+	{
+		DenseMatrix* product = new DenseMatrix(columnOfRow.size(), rightNumColumns, 0.0);
+
+		for (size_t r = 0; r < columnOfRow.size(); r++)
+		{
+			const double* sourceRow = denseRight->getRowData(columnOfRow[r]);
+			std::copy(sourceRow, sourceRow + rightNumColumns, product->getRowData(r));
+		}
+
+		return product;
+	}
+
+	// Row k of right becomes row rowOfColumn[k] of the product.
+	IndexStorage rowOfColumn(columnOfRow.size());
+
+	for (size_t r = 0; r < columnOfRow.size(); r++)
+	{
+		rowOfColumn[columnOfRow[r]] = r;
+	}
+
+	SparseMatrix* product = new SparseMatrix(columnOfRow.size(), rightNumColumns);
+
+	mcu::visitNonZeros(right, [&](size_t row, size_t column, double value)
+	{
+		product->setCell(rowOfColumn[row], column, value);
+	});
+
+	return product;
+}
+
+MatrixBase* PermutationMatrix::multiplyByLeft(const MatrixBase& left) const
+{
+	const PermutationMatrix* permutationLeft = dynamic_cast<const PermutationMatrix*>(&left);
+
+	if (permutationLeft != nullptr)
+	{
+		return permutationLeft->multiplyByRight(*this);
+	}
+
+	const DenseMatrix* denseLeft = dynamic_cast<const DenseMatrix*>(&left);
+	size_t leftNumRows = left.getNumRows();
+
+	if (denseLeft != nullptr)
+	{
+		DenseMatrix* product = new DenseMatrix(leftNumRows, columnOfRow.size(), 0.0);
+
+		for (size_t r = 0; r < leftNumRows; r++)
+		{
+			const double* sourceRow = denseLeft->getRowData(r);
+			double* productRow = product->getRowData(r);
+
+			for (size_t k = 0; k < columnOfRow.size(); k++)
+			{
+				productRow[columnOfRow[k]] = sourceRow[k];
+			}
+		}
+
+		return product;
+	}
+
+	SparseMatrix* product = new SparseMatrix(leftNumRows, columnOfRow.size());
+
+	mcu::visitNonZeros(left, [&](size_t row, size_t column, double value)
+	{
+		product->setCell(row, columnOfRow[column], value);
+	});
+
+	return product;
+}
+
+double PermutationMatrix::getDeterminant() const
+{
+	// A cycle of length k consists of (k - 1) transpositions.
+	std::vector<bool> isVisited(columnOfRow.size(), false);
+	size_t numTranspositions = 0;
+
+	for (size_t r = 0; r < columnOfRow.size(); r++)
+	{
+		size_t current = r;
+
+		while (isVisited[current] == false)
+		{
+			isVisited[current] = true;
+			current = columnOfRow[current];
+
+			if (isVisited[current] == false)
+			{
+				numTranspositions++;
+			}
+		}
+	}
+
+	return (numTranspositions % 2 == 0) ? 1.0 : -1.0;
+}
+
+MatrixBase* PermutationMatrix::getInverse(double determinant) const
+{
+	(void)determinant;
+
+	MatrixBase* inverse = clone();
+	inverse->transpose();
+
+	return inverse;
+}
+
+size_t PermutationMatrix::getRank() const
+{
+	return columnOfRow.size();
+}
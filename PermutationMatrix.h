@@ -0,0 +1,109 @@
+#ifndef PERMUTATION_MATRIX_H
+#define PERMUTATION_MATRIX_H
+
+#include "StructuredMatrix.h"
+#include <vector>
+
+/**
+* A square matrix which has exactly one 1.0 in every row and every column, and zeros elsewhere. Only the column index of the 1.0 of each row is stored (O(n) memory).
+* Multiplying by a permutation matrix remaps the rows (from the left) or the columns (from the right) of the other operand, instead of performing a matrix multiplication.
+*/
+class PermutationMatrix : public StructuredMatrix
+{
+public:
+	/**
+	* The type of the underlying storage. Its memory is served by MatrixMemory.
+	*/
+	typedef std::vector<size_t, MatrixStorageAllocator<size_t>> IndexStorage;
+
+	/**
+	* Creates the identity permutation.
+	* @param numDimensions The number of rows (and columns) of the matrix.
+	*/
+	PermutationMatrix(size_t numDimensions);
+	/**
+	* Creates a permutation matrix. Row r of the matrix has its 1.0 at column columnOfRow[r].
+	* @param columnOfRow The column index of the 1.0 of each row. Each index in [0, columnOfRow.size()) must appear exactly once.
+	*/
+	PermutationMatrix(const std::vector<size_t>& columnOfRow);
+	/**
+	* Checks whether or not the argument is a valid permutation (each index in [0, columnOfRow.size()) appears exactly once).
+	*/
+	static bool isPermutation(const std::vector<size_t>& columnOfRow);
+	/**
+	* Returns the number of rows of this matrix.
+	*/
+	virtual size_t getNumRows() const override;
+	/**
+	* Returns the number of columns of this matrix.
+	*/
+	virtual size_t getNumColumns() const override;
+	/**
+	* Returns 1.0 if the cell holds the 1.0 of its row, and 0.0 otherwise.
+	* @param row Row index of the matrix.
+	* @param column Column index of the matrix.
+	*/
+	virtual double getCell(size_t row, size_t column) const override;
+	/**
+	* Does nothing. Only the values which are already in the cells can be set (see canSetCell).
+	*/
+	virtual void setCell(size_t row, size_t column, double value) override;
+	/**
+	* Checks whether or not a cell can be set to a value. True only if the cell already has that value.
+	*/
+	virtual bool canSetCell(size_t row, size_t column, double value) const override;
+	/**
+	* Checks whether or not this matrix can be scaled. True only if the scalar is one.
+	*/
+	virtual bool canScale(double scalar) const override;
+	/**
+	* Inverts the permutation, since the transpose of a permutation matrix is its inverse.
+	*/
+	virtual void transpose() override;
+	/**
+	* Returns the number of dimensions.
+	*/
+	virtual size_t getNumNonZeros() const override;
+	/**
+	* Creates a deep copy of this matrix.
+	* @return A raw pointer to MatrixBase instance.
+	*/
+	virtual MatrixBase* clone() const override;
+	/**
+	* Calls the visitor for the 1.0 of every row, from the top row to the bottom row.
+	*/
+	virtual void forEachNonZero(const std::function<void(size_t row, size_t column, double value)>& visitor) const override;
+	/**
+	* Does nothing. Only a scalar of one can be applied (see canScale).
+	*/
+	virtual void scale(double scalar) override;
+	/**
+	* Calculates (this * right): row r of the result is row columnOfRow[r] of right. The product of two permutation matrices is a PermutationMatrix.
+	*/
+	virtual MatrixBase* multiplyByRight(const MatrixBase& right) const override;
+	/**
+	* Calculates (left * this): column columnOfRow[r] of the result is column r of left. The product of two permutation matrices is a PermutationMatrix.
+	*/
+	virtual MatrixBase* multiplyByLeft(const MatrixBase& left) const override;
+	/**
+	* Returns the sign of the permutation: 1.0 if it has an even number of transpositions, -1.0 otherwise.
+	*/
+	virtual double getDeterminant() const override;
+	/**
+	* Returns the inverse permutation.
+	* @param determinant The determinant of this matrix (ignored).
+	*/
+	virtual MatrixBase* getInverse(double determinant) const override;
+	/**
+	* Returns the number of dimensions.
+	*/
+	virtual size_t getRank() const override;
+
+private:
+	/**
+	* The column index of the 1.0 of each row.
+	*/
+	IndexStorage columnOfRow;
+};
+
+#endif // PERMUTATION_MATRIX_H
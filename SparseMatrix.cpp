@@ -1,6 +1,8 @@
 #include "SparseMatrix.h"
 #include "DenseMatrix.h"
 #include "MatCalcUtil.h"
+#include "MatrixCostModel.h"
+#include <algorithm>
 #include <iomanip>
 #include <limits> // Required by g++ (std::numeric_limits<double>)
 
@@ -19,6 +21,13 @@ SparseMatrix::SparseMatrix(size_t numRows, size_t numColumns)
 	this->numColumns = numColumns;
 }
 
+SparseMatrix::SparseMatrix(size_t numRows, size_t numColumns, MatrixAllocator* allocator)
+	: sparseMatrix(CellStorage::allocator_type(allocator))
+{
+	this->numRows = numRows;
+	this->numColumns = numColumns;
+}
+
 // Inherited via MatrixBase
 size_t SparseMatrix::getNumRows() const
 {
@@ -145,7 +154,7 @@ void SparseMatrix::resize(size_t newNumRows, size_t newNumColumns)
 
 void SparseMatrix::transpose()
 {
-	std::map<std::pair<size_t, size_t>, double> map_newSparseMatrix;
+	CellStorage map_newSparseMatrix;
 
 	auto oldMapBegin = sparseMatrix.begin();
 	auto oldMapEnd = sparseMatrix.end();
@@ -182,6 +191,11 @@ double SparseMatrix::getSparsity() const
 	return sparsity;
 }
 
+size_t SparseMatrix::getNumNonZeros() const
+{
+	return sparseMatrix.size();
+}
+
 double SparseMatrix::getDensity() const
 {
 	return 1.0 - getSparsity();
@@ -200,7 +214,8 @@ bool SparseMatrix::isDense() const
 
 bool SparseMatrix::requiresConversion() const
 {
-	return !isSparse(); // This is SparseMatrix. If it's not Sparse, then it requires conversion to Dense.
+	// This is SparseMatrix. It requires conversion to Dense only if DenseMatrix is clearly cheaper (above the hysteresis band of the cost model).
+	return MatrixCostModel::getInstance().shouldConvertToDense(numRows, numColumns, getNumNonZeros());
 }
 
 MatrixBase* SparseMatrix::getConvertedCopy() const
@@ -257,47 +272,226 @@ SparseMatrix* SparseMatrix::cloneAsSparseMatrix() const
 	return dynamic_cast<SparseMatrix*>(clone());
 }
 
-std::vector<std::tuple<size_t, size_t, double>> SparseMatrix::getCellDataList() const
+void SparseMatrix::forEachNonZero(const std::function<void(size_t row, size_t column, double value)>& visitor) const
 {
-	std::vector<std::tuple<size_t, size_t, double>> cellList;
+	visitNonZeros([&](size_t row, size_t column, double value)
+	{
+		visitor(row, column, value);
+	});
+}
 
-	auto mapBegin = sparseMatrix.begin();
-	auto mapEnd = sparseMatrix.end();
+SparseMatrix::NonZeroIterator SparseMatrix::nonZeroBegin() const
+{
+	return sparseMatrix.cbegin();
+}
 
-	for (auto mapIter = mapBegin; mapIter != mapEnd; ++mapIter)
+SparseMatrix::NonZeroIterator SparseMatrix::nonZeroEnd() const
+{
+	return sparseMatrix.cend();
+}
+
+void SparseMatrix::scale(double scalar)
+{
+	// Scale the existing elements in place. Elements which become zero are removed, just like setCell does.
+	for (auto iter = sparseMatrix.begin(); iter != sparseMatrix.end(); )
 	{
-		auto rowColumn_value_KVP = (*mapIter);
-		std::pair<size_t, size_t> rowColumn = rowColumn_value_KVP.first;
-		double valueAtCell = rowColumn_value_KVP.second;
+		(*iter).second *= scalar;
 
-		size_t row = rowColumn.first;
-		size_t column = rowColumn.second;
+		if (mcu::doubleAlmostEqual((*iter).second, 0.0))
+		{
+			iter = sparseMatrix.erase(iter);
+		}
+		else
+		{
+			++iter;
+		}
+	}
+}
 
-		auto cellData = std::make_tuple(row, column, valueAtCell);
+void SparseMatrix::addInPlace(const MatrixBase& right, double alpha)
+{
+	right.addScaledTo(*this, alpha);
+}
 
-		cellList.push_back(cellData);
+void SparseMatrix::addScaledTo(DenseMatrix& target, double alpha) const
+{
+	for (auto iter = sparseMatrix.begin(); iter != sparseMatrix.end(); ++iter)
+	{
+		size_t row = (*iter).first.first;
+		size_t column = (*iter).first.second;
+		double value = (*iter).second;
+
+		double existingValue = target.getCell(row, column);
+		target.setCell(row, column, existingValue + alpha * value);
+	}
+}
+
+void SparseMatrix::addScaledTo(SparseMatrix& target, double alpha) const
+{
+	if (&target == this)
+	{
+		// Writing into the map which is being iterated could erase the current element.
+		target.scale(1.0 + alpha);
+		return;
 	}
 
-	return cellList;
+	for (auto iter = sparseMatrix.begin(); iter != sparseMatrix.end(); ++iter)
+	{
+		size_t row = (*iter).first.first;
+		size_t column = (*iter).first.second;
+		double value = (*iter).second;
+
+		double existingValue = target.getCell(row, column);
+		target.setCell(row, column, existingValue + alpha * value);
+	}
 }
 
-void SparseMatrix::scale(double scalar)
+void SparseMatrix::multiplyAccumulate(double alpha, const MatrixBase& left, const MatrixBase& right, double beta)
 {
-	auto cellDataList = getCellDataList();
-	auto cellDataListBegin = cellDataList.begin();
-	auto cellDataListEnd = cellDataList.end();
+	// Gustavson's algorithm, like multiply: row r of (beta * this + alpha * left * right) is accumulated in a dense row, and then written back into the map once.
+	// The existing elements of the row are updated in place, so their nodes are reused; an element is only erased if its final value is zero.
 
-	for (auto iter = cellDataListBegin; iter != cellDataListEnd; ++iter)
+	const DenseMatrix* leftDense = dynamic_cast<const DenseMatrix*>(&left);
+	const DenseMatrix* rightDense = dynamic_cast<const DenseMatrix*>(&right);
+	const SparseMatrix* leftSparse = dynamic_cast<const SparseMatrix*>(&left);
+	const SparseMatrix* rightSparse = dynamic_cast<const SparseMatrix*>(&right);
+
+	// The other (structured) operands are visited through SparseMatrix copies.
+	SparseMatrix* leftCopy = (leftDense == nullptr && leftSparse == nullptr) ? left.cloneAsSparseMatrix() : nullptr;
+	SparseMatrix* rightCopy = (rightDense == nullptr && rightSparse == nullptr) ? right.cloneAsSparseMatrix() : nullptr;
+
+	if (leftCopy != nullptr)
 	{
-		auto cellData = (*iter);
-		size_t row = std::get<0>(cellData);
-		size_t column = std::get<1>(cellData);
-		double value = std::get<2>(cellData);
+		leftSparse = leftCopy;
+	}
 
-		double newValue = value * scalar;
+	if (rightCopy != nullptr)
+	{
+		rightSparse = rightCopy;
+	}
+
+	std::vector<NonZeroIterator> leftRowBegins;
+	std::vector<NonZeroIterator> rightRowBegins;
+
+	if (leftSparse != nullptr)
+	{
+		leftRowBegins = leftSparse->getRowBeginIterators();
+	}
 
-		setCell(row, column, newValue);
+	if (rightSparse != nullptr)
+	{
+		rightRowBegins = rightSparse->getRowBeginIterators();
 	}
+
+	size_t innerDimension = left.getNumColumns();
+	const size_t notSeen = std::numeric_limits<size_t>::max();
+	std::vector<double> accumulator(numColumns, 0.0);
+	std::vector<size_t> lastSeenRow(numColumns, notSeen);
+	std::vector<size_t> touchedColumns;
+
+	for (size_t r = 0; r < numRows; r++)
+	{
+		touchedColumns.clear();
+
+		auto touchColumn = [&](size_t column)
+		{
+			if (lastSeenRow[column] != r)
+			{
+				lastSeenRow[column] = r;
+				accumulator[column] = 0.0;
+				touchedColumns.push_back(column);
+			}
+		};
+
+		// Adds (leftValue * row k of the right matrix) to the accumulator.
+		auto addRightRow = [&](size_t k, double leftValue)
+		{
+			if (rightDense != nullptr)
+			{
+				const double* rightRowData = rightDense->getRowData(k);
+
+				for (size_t c = 0; c < numColumns; c++)
+				{
+					touchColumn(c);
+					accumulator[c] += leftValue * rightRowData[c];
+				}
+
+				return;
+			}
+
+			for (auto rightIter = rightRowBegins[k]; rightIter != rightRowBegins[k + 1]; ++rightIter)
+			{
+				size_t rightCol = (*rightIter).first.second;
+
+				touchColumn(rightCol);
+				accumulator[rightCol] += leftValue * (*rightIter).second;
+			}
+		};
+
+		CellStorage::iterator rowBegin = sparseMatrix.lower_bound(std::make_pair(r, (size_t)0));
+		CellStorage::iterator rowEnd = sparseMatrix.lower_bound(std::make_pair(r + 1, (size_t)0));
+
+		// When beta is zero, the existing values are ignored, like BLAS does. Their columns are still touched, so that they are erased unless the product fills them.
+		for (auto iter = rowBegin; iter != rowEnd; ++iter)
+		{
+			size_t column = iter->first.second;
+
+			touchColumn(column);
+			accumulator[column] = (beta == 0.0) ? 0.0 : beta * iter->second;
+		}
+
+		if (leftDense != nullptr)
+		{
+			const double* leftRowData = leftDense->getRowData(r);
+
+			for (size_t k = 0; k < innerDimension; k++)
+			{
+				if (leftRowData[k] != 0.0)
+				{
+					addRightRow(k, alpha * leftRowData[k]);
+				}
+			}
+		}
+		else
+		{
+			for (auto leftIter = leftRowBegins[r]; leftIter != leftRowBegins[r + 1]; ++leftIter)
+			{
+				addRightRow((*leftIter).first.second, alpha * (*leftIter).second);
+			}
+		}
+
+		// Merge the accumulated row into the existing one, in column order. Every existing element was touched, so it is either updated or erased.
+		std::sort(touchedColumns.begin(), touchedColumns.end());
+
+		CellStorage::iterator iter = rowBegin;
+
+		for (size_t i = 0; i < touchedColumns.size(); i++)
+		{
+			size_t column = touchedColumns[i];
+			double value = accumulator[column];
+			bool isZero = mcu::doubleAlmostEqual(value, 0.0);
+
+			if (iter != rowEnd && iter->first.second == column)
+			{
+				if (isZero)
+				{
+					iter = sparseMatrix.erase(iter);
+				}
+				else
+				{
+					iter->second = value;
+					++iter;
+				}
+			}
+			else if (isZero == false)
+			{
+				sparseMatrix.emplace_hint(iter, std::make_pair(r, column), value);
+			}
+		}
+	}
+
+	delete leftCopy;
+	delete rightCopy;
 }
 
 bool SparseMatrix::equal(const MatrixBase& right) const
@@ -313,14 +507,25 @@ bool SparseMatrix::equal(const DenseMatrix& left) const
 	}
 
 	// Dimensions match. Check every element.
+	// The non-zero elements of this matrix are ordered by row, then by column. So they can be walked alongside the cells, without any lookups.
+	auto rightIter = sparseMatrix.begin();
+	auto rightEnd = sparseMatrix.end();
+
 	for (size_t r = 0; r < numRows; r++)
 	{
+		const double* leftRow = left.getRowData(r);
+
 		for (size_t c = 0; c < numColumns; c++)
 		{
-			double leftValue = left.getCell(r, c);
-			double rightValue = this->getCell(r, c);
+			double rightValue = 0.0;
 
-			if (mcu::doubleAlmostEqual(leftValue, rightValue) == false)
+			if (rightIter != rightEnd && (*rightIter).first.first == r && (*rightIter).first.second == c)
+			{
+				rightValue = (*rightIter).second;
+				++rightIter;
+			}
+
+			if (mcu::doubleAlmostEqual(leftRow[c], rightValue) == false)
 			{
 				return false;
 			}
@@ -339,25 +544,18 @@ bool SparseMatrix::equal(const SparseMatrix& left) const
 
 	// Dimensions match. Check existing elements.
 
-	auto leftCellDataList = left.getCellDataList();
-	auto rightCellDataList = this->getCellDataList();
-
 	// Check if they have the same number of elements.
-	if (leftCellDataList.size() != rightCellDataList.size())
+	if (left.sparseMatrix.size() != this->sparseMatrix.size())
 	{
 		return false;
 	}
 
 	// Check if every single element is equal. Just iterate over one of them.
-	auto leftCellDataListBegin = leftCellDataList.begin();
-	auto leftCellDataListEnd = leftCellDataList.end();
-
-	for (auto leftIter = leftCellDataListBegin; leftIter != leftCellDataListEnd; ++leftIter)
+	for (auto leftIter = left.sparseMatrix.begin(); leftIter != left.sparseMatrix.end(); ++leftIter)
 	{
-		auto cellData = (*leftIter);
-		size_t leftRow = std::get<0>(cellData);
-		size_t leftColumn = std::get<1>(cellData);
-		double leftValue = std::get<2>(cellData);
+		size_t leftRow = (*leftIter).first.first;
+		size_t leftColumn = (*leftIter).first.second;
+		double leftValue = (*leftIter).second;
 
 		double rightValue = this->getCell(leftRow, leftColumn);
 
@@ -377,33 +575,16 @@ MatrixBase* SparseMatrix::add(const MatrixBase& right) const
 
 MatrixBase* SparseMatrix::add(const DenseMatrix& left) const
 {
-	DenseMatrix* addedDense = new DenseMatrix(numRows, numColumns, 0.0);
-
 	// Set left.
-	for (size_t r = 0; r < left.getNumRows(); r++)
-	{
-		for (size_t c = 0; c < left.getNumColumns(); c++)
-		{
-			double valueAtCell = left.getCell(r, c);
-			addedDense->setCell(r, c, valueAtCell);
-		}
-	}
+	DenseMatrix* addedDense = new DenseMatrix(left);
 
 	// Add right.
-	auto rightCellDataList = this->getCellDataList();
-	auto rightCellDataListBegin = rightCellDataList.begin();
-	auto rightCellDataListEnd = rightCellDataList.end();
-
-	for (auto iter = rightCellDataListBegin; iter != rightCellDataListEnd; ++iter)
+	for (auto mapIter = sparseMatrix.begin(); mapIter != sparseMatrix.end(); ++mapIter)
 	{
-		auto cellData = (*iter);
-		size_t row = std::get<0>(cellData);
-		size_t column = std::get<1>(cellData);
-		double value = std::get<2>(cellData);
+		size_t row = (*mapIter).first.first;
+		size_t column = (*mapIter).first.second;
 
-		double existingValue = addedDense->getCell(row, column);
-		double newValue = existingValue + value;
-		addedDense->setCell(row, column, newValue);
+		addedDense->getRowData(row)[column] += (*mapIter).second;
 	}
 
 	return addedDense;
@@ -411,34 +592,15 @@ MatrixBase* SparseMatrix::add(const DenseMatrix& left) const
 
 MatrixBase* SparseMatrix::add(const SparseMatrix& left) const
 {
-	SparseMatrix* addedSparse = new SparseMatrix(numRows, numColumns);
-
 	// Set left.
-	auto leftCellDataList = left.getCellDataList();
-	auto leftCellDataListBegin = leftCellDataList.begin();
-	auto leftCellDataListEnd = leftCellDataList.end();
-
-	for (auto iter = leftCellDataListBegin; iter != leftCellDataListEnd; ++iter)
-	{
-		auto cellData = (*iter);
-		size_t row = std::get<0>(cellData);
-		size_t column = std::get<1>(cellData);
-		double value = std::get<2>(cellData);
-
-		addedSparse->setCell(row, column, value);
-	}
+	SparseMatrix* addedSparse = new SparseMatrix(left);
 
 	// Add right.
-	auto rightCellDataList = this->getCellDataList();
-	auto rightCellDataListBegin = rightCellDataList.begin();
-	auto rightCellDataListEnd = rightCellDataList.end();
-
-	for (auto iter = rightCellDataListBegin; iter != rightCellDataListEnd; ++iter)
+	for (auto mapIter = sparseMatrix.begin(); mapIter != sparseMatrix.end(); ++mapIter)
 	{
-		auto cellData = (*iter);
-		size_t row = std::get<0>(cellData);
-		size_t column = std::get<1>(cellData);
-		double value = std::get<2>(cellData);
+		size_t row = (*mapIter).first.first;
+		size_t column = (*mapIter).first.second;
+		double value = (*mapIter).second;
 
 		double existingValue = addedSparse->getCell(row, column);
 		double newValue = existingValue + value;
@@ -455,34 +617,16 @@ MatrixBase* SparseMatrix::subtract(const MatrixBase& right) const
 
 MatrixBase* SparseMatrix::subtract(const DenseMatrix& left) const
 {
-	DenseMatrix* subtractedDense = new DenseMatrix(numRows, numColumns, 0.0);
-
 	// Set left.
-	for (size_t r = 0; r < left.getNumRows(); r++)
-	{
-		for (size_t c = 0; c < left.getNumColumns(); c++)
-		{
-			double valueAtCell = left.getCell(r, c);
-			subtractedDense->setCell(r, c, valueAtCell);
-		}
-	}
+	DenseMatrix* subtractedDense = new DenseMatrix(left);
 
 	// Add negated right.
-	auto rightCellDataList = this->getCellDataList();
-	auto rightCellDataListBegin = rightCellDataList.begin();
-	auto rightCellDataListEnd = rightCellDataList.end();
-
-	for (auto iter = rightCellDataListBegin; iter != rightCellDataListEnd; ++iter)
+	for (auto mapIter = sparseMatrix.begin(); mapIter != sparseMatrix.end(); ++mapIter)
 	{
-		auto cellData = (*iter);
-		size_t row = std::get<0>(cellData);
-		size_t column = std::get<1>(cellData);
-		double value = std::get<2>(cellData);
-
-		double existingValue = subtractedDense->getCell(row, column);
-		double newValue = existingValue - value; // SUBTRACTION
+		size_t row = (*mapIter).first.first;
+		size_t column = (*mapIter).first.second;
 
-		subtractedDense->setCell(row, column, newValue);
+		subtractedDense->getRowData(row)[column] -= (*mapIter).second; // SUBTRACTION
 	}
 
 	return subtractedDense;
@@ -490,34 +634,15 @@ MatrixBase* SparseMatrix::subtract(const DenseMatrix& left) const
 
 MatrixBase* SparseMatrix::subtract(const SparseMatrix& left) const
 {
-	SparseMatrix* subtractedSparse = new SparseMatrix(numRows, numColumns);
-
 	// Set left.
-	auto leftCellDataList = left.getCellDataList();
-	auto leftCellDataListBegin = leftCellDataList.begin();
-	auto leftCellDataListEnd = leftCellDataList.end();
-
-	for (auto iter = leftCellDataListBegin; iter != leftCellDataListEnd; ++iter)
-	{
-		auto cellData = (*iter);
-		size_t row = std::get<0>(cellData);
-		size_t column = std::get<1>(cellData);
-		double value = std::get<2>(cellData);
-
-		subtractedSparse->setCell(row, column, value);
-	}
+	SparseMatrix* subtractedSparse = new SparseMatrix(left);
 
 	// Add negated right.
-	auto rightCellDataList = this->getCellDataList();
-	auto rightCellDataListBegin = rightCellDataList.begin();
-	auto rightCellDataListEnd = rightCellDataList.end();
-
-	for (auto iter = rightCellDataListBegin; iter != rightCellDataListEnd; ++iter)
+	for (auto mapIter = sparseMatrix.begin(); mapIter != sparseMatrix.end(); ++mapIter)
 	{
-		auto cellData = (*iter);
-		size_t row = std::get<0>(cellData);
-		size_t column = std::get<1>(cellData);
-		double value = std::get<2>(cellData);
+		size_t row = (*mapIter).first.first;
+		size_t column = (*mapIter).first.second;
+		double value = (*mapIter).second;
 
 		double existingValue = subtractedSparse->getCell(row, column);
 		double newValue = existingValue - value; // SUBTRACTION
@@ -535,25 +660,64 @@ MatrixBase* SparseMatrix::multiply(const MatrixBase& right) const
 
 MatrixBase* SparseMatrix::multiply(const DenseMatrix& left) const
 {
-	// I'm using DenseMatrix * DenseMatrix algorithm again, because I don't know the best approach for now.
+	// Every non-zero CELL (k, c) of the RIGHTmatrix (this) scales the COLUMN k of the LEFTmatrix, which is ADDED to the COLUMN c of the RESULTmatrix.
+	// The rows are still traversed first, so that the rows of the LEFT and RESULT matrices are accessed contiguously.
 
 	DenseMatrix* denseProduct = new DenseMatrix(left.getNumRows(), this->numColumns, 0.0);
 
 	for (size_t leftRow = 0; leftRow < left.getNumRows(); leftRow++)
 	{
-		for (size_t leftCol = 0; leftCol < left.getNumColumns(); leftCol++)
+		const double* leftRowData = left.getRowData(leftRow);
+		double* productRowData = denseProduct->getRowData(leftRow);
+
+		for (auto mapIter = sparseMatrix.begin(); mapIter != sparseMatrix.end(); ++mapIter)
 		{
-			for (size_t rightCol = 0; rightCol < this->numColumns; rightCol++)
-			{
-				double leftValue = left.getCell(leftRow, leftCol);
-				double rightValue = this->getCell(leftCol, rightCol);
-				double product = leftValue * rightValue;
+			size_t rightRow = (*mapIter).first.first;
+			size_t rightCol = (*mapIter).first.second;
 
-				double existingValue = denseProduct->getCell(leftRow, rightCol);
-				double newValue = existingValue + product;
+			productRowData[rightCol] += leftRowData[rightRow] * (*mapIter).second;
+		}
+	}
 
-				denseProduct->setCell(leftRow, rightCol, newValue);
-			}
+	return denseProduct;
+}
+
+DenseMatrix* SparseMatrix::multiplyTransposedRight(const DenseMatrix& left, const SparseMatrix& right)
+{
+	// Same as multiply(const DenseMatrix&), with the row & column of each non-zero CELL of the RIGHT matrix swapped.
+	DenseMatrix* denseProduct = new DenseMatrix(left.getNumRows(), right.numRows, 0.0);
+
+	for (size_t leftRow = 0; leftRow < left.getNumRows(); leftRow++)
+	{
+		const double* leftRowData = left.getRowData(leftRow);
+		double* productRowData = denseProduct->getRowData(leftRow);
+
+		for (auto mapIter = right.sparseMatrix.begin(); mapIter != right.sparseMatrix.end(); ++mapIter)
+		{
+			size_t rightRow = (*mapIter).first.first;
+			size_t rightCol = (*mapIter).first.second;
+
+			productRowData[rightRow] += leftRowData[rightCol] * (*mapIter).second;
+		}
+	}
+
+	return denseProduct;
+}
+
+DenseMatrix* SparseMatrix::multiplyTransposedLeft(const SparseMatrix& left, const DenseMatrix& right)
+{
+	size_t productNumColumns = right.getNumColumns();
+	DenseMatrix* denseProduct = new DenseMatrix(left.numColumns, productNumColumns, 0.0);
+
+	for (auto mapIter = left.sparseMatrix.begin(); mapIter != left.sparseMatrix.end(); ++mapIter)
+	{
+		const double* rightRowData = right.getRowData((*mapIter).first.first);
+		double* productRowData = denseProduct->getRowData((*mapIter).first.second);
+		double value = (*mapIter).second;
+
+		for (size_t c = 0; c < productNumColumns; c++)
+		{
+			productRowData[c] += value * rightRowData[c];
 		}
 	}
 
@@ -562,24 +726,84 @@ MatrixBase* SparseMatrix::multiply(const DenseMatrix& left) const
 
 MatrixBase* SparseMatrix::multiply(const SparseMatrix& left) const
 {
-	// I'm using DenseMatrix * DenseMatrix algorithm again, because I don't know the best approach for now.
+	// Gustavson's algorithm: row i of the product is the sum of the rows k of the right matrix, scaled by the non-zero cells (i, k) of the left matrix.
+	// Both matrices are ordered by row, so the rows are ranges of the maps. The cells of each product row are accumulated in a dense row, and then copied into the result once.
 
-	SparseMatrix* sparseProduct = new SparseMatrix(left.getNumRows(), this->numColumns);
+	std::vector<NonZeroIterator> leftRowBegins = left.getRowBeginIterators();
+	std::vector<NonZeroIterator> rightRowBegins = this->getRowBeginIterators();
 
-	for (size_t leftRow = 0; leftRow < left.getNumRows(); leftRow++)
+	size_t productNumRows = left.getNumRows();
+	size_t productNumColumns = this->numColumns;
+
+	// Decide the format of the product before computing it.
+	size_t sampleStep = (productNumRows > 1024) ? (productNumRows / 256) : 1;
+	size_t estimatedNumNonZeros = countProductNonZeros(leftRowBegins, rightRowBegins, productNumColumns, sampleStep);
+
+	if (MatrixCostModel::getInstance().isDenseCheaper(productNumRows, productNumColumns, estimatedNumNonZeros))
 	{
-		for (size_t leftCol = 0; leftCol < left.getNumColumns(); leftCol++)
+		DenseMatrix* denseProduct = new DenseMatrix(productNumRows, productNumColumns, 0.0);
+
+		for (size_t leftRow = 0; leftRow < productNumRows; leftRow++)
 		{
-			for (size_t rightCol = 0; rightCol < this->numColumns; rightCol++)
+			double* productRowData = denseProduct->getRowData(leftRow);
+
+			for (auto leftIter = leftRowBegins[leftRow]; leftIter != leftRowBegins[leftRow + 1]; ++leftIter)
+			{
+				size_t leftCol = (*leftIter).first.second;
+				double leftValue = (*leftIter).second;
+
+				for (auto rightIter = rightRowBegins[leftCol]; rightIter != rightRowBegins[leftCol + 1]; ++rightIter)
+				{
+					productRowData[(*rightIter).first.second] += leftValue * (*rightIter).second;
+				}
+			}
+		}
+
+		return denseProduct;
+	}
+
+	SparseMatrix* sparseProduct = new SparseMatrix(productNumRows, productNumColumns);
+
+	const size_t notSeen = std::numeric_limits<size_t>::max();
+	std::vector<double> accumulator(productNumColumns, 0.0);
+	std::vector<size_t> lastSeenRow(productNumColumns, notSeen);
+	std::vector<size_t> touchedColumns;
+
+	for (size_t leftRow = 0; leftRow < productNumRows; leftRow++)
+	{
+		touchedColumns.clear();
+
+		for (auto leftIter = leftRowBegins[leftRow]; leftIter != leftRowBegins[leftRow + 1]; ++leftIter)
+		{
+			size_t leftCol = (*leftIter).first.second;
+			double leftValue = (*leftIter).second;
+
+			for (auto rightIter = rightRowBegins[leftCol]; rightIter != rightRowBegins[leftCol + 1]; ++rightIter)
 			{
-				double leftValue = left.getCell(leftRow, leftCol);
-				double rightValue = this->getCell(leftCol, rightCol);
-				double product = leftValue * rightValue;
+				size_t rightCol = (*rightIter).first.second;
 
-				double existingValue = sparseProduct->getCell(leftRow, rightCol);
-				double newValue = existingValue + product;
+				if (lastSeenRow[rightCol] != leftRow)
+				{
+					lastSeenRow[rightCol] = leftRow;
+					accumulator[rightCol] = 0.0;
+					touchedColumns.push_back(rightCol);
+				}
 
-				sparseProduct->setCell(leftRow, rightCol, newValue);
+				accumulator[rightCol] += leftValue * (*rightIter).second;
+			}
+		}
+
+		// Insert the row in order, so that every insertion happens at the end of the map (amortized constant time).
+		std::sort(touchedColumns.begin(), touchedColumns.end());
+
+		for (size_t i = 0; i < touchedColumns.size(); i++)
+		{
+			size_t column = touchedColumns[i];
+			double value = accumulator[column];
+
+			if (mcu::doubleAlmostEqual(value, 0.0) == false)
+			{
+				sparseProduct->sparseMatrix.emplace_hint(sparseProduct->sparseMatrix.end(), std::make_pair(leftRow, column), value);
 			}
 		}
 	}
@@ -587,6 +811,13 @@ MatrixBase* SparseMatrix::multiply(const SparseMatrix& left) const
 	return sparseProduct;
 }
 
+size_t SparseMatrix::estimateProductNumNonZeros(const SparseMatrix& left) const
+{
+	size_t sampleStep = (left.getNumRows() > 1024) ? (left.getNumRows() / 256) : 1;
+
+	return countProductNonZeros(left.getRowBeginIterators(), this->getRowBeginIterators(), this->numColumns, sampleStep);
+}
+
 MatrixBase* SparseMatrix::mergeByColumns(const MatrixBase& right) const
 {
 	return right.mergeByColumns(*this);
@@ -599,29 +830,19 @@ MatrixBase* SparseMatrix::mergeByColumns(const DenseMatrix& left) const
 	// Copy left.
 	for (size_t r = 0; r < numRows; r++)
 	{
-		for (size_t c = 0; c < left.getNumColumns(); c++)
-		{
-			double leftValue = left.getCell(r, c);
-			mergedDense->setCell(r, c, leftValue);
-		}
+		const double* leftRow = left.getRowData(r);
+		std::copy(leftRow, leftRow + left.getNumColumns(), mergedDense->getRowData(r));
 	}
 
 	// Copy right.
-	auto rightCellDataList = this->getCellDataList();
-	auto rightCellDataListBegin = rightCellDataList.begin();
-	auto rightCellDataListEnd = rightCellDataList.end();
+	size_t columnOffset = left.getNumColumns();
 
-	for (auto iter = rightCellDataListBegin; iter != rightCellDataListEnd; ++iter)
+	for (auto mapIter = sparseMatrix.begin(); mapIter != sparseMatrix.end(); ++mapIter)
 	{
-		auto cellData = (*iter);
-		size_t row = std::get<0>(cellData);
-		size_t column = std::get<1>(cellData);
-		double rightValue = std::get<2>(cellData);
-
-		size_t columnOffset = left.getNumColumns();
-		size_t newColumnIndex = column + columnOffset;
+		size_t row = (*mapIter).first.first;
+		size_t column = (*mapIter).first.second;
 
-		mergedDense->setCell(row, newColumnIndex, rightValue);
+		mergedDense->getRowData(row)[column + columnOffset] = (*mapIter).second;
 	}
 
 	return mergedDense;
@@ -681,29 +902,19 @@ MatrixBase* SparseMatrix::mergeByRows(const DenseMatrix& left) const
 	// Copy left.
 	for (size_t r = 0; r < left.getNumRows(); r++)
 	{
-		for (size_t c = 0; c < numColumns; c++)
-		{
-			double leftValue = left.getCell(r, c);
-			mergedDense->setCell(r, c, leftValue);
-		}
+		const double* leftRow = left.getRowData(r);
+		std::copy(leftRow, leftRow + numColumns, mergedDense->getRowData(r));
 	}
 
 	// Copy right.
-	auto rightCellDataList = this->getCellDataList();
-	auto rightCellDataListBegin = rightCellDataList.begin();
-	auto rightCellDataListEnd = rightCellDataList.end();
+	size_t rowOffset = left.getNumRows();
 
-	for (auto cellListIter = rightCellDataListBegin; cellListIter != rightCellDataListEnd; ++cellListIter)
+	for (auto mapIter = sparseMatrix.begin(); mapIter != sparseMatrix.end(); ++mapIter)
 	{
-		auto cellData = (*cellListIter);
-		size_t row = std::get<0>(cellData);
-		size_t column = std::get<1>(cellData);
-		double rightValue = std::get<2>(cellData);
+		size_t row = (*mapIter).first.first;
+		size_t column = (*mapIter).first.second;
 
-		size_t rowOffset = left.getNumRows();
-		size_t newRowIndex = row + rowOffset;
-
-		mergedDense->setCell(newRowIndex, column, rightValue);
+		mergedDense->getRowData(row + rowOffset)[column] = (*mapIter).second;
 	}
 
 	return mergedDense;
@@ -835,16 +1046,11 @@ MatrixBase* SparseMatrix::getSubMatrix(size_t subRowBeginIndex, size_t subNumRow
 
 	SparseMatrix* subSparse = new SparseMatrix(subNumRows, subNumColumns);
 
-	auto cellDataList = this->getCellDataList();
-	auto cellDataListBegin = cellDataList.begin();
-	auto cellDataListEnd = cellDataList.end();
-
-	for (auto cellDataIter = cellDataListBegin; cellDataIter != cellDataListEnd; ++cellDataIter)
+	for (auto mapIter = sparseMatrix.begin(); mapIter != sparseMatrix.end(); ++mapIter)
 	{
-		auto cellData = (*cellDataIter);
-		size_t bigMatRow = std::get<0>(cellData);
-		size_t bigMatCol = std::get<1>(cellData);
-		double bigMatValue = std::get<2>(cellData);
+		size_t bigMatRow = (*mapIter).first.first;
+		size_t bigMatCol = (*mapIter).first.second;
+		double bigMatValue = (*mapIter).second;
 
 		// Boundary check: (rowBegin <= row < (rowBegin + numRows)) && (colBegin <= col < (colBegin + numCols))
 		if (((subRowBeginIndex <= bigMatRow) && (bigMatRow < (subRowBeginIndex + subNumRows)))
@@ -933,16 +1139,11 @@ MatrixBase* SparseMatrix::getSubMatrixTopLeft(size_t ignoredRowIndex, size_t ign
 	size_t subNumColumns = ignoredColumnIndex;
 	SparseMatrix* topLeft = new SparseMatrix(subNumRows, subNumColumns);
 
-	auto cellDataList = this->getCellDataList();
-	auto cellDataListBegin = cellDataList.begin();
-	auto cellDataListEnd = cellDataList.end();
-
-	for (auto cellDataIter = cellDataListBegin; cellDataIter != cellDataListEnd; ++cellDataIter)
+	for (auto mapIter = sparseMatrix.begin(); mapIter != sparseMatrix.end(); ++mapIter)
 	{
-		auto cellData = (*cellDataIter);
-		size_t bigRow = std::get<0>(cellData);
-		size_t bigColumn = std::get<1>(cellData);
-		double bigValue = std::get<2>(cellData);
+		size_t bigRow = (*mapIter).first.first;
+		size_t bigColumn = (*mapIter).first.second;
+		double bigValue = (*mapIter).second;
 
 		// Pick bigMatrix cells that are within the following boundaries:
 		// 0 <= bigRow < ignoredRowIndex
@@ -968,16 +1169,11 @@ MatrixBase* SparseMatrix::getSubMatrixTopRight(size_t ignoredRowIndex, size_t ig
 	size_t subNumColumns = (this->numColumns - 1) - ignoredColumnIndex;
 	SparseMatrix* topRight = new SparseMatrix(subNumRows, subNumColumns);
 
-	auto cellDataList = this->getCellDataList();
-	auto cellDataListBegin = cellDataList.begin();
-	auto cellDataListEnd = cellDataList.end();
-
-	for (auto cellDataIter = cellDataListBegin; cellDataIter != cellDataListEnd; ++cellDataIter)
+	for (auto mapIter = sparseMatrix.begin(); mapIter != sparseMatrix.end(); ++mapIter)
 	{
-		auto cellData = (*cellDataIter);
-		size_t bigRow = std::get<0>(cellData);
-		size_t bigColumn = std::get<1>(cellData);
-		double bigValue = std::get<2>(cellData);
+		size_t bigRow = (*mapIter).first.first;
+		size_t bigColumn = (*mapIter).first.second;
+		double bigValue = (*mapIter).second;
 
 		// Pick bigMatrix cells that are within the following boundaries:
 		// 0 <= bigRow < ignoredRowIndex
@@ -1005,16 +1201,11 @@ MatrixBase* SparseMatrix::getSubMatrixBottomLeft(size_t ignoredRowIndex, size_t
 	size_t subNumColumns = ignoredColumnIndex;
 	SparseMatrix* bottomLeft = new SparseMatrix(subNumRows, subNumColumns);
 
-	auto cellDataList = this->getCellDataList();
-	auto cellDataListBegin = cellDataList.begin();
-	auto cellDataListEnd = cellDataList.end();
-
-	for (auto cellDataIter = cellDataListBegin; cellDataIter != cellDataListEnd; ++cellDataIter)
+	for (auto mapIter = sparseMatrix.begin(); mapIter != sparseMatrix.end(); ++mapIter)
 	{
-		auto cellData = (*cellDataIter);
-		size_t bigRow = std::get<0>(cellData);
-		size_t bigColumn = std::get<1>(cellData);
-		double bigValue = std::get<2>(cellData);
+		size_t bigRow = (*mapIter).first.first;
+		size_t bigColumn = (*mapIter).first.second;
+		double bigValue = (*mapIter).second;
 
 		// Pick bigMatrix cells that are within the following boundaries:
 		// ignoredRowIndex < bigRow < this->numRows
@@ -1042,16 +1233,11 @@ MatrixBase* SparseMatrix::getSubMatrixBottomRight(size_t ignoredRowIndex, size_t
 	size_t subNumColumns = (this->numColumns - 1) - ignoredColumnIndex;
 	SparseMatrix* bottomRight = new SparseMatrix(subNumRows, subNumColumns);
 
-	auto cellDataList = this->getCellDataList();
-	auto cellDataListBegin = cellDataList.begin();
-	auto cellDataListEnd = cellDataList.end();
-
-	for (auto cellDataIter = cellDataListBegin; cellDataIter != cellDataListEnd; ++cellDataIter)
+	for (auto mapIter = sparseMatrix.begin(); mapIter != sparseMatrix.end(); ++mapIter)
 	{
-		auto cellData = (*cellDataIter);
-		size_t bigRow = std::get<0>(cellData);
-		size_t bigColumn = std::get<1>(cellData);
-		double bigValue = std::get<2>(cellData);
+		size_t bigRow = (*mapIter).first.first;
+		size_t bigColumn = (*mapIter).first.second;
+		double bigValue = (*mapIter).second;
 
 		// Pick bigMatrix cells that are within the following boundaries:
 		// ignoredRowIndex < bigRow < this->numRows
@@ -1109,47 +1295,18 @@ double SparseMatrix::getDeterminant() const
 			cellAtFirstRow = -cellAtFirstRow;
 		}
 
+		// The sub-matrix of this step (and those of the recursive steps) is only needed until its determinant is known, so its elements come from the scratch arena.
+		MatrixScratchScope scratchScope;
+
 		// Create sub-matrix, by ignoring the current cell's entire row and column.
-		// Create left side.
-		size_t leftRowBegin = 1;
-		size_t leftNumRows = this->numRows - 1;
-		size_t leftColBegin = 0;
-		size_t leftNumCols = c;
-		MatrixBase* leftSubMatrix = this->getSubMatrix(leftRowBegin, leftNumRows, leftColBegin, leftNumCols);
-
-		// Create right side.
-		size_t rightRowBegin = leftRowBegin; // Always the same.
-		size_t rightNumRows = leftNumRows; // Always the same.
-		size_t rightColBegin = c + 1;
-		size_t rightNumCols = (this->numColumns - 1) - c;
-		MatrixBase* rightSubMatrix = this->getSubMatrix(rightRowBegin, rightNumRows, rightColBegin, rightNumCols);
-
-		// Create merged sub-matrix from left and right sides.
-		MatrixBase* mergedSub = nullptr;
-
-		if (leftSubMatrix == nullptr)
-		{
-			mergedSub = rightSubMatrix->clone();
-		}
-		else if (rightSubMatrix == nullptr)
-		{
-			mergedSub = leftSubMatrix->clone();
-		}
-		else
-		{
-			mergedSub = leftSubMatrix->mergeByColumns((*rightSubMatrix));
-		}
+		SparseMatrix subMatrix(numRows - 1, numColumns - 1, scratchScope.getAllocator());
+		copyCofactorSubMatrix(0, c, &subMatrix);
 
-		// Get the determinant of the merged sub-matrix.
-		double subMatDet = mergedSub->getDeterminant();
+		// Get the determinant of the sub-matrix.
+		double subMatDet = subMatrix.getDeterminant();
 
 		// Finally, the big meat.
 		determinant += (cellAtFirstRow * subMatDet);
-
-		// Delete the matrices. (left, right and mergedSub).
-		delete leftSubMatrix;
-		delete rightSubMatrix;
-		delete mergedSub;
 	}
 
 	return determinant;
@@ -1164,13 +1321,18 @@ MatrixBase* SparseMatrix::getMinorMatrix() const
 	{
 		for (size_t c = 0; c < numColumns; c++)
 		{
-			MatrixBase* subSparseMatrix = this->getSubMatrix(r, c);
+			double subDeterminant = 0;
+
+			{
+				// The sub-matrix is a temporary, so its elements come from the scratch arena.
+				MatrixScratchScope scratchScope;
+				SparseMatrix subSparseMatrix(numRows - 1, numColumns - 1, scratchScope.getAllocator());
 
-			double subDeterminant = subSparseMatrix->getDeterminant();
+				copyCofactorSubMatrix(r, c, &subSparseMatrix);
+				subDeterminant = subSparseMatrix.getDeterminant();
+			}
 
 			sparseMinorMatrix->setCell(r, c, subDeterminant);
-
-			delete subSparseMatrix;
 		}
 	}
 
@@ -1353,3 +1515,86 @@ std::map<size_t, size_t> SparseMatrix::getColumnAlignmentMapForPrinting() const
 
 	return map_colIndex_maxDigits;
 }
+
+std::vector<SparseMatrix::NonZeroIterator> SparseMatrix::getRowBeginIterators() const
+{
+	std::vector<NonZeroIterator> rowBegins(numRows + 1, sparseMatrix.cend());
+
+	auto mapIter = sparseMatrix.cbegin();
+
+	for (size_t r = 0; r <= numRows; r++)
+	{
+		// Skip the rest of the previous row.
+		while (mapIter != sparseMatrix.cend() && (*mapIter).first.first < r)
+		{
+			++mapIter;
+		}
+
+		rowBegins[r] = mapIter;
+	}
+
+	return rowBegins;
+}
+
+void SparseMatrix::copyCofactorSubMatrix(size_t excludedRow, size_t excludedColumn, SparseMatrix* out_subMatrix) const
+{
+	CellStorage& subCells = out_subMatrix->sparseMatrix;
+
+	for (auto iter = sparseMatrix.cbegin(); iter != sparseMatrix.cend(); ++iter)
+	{
+		size_t row = (*iter).first.first;
+		size_t column = (*iter).first.second;
+
+		if (row == excludedRow || column == excludedColumn)
+		{
+			continue;
+		}
+
+		// The elements are visited in row-major order, so every element goes to the end of the sub-matrix.
+		std::pair<size_t, size_t> subCoordinates((row > excludedRow) ? row - 1 : row, (column > excludedColumn) ? column - 1 : column);
+		subCells.emplace_hint(subCells.end(), subCoordinates, (*iter).second);
+	}
+}
+
+size_t SparseMatrix::countProductNonZeros(const std::vector<NonZeroIterator>& leftRowBegins, const std::vector<NonZeroIterator>& rightRowBegins, size_t rightNumColumns, size_t sampleStep)
+{
+	size_t leftNumRows = leftRowBegins.size() - 1;
+
+	// Marks the columns which are already counted for the current row, so that no clearing is required between the rows.
+	const size_t notSeen = std::numeric_limits<size_t>::max();
+	std::vector<size_t> lastSeenRow(rightNumColumns, notSeen);
+
+	size_t numCountedRows = 0;
+	size_t numNonZeros = 0;
+
+	for (size_t leftRow = 0; leftRow < leftNumRows; leftRow += sampleStep)
+	{
+		numCountedRows++;
+
+		for (auto leftIter = leftRowBegins[leftRow]; leftIter != leftRowBegins[leftRow + 1]; ++leftIter)
+		{
+			size_t leftCol = (*leftIter).first.second;
+
+			for (auto rightIter = rightRowBegins[leftCol]; rightIter != rightRowBegins[leftCol + 1]; ++rightIter)
+			{
+				size_t rightCol = (*rightIter).first.second;
+
+				if (lastSeenRow[rightCol] != leftRow)
+				{
+					lastSeenRow[rightCol] = leftRow;
+					numNonZeros++;
+				}
+			}
+		}
+	}
+
+	if (sampleStep == 1 || numCountedRows == 0)
+	{
+		return numNonZeros;
+	}
+
+	// Scale the sampled count up to all of the rows.
+	double scaledNumNonZeros = ((double)numNonZeros * (double)leftNumRows) / (double)numCountedRows;
+
+	return (size_t)scaledNumNonZeros;
+}
@@ -14,6 +14,15 @@ class DenseMatrix;
 class SparseMatrix : public MatrixBase
 {
 public:
+	/**
+	* The type of the underlying storage (see sparseMatrix). Its memory is served by MatrixMemory.
+	*/
+	typedef std::map<std::pair<size_t, size_t>, double, std::less<std::pair<size_t, size_t>>, MatrixStorageAllocator<std::pair<const std::pair<size_t, size_t>, double>>> CellStorage;
+	/**
+	* Read-only iterator over the non-zero elements of SparseMatrix.
+	*/
+	typedef CellStorage::const_iterator NonZeroIterator;
+
 	/**
 	* Creates an invalid SparseMatrix with zero rows and zero dimensions. Don't use it. Use the custom consturctor instead.
 	*/
@@ -49,6 +58,13 @@ public:
 	*/
 	SparseMatrix(size_t numRows, size_t numColumns);
 	/**
+	* Custom Constructor for a SparseMatrix whose elements are served by the given allocator, e.g. a temporary in the arena of a MatrixScratchScope. Copies of the matrix are served by the default allocator.
+	* @param numRows The number of rows for the SparseMatrix.
+	* @param numColumns The number of columns for the SparseMatrix.
+	* @param allocator The allocator of the elements. It must outlive the matrix.
+	*/
+	SparseMatrix(size_t numRows, size_t numColumns, MatrixAllocator* allocator);
+	/**
 	* Returns the number of rows of this matrix.
 	*/
 	virtual size_t getNumRows() const override;
@@ -97,6 +113,10 @@ public:
 	*/
 	virtual double getSparsity() const override;
 	/**
+	* Returns the number of non-zero elements of this matrix, which is the number of elements in the underlying std::map.
+	*/
+	virtual size_t getNumNonZeros() const override;
+	/**
 	* Gets the Density value of the matrix. Density is the ratio of numNonZeroElements/numTotalElements.
 	* @see MatrixBase::DensityThreshold
 	* @return Density floating point value between 0 and 1. The DensityThreshold value itself IS considered Density.
@@ -117,10 +137,9 @@ public:
 	*/
 	virtual bool isDense() const override;
 	/**
-	* This class is SparseMatrix. It is meant for containing sparse matrices. If its Sparsity is less than or equal to SparsityThreshold, then it requires conversion to DenseeMatrix. This method answers that question.
-	* @see MatrixBase::DensityThreshold
+	* This class is SparseMatrix. It is meant for containing sparse matrices. If DenseMatrix would be clearly cheaper according to the cost model (above its hysteresis band), then it requires conversion to DenseMatrix. This method answers that question.
+	* @see MatrixCostModel::shouldConvertToDense()
 	* @see getDensity()
-	* @see isDense()
 	* @return True if it requires conversion, false if not.
 	*/
 	virtual bool requiresConversion() const override;
@@ -148,16 +167,65 @@ public:
 	*/
 	virtual SparseMatrix* cloneAsSparseMatrix() const override;
 	/**
-	* Creates a vector of 3-tuples. The first two size_t are the row & column data; the double is the value at the row & column coordinate. It makes it easier to use SparseMatrix. Acts as a short hack instead of writing a custom iterator. Recommended to use this instead of iterating over an std::map, which can reduce your keyboard's life span with all the insufferably::verbose::iterator::syntax..
-	* @return A vector of 3-tuples, which contains row & column coordinates; and their corresponding double value.
+	* Calls the visitor for every non-zero cell of this matrix, in row-major order. Prefer nonZeroBegin and nonZeroEnd when the type is known to be SparseMatrix.
+	* @param visitor A function which takes the row index, the column index and the value of the cell.
+	*/
+	virtual void forEachNonZero(const std::function<void(size_t row, size_t column, double value)>& visitor) const override;
+	/**
+	* Calls the visitor for every non-zero cell of this matrix, in row-major order, like forEachNonZero. Not virtual, and the visitor is called directly, so the compiler can inline it into the loop over the elements.
+	* @see mcu::visitNonZeros for the matrices whose type isn't known.
+	* @param visitor A callable which takes the row index, the column index and the value of the cell.
+	*/
+	template <typename Visitor>
+	void visitNonZeros(Visitor visitor) const
+	{
+		for (auto mapIter = sparseMatrix.begin(); mapIter != sparseMatrix.end(); ++mapIter)
+		{
+			visitor((*mapIter).first.first, (*mapIter).first.second, (*mapIter).second);
+		}
+	}
+	/**
+	* Returns an iterator to the first non-zero element. Elements are ordered by row, then by column. The key of an element is the (row, column) pair, and the mapped value is the value of the cell.
+	* Not virtual, so that the kernels can iterate the non-zero elements without allocating anything.
+	*/
+	NonZeroIterator nonZeroBegin() const;
+	/**
+	* Returns the past-the-end iterator of the non-zero elements.
+	* @see nonZeroBegin()
 	*/
-	virtual std::vector<std::tuple<size_t, size_t, double>> getCellDataList() const override;
+	NonZeroIterator nonZeroEnd() const;
 	/**
 	* Scales every cell of this matrix by the given scalar value.
 	* @param scalar Scalar value to scale each cell.
 	*/
 	virtual void scale(double scalar) override;
 	/**
+	* Adds the argument matrix, scaled by alpha, to this matrix in place (this = this + alpha * right). Method implements Double Dispatch. This particular method just calls the addScaledTo method on the argument to activate polymorphism.
+	* @param right The other MatrixBase.
+	* @param alpha Scalar value by which the argument is scaled before it is added.
+	*/
+	virtual void addInPlace(const MatrixBase& right, double alpha) override;
+	/**
+	* Adds this matrix, scaled by alpha, to the target DenseMatrix in place. Method implements Double Dispatch.
+	* @param target The DenseMatrix which is modified.
+	* @param alpha Scalar value by which this matrix is scaled before it is added.
+	*/
+	virtual void addScaledTo(DenseMatrix& target, double alpha) const override;
+	/**
+	* Adds this matrix, scaled by alpha, to the target SparseMatrix in place. Method implements Double Dispatch.
+	* @param target The SparseMatrix which is modified.
+	* @param alpha Scalar value by which this matrix is scaled before it is added.
+	*/
+	virtual void addScaledTo(SparseMatrix& target, double alpha) const override;
+	/**
+	* Performs this = alpha * left * right + beta * this in place. Only the non-zero elements of the left operand contribute to the product.
+	* @param alpha Scalar value by which the product is scaled.
+	* @param left The left operand of the product.
+	* @param right The right operand of the product.
+	* @param beta Scalar value by which this matrix is scaled before the product is accumulated.
+	*/
+	virtual void multiplyAccumulate(double alpha, const MatrixBase& left, const MatrixBase& right, double beta) override;
+	/**
 	* Checks if this matrix is equal to the argument matrix. Method implements Double Dispatch. This particular method just calls the equal method on the argument to activate polymorphism.
 	* @param right The other MatrixBase.
 	* @return True if equal, false if not equal.
@@ -224,12 +292,35 @@ public:
 	*/
 	virtual MatrixBase* multiply(const DenseMatrix& left) const override;
 	/**
-	* Performs matrix multiplication with the argument and returns the result. Method implements Double Dispatch. This particular method multiples the argument SparseMatrix by this SparseMatrix. No exception is thrown by std::map (probaby) if the dimensions don't match, but don't do it anyway. The method uses the same algorithm as DenseMatrix::multiply.
+	* Performs matrix multiplication with the argument and returns the result. Method implements Double Dispatch. This particular method multiples the argument SparseMatrix by this SparseMatrix. Don't do it if the dimensions don't match.
+	* The number of non-zero elements of the product is estimated first (see estimateProductNumNonZeros), and the result is allocated directly in the cheaper format. The product itself is computed row by row (Gustavson's algorithm).
 	* @param left The other SparseMatrix. This is meant to be called by the more generic multiply method.
-	* @return A raw pointer to MatrixBase instance. Both of the matrices are SparseMatrix, so it will return a SparseMatrix.
+	* @return A raw pointer to MatrixBase instance. It is a SparseMatrix, unless the product is expected to be dense enough for DenseMatrix to be cheaper.
+	* @see MatrixCostModel::isDenseCheaper()
 	*/
 	virtual MatrixBase* multiply(const SparseMatrix& left) const override;
 	/**
+	* Calculates (left * transpose(right)) without transposing right: every non-zero cell (j, k) of right scales the column k of left, which is added to the column j of the product. The rows of left and of the product are traversed first, so they are accessed contiguously.
+	* @param left The left operand. Its number of columns must match the number of columns of right.
+	* @param right The right operand, which is multiplied as if it were transposed.
+	* @return A raw pointer to a new DenseMatrix instance.
+	*/
+	static DenseMatrix* multiplyTransposedRight(const DenseMatrix& left, const SparseMatrix& right);
+	/**
+	* Calculates (transpose(left) * right) without transposing left: every non-zero cell (k, i) of left scales the row k of right, which is added to the row i of the product, so the rows are accessed contiguously.
+	* @param left The left operand, which is multiplied as if it were transposed. Its number of rows must match the number of rows of right.
+	* @param right The right operand.
+	* @return A raw pointer to a new DenseMatrix instance.
+	*/
+	static DenseMatrix* multiplyTransposedLeft(const SparseMatrix& left, const DenseMatrix& right);
+	/**
+	* Estimates the number of non-zero elements of the product (left * this) with a symbolic pass, which only looks at the positions of the non-zero elements (no floating point operations, no allocations per element).
+	* The estimate is exact (ignoring numerical cancellation) if the left matrix has at most 1024 rows. Otherwise, only every n-th row is counted (about 256 rows), and the count is scaled up.
+	* @param left The left operand of the product.
+	* @return The estimated number of non-zero elements of the product.
+	*/
+	size_t estimateProductNumNonZeros(const SparseMatrix& left) const;
+	/**
 	* Merges this and the argument matrix by columns and returns the result. Method implements Double Disptch. This particular method just calls the mergeByColumns method on the argument to activate polymorphism. std::vector may throw an exception (if at least one of the matrices is DenseMatrix) if the dimensions don't match.
 	* @param right The other MatrixBase.
 	* @return A raw pointer to MatrixBase instance. The result is SparseMatrix if and only if both of the matrices are of type SparseMatrix.
@@ -370,7 +461,7 @@ private:
 	/**
 	* The underlying implementation of SparseMatrix. An std::map of std::pair for row & column coordinates of the cells; and a double as value of the cell.
 	*/
-	std::map<std::pair<size_t, size_t>, double> sparseMatrix;
+	CellStorage sparseMatrix;
 	/**
 	* The number of rows of this matrix.
 	*/
@@ -385,6 +476,25 @@ private:
 	* @return An "alignment map". The first size_t is the index of the column; the second size_t is the maximum digit size for each column. The negative sign adds 1 to the "digit count" as well.
 	*/
 	std::map<size_t, size_t> getColumnAlignmentMapForPrinting() const;
+	/**
+	* Returns the iterators where each row begins. The elements of row r are in the range [rowBegins[r], rowBegins[r + 1]), so the returned vector has (numRows + 1) iterators.
+	*/
+	std::vector<NonZeroIterator> getRowBeginIterators() const;
+	/**
+	* Copies the elements of this matrix, except those of the given row and column, into a sub-matrix (the sub-matrix of a cofactor).
+	* @param excludedRow The index of the row which is left out.
+	* @param excludedColumn The index of the column which is left out.
+	* @param out_subMatrix A pointer to the empty ((numRows - 1) x (numColumns - 1)) SparseMatrix to which the elements are meant to be copied.
+	*/
+	void copyCofactorSubMatrix(size_t excludedRow, size_t excludedColumn, SparseMatrix* out_subMatrix) const;
+	/**
+	* Counts the non-zero elements of the product (left * right) symbolically. Every sampleStep-th row of the left matrix is counted, and the count is scaled up accordingly.
+	* @param leftRowBegins The row begin iterators of the left matrix.
+	* @param rightRowBegins The row begin iterators of the right matrix.
+	* @param rightNumColumns The number of columns of the right matrix.
+	* @param sampleStep Counts every sampleStep-th row. 1 means every row (exact count).
+	*/
+	static size_t countProductNonZeros(const std::vector<NonZeroIterator>& leftRowBegins, const std::vector<NonZeroIterator>& rightRowBegins, size_t rightNumColumns, size_t sampleStep);
 };
 
 #endif // SPARSE_MATRIX_H
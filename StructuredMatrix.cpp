@@ -0,0 +1,418 @@
+#include "StructuredMatrix.h"
+#include "DenseMatrix.h"
+#include "SparseMatrix.h"
+#include "MatrixCostModel.h"
+
+// Public members
+
+MatrixBase* StructuredMatrix::multiplyByRight(const MatrixBase& right) const
+{
+	MatrixBase* general = toGeneral();
+	MatrixBase* product = general->multiply(right);
+	delete general;
+
+	return product;
+}
+
+MatrixBase* StructuredMatrix::multiplyByLeft(const MatrixBase& left) const
+{
+	MatrixBase* general = toGeneral();
+	MatrixBase* product = left.multiply(*general);
+	delete general;
+
+	return product;
+}
+
+MatrixBase* StructuredMatrix::toGeneral() const
+{
+	if (MatrixCostModel::getInstance().isDenseCheaper(getNumRows(), getNumColumns(), getNumNonZeros()))
+	{
+		return cloneAsDenseMatrix();
+	}
+
+	return cloneAsSparseMatrix();
+}
+
+void StructuredMatrix::resizeNumRows(size_t newNumRows)
+{
+	(void)newNumRows; // See Matrix::resizeNumRows.
+}
+
+void StructuredMatrix::resizeNumColumns(size_t newNumColumns)
+{
+	(void)newNumColumns; // See Matrix::resizeNumColumns.
+}
+
+void StructuredMatrix::resize(size_t newNumRows, size_t newNumColumns)
+{
+	(void)newNumRows; // See Matrix::resize.
+	(void)newNumColumns;
+}
+
+double StructuredMatrix::getSparsity() const
+{
+	return 1.0 - getDensity();
+}
+
+double StructuredMatrix::getDensity() const
+{
+	double numCells = (double)getNumRows() * (double)getNumColumns();
+
+	return (double)getNumNonZeros() / numCells;
+}
+
+bool StructuredMatrix::isSparse() const
+{
+	return getSparsity() > SparsityThreshold;
+}
+
+bool StructuredMatrix::isDense() const
+{
+	return !isSparse();
+}
+
+bool StructuredMatrix::requiresConversion() const
+{
+	return false;
+}
+
+MatrixBase* StructuredMatrix::getConvertedCopy() const
+{
+	return clone();
+}
+
+DenseMatrix* StructuredMatrix::cloneAsDenseMatrix() const
+{
+	DenseMatrix* denseClone = new DenseMatrix(getNumRows(), getNumColumns(), 0.0);
+
+	forEachNonZero([&](size_t row, size_t column, double value)
+	{
+		denseClone->setCell(row, column, value);
+	});
+
+	return denseClone;
+}
+
+SparseMatrix* StructuredMatrix::cloneAsSparseMatrix() const
+{
+	SparseMatrix* sparseClone = new SparseMatrix(getNumRows(), getNumColumns());
+
+	forEachNonZero([&](size_t row, size_t column, double value)
+	{
+		sparseClone->setCell(row, column, value);
+	});
+
+	return sparseClone;
+}
+
+void StructuredMatrix::addInPlace(const MatrixBase& right, double alpha)
+{
+	(void)right; // See Matrix::axpy.
+	(void)alpha;
+}
+
+void StructuredMatrix::addScaledTo(DenseMatrix& target, double alpha) const
+{
+	forEachNonZero([&](size_t row, size_t column, double value)
+	{
+		target.setCell(row, column, target.getCell(row, column) + alpha * value);
+	});
+}
+
+void StructuredMatrix::addScaledTo(SparseMatrix& target, double alpha) const
+{
+	forEachNonZero([&](size_t row, size_t column, double value)
+	{
+		target.setCell(row, column, target.getCell(row, column) + alpha * value);
+	});
+}
+
+void StructuredMatrix::multiplyAccumulate(double alpha, const MatrixBase& left, const MatrixBase& right, double beta)
+{
+	(void)alpha; // See Matrix::gemm.
+	(void)left;
+	(void)right;
+	(void)beta;
+}
+
+bool StructuredMatrix::equal(const MatrixBase& right) const
+{
+	MatrixBase* general = toGeneral();
+	bool isEqual = general->equal(right);
+	delete general;
+
+	return isEqual;
+}
+
+bool StructuredMatrix::equal(const DenseMatrix& left) const
+{
+	MatrixBase* general = toGeneral();
+	bool isEqual = left.equal(*general);
+	delete general;
+
+	return isEqual;
+}
+
+bool StructuredMatrix::equal(const SparseMatrix& left) const
+{
+	MatrixBase* general = toGeneral();
+	bool isEqual = left.equal(*general);
+	delete general;
+
+	return isEqual;
+}
+
+MatrixBase* StructuredMatrix::add(const MatrixBase& right) const
+{
+	MatrixBase* general = toGeneral();
+	MatrixBase* sum = general->add(right);
+	delete general;
+
+	return sum;
+}
+
+MatrixBase* StructuredMatrix::add(const DenseMatrix& left) const
+{
+	MatrixBase* general = toGeneral();
+	MatrixBase* sum = left.add(*general);
+	delete general;
+
+	return sum;
+}
+
+MatrixBase* StructuredMatrix::add(const SparseMatrix& left) const
+{
+	MatrixBase* general = toGeneral();
+	MatrixBase* sum = left.add(*general);
+	delete general;
+
+	return sum;
+}
+
+MatrixBase* StructuredMatrix::subtract(const MatrixBase& right) const
+{
+	MatrixBase* general = toGeneral();
+	MatrixBase* difference = general->subtract(right);
+	delete general;
+
+	return difference;
+}
+
+MatrixBase* StructuredMatrix::subtract(const DenseMatrix& left) const
+{
+	MatrixBase* general = toGeneral();
+	MatrixBase* difference = left.subtract(*general);
+	delete general;
+
+	return difference;
+}
+
+MatrixBase* StructuredMatrix::subtract(const SparseMatrix& left) const
+{
+	MatrixBase* general = toGeneral();
+	MatrixBase* difference = left.subtract(*general);
+	delete general;
+
+	return difference;
+}
+
+MatrixBase* StructuredMatrix::multiply(const MatrixBase& right) const
+{
+	return multiplyByRight(right);
+}
+
+MatrixBase* StructuredMatrix::multiply(const DenseMatrix& left) const
+{
+	return multiplyByLeft(left);
+}
+
+MatrixBase* StructuredMatrix::multiply(const SparseMatrix& left) const
+{
+	return multiplyByLeft(left);
+}
+
+MatrixBase* StructuredMatrix::mergeByColumns(const MatrixBase& right) const
+{
+	MatrixBase* general = toGeneral();
+	MatrixBase* merged = general->mergeByColumns(right);
+	delete general;
+
+	return merged;
+}
+
+MatrixBase* StructuredMatrix::mergeByColumns(const DenseMatrix& left) const
+{
+	MatrixBase* general = toGeneral();
+	MatrixBase* merged = left.mergeByColumns(*general);
+	delete general;
+
+	return merged;
+}
+
+MatrixBase* StructuredMatrix::mergeByColumns(const SparseMatrix& left) const
+{
+	MatrixBase* general = toGeneral();
+	MatrixBase* merged = left.mergeByColumns(*general);
+	delete general;
+
+	return merged;
+}
+
+MatrixBase* StructuredMatrix::mergeByRows(const MatrixBase& right) const
+{
+	MatrixBase* general = toGeneral();
+	MatrixBase* merged = general->mergeByRows(right);
+	delete general;
+
+	return merged;
+}
+
+MatrixBase* StructuredMatrix::mergeByRows(const DenseMatrix& left) const
+{
+	MatrixBase* general = toGeneral();
+	MatrixBase* merged = left.mergeByRows(*general);
+	delete general;
+
+	return merged;
+}
+
+MatrixBase* StructuredMatrix::mergeByRows(const SparseMatrix& left) const
+{
+	MatrixBase* general = toGeneral();
+	MatrixBase* merged = left.mergeByRows(*general);
+	delete general;
+
+	return merged;
+}
+
+MatrixBase* StructuredMatrix::splitByColumn(size_t leftNewNumColumns, bool returnLeftMatrix) const
+{
+	MatrixBase* general = toGeneral();
+	MatrixBase* split = general->splitByColumn(leftNewNumColumns, returnLeftMatrix);
+	delete general;
+
+	return split;
+}
+
+MatrixBase* StructuredMatrix::splitByRow(size_t topNewNumRows, bool returnTopMatrix) const
+{
+	MatrixBase* general = toGeneral();
+	MatrixBase* split = general->splitByRow(topNewNumRows, returnTopMatrix);
+	delete general;
+
+	return split;
+}
+
+MatrixBase* StructuredMatrix::getSubMatrix(size_t subRowBeginIndex, size_t subNumRows, size_t subColumnBeginIndex, size_t subNumColumns) const
+{
+	MatrixBase* general = toGeneral();
+	MatrixBase* subMatrix = general->getSubMatrix(subRowBeginIndex, subNumRows, subColumnBeginIndex, subNumColumns);
+	delete general;
+
+	return subMatrix;
+}
+
+MatrixBase* StructuredMatrix::getSubMatrix(size_t ignoredRowIndex, size_t ignoredColumnIndex) const
+{
+	MatrixBase* general = toGeneral();
+	MatrixBase* subMatrix = general->getSubMatrix(ignoredRowIndex, ignoredColumnIndex);
+	delete general;
+
+	return subMatrix;
+}
+
+MatrixBase* StructuredMatrix::getSubMatrixTopLeft(size_t ignoredRowIndex, size_t ignoredColumnIndex) const
+{
+	MatrixBase* general = toGeneral();
+	MatrixBase* subMatrix = general->getSubMatrixTopLeft(ignoredRowIndex, ignoredColumnIndex);
+	delete general;
+
+	return subMatrix;
+}
+
+MatrixBase* StructuredMatrix::getSubMatrixTopRight(size_t ignoredRowIndex, size_t ignoredColumnIndex) const
+{
+	MatrixBase* general = toGeneral();
+	MatrixBase* subMatrix = general->getSubMatrixTopRight(ignoredRowIndex, ignoredColumnIndex);
+	delete general;
+
+	return subMatrix;
+}
+
+MatrixBase* StructuredMatrix::getSubMatrixBottomLeft(size_t ignoredRowIndex, size_t ignoredColumnIndex) const
+{
+	MatrixBase* general = toGeneral();
+	MatrixBase* subMatrix = general->getSubMatrixBottomLeft(ignoredRowIndex, ignoredColumnIndex);
+	delete general;
+
+	return subMatrix;
+}
+
+MatrixBase* StructuredMatrix::getSubMatrixBottomRight(size_t ignoredRowIndex, size_t ignoredColumnIndex) const
+{
+	MatrixBase* general = toGeneral();
+	MatrixBase* subMatrix = general->getSubMatrixBottomRight(ignoredRowIndex, ignoredColumnIndex);
+	delete general;
+
+	return subMatrix;
+}
+
+double StructuredMatrix::getDeterminant() const
+{
+	MatrixBase* general = toGeneral();
+	double determinant = general->getDeterminant();
+	delete general;
+
+	return determinant;
+}
+
+MatrixBase* StructuredMatrix::getMinorMatrix() const
+{
+	MatrixBase* general = toGeneral();
+	MatrixBase* minorMatrix = general->getMinorMatrix();
+	delete general;
+
+	return minorMatrix;
+}
+
+void StructuredMatrix::applyCheckerboardPattern()
+{
+	// See Matrix::applyCheckerboardPattern.
+}
+
+MatrixBase* StructuredMatrix::getInverse(double determinant) const
+{
+	MatrixBase* general = toGeneral();
+	MatrixBase* inverse = general->getInverse(determinant);
+	delete general;
+
+	return inverse;
+}
+
+std::string StructuredMatrix::getPrintStr(size_t precision) const
+{
+	// Always printed like a SparseMatrix (which is what Matrix::createIdentity used to create), so that the output doesn't depend on the cost model.
+	SparseMatrix* general = cloneAsSparseMatrix();
+	std::string printStr = general->getPrintStr(precision);
+	delete general;
+
+	return printStr;
+}
+
+std::string StructuredMatrix::solveFor(const MatrixBase& augmentedColumn, bool verbose, size_t doublePrecision) const
+{
+	MatrixBase* general = toGeneral();
+	std::string solution = general->solveFor(augmentedColumn, verbose, doublePrecision);
+	delete general;
+
+	return solution;
+}
+
+size_t StructuredMatrix::getRank() const
+{
+	MatrixBase* general = toGeneral();
+	size_t rank = general->getRank();
+	delete general;
+
+	return rank;
+}
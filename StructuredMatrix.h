@@ -0,0 +1,230 @@
+#ifndef STRUCTURED_MATRIX_H
+#define STRUCTURED_MATRIX_H
+
+#include "MatrixBase.h"
+
+/**
+* Base class of the matrices whose zero pattern (or symmetry) is known by their type: DiagonalMatrix, IdentityMatrix, PermutationMatrix, TriangularMatrix and SymmetricMatrix.
+* A structured matrix only stores what its structure requires, and overrides the operations which its structure makes cheaper (e.g. a diagonal matrix scales rows instead of multiplying).
+* Every other operation is performed on a general copy (DenseMatrix or SparseMatrix, see toGeneral), so a structured matrix works everywhere a MatrixBase does.
+* Structured matrices take part in Double Dispatch like any other MatrixBase: as the left operand, their generic methods (e.g. multiply(const MatrixBase&)) are called first; as the right operand, the typed overloads (e.g. multiply(const DenseMatrix&)) are called by the left operand.
+* A structured matrix can't change its type, so the in-place operations which would break the structure (see MatrixBase::canSetCell and MatrixBase::canScale) are left to the Matrix wrapper, which replaces it with a general copy first.
+*/
+class StructuredMatrix : public MatrixBase
+{
+public:
+	/**
+	* Calculates (this * right). The default implementation multiplies a general copy of this matrix.
+	* @param right The right operand.
+	* @return A raw pointer to MatrixBase instance.
+	*/
+	virtual MatrixBase* multiplyByRight(const MatrixBase& right) const;
+	/**
+	* Calculates (left * this). The default implementation multiplies by a general copy of this matrix.
+	* @param left The left operand.
+	* @return A raw pointer to MatrixBase instance.
+	*/
+	virtual MatrixBase* multiplyByLeft(const MatrixBase& left) const;
+	/**
+	* Returns a general copy of this matrix: a DenseMatrix or a SparseMatrix, whichever is cheaper according to the cost model.
+	* @see MatrixCostModel::isDenseCheaper()
+	* @return A raw pointer to MatrixBase instance.
+	*/
+	MatrixBase* toGeneral() const;
+
+	/**
+	* Does nothing. A structured matrix can't be resized; Matrix replaces it with a general copy first.
+	*/
+	virtual void resizeNumRows(size_t newNumRows) override;
+	/**
+	* Does nothing. A structured matrix can't be resized; Matrix replaces it with a general copy first.
+	*/
+	virtual void resizeNumColumns(size_t newNumColumns) override;
+	/**
+	* Does nothing. A structured matrix can't be resized; Matrix replaces it with a general copy first.
+	*/
+	virtual void resize(size_t newNumRows, size_t newNumColumns) override;
+	/**
+	* Gets the Sparsity value of the matrix. Sparsity is the ratio of numZeroElements/numTotalElements.
+	*/
+	virtual double getSparsity() const override;
+	/**
+	* Gets the Density value of the matrix. Density is the ratio of numNonZeroElements/numTotalElements.
+	*/
+	virtual double getDensity() const override;
+	/**
+	* Checks if the matrix's Sparsity is greater than SparsityThreshold.
+	*/
+	virtual bool isSparse() const override;
+	/**
+	* Checks if the matrix's Density is greater than or equal to DensityThreshold.
+	*/
+	virtual bool isDense() const override;
+	/**
+	* Always false. The structured storage is never more expensive than the general one.
+	*/
+	virtual bool requiresConversion() const override;
+	/**
+	* Returns a copy of this matrix, since it never requires conversion.
+	* @return A raw pointer to MatrixBase instance.
+	*/
+	virtual MatrixBase* getConvertedCopy() const override;
+	/**
+	* Returns a DenseMatrix copy of this matrix.
+	*/
+	virtual DenseMatrix* cloneAsDenseMatrix() const override;
+	/**
+	* Returns a SparseMatrix copy of this matrix.
+	*/
+	virtual SparseMatrix* cloneAsSparseMatrix() const override;
+	/**
+	* Does nothing. A structured matrix can't hold an arbitrary sum; Matrix replaces it with a general copy first.
+	*/
+	virtual void addInPlace(const MatrixBase& right, double alpha) override;
+	/**
+	* Adds (alpha * this) to the target, one non-zero element at a time.
+	*/
+	virtual void addScaledTo(DenseMatrix& target, double alpha) const override;
+	/**
+	* Adds (alpha * this) to the target, one non-zero element at a time.
+	*/
+	virtual void addScaledTo(SparseMatrix& target, double alpha) const override;
+	/**
+	* Does nothing. A structured matrix can't hold an arbitrary product; Matrix replaces it with a general copy first.
+	*/
+	virtual void multiplyAccumulate(double alpha, const MatrixBase& left, const MatrixBase& right, double beta) override;
+	/**
+	* Checks the equality of this matrix with the argument (Double Dispatch), through a general copy of this matrix.
+	*/
+	virtual bool equal(const MatrixBase& right) const override;
+	/**
+	* Checks the equality of the argument with this matrix, through a general copy of this matrix.
+	*/
+	virtual bool equal(const DenseMatrix& left) const override;
+	/**
+	* Checks the equality of the argument with this matrix, through a general copy of this matrix.
+	*/
+	virtual bool equal(const SparseMatrix& left) const override;
+	/**
+	* Calculates (this + right), through a general copy of this matrix.
+	*/
+	virtual MatrixBase* add(const MatrixBase& right) const override;
+	/**
+	* Calculates (left + this), through a general copy of this matrix.
+	*/
+	virtual MatrixBase* add(const DenseMatrix& left) const override;
+	/**
+	* Calculates (left + this), through a general copy of this matrix.
+	*/
+	virtual MatrixBase* add(const SparseMatrix& left) const override;
+	/**
+	* Calculates (this - right), through a general copy of this matrix.
+	*/
+	virtual MatrixBase* subtract(const MatrixBase& right) const override;
+	/**
+	* Calculates (left - this), through a general copy of this matrix.
+	*/
+	virtual MatrixBase* subtract(const DenseMatrix& left) const override;
+	/**
+	* Calculates (left - this), through a general copy of this matrix.
+	*/
+	virtual MatrixBase* subtract(const SparseMatrix& left) const override;
+	/**
+	* Calculates (this * right) with the kernel of this structure (see multiplyByRight).
+	*/
+	virtual MatrixBase* multiply(const MatrixBase& right) const override;
+	/**
+	* Calculates (left * this) with the kernel of this structure (see multiplyByLeft).
+	*/
+	virtual MatrixBase* multiply(const DenseMatrix& left) const override;
+	/**
+	* Calculates (left * this) with the kernel of this structure (see multiplyByLeft).
+	*/
+	virtual MatrixBase* multiply(const SparseMatrix& left) const override;
+	/**
+	* Merges this matrix and the argument by columns, through a general copy of this matrix.
+	*/
+	virtual MatrixBase* mergeByColumns(const MatrixBase& right) const override;
+	/**
+	* Merges the argument and this matrix by columns, through a general copy of this matrix.
+	*/
+	virtual MatrixBase* mergeByColumns(const DenseMatrix& left) const override;
+	/**
+	* Merges the argument and this matrix by columns, through a general copy of this matrix.
+	*/
+	virtual MatrixBase* mergeByColumns(const SparseMatrix& left) const override;
+	/**
+	* Merges this matrix and the argument by rows, through a general copy of this matrix.
+	*/
+	virtual MatrixBase* mergeByRows(const MatrixBase& right) const override;
+	/**
+	* Merges the argument and this matrix by rows, through a general copy of this matrix.
+	*/
+	virtual MatrixBase* mergeByRows(const DenseMatrix& left) const override;
+	/**
+	* Merges the argument and this matrix by rows, through a general copy of this matrix.
+	*/
+	virtual MatrixBase* mergeByRows(const SparseMatrix& left) const override;
+	/**
+	* Splits a general copy of this matrix by columns.
+	*/
+	virtual MatrixBase* splitByColumn(size_t leftNewNumColumns, bool returnLeftMatrix) const override;
+	/**
+	* Splits a general copy of this matrix by rows.
+	*/
+	virtual MatrixBase* splitByRow(size_t topNewNumRows, bool returnTopMatrix) const override;
+	/**
+	* Returns a submatrix of a general copy of this matrix.
+	*/
+	virtual MatrixBase* getSubMatrix(size_t subRowBeginIndex, size_t subNumRows, size_t subColumnBeginIndex, size_t subNumColumns) const override;
+	/**
+	* Returns a submatrix of a general copy of this matrix.
+	*/
+	virtual MatrixBase* getSubMatrix(size_t ignoredRowIndex, size_t ignoredColumnIndex) const override;
+	/**
+	* Returns the top left part of a general copy of this matrix.
+	*/
+	virtual MatrixBase* getSubMatrixTopLeft(size_t ignoredRowIndex, size_t ignoredColumnIndex) const override;
+	/**
+	* Returns the top right part of a general copy of this matrix.
+	*/
+	virtual MatrixBase* getSubMatrixTopRight(size_t ignoredRowIndex, size_t ignoredColumnIndex) const override;
+	/**
+	* Returns the bottom left part of a general copy of this matrix.
+	*/
+	virtual MatrixBase* getSubMatrixBottomLeft(size_t ignoredRowIndex, size_t ignoredColumnIndex) const override;
+	/**
+	* Returns the bottom right part of a general copy of this matrix.
+	*/
+	virtual MatrixBase* getSubMatrixBottomRight(size_t ignoredRowIndex, size_t ignoredColumnIndex) const override;
+	/**
+	* Calculates the determinant of a general copy of this matrix.
+	*/
+	virtual double getDeterminant() const override;
+	/**
+	* Returns the matrix of minors of a general copy of this matrix.
+	*/
+	virtual MatrixBase* getMinorMatrix() const override;
+	/**
+	* Does nothing. The checkerboard pattern breaks every structure; Matrix replaces it with a general copy first.
+	*/
+	virtual void applyCheckerboardPattern() override;
+	/**
+	* Returns the inverse of a general copy of this matrix.
+	*/
+	virtual MatrixBase* getInverse(double determinant) const override;
+	/**
+	* Prepares the output string of a general copy of this matrix, so that it looks exactly the same.
+	*/
+	virtual std::string getPrintStr(size_t precision) const override;
+	/**
+	* Solves the system with a general copy of this matrix.
+	*/
+	virtual std::string solveFor(const MatrixBase& augmentedColumn, bool verbose, size_t doublePrecision) const override;
+	/**
+	* Calculates the rank of a general copy of this matrix.
+	*/
+	virtual size_t getRank() const override;
+};
+
+#endif // STRUCTURED_MATRIX_H
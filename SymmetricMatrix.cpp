@@ -0,0 +1,150 @@
+#include "SymmetricMatrix.h"
+#include "DenseMatrix.h"
+#include "MatCalcUtil.h"
+#include <algorithm>
+
+// Public members
+
+SymmetricMatrix::SymmetricMatrix(size_t numDimensions)
+{
+	this->numDimensions = numDimensions;
+
+	packedCells.assign(numDimensions * (numDimensions + 1) / 2, 0.0);
+}
+
+size_t SymmetricMatrix::getNumRows() const
+{
+	return numDimensions;
+}
+
+size_t SymmetricMatrix::getNumColumns() const
+{
+	return numDimensions;
+}
+
+double SymmetricMatrix::getCell(size_t row, size_t column) const
+{
+	return packedCells[getPackedIndex(row, column)];
+}
+
+void SymmetricMatrix::setCell(size_t row, size_t column, double value)
+{
+	packedCells[getPackedIndex(row, column)] = value;
+}
+
+bool SymmetricMatrix::canSetCell(size_t row, size_t column, double value) const
+{
+	return row == column || value == getCell(column, row);
+}
+
+void SymmetricMatrix::transpose()
+{
+	// A symmetric matrix is its own transpose.
+}
+
+size_t SymmetricMatrix::getNumNonZeros() const
+{
+	size_t numNonZeros = 0;
+
+	for (size_t r = 0; r < numDimensions; r++)
+	{
+		for (size_t c = r; c < numDimensions; c++)
+		{
+			if (mcu::doubleAlmostEqual(packedCells[getPackedIndex(r, c)], 0.0) == false)
+			{
+				numNonZeros += (r == c) ? 1 : 2;
+			}
+		}
+	}
+
+	return numNonZeros;
+}
+
+MatrixBase* SymmetricMatrix::clone() const
+{
+	return new SymmetricMatrix(*this);
+}
+
+void SymmetricMatrix::forEachNonZero(const std::function<void(size_t row, size_t column, double value)>& visitor) const
+{
+	for (size_t r = 0; r < numDimensions; r++)
+	{
+		for (size_t c = 0; c < numDimensions; c++)
+		{
+			double value = packedCells[getPackedIndex(r, c)];
+
+			if (mcu::doubleAlmostEqual(value, 0.0) == false)
+			{
+				visitor(r, c, value);
+			}
+		}
+	}
+}
+
+void SymmetricMatrix::scale(double scalar)
+{
+	for (size_t i = 0; i < packedCells.size(); i++)
+	{
+		packedCells[i] *= scalar;
+	}
+}
+
+MatrixBase* SymmetricMatrix::multiplyByRight(const MatrixBase& right) const
+{
+	const DenseMatrix* denseRight = dynamic_cast<const DenseMatrix*>(&right);
+
+	if (denseRight == nullptr)
+	{
+		return StructuredMatrix::multiplyByRight(right);
+	}
+
+	size_t rightNumColumns = right.getNumColumns();
+	DenseMatrix* product = new DenseMatrix(numDimensions, rightNumColumns, 0.0);
+
+	// Every stored element a(r, k) with r < k contributes twice: a(r, k) * right(k, :) to row r, and a(k, r) * right(r, :) to row k.
+	for (size_t r = 0; r < numDimensions; r++)
+	{
+		const double* packedRow = packedCells.data() + getPackedIndex(r, r);
+		const double* rightRow = denseRight->getRowData(r);
+		double* productRow = product->getRowData(r);
+
+		for (size_t c = 0; c < rightNumColumns; c++)
+		{
+			productRow[c] += packedRow[0] * rightRow[c];
+		}
+
+		for (size_t k = r + 1; k < numDimensions; k++)
+		{
+			double coefficient = packedRow[k - r];
+
+			if (coefficient == 0.0)
+			{
+				continue;
+			}
+
+			const double* rightRowK = denseRight->getRowData(k);
+			double* productRowK = product->getRowData(k);
+
+			for (size_t c = 0; c < rightNumColumns; c++)
+			{
+				productRow[c] += coefficient * rightRowK[c];
+				productRowK[c] += coefficient * rightRow[c];
+			}
+		}
+	}
+
+	return product;
+}
+
+// Private members
+
+size_t SymmetricMatrix::getPackedIndex(size_t row, size_t column) const
+{
+	if (column < row)
+	{
+		std::swap(row, column);
+	}
+
+	// Row r starts after the (n + (n - 1) + ... + (n - r + 1)) elements of the rows above, with its diagonal element.
+	return row * numDimensions - row * (row - 1) / 2 + (column - row);
+}
@@ -0,0 +1,95 @@
+#ifndef SYMMETRIC_MATRIX_H
+#define SYMMETRIC_MATRIX_H
+
+#include "StructuredMatrix.h"
+#include <vector>
+
+/**
+* A square matrix which is equal to its transpose. Only the upper triangle (with the diagonal) is stored, packed row by row (n * (n + 1) / 2 elements).
+* Setting a cell also sets its mirror cell, so the matrix stays symmetric (see Matrix::setSymmetricCell).
+*/
+class SymmetricMatrix : public StructuredMatrix
+{
+public:
+	/**
+	* The type of the underlying storage. Its memory is served by MatrixMemory.
+	*/
+	typedef std::vector<double, MatrixStorageAllocator<double>> CellStorage;
+
+	/**
+	* Creates a zero symmetric matrix.
+	* @param numDimensions The number of rows (and columns) of the matrix.
+	*/
+	SymmetricMatrix(size_t numDimensions);
+	/**
+	* Returns the number of rows of this matrix.
+	*/
+	virtual size_t getNumRows() const override;
+	/**
+	* Returns the number of columns of this matrix.
+	*/
+	virtual size_t getNumColumns() const override;
+	/**
+	* Returns the double value at a given cell. Indices start from zero.
+	* @param row Row index of the matrix.
+	* @param column Column index of the matrix.
+	*/
+	virtual double getCell(size_t row, size_t column) const override;
+	/**
+	* Sets a cell and its mirror cell (column, row) to the given value.
+	* @param row Row index of the matrix.
+	* @param column Column index of the matrix.
+	* @param value The value to be set in the cells.
+	*/
+	virtual void setCell(size_t row, size_t column, double value) override;
+	/**
+	* Checks whether or not a cell can be set without changing another cell: only a diagonal cell, or a cell whose mirror cell already holds the value.
+	* Any other value would also change the mirror cell (see setCell), so the Matrix wrapper turns this matrix into a general matrix first.
+	* @param row Row index of the matrix.
+	* @param column Column index of the matrix.
+	* @param value The value to be set in the cell.
+	*/
+	virtual bool canSetCell(size_t row, size_t column, double value) const override;
+	/**
+	* Does nothing. A symmetric matrix is its own transpose.
+	*/
+	virtual void transpose() override;
+	/**
+	* Returns the number of non-zero elements, counting both of the mirror cells.
+	*/
+	virtual size_t getNumNonZeros() const override;
+	/**
+	* Creates a deep copy of this matrix.
+	* @return A raw pointer to MatrixBase instance.
+	*/
+	virtual MatrixBase* clone() const override;
+	/**
+	* Calls the visitor for every non-zero element (both of the mirror cells), in row-major order.
+	*/
+	virtual void forEachNonZero(const std::function<void(size_t row, size_t column, double value)>& visitor) const override;
+	/**
+	* Scales every element of the matrix.
+	*/
+	virtual void scale(double scalar) override;
+	/**
+	* Calculates (this * right). When right is a DenseMatrix, the product is calculated from the packed upper triangle directly.
+	*/
+	virtual MatrixBase* multiplyByRight(const MatrixBase& right) const override;
+
+private:
+	/**
+	* The number of rows (and columns) of the matrix.
+	*/
+	size_t numDimensions;
+	/**
+	* The elements of the upper triangle (with the diagonal), packed row by row.
+	*/
+	CellStorage packedCells;
+
+	/**
+	* Returns the index of a cell in packedCells. The cells below the diagonal are mapped to their mirror cells.
+	*/
+	size_t getPackedIndex(size_t row, size_t column) const;
+};
+
+#endif // SYMMETRIC_MATRIX_H
@@ -0,0 +1,997 @@
+#include "TiledMatrix.h"
+#include "DenseMatrix.h"
+#include "SparseMatrix.h"
+#include "MatCalcUtil.h"
+#include "NonZeroVisitor.h"
+#include "MatrixCostModel.h"
+#include <algorithm>
+
+// Public members
+
+TiledMatrix::TiledMatrix(size_t numRows, size_t numColumns, size_t tileSize)
+{
+	this->numRows = numRows;
+	this->numColumns = numColumns;
+	this->tileSize = (tileSize != 0) ? tileSize : DefaultTileSize;
+
+	numTileRows = (numRows + this->tileSize - 1) / this->tileSize;
+	numTileColumns = (numColumns + this->tileSize - 1) / this->tileSize;
+
+	tiles.assign(numTileRows * numTileColumns, nullptr);
+}
+
+TiledMatrix::TiledMatrix(const TiledMatrix& other)
+	: MatrixBase(other)
+{
+	numRows = other.numRows;
+	numColumns = other.numColumns;
+	tileSize = other.tileSize;
+	numTileRows = other.numTileRows;
+	numTileColumns = other.numTileColumns;
+
+	tiles.assign(other.tiles.size(), nullptr);
+
+	for (size_t i = 0; i < tiles.size(); i++)
+	{
+		if (other.tiles[i] != nullptr)
+		{
+			tiles[i] = other.tiles[i]->clone();
+		}
+	}
+}
+
+TiledMatrix::~TiledMatrix()
+{
+	clearTiles();
+}
+
+TiledMatrix* TiledMatrix::fromMatrix(const MatrixBase& source, size_t tileSize)
+{
+	TiledMatrix* tiled = new TiledMatrix(source.getNumRows(), source.getNumColumns(), tileSize);
+	const DenseMatrix* denseSource = dynamic_cast<const DenseMatrix*>(&source);
+
+	if (denseSource != nullptr)
+	{
+		// Copy each tile from a view over the source, without initializing it first.
+		for (size_t tileRow = 0; tileRow < tiled->numTileRows; tileRow++)
+		{
+			for (size_t tileColumn = 0; tileColumn < tiled->numTileColumns; tileColumn++)
+			{
+				size_t rowBegin = tileRow * tiled->tileSize;
+				size_t columnBegin = tileColumn * tiled->tileSize;
+				size_t tileNumRows = tiled->getTileNumRows(tileRow);
+				size_t tileNumColumns = tiled->getTileNumColumns(tileColumn);
+
+				DenseMatrix* tile = DenseMatrix::createUninitialized(tileNumRows, tileNumColumns);
+				denseSource->getSubView(rowBegin, tileNumRows, columnBegin, tileNumColumns).copyTo(tile->getRowData(0), tileNumColumns);
+
+				tiled->getTileRef(tileRow, tileColumn) = tile;
+			}
+		}
+	}
+	else
+	{
+		mcu::visitNonZeros(source, [&](size_t row, size_t column, double value)
+		{
+			tiled->setCell(row, column, value);
+		});
+	}
+
+	tiled->updateTileStorage();
+
+	return tiled;
+}
+
+size_t TiledMatrix::getTileSize() const
+{
+	return tileSize;
+}
+
+size_t TiledMatrix::getNumTileRows() const
+{
+	return numTileRows;
+}
+
+size_t TiledMatrix::getNumTileColumns() const
+{
+	return numTileColumns;
+}
+
+TiledMatrix::TileStorage TiledMatrix::getTileStorage(size_t tileRow, size_t tileColumn) const
+{
+	const MatrixBase* tile = getTile(tileRow, tileColumn);
+
+	if (tile == nullptr)
+	{
+		return TileStorage::Zero;
+	}
+
+	return (dynamic_cast<const DenseMatrix*>(tile) != nullptr) ? TileStorage::Dense : TileStorage::Sparse;
+}
+
+void TiledMatrix::updateTileStorage()
+{
+	for (size_t i = 0; i < tiles.size(); i++)
+	{
+		MatrixBase*& tile = tiles[i];
+
+		if (tile == nullptr)
+		{
+			continue;
+		}
+
+		if (tile->getNumNonZeros() == 0)
+		{
+			delete tile;
+			tile = nullptr;
+		}
+		else if (tile->requiresConversion())
+		{
+			MatrixBase* converted = tile->getConvertedCopy();
+			delete tile;
+			tile = converted;
+		}
+	}
+}
+
+// Inherited via MatrixBase
+size_t TiledMatrix::getNumRows() const
+{
+	return numRows;
+}
+
+size_t TiledMatrix::getNumColumns() const
+{
+	return numColumns;
+}
+
+double TiledMatrix::getCell(size_t row, size_t column) const
+{
+	const MatrixBase* tile = getTile(row / tileSize, column / tileSize);
+
+	return (tile != nullptr) ? tile->getCell(row % tileSize, column % tileSize) : 0.0;
+}
+
+void TiledMatrix::setCell(size_t row, size_t column, double value)
+{
+	size_t tileRow = row / tileSize;
+	size_t tileColumn = column / tileSize;
+	MatrixBase*& tile = getTileRef(tileRow, tileColumn);
+
+	if (tile == nullptr)
+	{
+		if (mcu::doubleAlmostEqual(value, 0.0))
+		{
+			return; // Still an all-zero tile.
+		}
+
+		tile = new SparseMatrix(getTileNumRows(tileRow), getTileNumColumns(tileColumn));
+	}
+
+	tile->setCell(row % tileSize, column % tileSize, value);
+}
+
+void TiledMatrix::resizeNumRows(size_t newNumRows)
+{
+	resize(newNumRows, numColumns);
+}
+
+void TiledMatrix::resizeNumColumns(size_t newNumColumns)
+{
+	resize(numRows, newNumColumns);
+}
+
+void TiledMatrix::resize(size_t newNumRows, size_t newNumColumns)
+{
+	// The edge tiles change their dimensions, so the cells are moved into a new grid.
+	TiledMatrix resized(newNumRows, newNumColumns, tileSize);
+
+	forEachNonZero([&](size_t row, size_t column, double value)
+	{
+		if (row < newNumRows && column < newNumColumns)
+		{
+			resized.setCell(row, column, value);
+		}
+	});
+
+	resized.updateTileStorage();
+
+	std::swap(numRows, resized.numRows);
+	std::swap(numColumns, resized.numColumns);
+	std::swap(numTileRows, resized.numTileRows);
+	std::swap(numTileColumns, resized.numTileColumns);
+	tiles.swap(resized.tiles); // The old tiles are deleted by the destructor of resized.
+}
+
+void TiledMatrix::transpose()
+{
+	TileStorageGrid transposedTiles(tiles.size(), nullptr);
+
+	for (size_t tileRow = 0; tileRow < numTileRows; tileRow++)
+	{
+		for (size_t tileColumn = 0; tileColumn < numTileColumns; tileColumn++)
+		{
+			MatrixBase* tile = getTile(tileRow, tileColumn);
+
+			if (tile != nullptr)
+			{
+				tile->transpose();
+			}
+
+			transposedTiles[tileColumn * numTileRows + tileRow] = tile;
+		}
+	}
+
+	tiles.swap(transposedTiles);
+	std::swap(numRows, numColumns);
+	std::swap(numTileRows, numTileColumns);
+}
+
+double TiledMatrix::getSparsity() const
+{
+	return 1.0 - getDensity();
+}
+
+size_t TiledMatrix::getNumNonZeros() const
+{
+	size_t numNonZeros = 0;
+
+	for (size_t i = 0; i < tiles.size(); i++)
+	{
+		if (tiles[i] != nullptr)
+		{
+			numNonZeros += tiles[i]->getNumNonZeros();
+		}
+	}
+
+	return numNonZeros;
+}
+
+double TiledMatrix::getDensity() const
+{
+	double numCells = (double)numRows * (double)numColumns;
+
+	return (double)getNumNonZeros() / numCells;
+}
+
+bool TiledMatrix::isSparse() const
+{
+	return getSparsity() > SparsityThreshold;
+}
+
+bool TiledMatrix::isDense() const
+{
+	return !isSparse();
+}
+
+bool TiledMatrix::requiresConversion() const
+{
+	for (size_t i = 0; i < tiles.size(); i++)
+	{
+		if (tiles[i] != nullptr && (tiles[i]->getNumNonZeros() == 0 || tiles[i]->requiresConversion()))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+MatrixBase* TiledMatrix::getConvertedCopy() const
+{
+	TiledMatrix* converted = new TiledMatrix(*this);
+	converted->updateTileStorage();
+
+	return converted;
+}
+
+MatrixBase* TiledMatrix::clone() const
+{
+	return new TiledMatrix(*this);
+}
+
+DenseMatrix* TiledMatrix::cloneAsDenseMatrix() const
+{
+	DenseMatrix* denseClone = new DenseMatrix(numRows, numColumns, 0.0);
+	addScaledTo(*denseClone, 1.0);
+
+	return denseClone;
+}
+
+SparseMatrix* TiledMatrix::cloneAsSparseMatrix() const
+{
+	SparseMatrix* sparseClone = new SparseMatrix(numRows, numColumns);
+
+	forEachNonZero([&](size_t row, size_t column, double value)
+	{
+		sparseClone->setCell(row, column, value);
+	});
+
+	return sparseClone;
+}
+
+void TiledMatrix::forEachNonZero(const std::function<void(size_t row, size_t column, double value)>& visitor) const
+{
+	// Walk a row of tiles one row of cells at a time, so that the cells are visited in row-major order. A cursor is kept for every sparse tile of the row of tiles.
+	std::vector<SparseMatrix::NonZeroIterator> sparseCursors(numTileColumns);
+
+	for (size_t tileRow = 0; tileRow < numTileRows; tileRow++)
+	{
+		for (size_t tileColumn = 0; tileColumn < numTileColumns; tileColumn++)
+		{
+			const SparseMatrix* sparseTile = dynamic_cast<const SparseMatrix*>(getTile(tileRow, tileColumn));
+
+			if (sparseTile != nullptr)
+			{
+				sparseCursors[tileColumn] = sparseTile->nonZeroBegin();
+			}
+		}
+
+		size_t rowBegin = tileRow * tileSize;
+
+		for (size_t r = 0; r < getTileNumRows(tileRow); r++)
+		{
+			for (size_t tileColumn = 0; tileColumn < numTileColumns; tileColumn++)
+			{
+				const MatrixBase* tile = getTile(tileRow, tileColumn);
+
+				if (tile == nullptr)
+				{
+					continue;
+				}
+
+				size_t columnBegin = tileColumn * tileSize;
+				const DenseMatrix* denseTile = dynamic_cast<const DenseMatrix*>(tile);
+
+				if (denseTile != nullptr)
+				{
+					const double* tileRowData = denseTile->getRowData(r);
+
+					for (size_t c = 0; c < denseTile->getNumColumns(); c++)
+					{
+						if (mcu::doubleAlmostEqual(tileRowData[c], 0.0) == false)
+						{
+							visitor(rowBegin + r, columnBegin + c, tileRowData[c]);
+						}
+					}
+
+					continue;
+				}
+
+				const SparseMatrix* sparseTile = static_cast<const SparseMatrix*>(tile);
+				SparseMatrix::NonZeroIterator& cursor = sparseCursors[tileColumn];
+
+				while (cursor != sparseTile->nonZeroEnd() && (*cursor).first.first == r)
+				{
+					visitor(rowBegin + r, columnBegin + (*cursor).first.second, (*cursor).second);
+					++cursor;
+				}
+			}
+		}
+	}
+}
+
+void TiledMatrix::scale(double scalar)
+{
+	if (scalar == 0.0)
+	{
+		clearTiles();
+		return;
+	}
+
+	for (size_t i = 0; i < tiles.size(); i++)
+	{
+		if (tiles[i] != nullptr)
+		{
+			tiles[i]->scale(scalar);
+		}
+	}
+}
+
+void TiledMatrix::addInPlace(const MatrixBase& right, double alpha)
+{
+	const TiledMatrix* tiledRight = dynamic_cast<const TiledMatrix*>(&right);
+
+	if (tiledRight != nullptr && tiledRight->tileSize == tileSize)
+	{
+		// Same dimensions and tile size, so the grids line up.
+		for (size_t i = 0; i < tiles.size(); i++)
+		{
+			const MatrixBase* rightTile = tiledRight->tiles[i];
+
+			if (rightTile == nullptr)
+			{
+				continue;
+			}
+
+			if (tiles[i] == nullptr)
+			{
+				tiles[i] = rightTile->clone();
+				tiles[i]->scale(alpha);
+			}
+			else
+			{
+				tiles[i]->addInPlace(*rightTile, alpha);
+			}
+		}
+	}
+	else
+	{
+		mcu::visitNonZeros(right, [&](size_t row, size_t column, double value)
+		{
+			setCell(row, column, getCell(row, column) + alpha * value);
+		});
+	}
+
+	updateTileStorage();
+}
+
+void TiledMatrix::addScaledTo(DenseMatrix& target, double alpha) const
+{
+	for (size_t tileRow = 0; tileRow < numTileRows; tileRow++)
+	{
+		for (size_t tileColumn = 0; tileColumn < numTileColumns; tileColumn++)
+		{
+			const MatrixBase* tile = getTile(tileRow, tileColumn);
+
+			if (tile == nullptr)
+			{
+				continue;
+			}
+
+			size_t rowBegin = tileRow * tileSize;
+			size_t columnBegin = tileColumn * tileSize;
+			const DenseMatrix* denseTile = dynamic_cast<const DenseMatrix*>(tile);
+
+			if (denseTile != nullptr)
+			{
+				for (size_t r = 0; r < denseTile->getNumRows(); r++)
+				{
+					const double* tileRowData = denseTile->getRowData(r);
+					double* targetRowData = target.getRowData(rowBegin + r) + columnBegin;
+
+					for (size_t c = 0; c < denseTile->getNumColumns(); c++)
+					{
+						targetRowData[c] += alpha * tileRowData[c];
+					}
+				}
+
+				continue;
+			}
+
+			mcu::visitNonZeros(*tile, [&](size_t row, size_t column, double value)
+			{
+				target.getRowData(rowBegin + row)[columnBegin + column] += alpha * value;
+			});
+		}
+	}
+}
+
+void TiledMatrix::addScaledTo(SparseMatrix& target, double alpha) const
+{
+	forEachNonZero([&](size_t row, size_t column, double value)
+	{
+		target.setCell(row, column, target.getCell(row, column) + alpha * value);
+	});
+}
+
+void TiledMatrix::multiplyAccumulate(double alpha, const MatrixBase& left, const MatrixBase& right, double beta)
+{
+	// When beta is zero, the existing values are ignored, like BLAS does.
+	if (beta == 0.0)
+	{
+		clearTiles();
+	}
+	else if (beta != 1.0)
+	{
+		scale(beta);
+	}
+
+	TiledMatrix* ownedLeft = nullptr;
+	TiledMatrix* ownedRight = nullptr;
+	const TiledMatrix& tiledLeft = getTiledOperand(left, ownedLeft);
+	const TiledMatrix& tiledRight = getTiledOperand(right, ownedRight);
+
+	accumulateProduct(alpha, tiledLeft, tiledRight);
+	updateTileStorage();
+
+	delete ownedLeft;
+	delete ownedRight;
+}
+
+bool TiledMatrix::equal(const MatrixBase& right) const
+{
+	TiledMatrix* ownedRight = nullptr;
+	bool isEqual = equalTiled(*this, getTiledOperand(right, ownedRight));
+	delete ownedRight;
+
+	return isEqual;
+}
+
+bool TiledMatrix::equal(const DenseMatrix& left) const
+{
+	TiledMatrix* ownedLeft = nullptr;
+	bool isEqual = equalTiled(getTiledOperand(left, ownedLeft), *this);
+	delete ownedLeft;
+
+	return isEqual;
+}
+
+bool TiledMatrix::equal(const SparseMatrix& left) const
+{
+	TiledMatrix* ownedLeft = nullptr;
+	bool isEqual = equalTiled(getTiledOperand(left, ownedLeft), *this);
+	delete ownedLeft;
+
+	return isEqual;
+}
+
+MatrixBase* TiledMatrix::add(const MatrixBase& right) const
+{
+	TiledMatrix* ownedRight = nullptr;
+	MatrixBase* sum = addTiled(*this, getTiledOperand(right, ownedRight), 1.0);
+	delete ownedRight;
+
+	return sum;
+}
+
+MatrixBase* TiledMatrix::add(const DenseMatrix& left) const
+{
+	TiledMatrix* ownedLeft = nullptr;
+	MatrixBase* sum = addTiled(getTiledOperand(left, ownedLeft), *this, 1.0);
+	delete ownedLeft;
+
+	return sum;
+}
+
+MatrixBase* TiledMatrix::add(const SparseMatrix& left) const
+{
+	TiledMatrix* ownedLeft = nullptr;
+	MatrixBase* sum = addTiled(getTiledOperand(left, ownedLeft), *this, 1.0);
+	delete ownedLeft;
+
+	return sum;
+}
+
+MatrixBase* TiledMatrix::subtract(const MatrixBase& right) const
+{
+	TiledMatrix* ownedRight = nullptr;
+	MatrixBase* difference = addTiled(*this, getTiledOperand(right, ownedRight), -1.0);
+	delete ownedRight;
+
+	return difference;
+}
+
+MatrixBase* TiledMatrix::subtract(const DenseMatrix& left) const
+{
+	TiledMatrix* ownedLeft = nullptr;
+	MatrixBase* difference = addTiled(getTiledOperand(left, ownedLeft), *this, -1.0);
+	delete ownedLeft;
+
+	return difference;
+}
+
+MatrixBase* TiledMatrix::subtract(const SparseMatrix& left) const
+{
+	TiledMatrix* ownedLeft = nullptr;
+	MatrixBase* difference = addTiled(getTiledOperand(left, ownedLeft), *this, -1.0);
+	delete ownedLeft;
+
+	return difference;
+}
+
+MatrixBase* TiledMatrix::multiply(const MatrixBase& right) const
+{
+	TiledMatrix* ownedRight = nullptr;
+	MatrixBase* product = multiplyTiled(*this, getTiledOperand(right, ownedRight));
+	delete ownedRight;
+
+	return product;
+}
+
+MatrixBase* TiledMatrix::multiply(const DenseMatrix& left) const
+{
+	TiledMatrix* ownedLeft = nullptr;
+	MatrixBase* product = multiplyTiled(getTiledOperand(left, ownedLeft), *this);
+	delete ownedLeft;
+
+	return product;
+}
+
+MatrixBase* TiledMatrix::multiply(const SparseMatrix& left) const
+{
+	TiledMatrix* ownedLeft = nullptr;
+	MatrixBase* product = multiplyTiled(getTiledOperand(left, ownedLeft), *this);
+	delete ownedLeft;
+
+	return product;
+}
+
+MatrixBase* TiledMatrix::mergeByColumns(const MatrixBase& right) const
+{
+	MatrixBase* general = toGeneral();
+	MatrixBase* merged = general->mergeByColumns(right);
+	delete general;
+
+	return merged;
+}
+
+MatrixBase* TiledMatrix::mergeByColumns(const DenseMatrix& left) const
+{
+	MatrixBase* general = toGeneral();
+	MatrixBase* merged = left.mergeByColumns(*general);
+	delete general;
+
+	return merged;
+}
+
+MatrixBase* TiledMatrix::mergeByColumns(const SparseMatrix& left) const
+{
+	MatrixBase* general = toGeneral();
+	MatrixBase* merged = left.mergeByColumns(*general);
+	delete general;
+
+	return merged;
+}
+
+MatrixBase* TiledMatrix::mergeByRows(const MatrixBase& right) const
+{
+	MatrixBase* general = toGeneral();
+	MatrixBase* merged = general->mergeByRows(right);
+	delete general;
+
+	return merged;
+}
+
+MatrixBase* TiledMatrix::mergeByRows(const DenseMatrix& left) const
+{
+	MatrixBase* general = toGeneral();
+	MatrixBase* merged = left.mergeByRows(*general);
+	delete general;
+
+	return merged;
+}
+
+MatrixBase* TiledMatrix::mergeByRows(const SparseMatrix& left) const
+{
+	MatrixBase* general = toGeneral();
+	MatrixBase* merged = left.mergeByRows(*general);
+	delete general;
+
+	return merged;
+}
+
+MatrixBase* TiledMatrix::splitByColumn(size_t leftNewNumColumns, bool returnLeftMatrix) const
+{
+	MatrixBase* general = toGeneral();
+	MatrixBase* split = general->splitByColumn(leftNewNumColumns, returnLeftMatrix);
+	delete general;
+
+	return split;
+}
+
+MatrixBase* TiledMatrix::splitByRow(size_t topNewNumRows, bool returnTopMatrix) const
+{
+	MatrixBase* general = toGeneral();
+	MatrixBase* split = general->splitByRow(topNewNumRows, returnTopMatrix);
+	delete general;
+
+	return split;
+}
+
+MatrixBase* TiledMatrix::getSubMatrix(size_t subRowBeginIndex, size_t subNumRows, size_t subColumnBeginIndex, size_t subNumColumns) const
+{
+	MatrixBase* general = toGeneral();
+	MatrixBase* subMatrix = general->getSubMatrix(subRowBeginIndex, subNumRows, subColumnBeginIndex, subNumColumns);
+	delete general;
+
+	return subMatrix;
+}
+
+MatrixBase* TiledMatrix::getSubMatrix(size_t ignoredRowIndex, size_t ignoredColumnIndex) const
+{
+	MatrixBase* general = toGeneral();
+	MatrixBase* subMatrix = general->getSubMatrix(ignoredRowIndex, ignoredColumnIndex);
+	delete general;
+
+	return subMatrix;
+}
+
+MatrixBase* TiledMatrix::getSubMatrixTopLeft(size_t ignoredRowIndex, size_t ignoredColumnIndex) const
+{
+	MatrixBase* general = toGeneral();
+	MatrixBase* subMatrix = general->getSubMatrixTopLeft(ignoredRowIndex, ignoredColumnIndex);
+	delete general;
+
+	return subMatrix;
+}
+
+MatrixBase* TiledMatrix::getSubMatrixTopRight(size_t ignoredRowIndex, size_t ignoredColumnIndex) const
+{
+	MatrixBase* general = toGeneral();
+	MatrixBase* subMatrix = general->getSubMatrixTopRight(ignoredRowIndex, ignoredColumnIndex);
+	delete general;
+
+	return subMatrix;
+}
+
+MatrixBase* TiledMatrix::getSubMatrixBottomLeft(size_t ignoredRowIndex, size_t ignoredColumnIndex) const
+{
+	MatrixBase* general = toGeneral();
+	MatrixBase* subMatrix = general->getSubMatrixBottomLeft(ignoredRowIndex, ignoredColumnIndex);
+	delete general;
+
+	return subMatrix;
+}
+
+MatrixBase* TiledMatrix::getSubMatrixBottomRight(size_t ignoredRowIndex, size_t ignoredColumnIndex) const
+{
+	MatrixBase* general = toGeneral();
+	MatrixBase* subMatrix = general->getSubMatrixBottomRight(ignoredRowIndex, ignoredColumnIndex);
+	delete general;
+
+	return subMatrix;
+}
+
+double TiledMatrix::getDeterminant() const
+{
+	MatrixBase* general = toGeneral();
+	double determinant = general->getDeterminant();
+	delete general;
+
+	return determinant;
+}
+
+MatrixBase* TiledMatrix::getMinorMatrix() const
+{
+	MatrixBase* general = toGeneral();
+	MatrixBase* minorMatrix = general->getMinorMatrix();
+	delete general;
+
+	return minorMatrix;
+}
+
+void TiledMatrix::applyCheckerboardPattern()
+{
+	for (size_t tileRow = 0; tileRow < numTileRows; tileRow++)
+	{
+		for (size_t tileColumn = 0; tileColumn < numTileColumns; tileColumn++)
+		{
+			MatrixBase* tile = getTile(tileRow, tileColumn);
+
+			if (tile == nullptr)
+			{
+				continue;
+			}
+
+			tile->applyCheckerboardPattern();
+
+			// The pattern of the tile starts from its own top left cell. Flip it if the top left cell is an odd cell of the whole matrix.
+			if ((tileRow * tileSize + tileColumn * tileSize) % 2 == 1)
+			{
+				tile->scale(-1.0);
+			}
+		}
+	}
+}
+
+MatrixBase* TiledMatrix::getInverse(double determinant) const
+{
+	MatrixBase* general = toGeneral();
+	MatrixBase* inverse = general->getInverse(determinant);
+	delete general;
+
+	return inverse;
+}
+
+std::string TiledMatrix::getPrintStr(size_t precision) const
+{
+	MatrixBase* general = toGeneral();
+	std::string printStr = general->getPrintStr(precision);
+	delete general;
+
+	return printStr;
+}
+
+std::string TiledMatrix::solveFor(const MatrixBase& augmentedColumn, bool verbose, size_t doublePrecision) const
+{
+	MatrixBase* general = toGeneral();
+	std::string solution = general->solveFor(augmentedColumn, verbose, doublePrecision);
+	delete general;
+
+	return solution;
+}
+
+size_t TiledMatrix::getRank() const
+{
+	MatrixBase* general = toGeneral();
+	size_t rank = general->getRank();
+	delete general;
+
+	return rank;
+}
+
+// Private members
+
+MatrixBase* TiledMatrix::getTile(size_t tileRow, size_t tileColumn) const
+{
+	return tiles[tileRow * numTileColumns + tileColumn];
+}
+
+MatrixBase*& TiledMatrix::getTileRef(size_t tileRow, size_t tileColumn)
+{
+	return tiles[tileRow * numTileColumns + tileColumn];
+}
+
+size_t TiledMatrix::getTileNumRows(size_t tileRow) const
+{
+	return std::min(tileSize, numRows - tileRow * tileSize);
+}
+
+size_t TiledMatrix::getTileNumColumns(size_t tileColumn) const
+{
+	return std::min(tileSize, numColumns - tileColumn * tileSize);
+}
+
+void TiledMatrix::clearTiles()
+{
+	for (size_t i = 0; i < tiles.size(); i++)
+	{
+		delete tiles[i];
+		tiles[i] = nullptr;
+	}
+}
+
+const TiledMatrix& TiledMatrix::getTiledOperand(const MatrixBase& operand, TiledMatrix*& ownedCopy) const
+{
+	ownedCopy = nullptr;
+
+	const TiledMatrix* tiledOperand = dynamic_cast<const TiledMatrix*>(&operand);
+
+	if (tiledOperand != nullptr && tiledOperand->tileSize == tileSize)
+	{
+		return *tiledOperand;
+	}
+
+	ownedCopy = fromMatrix(operand, tileSize);
+
+	return *ownedCopy;
+}
+
+TiledMatrix* TiledMatrix::addTiled(const TiledMatrix& left, const TiledMatrix& right, double alpha)
+{
+	TiledMatrix* sum = new TiledMatrix(left.numRows, left.numColumns, left.tileSize);
+
+	for (size_t i = 0; i < sum->tiles.size(); i++)
+	{
+		const MatrixBase* leftTile = left.tiles[i];
+		const MatrixBase* rightTile = right.tiles[i];
+
+		if (rightTile == nullptr)
+		{
+			sum->tiles[i] = (leftTile != nullptr) ? leftTile->clone() : nullptr; // Both all-zero: nothing to add.
+		}
+		else if (leftTile == nullptr)
+		{
+			sum->tiles[i] = rightTile->clone();
+			sum->tiles[i]->scale(alpha);
+		}
+		else
+		{
+			// The tiles pick the right algorithm for their storage through Double Dispatch.
+			sum->tiles[i] = (alpha == 1.0) ? leftTile->add(*rightTile) : leftTile->subtract(*rightTile);
+		}
+	}
+
+	sum->updateTileStorage();
+
+	return sum;
+}
+
+TiledMatrix* TiledMatrix::multiplyTiled(const TiledMatrix& left, const TiledMatrix& right)
+{
+	TiledMatrix* product = new TiledMatrix(left.numRows, right.numColumns, left.tileSize);
+
+	product->accumulateProduct(1.0, left, right);
+	product->updateTileStorage();
+
+	return product;
+}
+
+bool TiledMatrix::equalTiled(const TiledMatrix& left, const TiledMatrix& right)
+{
+	if (left.numRows != right.numRows || left.numColumns != right.numColumns)
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < left.tiles.size(); i++)
+	{
+		const MatrixBase* leftTile = left.tiles[i];
+		const MatrixBase* rightTile = right.tiles[i];
+
+		if (leftTile == nullptr && rightTile == nullptr)
+		{
+			continue;
+		}
+
+		if (leftTile == nullptr || rightTile == nullptr)
+		{
+			// An all-zero tile is equal to a stored tile of zeros only.
+			const MatrixBase* storedTile = (leftTile != nullptr) ? leftTile : rightTile;
+
+			if (storedTile->getNumNonZeros() != 0)
+			{
+				return false;
+			}
+
+			continue;
+		}
+
+		if (leftTile->equal(*rightTile) == false)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void TiledMatrix::accumulateProduct(double alpha, const TiledMatrix& left, const TiledMatrix& right)
+{
+	// C(i, j) += alpha * A(i, k) * B(k, j), for every pair of tiles which are not all-zero.
+	for (size_t i = 0; i < left.numTileRows; i++)
+	{
+		for (size_t k = 0; k < left.numTileColumns; k++)
+		{
+			const MatrixBase* leftTile = left.getTile(i, k);
+
+			if (leftTile == nullptr)
+			{
+				continue;
+			}
+
+			for (size_t j = 0; j < right.numTileColumns; j++)
+			{
+				const MatrixBase* rightTile = right.getTile(k, j);
+
+				if (rightTile == nullptr)
+				{
+					continue;
+				}
+
+				MatrixBase*& resultTile = getTileRef(i, j);
+
+				if (resultTile == nullptr)
+				{
+					resultTile = leftTile->multiply(*rightTile);
+
+					if (alpha != 1.0)
+					{
+						resultTile->scale(alpha);
+					}
+				}
+				else if (dynamic_cast<DenseMatrix*>(resultTile) != nullptr)
+				{
+					resultTile->multiplyAccumulate(alpha, *leftTile, *rightTile, 1.0); // No temporary product.
+				}
+				else
+				{
+					MatrixBase* tileProduct = leftTile->multiply(*rightTile);
+					resultTile->addInPlace(*tileProduct, alpha);
+					delete tileProduct;
+				}
+			}
+		}
+	}
+}
+
+MatrixBase* TiledMatrix::toGeneral() const
+{
+	if (MatrixCostModel::getInstance().isDenseCheaper(numRows, numColumns, getNumNonZeros()))
+	{
+		return cloneAsDenseMatrix();
+	}
+
+	return cloneAsSparseMatrix();
+}
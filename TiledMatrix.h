@@ -0,0 +1,395 @@
+#ifndef TILED_MATRIX_H
+#define TILED_MATRIX_H
+
+#include "MatrixBase.h"
+#include <vector>
+
+/**
+* A matrix which is divided into square tiles of a fixed size (the tiles at the right and bottom edges may be smaller). Each tile picks its own storage: DenseMatrix, SparseMatrix, or nothing at all for an all-zero tile.
+* Meant for the matrices which are neither uniformly dense nor uniformly sparse (e.g. dense blocks around the diagonal and a sparse far field).
+* Multiplication and addition are performed tile pair by tile pair through the Double Dispatch of the tiles, and the all-zero tiles are skipped. When the other operand is not a TiledMatrix, it is tiled first, and the result is a TiledMatrix.
+* The other operations are performed on a general copy (DenseMatrix or SparseMatrix).
+*/
+class TiledMatrix : public MatrixBase
+{
+public:
+	/**
+	* The storage of a tile.
+	*/
+	enum class TileStorage
+	{
+		Zero,
+		Dense,
+		Sparse
+	};
+
+	/**
+	* The default number of rows (and columns) of a tile.
+	*/
+	static const size_t DefaultTileSize = 64;
+
+	/**
+	* Creates a zero matrix. Every tile is an all-zero tile.
+	* @param numRows The number of rows of the matrix.
+	* @param numColumns The number of columns of the matrix.
+	* @param tileSize The number of rows (and columns) of a tile. Zero is replaced by DefaultTileSize.
+	*/
+	TiledMatrix(size_t numRows, size_t numColumns, size_t tileSize = DefaultTileSize);
+	/**
+	* Copy Constructor. Copies every tile.
+	*/
+	TiledMatrix(const TiledMatrix& other);
+	/**
+	* The tiles are owned by the matrix; copy it with the Copy Constructor or clone instead.
+	*/
+	TiledMatrix& operator=(const TiledMatrix& other) = delete;
+	/**
+	* Destructor. Deletes every tile.
+	*/
+	~TiledMatrix();
+	/**
+	* Creates a tiled copy of a matrix. The storage of each tile is picked by the cost model (see updateTileStorage).
+	* @param source The matrix to be copied.
+	* @param tileSize The number of rows (and columns) of a tile. Zero is replaced by DefaultTileSize.
+	* @return A raw pointer to a TiledMatrix instance.
+	*/
+	static TiledMatrix* fromMatrix(const MatrixBase& source, size_t tileSize = DefaultTileSize);
+	/**
+	* Returns the number of rows (and columns) of a tile.
+	*/
+	size_t getTileSize() const;
+	/**
+	* Returns the number of tiles in a column of tiles.
+	*/
+	size_t getNumTileRows() const;
+	/**
+	* Returns the number of tiles in a row of tiles.
+	*/
+	size_t getNumTileColumns() const;
+	/**
+	* Returns the storage of a tile.
+	* @param tileRow Row index of the tile.
+	* @param tileColumn Column index of the tile.
+	*/
+	TileStorage getTileStorage(size_t tileRow, size_t tileColumn) const;
+	/**
+	* Picks the storage of every tile again: the tiles without any non-zero elements are released, and the others are converted between DenseMatrix and SparseMatrix when the cost model says so.
+	* Called after every operation which creates a TiledMatrix. Call it after many setCell calls, too.
+	* @see MatrixBase::requiresConversion()
+	*/
+	void updateTileStorage();
+
+	/**
+	* Returns the number of rows of this matrix.
+	*/
+	virtual size_t getNumRows() const override;
+	/**
+	* Returns the number of columns of this matrix.
+	*/
+	virtual size_t getNumColumns() const override;
+	/**
+	* Returns the double value at a given cell. Indices start from zero.
+	* @param row Row index of the matrix.
+	* @param column Column index of the matrix.
+	*/
+	virtual double getCell(size_t row, size_t column) const override;
+	/**
+	* Sets a cell to the given value. Setting a non-zero value in an all-zero tile creates a SparseMatrix tile.
+	* @param row Row index of the matrix.
+	* @param column Column index of the matrix.
+	* @param value The value to be set in the cell.
+	*/
+	virtual void setCell(size_t row, size_t column, double value) override;
+	/**
+	* Resizes the matrix by rows. New cells are zero.
+	*/
+	virtual void resizeNumRows(size_t newNumRows) override;
+	/**
+	* Resizes the matrix by columns. New cells are zero.
+	*/
+	virtual void resizeNumColumns(size_t newNumColumns) override;
+	/**
+	* Resizes the matrix. New cells are zero.
+	*/
+	virtual void resize(size_t newNumRows, size_t newNumColumns) override;
+	/**
+	* Transposes the grid of tiles, and every tile.
+	*/
+	virtual void transpose() override;
+	/**
+	* Gets the Sparsity value of the matrix. Sparsity is the ratio of numZeroElements/numTotalElements.
+	*/
+	virtual double getSparsity() const override;
+	/**
+	* Returns the number of non-zero elements, summed over the tiles.
+	*/
+	virtual size_t getNumNonZeros() const override;
+	/**
+	* Gets the Density value of the matrix. Density is the ratio of numNonZeroElements/numTotalElements.
+	*/
+	virtual double getDensity() const override;
+	/**
+	* Checks if the matrix's Sparsity is greater than SparsityThreshold.
+	*/
+	virtual bool isSparse() const override;
+	/**
+	* Checks if the matrix's Density is greater than or equal to DensityThreshold.
+	*/
+	virtual bool isDense() const override;
+	/**
+	* Checks if the storage of any tile should be picked again. A TiledMatrix never requires conversion to another type of matrix.
+	*/
+	virtual bool requiresConversion() const override;
+	/**
+	* Returns a copy of this matrix, with the storage of every tile picked again.
+	* @see updateTileStorage()
+	*/
+	virtual MatrixBase* getConvertedCopy() const override;
+	/**
+	* Creates a deep copy of this matrix.
+	* @return A raw pointer to MatrixBase instance.
+	*/
+	virtual MatrixBase* clone() const override;
+	/**
+	* Returns a DenseMatrix copy of this matrix.
+	*/
+	virtual DenseMatrix* cloneAsDenseMatrix() const override;
+	/**
+	* Returns a SparseMatrix copy of this matrix.
+	*/
+	virtual SparseMatrix* cloneAsSparseMatrix() const override;
+	/**
+	* Calls the visitor for every non-zero cell of this matrix, in row-major order. The all-zero tiles are skipped.
+	*/
+	virtual void forEachNonZero(const std::function<void(size_t row, size_t column, double value)>& visitor) const override;
+	/**
+	* Scales every tile. Scaling by zero releases every tile.
+	*/
+	virtual void scale(double scalar) override;
+	/**
+	* Adds (alpha * right) to this matrix in place. A TiledMatrix argument is added tile by tile; any other matrix is added one non-zero element at a time.
+	*/
+	virtual void addInPlace(const MatrixBase& right, double alpha) override;
+	/**
+	* Adds (alpha * this) to the target, tile by tile. The all-zero tiles are skipped.
+	*/
+	virtual void addScaledTo(DenseMatrix& target, double alpha) const override;
+	/**
+	* Adds (alpha * this) to the target, tile by tile. The all-zero tiles are skipped.
+	*/
+	virtual void addScaledTo(SparseMatrix& target, double alpha) const override;
+	/**
+	* Performs this = alpha * left * right + beta * this. The product of each pair of tiles is accumulated into the tile of this matrix, and the pairs with an all-zero tile are skipped.
+	*/
+	virtual void multiplyAccumulate(double alpha, const MatrixBase& left, const MatrixBase& right, double beta) override;
+	/**
+	* Checks the equality of this matrix with the argument, tile by tile.
+	*/
+	virtual bool equal(const MatrixBase& right) const override;
+	/**
+	* Checks the equality of the argument with this matrix, tile by tile.
+	*/
+	virtual bool equal(const DenseMatrix& left) const override;
+	/**
+	* Checks the equality of the argument with this matrix, tile by tile.
+	*/
+	virtual bool equal(const SparseMatrix& left) const override;
+	/**
+	* Calculates (this + right), tile by tile.
+	*/
+	virtual MatrixBase* add(const MatrixBase& right) const override;
+	/**
+	* Calculates (left + this), tile by tile.
+	*/
+	virtual MatrixBase* add(const DenseMatrix& left) const override;
+	/**
+	* Calculates (left + this), tile by tile.
+	*/
+	virtual MatrixBase* add(const SparseMatrix& left) const override;
+	/**
+	* Calculates (this - right), tile by tile.
+	*/
+	virtual MatrixBase* subtract(const MatrixBase& right) const override;
+	/**
+	* Calculates (left - this), tile by tile.
+	*/
+	virtual MatrixBase* subtract(const DenseMatrix& left) const override;
+	/**
+	* Calculates (left - this), tile by tile.
+	*/
+	virtual MatrixBase* subtract(const SparseMatrix& left) const override;
+	/**
+	* Calculates (this * right), tile pair by tile pair.
+	*/
+	virtual MatrixBase* multiply(const MatrixBase& right) const override;
+	/**
+	* Calculates (left * this), tile pair by tile pair.
+	*/
+	virtual MatrixBase* multiply(const DenseMatrix& left) const override;
+	/**
+	* Calculates (left * this), tile pair by tile pair.
+	*/
+	virtual MatrixBase* multiply(const SparseMatrix& left) const override;
+	/**
+	* Merges this matrix and the argument by columns, through a general copy of this matrix.
+	*/
+	virtual MatrixBase* mergeByColumns(const MatrixBase& right) const override;
+	/**
+	* Merges the argument and this matrix by columns, through a general copy of this matrix.
+	*/
+	virtual MatrixBase* mergeByColumns(const DenseMatrix& left) const override;
+	/**
+	* Merges the argument and this matrix by columns, through a general copy of this matrix.
+	*/
+	virtual MatrixBase* mergeByColumns(const SparseMatrix& left) const override;
+	/**
+	* Merges this matrix and the argument by rows, through a general copy of this matrix.
+	*/
+	virtual MatrixBase* mergeByRows(const MatrixBase& right) const override;
+	/**
+	* Merges the argument and this matrix by rows, through a general copy of this matrix.
+	*/
+	virtual MatrixBase* mergeByRows(const DenseMatrix& left) const override;
+	/**
+	* Merges the argument and this matrix by rows, through a general copy of this matrix.
+	*/
+	virtual MatrixBase* mergeByRows(const SparseMatrix& left) const override;
+	/**
+	* Splits a general copy of this matrix by columns.
+	*/
+	virtual MatrixBase* splitByColumn(size_t leftNewNumColumns, bool returnLeftMatrix) const override;
+	/**
+	* Splits a general copy of this matrix by rows.
+	*/
+	virtual MatrixBase* splitByRow(size_t topNewNumRows, bool returnTopMatrix) const override;
+	/**
+	* Returns a submatrix of a general copy of this matrix.
+	*/
+	virtual MatrixBase* getSubMatrix(size_t subRowBeginIndex, size_t subNumRows, size_t subColumnBeginIndex, size_t subNumColumns) const override;
+	/**
+	* Returns a submatrix of a general copy of this matrix.
+	*/
+	virtual MatrixBase* getSubMatrix(size_t ignoredRowIndex, size_t ignoredColumnIndex) const override;
+	/**
+	* Returns the top left part of a general copy of this matrix.
+	*/
+	virtual MatrixBase* getSubMatrixTopLeft(size_t ignoredRowIndex, size_t ignoredColumnIndex) const override;
+	/**
+	* Returns the top right part of a general copy of this matrix.
+	*/
+	virtual MatrixBase* getSubMatrixTopRight(size_t ignoredRowIndex, size_t ignoredColumnIndex) const override;
+	/**
+	* Returns the bottom left part of a general copy of this matrix.
+	*/
+	virtual MatrixBase* getSubMatrixBottomLeft(size_t ignoredRowIndex, size_t ignoredColumnIndex) const override;
+	/**
+	* Returns the bottom right part of a general copy of this matrix.
+	*/
+	virtual MatrixBase* getSubMatrixBottomRight(size_t ignoredRowIndex, size_t ignoredColumnIndex) const override;
+	/**
+	* Calculates the determinant of a general copy of this matrix.
+	*/
+	virtual double getDeterminant() const override;
+	/**
+	* Returns the matrix of minors of a general copy of this matrix.
+	*/
+	virtual MatrixBase* getMinorMatrix() const override;
+	/**
+	* Applies the checkerboard pattern tile by tile.
+	*/
+	virtual void applyCheckerboardPattern() override;
+	/**
+	* Returns the inverse of a general copy of this matrix.
+	*/
+	virtual MatrixBase* getInverse(double determinant) const override;
+	/**
+	* Prepares the output string of a general copy of this matrix.
+	*/
+	virtual std::string getPrintStr(size_t precision) const override;
+	/**
+	* Solves the system with a general copy of this matrix.
+	*/
+	virtual std::string solveFor(const MatrixBase& augmentedColumn, bool verbose, size_t doublePrecision) const override;
+	/**
+	* Calculates the rank of a general copy of this matrix.
+	*/
+	virtual size_t getRank() const override;
+
+private:
+	/**
+	* The type of the grid of tiles. Its memory is served by MatrixMemory.
+	*/
+	typedef std::vector<MatrixBase*, MatrixStorageAllocator<MatrixBase*>> TileStorageGrid;
+
+	/**
+	* The number of rows of this matrix.
+	*/
+	size_t numRows;
+	/**
+	* The number of columns of this matrix.
+	*/
+	size_t numColumns;
+	/**
+	* The number of rows (and columns) of a tile.
+	*/
+	size_t tileSize;
+	/**
+	* The number of tiles in a column of tiles.
+	*/
+	size_t numTileRows;
+	/**
+	* The number of tiles in a row of tiles.
+	*/
+	size_t numTileColumns;
+	/**
+	* The tiles, in row-major order. An all-zero tile is nullptr; the others are DenseMatrix or SparseMatrix instances owned by this matrix.
+	*/
+	TileStorageGrid tiles;
+
+	/**
+	* Returns a tile. nullptr is an all-zero tile.
+	*/
+	MatrixBase* getTile(size_t tileRow, size_t tileColumn) const;
+	/**
+	* Returns a reference to the pointer of a tile, so that the tile can be replaced.
+	*/
+	MatrixBase*& getTileRef(size_t tileRow, size_t tileColumn);
+	/**
+	* Returns the number of rows of the tiles in a row of tiles (the bottom ones may be smaller).
+	*/
+	size_t getTileNumRows(size_t tileRow) const;
+	/**
+	* Returns the number of columns of the tiles in a column of tiles (the rightmost ones may be smaller).
+	*/
+	size_t getTileNumColumns(size_t tileColumn) const;
+	/**
+	* Deletes every tile and leaves all-zero tiles behind.
+	*/
+	void clearTiles();
+	/**
+	* Returns the argument if it is a TiledMatrix with the same tile size as this matrix. Otherwise, tiles it, and returns the tiled copy, which is also stored in ownedCopy (to be deleted by the caller).
+	*/
+	const TiledMatrix& getTiledOperand(const MatrixBase& operand, TiledMatrix*& ownedCopy) const;
+	/**
+	* Calculates (left + alpha * right) tile by tile, where alpha is 1.0 (addition) or -1.0 (subtraction). Both of the arguments must have the same dimensions and tile size.
+	*/
+	static TiledMatrix* addTiled(const TiledMatrix& left, const TiledMatrix& right, double alpha);
+	/**
+	* Calculates (left * right) tile pair by tile pair. Both of the arguments must have the same tile size.
+	*/
+	static TiledMatrix* multiplyTiled(const TiledMatrix& left, const TiledMatrix& right);
+	/**
+	* Checks the equality of the arguments tile by tile. Both of the arguments must have the same tile size.
+	*/
+	static bool equalTiled(const TiledMatrix& left, const TiledMatrix& right);
+	/**
+	* Accumulates (alpha * left * right) into this matrix, tile pair by tile pair. The all-zero tiles are skipped.
+	*/
+	void accumulateProduct(double alpha, const TiledMatrix& left, const TiledMatrix& right);
+	/**
+	* Returns a general copy of this matrix: a DenseMatrix or a SparseMatrix, whichever is cheaper according to the cost model.
+	*/
+	MatrixBase* toGeneral() const;
+};
+
+#endif // TILED_MATRIX_H
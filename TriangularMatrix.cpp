@@ -0,0 +1,185 @@
+#include "TriangularMatrix.h"
+#include "DenseMatrix.h"
+#include "MatCalcUtil.h"
+#include "MatCalcKernels.h"
+
+// Public members
+
+TriangularMatrix::TriangularMatrix(size_t numDimensions, bool isUpper)
+{
+	this->numDimensions = numDimensions;
+	isUpperTriangular = isUpper;
+
+	packedCells.assign(numDimensions * (numDimensions + 1) / 2, 0.0);
+}
+
+bool TriangularMatrix::isUpper() const
+{
+	return isUpperTriangular;
+}
+
+MatrixBase* TriangularMatrix::solve(const MatrixBase& rightHandSide) const
+{
+	return mck::solveTriangular(*this, rightHandSide, !isUpperTriangular, false, false);
+}
+
+size_t TriangularMatrix::getNumRows() const
+{
+	return numDimensions;
+}
+
+size_t TriangularMatrix::getNumColumns() const
+{
+	return numDimensions;
+}
+
+double TriangularMatrix::getCell(size_t row, size_t column) const
+{
+	return isInTriangle(row, column) ? packedCells[getPackedIndex(row, column)] : 0.0;
+}
+
+void TriangularMatrix::setCell(size_t row, size_t column, double value)
+{
+	if (isInTriangle(row, column))
+	{
+		packedCells[getPackedIndex(row, column)] = value;
+	}
+	// else see canSetCell.
+}
+
+bool TriangularMatrix::canSetCell(size_t row, size_t column, double value) const
+{
+	return isInTriangle(row, column) || mcu::doubleAlmostEqual(value, 0.0);
+}
+
+void TriangularMatrix::transpose()
+{
+	TriangularMatrix transposed(numDimensions, !isUpperTriangular);
+
+	for (size_t r = 0; r < numDimensions; r++)
+	{
+		size_t beginColumn = isUpperTriangular ? r : 0;
+		size_t endColumn = isUpperTriangular ? numDimensions : (r + 1);
+
+		for (size_t c = beginColumn; c < endColumn; c++)
+		{
+			transposed.packedCells[transposed.getPackedIndex(c, r)] = packedCells[getPackedIndex(r, c)];
+		}
+	}
+
+	isUpperTriangular = transposed.isUpperTriangular;
+	packedCells.swap(transposed.packedCells);
+}
+
+size_t TriangularMatrix::getNumNonZeros() const
+{
+	size_t numNonZeros = 0;
+
+	for (size_t i = 0; i < packedCells.size(); i++)
+	{
+		if (mcu::doubleAlmostEqual(packedCells[i], 0.0) == false)
+		{
+			numNonZeros++;
+		}
+	}
+
+	return numNonZeros;
+}
+
+MatrixBase* TriangularMatrix::clone() const
+{
+	return new TriangularMatrix(*this);
+}
+
+void TriangularMatrix::forEachNonZero(const std::function<void(size_t row, size_t column, double value)>& visitor) const
+{
+	for (size_t r = 0; r < numDimensions; r++)
+	{
+		size_t beginColumn = isUpperTriangular ? r : 0;
+		size_t endColumn = isUpperTriangular ? numDimensions : (r + 1);
+		const double* packedRow = packedCells.data() + getPackedIndex(r, beginColumn);
+
+		for (size_t c = beginColumn; c < endColumn; c++)
+		{
+			double value = packedRow[c - beginColumn];
+
+			if (mcu::doubleAlmostEqual(value, 0.0) == false)
+			{
+				visitor(r, c, value);
+			}
+		}
+	}
+}
+
+void TriangularMatrix::scale(double scalar)
+{
+	for (size_t i = 0; i < packedCells.size(); i++)
+	{
+		packedCells[i] *= scalar;
+	}
+}
+
+MatrixBase* TriangularMatrix::multiplyByRight(const MatrixBase& right) const
+{
+	const DenseMatrix* denseRight = dynamic_cast<const DenseMatrix*>(&right);
+
+	if (denseRight == nullptr)
+	{
+		return StructuredMatrix::multiplyByRight(right);
+	}
+
+	size_t rightNumColumns = right.getNumColumns();
+	DenseMatrix* product = new DenseMatrix(numDimensions, rightNumColumns, 0.0);
+
+	for (size_t r = 0; r < numDimensions; r++)
+	{
+		size_t beginColumn = isUpperTriangular ? r : 0;
+		size_t endColumn = isUpperTriangular ? numDimensions : (r + 1);
+		const double* packedRow = packedCells.data() + getPackedIndex(r, beginColumn);
+		double* productRow = product->getRowData(r);
+
+		for (size_t k = beginColumn; k < endColumn; k++)
+		{
+			double coefficient = packedRow[k - beginColumn];
+			const double* rightRow = denseRight->getRowData(k);
+
+			for (size_t c = 0; c < rightNumColumns; c++)
+			{
+				productRow[c] += coefficient * rightRow[c];
+			}
+		}
+	}
+
+	return product;
+}
+
+double TriangularMatrix::getDeterminant() const
+{
+	double determinant = 1.0;
+
+	for (size_t d = 0; d < numDimensions; d++)
+	{
+		determinant *= packedCells[getPackedIndex(d, d)];
+	}
+
+	return determinant;
+}
+
+// Private members
+
+bool TriangularMatrix::isInTriangle(size_t row, size_t column) const
+{
+	return isUpperTriangular ? (row <= column) : (column <= row);
+}
+
+size_t TriangularMatrix::getPackedIndex(size_t row, size_t column) const
+{
+	if (isUpperTriangular)
+	{
+		// Row r starts after the (n + (n - 1) + ... + (n - r + 1)) elements of the rows above, with its diagonal element.
+		return row * numDimensions - row * (row - 1) / 2 + (column - row);
+	}
+
+	// Row r starts after the (1 + 2 + ... + r) elements of the rows above.
+	return row * (row + 1) / 2 + column;
+}
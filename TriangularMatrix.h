@@ -0,0 +1,114 @@
+#ifndef TRIANGULAR_MATRIX_H
+#define TRIANGULAR_MATRIX_H
+
+#include "StructuredMatrix.h"
+#include <vector>
+
+/**
+* A square matrix whose non-zero elements can only be on or above (upper triangular), or on or below (lower triangular) its main diagonal.
+* Only the triangle is stored, packed row by row (n * (n + 1) / 2 elements). Linear systems are solved by forward or back substitution, and the multiplication skips the zero triangle.
+*/
+class TriangularMatrix : public StructuredMatrix
+{
+public:
+	/**
+	* The type of the underlying storage. Its memory is served by MatrixMemory.
+	*/
+	typedef std::vector<double, MatrixStorageAllocator<double>> CellStorage;
+
+	/**
+	* Creates a zero triangular matrix.
+	* @param numDimensions The number of rows (and columns) of the matrix.
+	* @param isUpper True for an upper triangular matrix, false for a lower triangular matrix.
+	*/
+	TriangularMatrix(size_t numDimensions, bool isUpper);
+	/**
+	* Returns true if this is an upper triangular matrix, and false if it is a lower triangular matrix.
+	*/
+	bool isUpper() const;
+	/**
+	* Solves (this * X = rightHandSide) for X by back substitution (upper) or forward substitution (lower), for every column of rightHandSide at once (see mck::solveTriangular).
+	* @param rightHandSide The right hand side. Must have as many rows as this matrix.
+	* @return A raw pointer to a DenseMatrix holding X. nullptr if the dimensions don't match or this matrix is singular (a zero on the diagonal).
+	*/
+	MatrixBase* solve(const MatrixBase& rightHandSide) const;
+	/**
+	* Returns the number of rows of this matrix.
+	*/
+	virtual size_t getNumRows() const override;
+	/**
+	* Returns the number of columns of this matrix.
+	*/
+	virtual size_t getNumColumns() const override;
+	/**
+	* Returns the double value at a given cell. Indices start from zero.
+	* @param row Row index of the matrix.
+	* @param column Column index of the matrix.
+	*/
+	virtual double getCell(size_t row, size_t column) const override;
+	/**
+	* Sets a cell of the triangle to the given value. Cells outside of the triangle are ignored (see canSetCell).
+	* @param row Row index of the matrix.
+	* @param column Column index of the matrix.
+	* @param value The value to be set in the cell.
+	*/
+	virtual void setCell(size_t row, size_t column, double value) override;
+	/**
+	* Checks whether or not a cell can be set to a value. True for the cells of the triangle, and for zeros anywhere.
+	*/
+	virtual bool canSetCell(size_t row, size_t column, double value) const override;
+	/**
+	* Transposes this matrix, which turns an upper triangular matrix into a lower triangular one, and vice versa.
+	*/
+	virtual void transpose() override;
+	/**
+	* Returns the number of non-zero elements of the triangle.
+	*/
+	virtual size_t getNumNonZeros() const override;
+	/**
+	* Creates a deep copy of this matrix.
+	* @return A raw pointer to MatrixBase instance.
+	*/
+	virtual MatrixBase* clone() const override;
+	/**
+	* Calls the visitor for every non-zero element of the triangle, in row-major order.
+	*/
+	virtual void forEachNonZero(const std::function<void(size_t row, size_t column, double value)>& visitor) const override;
+	/**
+	* Scales every element of the triangle.
+	*/
+	virtual void scale(double scalar) override;
+	/**
+	* Calculates (this * right). When right is a DenseMatrix, only the triangle of this matrix takes part in the multiplication.
+	*/
+	virtual MatrixBase* multiplyByRight(const MatrixBase& right) const override;
+	/**
+	* Returns the product of the diagonal.
+	*/
+	virtual double getDeterminant() const override;
+
+private:
+	/**
+	* The number of rows (and columns) of the matrix.
+	*/
+	size_t numDimensions;
+	/**
+	* True for an upper triangular matrix.
+	*/
+	bool isUpperTriangular;
+	/**
+	* The elements of the triangle, packed row by row.
+	*/
+	CellStorage packedCells;
+
+	/**
+	* Checks whether or not a cell is inside the triangle.
+	*/
+	bool isInTriangle(size_t row, size_t column) const;
+	/**
+	* Returns the index of a cell of the triangle in packedCells.
+	*/
+	size_t getPackedIndex(size_t row, size_t column) const;
+};
+
+#endif // TRIANGULAR_MATRIX_H